@@ -289,6 +289,10 @@ _Static_assert(ARRAY_GROWTH_FACTOR_NUMERATOR > ARRAY_GROWTH_FACTOR_DENOMINATOR,
 //   (Warning: uses at least as much stack space as the size of one element)
 #define array_shuffle(a, random)        _arr_shuffle(a, random)
 
+// void array_shuffle_state(array_t(T) a, struct random_state *state)
+//   like array_shuffle, but unbiased and much faster (see random_shuffle, requires random.h)
+#define array_shuffle_state(a, state)   random_shuffle((state), (a), array_length(a), sizeof((a)[0]))
+
 // void array_call_foreach(array_t(T) a, void (*func)(T *))
 //   for each element in the array call func with a pointer to the current element
 #define array_call_foreach(a, func)              _arr_call_foreach(a, func)
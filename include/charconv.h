@@ -35,6 +35,10 @@ enum to_chars_flags {
 	TO_CHARS_LEADING_ZEROS = 128, // %0n with n=maxlen for the specified conversion
 	TO_CHARS_PLUS_SIGN = 256, // %+
 	TO_CHARS_UPPERCASE = 512, // %x -> %X
+
+	// floating point styles (the default is the shorter of the two, like std::to_chars)
+	TO_CHARS_FIXED = 1024, // %f
+	TO_CHARS_SCIENTIFIC = 2048, // %e
 };
 
 __AD_LINKAGE size_t to_chars_char(char *buf, char val, unsigned int flags) _attr_unused;
@@ -48,6 +52,13 @@ __AD_LINKAGE size_t to_chars_long(char *buf, long val, unsigned int flags) _attr
 __AD_LINKAGE size_t to_chars_ulong(char *buf, unsigned long val, unsigned int flags) _attr_unused;
 __AD_LINKAGE size_t to_chars_llong(char *buf, long long val, unsigned int flags) _attr_unused;
 __AD_LINKAGE size_t to_chars_ullong(char *buf, unsigned long long val, unsigned int flags) _attr_unused;
+// Floating point values are written with the fewest digits that still parse back (strtod) to the same value
+// (Ryu), in the "C" locale. TO_CHARS_PLUS_SIGN and TO_CHARS_UPPERCASE apply, the other integer flags are ignored.
+// The result has at most TO_CHARS_DOUBLE_MAX_LENGTH or TO_CHARS_FLOAT_MAX_LENGTH characters.
+#define TO_CHARS_DOUBLE_MAX_LENGTH 330
+#define TO_CHARS_FLOAT_MAX_LENGTH 50
+__AD_LINKAGE size_t to_chars_double(char *buf, double val, unsigned int flags) _attr_unused;
+__AD_LINKAGE size_t to_chars_float(char *buf, float val, unsigned int flags) _attr_unused;
 #define to_chars(buf, val, flags) _Generic(val,				\
 					   char : to_chars_char(buf, (char)val, flags), \
 					   unsigned char : to_chars_uchar(buf, (unsigned char)val, flags), \
@@ -59,45 +70,56 @@ __AD_LINKAGE size_t to_chars_ullong(char *buf, unsigned long long val, unsigned
 					   signed short : to_chars_short(buf, (signed short)val, flags), \
 					   signed int : to_chars_int(buf, (signed int)val, flags), \
 					   signed long : to_chars_long(buf, (signed long)val, flags), \
-					   signed long long : to_chars_llong(buf, (signed long long)val, flags))
+					   signed long long : to_chars_llong(buf, (signed long long)val, flags), \
+					   float : to_chars_float(buf, (float)val, flags), \
+					   double : to_chars_double(buf, (double)val, flags))
 
-#if 0 // TODO implement
 enum from_chars_flags {
-	FROM_CHARS_AUTODETECT_BASE = 0, // autodetect base according to C syntax
+	FROM_CHARS_AUTODETECT_BASE = 0, // autodetect base according to C syntax (0x, 0b and 0 prefixes)
 
 	FROM_CHARS_BINARY = 2, // %b
 	FROM_CHARS_OCTAL = 8, // %o
 	FROM_CHARS_DECIMAL = 10, // %d, %u
-	FROM_CHARS_HEXADECIMAL = 16, // %x
+	FROM_CHARS_HEXADECIMAL = 16, // %x, %X
 
 	__FROM_CHARS_BASE_MASK = 63, // base must be between 2 and 36 inclusive
 
 	// TODO FROM_CHARS_SKIP_LEADING_WHITESPACE
 };
 
-__AD_LINKAGE size_t from_chars_char(char *chars, size_t nchars, char *retval, unsigned int flags) _attr_unused;
-__AD_LINKAGE size_t from_chars_schar(char *chars, size_t nchars, signed char *retval, unsigned int flags) _attr_unused;
-__AD_LINKAGE size_t from_chars_uchar(char *chars, size_t nchars, unsigned char *retval, unsigned int flags) _attr_unused;
-__AD_LINKAGE size_t from_chars_short(char *chars, size_t nchars, short *retval, unsigned int flags) _attr_unused;
-__AD_LINKAGE size_t from_chars_ushort(char *chars, size_t nchars, unsigned short *retval, unsigned int flags) _attr_unused;
-__AD_LINKAGE size_t from_chars_int(char *chars, size_t nchars, int *retval, unsigned int flags) _attr_unused;
-__AD_LINKAGE size_t from_chars_uint(char *chars, size_t nchars, unsigned int *retval, unsigned int flags) _attr_unused;
-__AD_LINKAGE size_t from_chars_long(char *chars, size_t nchars, long *retval, unsigned int flags) _attr_unused;
-__AD_LINKAGE size_t from_chars_ulong(char *chars, size_t nchars, unsigned long *retval, unsigned int flags) _attr_unused;
-__AD_LINKAGE size_t from_chars_llong(char *chars, size_t nchars, long long *retval, unsigned int flags) _attr_unused;
-__AD_LINKAGE size_t from_chars_ullong(char *chars, size_t nchars, unsigned long long *retval, unsigned int flags) _attr_unused;
+// Parse the number at the start of the nchars characters at 'chars' (no null termination needed, nothing beyond
+// chars[nchars - 1] is read) and return the number of characters parsed. Signed types accept a '+' or '-' sign,
+// in bases other than 10 they also accept the two's complement bit pattern (as written by to_chars).
+// Returns 0 and leaves *retval unchanged if there is no number or it does not fit in the type.
+__AD_LINKAGE size_t from_chars_char(const char *chars, size_t nchars, char *retval, unsigned int flags) _attr_unused;
+__AD_LINKAGE size_t from_chars_schar(const char *chars, size_t nchars, signed char *retval,
+				     unsigned int flags) _attr_unused;
+__AD_LINKAGE size_t from_chars_uchar(const char *chars, size_t nchars, unsigned char *retval,
+				     unsigned int flags) _attr_unused;
+__AD_LINKAGE size_t from_chars_short(const char *chars, size_t nchars, short *retval, unsigned int flags) _attr_unused;
+__AD_LINKAGE size_t from_chars_ushort(const char *chars, size_t nchars, unsigned short *retval,
+				      unsigned int flags) _attr_unused;
+__AD_LINKAGE size_t from_chars_int(const char *chars, size_t nchars, int *retval, unsigned int flags) _attr_unused;
+__AD_LINKAGE size_t from_chars_uint(const char *chars, size_t nchars, unsigned int *retval,
+				    unsigned int flags) _attr_unused;
+__AD_LINKAGE size_t from_chars_long(const char *chars, size_t nchars, long *retval, unsigned int flags) _attr_unused;
+__AD_LINKAGE size_t from_chars_ulong(const char *chars, size_t nchars, unsigned long *retval,
+				     unsigned int flags) _attr_unused;
+__AD_LINKAGE size_t from_chars_llong(const char *chars, size_t nchars, long long *retval,
+				     unsigned int flags) _attr_unused;
+__AD_LINKAGE size_t from_chars_ullong(const char *chars, size_t nchars, unsigned long long *retval,
+				      unsigned int flags) _attr_unused;
 #define from_chars(chars, nchars, retval, flags) _Generic(retval,	\
 							  char * : from_chars_char(chars, nchars, (char *)retval, flags), \
-							  unsigned char * : from_chars_char(chars, nchars, (unsigned char *)retval, flags), \
-							  unsigned short * : from_chars_char(chars, nchars, (unsigned short *)retval, flags), \
-							  unsigned int * : from_chars_char(chars, nchars, (unsigned int *)retval, flags), \
-							  unsigned long * : from_chars_char(chars, nchars, (unsigned long *)retval, flags), \
-							  unsigned long long * : from_chars_char(chars, nchars, (unsigned long long *)retval, flags), \
-							  signed char * : from_chars_char(chars, nchars, (signed char *)retval, flags), \
-							  signed short * : from_chars_char(chars, nchars, (signed short *)retval, flags), \
-							  signed int * : from_chars_char(chars, nchars, (signed int *)retval, flags), \
-							  signed long * : from_chars_char(chars, nchars, (signed long *)retval, flags), \
-							  signed long long * : from_chars_char(chars, nchars, (signed long long *)retval, flags))
-#endif
+							  unsigned char * : from_chars_uchar(chars, nchars, (unsigned char *)retval, flags), \
+							  unsigned short * : from_chars_ushort(chars, nchars, (unsigned short *)retval, flags), \
+							  unsigned int * : from_chars_uint(chars, nchars, (unsigned int *)retval, flags), \
+							  unsigned long * : from_chars_ulong(chars, nchars, (unsigned long *)retval, flags), \
+							  unsigned long long * : from_chars_ullong(chars, nchars, (unsigned long long *)retval, flags), \
+							  signed char * : from_chars_schar(chars, nchars, (signed char *)retval, flags), \
+							  signed short * : from_chars_short(chars, nchars, (signed short *)retval, flags), \
+							  signed int * : from_chars_int(chars, nchars, (signed int *)retval, flags), \
+							  signed long * : from_chars_long(chars, nchars, (signed long *)retval, flags), \
+							  signed long long * : from_chars_llong(chars, nchars, (signed long long *)retval, flags))
 
 #endif
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __CHECKSUM_INCLUDE__
+#define __CHECKSUM_INCLUDE__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "compiler.h"
+
+/* Checksums for detecting accidental corruption (see hash.h for keyed and general purpose hashes,
+ * xxh3_64 is a good choice if it doesn't have to be a CRC).
+ * All of them can be computed incrementally by passing the previous result back in, e.g.
+ *     uint32_t crc = CRC32C_INIT;
+ *     crc = crc32c(crc, buf1, len1);
+ *     crc = crc32c(crc, buf2, len2); // == crc32c(CRC32C_INIT, buf1 ++ buf2, len1 + len2)
+ * and the checksums of two buffers can be combined into the checksum of their concatenation
+ * without access to the data (which allows computing them in parallel).
+ */
+
+#define CRC32C_INIT  UINT32_C(0)
+#define ADLER32_INIT UINT32_C(1)
+
+// CRC-32C (Castagnoli), as used by iSCSI, ext4, etc. (crc32c(0, "123456789", 9) == 0xe3069283)
+// (uses the SSE4.2 crc32 instruction and PCLMULQDQ if the CPU supports them, slicing-by-8 otherwise)
+__AD_LINKAGE uint32_t crc32c(uint32_t crc, const void *data, size_t len) _attr_unused _attr_pure;
+// return the CRC-32C of the concatenation of two buffers with CRCs crc1 and crc2 (len2 is the length of the second)
+__AD_LINKAGE uint32_t crc32c_combine(uint32_t crc1, uint32_t crc2, uint64_t len2) _attr_unused _attr_const;
+
+// Adler-32 (as used by zlib)
+__AD_LINKAGE uint32_t adler32(uint32_t adler, const void *data, size_t len) _attr_unused _attr_pure;
+__AD_LINKAGE uint32_t adler32_combine(uint32_t adler1, uint32_t adler2, uint64_t len2) _attr_unused _attr_const;
+
+// private API
+
+// CRC-32C without any special instructions
+__AD_LINKAGE uint32_t _crc32c_portable(uint32_t crc, const void *data, size_t len) _attr_unused _attr_pure;
+
+#endif
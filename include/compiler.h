@@ -73,6 +73,12 @@
 #if __has_attribute(noinline)
 # define HAVE_ATTR_NOINLINE 1
 #endif
+#if __has_attribute(vector_size)
+# define HAVE_ATTR_VECTOR_SIZE 1
+#endif
+#if __has_attribute(target)
+# define HAVE_ATTR_TARGET 1
+#endif
 #if __has_attribute(constructor)
 # define HAVE_ATTR_CONSTRUCTOR 1
 #endif
@@ -113,6 +119,9 @@
 #if !defined(HAVE_BUILTIN_POPCOUNT) && __has_builtin(__builtin_popcount)
 # define HAVE_BUILTIN_POPCOUNT 1
 #endif
+#if !defined(HAVE_BUILTIN_PREFETCH) && __has_builtin(__builtin_prefetch)
+# define HAVE_BUILTIN_PREFETCH 1
+#endif
 #if !defined(HAVE_BUILTIN_UNREACHABLE) && __has_builtin(__builtin_unreachable)
 # define HAVE_BUILTIN_UNREACHABLE 1
 #endif
@@ -202,6 +211,12 @@
 # define _attr_noinline
 #endif
 
+#ifdef HAVE_ATTR_TARGET
+# define _attr_target(isa)                   __attribute__((target(isa)))
+#else
+# define _attr_target(isa)
+#endif
+
 #ifdef HAVE_ATTR_CONSTRUCTOR
 # define _attr_constructor                   __attribute__((constructor))
 #endif
@@ -228,6 +243,14 @@
 # define unreachable()                       do {} while (0)
 #endif
 
+#ifdef HAVE_BUILTIN_PREFETCH
+# define prefetch(addr)                      __builtin_prefetch((addr), 0, 3)
+# define prefetch_write(addr)                __builtin_prefetch((addr), 1, 3)
+#else
+# define prefetch(addr)                      ((void)(addr))
+# define prefetch_write(addr)                ((void)(addr))
+#endif
+
 #ifdef HAVE_BUILTIN_OBJECT_SIZE
 # define _bos(ptr, type)                     __builtin_object_size(ptr, type)
 #else
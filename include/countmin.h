@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __COUNTMIN_INCLUDE__
+#define __COUNTMIN_INCLUDE__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "compiler.h"
+
+/* Count-min sketch: approximate counts of 64-bit keys in a fixed amount of memory.
+ * Every key is counted in one counter of each of the 'depth' rows (picked with a per-row seeded hash) and its
+ * estimate is the minimum of those counters. Estimates never underestimate and with width w and depth d
+ * overestimate by at most e / w * total with probability 1 - exp(-d).
+ * Updates are conservative (only counters below the new estimate are raised), which reduces the error
+ * considerably for skewed streams but means that sketches can only be merged by adding them up (which is
+ * still an upper bound) and counts cannot be removed.
+ */
+
+#define COUNT_MIN_MAX_DEPTH 16
+
+struct count_min {
+	// do not access these fields directly
+	uint64_t *_counters; // depth rows of width counters
+	uint64_t _total;
+	size_t _width; // a power of two
+	unsigned int _depth;
+	uint64_t _seeds[COUNT_MIN_MAX_DEPTH];
+};
+
+// width is rounded up to a power of two, depth must be in [1, COUNT_MIN_MAX_DEPTH]
+__AD_LINKAGE _attr_unused void count_min_init(struct count_min *cms, size_t width, unsigned int depth, uint64_t seed);
+// pick width and depth so that estimates exceed the true count by more than epsilon * total with a
+// probability of at most delta
+__AD_LINKAGE _attr_unused void count_min_init_with_error(struct count_min *cms, double epsilon, double delta,
+							uint64_t seed);
+__AD_LINKAGE _attr_unused void count_min_destroy(struct count_min *cms);
+__AD_LINKAGE _attr_unused void count_min_clear(struct count_min *cms);
+// add 'count' occurrences of key and return its new estimate
+__AD_LINKAGE _attr_unused uint64_t count_min_add(struct count_min *cms, uint64_t key, uint64_t count);
+// add one occurrence of each key (the counters of the following keys are prefetched)
+__AD_LINKAGE _attr_unused void count_min_add_batch(struct count_min *cms, const uint64_t *keys, size_t count);
+__AD_LINKAGE _attr_unused _attr_pure uint64_t count_min_estimate(const struct count_min *cms, uint64_t key);
+// the sum of all counts that were added
+__AD_LINKAGE _attr_unused _attr_pure uint64_t count_min_total(const struct count_min *cms);
+// add the counters of 'other' to cms (return false unless both have the same width, depth and seed)
+__AD_LINKAGE _attr_unused bool count_min_merge(struct count_min *cms, const struct count_min *other);
+__AD_LINKAGE _attr_unused _attr_pure size_t count_min_memory_usage(const struct count_min *cms);
+
+/* Top-k (heavy hitters) tracker: the k keys with the highest estimated counts in a stream.
+ * Every key is counted in a count-min sketch and the k keys with the largest estimates are kept in a min-heap
+ * (plus a hashtable to find them), so memory stays fixed no matter how many distinct keys the stream has.
+ * A key that is not tracked replaces the tracked key with the smallest count once its estimate exceeds that
+ * count. The reported counts are count-min estimates, so they are upper bounds of the true counts.
+ */
+
+struct topk_entry {
+	uint64_t key;
+	uint64_t count;
+};
+
+struct _topk_heap_node;
+struct _topk_index;
+
+struct topk {
+	// do not access these fields directly
+	struct count_min _sketch;
+	struct topk_entry *_entries;
+	struct _topk_heap_node *_heap; // the counts in the heap may lag behind the counts in _entries
+	struct _topk_index *_index; // key -> index in _entries
+	size_t _size;
+	size_t _k;
+};
+
+// track the k heaviest keys with a count-min sketch of the given width and depth (see count_min_init)
+__AD_LINKAGE _attr_unused void topk_init(struct topk *topk, size_t k, size_t width, unsigned int depth, uint64_t seed);
+__AD_LINKAGE _attr_unused void topk_destroy(struct topk *topk);
+__AD_LINKAGE _attr_unused void topk_clear(struct topk *topk);
+// add 'count' occurrences of key and return its new estimate
+__AD_LINKAGE _attr_unused uint64_t topk_add(struct topk *topk, uint64_t key, uint64_t count);
+// return true and store the estimate in *ret_count (if not NULL) if key is currently tracked
+__AD_LINKAGE _attr_unused bool topk_query(const struct topk *topk, uint64_t key, uint64_t *ret_count);
+// estimate of any key (tracked or not)
+__AD_LINKAGE _attr_unused _attr_pure uint64_t topk_estimate(const struct topk *topk, uint64_t key);
+// store the tracked keys in 'out' (which must have room for k entries) ordered by descending count and
+// return their number
+__AD_LINKAGE _attr_unused size_t topk_list(const struct topk *topk, struct topk_entry *out);
+__AD_LINKAGE _attr_unused _attr_pure size_t topk_size(const struct topk *topk);
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __CPU_INCLUDE__
+#define __CPU_INCLUDE__
+
+#include <stdbool.h>
+#include "config.h"
+#include "compiler.h"
+
+/* Runtime CPU feature detection for selecting SIMD code paths, so that the library does not have to be
+ * compiled with -march=native to use them.
+ * Setting the environment variable ADLIB_CPU_FEATURES to a mask of CPU_FEATURE_* values (e.g. "0" or "0x9")
+ * hides all other features, which is useful for testing and benchmarking the fallback code paths
+ * (it is read once, on the first call to cpu_features).
+ */
+
+enum cpu_feature {
+	CPU_FEATURE_SSE2   = 1 << 0,
+	CPU_FEATURE_SSE4_2 = 1 << 1,
+	CPU_FEATURE_PCLMUL = 1 << 2,
+	CPU_FEATURE_POPCNT = 1 << 3,
+	CPU_FEATURE_AVX2   = 1 << 4,
+	CPU_FEATURE_BMI2   = 1 << 5,
+	CPU_FEATURE_AVX512 = 1 << 6, // F, VL, BW and DQ
+};
+
+// return the features (enum cpu_feature) supported by the CPU and OS
+__AD_LINKAGE _attr_unused unsigned int cpu_features(void);
+// return true if all of the given features are supported
+__AD_LINKAGE _attr_unused bool cpu_has(unsigned int features);
+
+/* Code paths for other targets are compiled with _attr_target and called through function pointers
+ * that are resolved on their first use (only on x86 so far).
+ */
+#if defined(HAVE_ATTR_TARGET) && defined(HAVE_BUILTIN_CPU_SUPPORTS) && (defined(__x86_64__) || defined(__i386__))
+# define HAVE_CPU_DISPATCH 1
+#endif
+
+#endif
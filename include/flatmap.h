@@ -0,0 +1,316 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __FLATMAP_INCLUDE__
+#define __FLATMAP_INCLUDE__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "compiler.h"
+#include "hashtable.h"
+
+/* DEFINE_FLATMAP(name, key_type, value_type, INLINE_CAPACITY, MAX_FLAT, hash_func, keys_equal_expr)
+ * A map for small key sets: the first INLINE_CAPACITY entries are stored inside struct name itself,
+ * up to MAX_FLAT entries in small heap allocated key and value arrays (searched linearly) and once it
+ * grows past that it moves everything into a hashtable (and stays there until it is cleared).
+ * hash_func(key) must return a uint32_t, keys_equal_expr compares the keys pointed to by 'a' and 'b'.
+ * Keys of integer types with 4 or 8 bytes are searched with SIMD and always compared with ==.
+ * Pointers to values are invalidated by insertions and removals.
+ *
+ * void name##_init(struct name *map);
+ * void name##_destroy(struct name *map);
+ * void name##_clear(struct name *map);
+ * size_t name##_size(struct name *map);
+ * value_type *name##_lookup(struct name *map, key_type key); // NULL if key is not in the map
+ * value_type *name##_lookup_or_insert(struct name *map, key_type key, bool *ret_found); // value is
+ *                                                                 // uninitialized if it was inserted
+ * bool name##_remove(struct name *map, key_type key, value_type *ret_value);
+ * name##_iter_start/name##_iter_finished/name##_iter_advance iterate over iter.key and iter.value
+ */
+#define DEFINE_FLATMAP(name, key_type, value_type, INLINE_CAPACITY, MAX_FLAT, hash_func, ...) \
+									\
+	_Static_assert(1 <= (INLINE_CAPACITY) && (INLINE_CAPACITY) <= (MAX_FLAT) && (MAX_FLAT) <= 1024, \
+		       "flatmap capacities must satisfy 1 <= INLINE_CAPACITY <= MAX_FLAT <= 1024"); \
+									\
+	struct name##_pair {						\
+		key_type key;						\
+		value_type value;					\
+	};								\
+									\
+	static _attr_unused _attr_always_inline bool _##name##_keys_equal(const key_type *a, const key_type *b) \
+	{								\
+		return (__VA_ARGS__);					\
+	}								\
+									\
+	DEFINE_HASHTABLE(_##name##_table, key_type, struct name##_pair, 7, \
+			 _##name##_keys_equal(key, &entry->key))	\
+									\
+	struct name {							\
+		/* do not access these fields directly */		\
+		uint32_t _size;						\
+		uint32_t _capacity;					\
+		key_type *_keys; /* NULL while the inline arrays are used */ \
+		value_type *_values;					\
+		struct _##name##_table *_table; /* non-NULL after switching to a hashtable */ \
+		key_type _inline_keys[INLINE_CAPACITY];			\
+		value_type _inline_values[INLINE_CAPACITY];		\
+	};								\
+									\
+	static _attr_unused void name##_init(struct name *map)		\
+	{								\
+		map->_size = 0;						\
+		map->_capacity = (INLINE_CAPACITY);			\
+		map->_keys = NULL;					\
+		map->_values = NULL;					\
+		map->_table = NULL;					\
+	}								\
+									\
+	static _attr_unused void name##_destroy(struct name *map)	\
+	{								\
+		free(map->_keys);					\
+		free(map->_values);					\
+		if (map->_table) {					\
+			_##name##_table_delete(map->_table);		\
+		}							\
+		name##_init(map);					\
+	}								\
+									\
+	static _attr_unused void name##_clear(struct name *map)	\
+	{								\
+		name##_destroy(map);					\
+	}								\
+									\
+	static _attr_unused size_t name##_size(struct name *map)	\
+	{								\
+		if (map->_table) {					\
+			return _##name##_table_num_entries(map->_table); \
+		}							\
+		return map->_size;					\
+	}								\
+									\
+	static _attr_unused _attr_always_inline key_type *_##name##_keys(struct name *map) \
+	{								\
+		return map->_keys ? map->_keys : map->_inline_keys;	\
+	}								\
+									\
+	static _attr_unused _attr_always_inline value_type *_##name##_values(struct name *map) \
+	{								\
+		return map->_values ? map->_values : map->_inline_values; \
+	}								\
+									\
+	static _attr_unused size_t _##name##_find(struct name *map, const key_type *key) \
+	{								\
+		const key_type *keys = _##name##_keys(map);		\
+		size_t n = map->_size;					\
+		switch (_FLATMAP_KEY_CLASS(key_type)) {			\
+		case 4: {						\
+			uint32_t k; /* key_type might not be compatible with uint32_t */ \
+			memcpy(&k, key, sizeof(k));			\
+			return _flatmap_find_u32(keys, n, k);		\
+		}							\
+		case 8: {						\
+			uint64_t k;					\
+			memcpy(&k, key, sizeof(k));			\
+			return _flatmap_find_u64(keys, n, k);		\
+		}							\
+		}							\
+		for (size_t i = 0; i < n; i++) {			\
+			if (_##name##_keys_equal(key, &keys[i])) {	\
+				return i;				\
+			}						\
+		}							\
+		return n;						\
+	}								\
+									\
+	static _attr_unused value_type *name##_lookup(struct name *map, key_type key) \
+	{								\
+		if (map->_table) {					\
+			struct name##_pair *pair = _##name##_table_lookup(map->_table, key, hash_func(key)); \
+			return pair ? &pair->value : NULL;		\
+		}							\
+		size_t i = _##name##_find(map, &key);			\
+		return i < map->_size ? &_##name##_values(map)[i] : NULL; \
+	}								\
+									\
+	static _attr_unused void _##name##_grow(struct name *map)	\
+	{								\
+		if (map->_capacity >= (MAX_FLAT)) {			\
+			struct _##name##_table *table = _##name##_table_new(2 * (MAX_FLAT)); \
+			key_type *keys = _##name##_keys(map);		\
+			value_type *values = _##name##_values(map);	\
+			for (size_t i = 0; i < map->_size; i++) {	\
+				struct name##_pair *pair = _##name##_table_insert(table, keys[i], hash_func(keys[i])); \
+				pair->key = keys[i];			\
+				pair->value = values[i];		\
+			}						\
+			free(map->_keys);				\
+			free(map->_values);				\
+			map->_keys = NULL;				\
+			map->_values = NULL;				\
+			map->_size = 0;					\
+			map->_capacity = (INLINE_CAPACITY);		\
+			map->_table = table;				\
+			return;						\
+		}							\
+		uint32_t capacity = 2 * map->_capacity < (MAX_FLAT) ? 2 * map->_capacity : (MAX_FLAT); \
+		key_type *keys = malloc(capacity * sizeof(key_type));	\
+		value_type *values = malloc(capacity * sizeof(value_type)); \
+		if (unlikely(!keys || !values)) {			\
+			abort();					\
+		}							\
+		memcpy(keys, _##name##_keys(map), map->_size * sizeof(key_type)); \
+		memcpy(values, _##name##_values(map), map->_size * sizeof(value_type)); \
+		free(map->_keys);					\
+		free(map->_values);					\
+		map->_keys = keys;					\
+		map->_values = values;					\
+		map->_capacity = capacity;				\
+	}								\
+									\
+	static _attr_unused value_type *name##_lookup_or_insert(struct name *map, key_type key, bool *ret_found) \
+	{								\
+		bool found = false;					\
+		value_type *value;					\
+		if (!map->_table) {					\
+			size_t i = _##name##_find(map, &key);		\
+			if (i < map->_size) {				\
+				found = true;				\
+				value = &_##name##_values(map)[i];	\
+				goto out;				\
+			}						\
+			if (map->_size == map->_capacity) {		\
+				_##name##_grow(map);			\
+			}						\
+		}							\
+		if (map->_table) {					\
+			struct name##_pair *pair = _##name##_table_lookup_or_insert(map->_table, key, \
+										    hash_func(key), &found); \
+			pair->key = key;				\
+			value = &pair->value;				\
+			goto out;					\
+		}							\
+		_##name##_keys(map)[map->_size] = key;			\
+		value = &_##name##_values(map)[map->_size];		\
+		map->_size++;						\
+	out:								\
+		if (ret_found) {					\
+			*ret_found = found;				\
+		}							\
+		return value;						\
+	}								\
+									\
+	static _attr_unused bool name##_remove(struct name *map, key_type key, value_type *ret_value) \
+	{								\
+		if (map->_table) {					\
+			struct name##_pair pair;			\
+			if (!_##name##_table_remove(map->_table, key, hash_func(key), &pair)) { \
+				return false;				\
+			}						\
+			if (ret_value) {				\
+				*ret_value = pair.value;		\
+			}						\
+			return true;					\
+		}							\
+		size_t i = _##name##_find(map, &key);			\
+		if (i == map->_size) {					\
+			return false;					\
+		}							\
+		key_type *keys = _##name##_keys(map);			\
+		value_type *values = _##name##_values(map);		\
+		if (ret_value) {					\
+			*ret_value = values[i];				\
+		}							\
+		map->_size--;						\
+		keys[i] = keys[map->_size];				\
+		values[i] = values[map->_size];				\
+		return true;						\
+	}								\
+									\
+	typedef struct name##_iterator {				\
+		key_type *key;						\
+		value_type *value;					\
+		size_t _index;						\
+		struct name *_map;					\
+		_##name##_table_iter_t _table_iter;			\
+	} name##_iter_t;						\
+									\
+	static _attr_unused bool name##_iter_finished(struct name##_iterator *iter) \
+	{								\
+		return !iter->key;					\
+	}								\
+									\
+	static _attr_unused void _##name##_iter_load(struct name##_iterator *iter) \
+	{								\
+		struct name *map = iter->_map;				\
+		iter->key = NULL;					\
+		iter->value = NULL;					\
+		if (map->_table) {					\
+			if (!_##name##_table_iter_finished(&iter->_table_iter)) { \
+				iter->key = &iter->_table_iter.entry->key; \
+				iter->value = &iter->_table_iter.entry->value; \
+			}						\
+		} else if (iter->_index < map->_size) {			\
+			iter->key = &_##name##_keys(map)[iter->_index];	\
+			iter->value = &_##name##_values(map)[iter->_index]; \
+		}							\
+	}								\
+									\
+	static _attr_unused void name##_iter_advance(struct name##_iterator *iter) \
+	{								\
+		if (iter->_map->_table) {				\
+			_##name##_table_iter_advance(&iter->_table_iter); \
+		} else {						\
+			iter->_index++;					\
+		}							\
+		_##name##_iter_load(iter);				\
+	}								\
+									\
+	static _attr_unused struct name##_iterator name##_iter_start(struct name *map) \
+	{								\
+		struct name##_iterator iter = {0};			\
+		iter._map = map;					\
+		if (map->_table) {					\
+			iter._table_iter = _##name##_table_iter_start(map->_table); \
+		}							\
+		_##name##_iter_load(&iter);				\
+		return iter;						\
+	}								\
+
+
+// private API
+
+// 4 or 8 for integer types of that size (which get searched with SIMD), 0 for everything else
+#define _FLATMAP_KEY_CLASS(key_type) _Generic(*(key_type *)0,		\
+					      int: sizeof(int),		\
+					      unsigned int: sizeof(int), \
+					      long: sizeof(long),	\
+					      unsigned long: sizeof(long), \
+					      long long: sizeof(long long), \
+					      unsigned long long: sizeof(long long), \
+					      default: 0)
+
+// return the index of the first element of keys that is equal to key or n if there is none
+__AD_LINKAGE _attr_unused _attr_pure size_t _flatmap_find_u32(const void *keys, size_t n, uint32_t key);
+__AD_LINKAGE _attr_unused _attr_pure size_t _flatmap_find_u64(const void *keys, size_t n, uint64_t key);
+
+#endif
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __GROUPBY_INCLUDE__
+#define __GROUPBY_INCLUDE__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "config.h"
+#include "compiler.h"
+#include "hashtable.h"
+
+// number of rows that are hashed and prefetched before any of them is looked up
+#ifndef GROUPBY_BATCH_SIZE
+# define GROUPBY_BATCH_SIZE 64
+#endif
+
+// size of the cache the per-partition tables should fit into (see groupby_partition_bits)
+#ifndef GROUPBY_CACHE_SIZE
+# define GROUPBY_CACHE_SIZE (256 * 1024)
+#endif
+
+#define GROUPBY_MAX_PARTITION_BITS 12
+
+/* DEFINE_GROUPBY(name, key_type, value_type, hash_func, keys_match_expr)
+ * Defines a hashtable 'struct name' (with all the usual name##_* functions, see DEFINE_HASHTABLE)
+ * whose entries are of type 'struct name##_group' and the following aggregation functions:
+ *
+ * // aggregate n rows (keys[i], values[i]) into table
+ * void name##_aggregate(struct name *table, const key_type *keys, const value_type *values, size_t n);
+ *
+ * // radix-partition the rows by the top partition_bits bits of their hash and aggregate each partition
+ * // into its own table (tables must point to 1 << partition_bits initialized tables, every key ends up
+ * // in exactly one of them, partition_bits must not exceed GROUPBY_MAX_PARTITION_BITS)
+ * void name##_aggregate_partitioned(struct name *tables, unsigned int partition_bits,
+ *                                   const key_type *keys, const value_type *values, size_t n);
+ *
+ * hash_func(key) must return a name##_hash_t and keys_match_expr gets the same 'key' and 'entry'
+ * pointers as in DEFINE_HASHTABLE (entry is a 'struct name##_group *').
+ * The sum is accumulated in value_type, so pick a type that is wide enough.
+ */
+#define DEFINE_GROUPBY(name, key_type, value_type, hash_func, ...)	\
+									\
+	struct name##_group {						\
+		key_type key;						\
+		uint64_t count;						\
+		value_type sum;						\
+		value_type min;						\
+		value_type max;						\
+	};								\
+									\
+	DEFINE_HASHTABLE(name, key_type, struct name##_group, 7, __VA_ARGS__) \
+									\
+	static _attr_unused void _##name##_aggregate_block(struct name *table, const key_type *keys, \
+							    const value_type *values, \
+							    const name##_hash_t *hashes, size_t n) \
+	{								\
+		for (size_t i = 0; i < n; i++) {			\
+			name##_prefetch(table, hashes[i]);		\
+		}							\
+		for (size_t i = 0; i < n; i++) {			\
+			bool found;					\
+			struct name##_group *group = name##_lookup_or_insert(table, keys[i], hashes[i], &found); \
+			value_type value = values[i];			\
+			if (!found) {					\
+				group->key = keys[i];			\
+				group->count = 1;			\
+				group->sum = value;			\
+				group->min = value;			\
+				group->max = value;			\
+				continue;				\
+			}						\
+			group->count++;					\
+			group->sum += value;				\
+			if (value < group->min) {			\
+				group->min = value;			\
+			}						\
+			if (value > group->max) {			\
+				group->max = value;			\
+			}						\
+		}							\
+	}								\
+									\
+	static _attr_unused void name##_aggregate(struct name *table, const key_type *keys, \
+						  const value_type *values, size_t n) \
+	{								\
+		name##_hash_t hashes[GROUPBY_BATCH_SIZE];		\
+		for (size_t start = 0; start < n; start += GROUPBY_BATCH_SIZE) { \
+			size_t count = n - start < GROUPBY_BATCH_SIZE ? n - start : GROUPBY_BATCH_SIZE; \
+			for (size_t i = 0; i < count; i++) {		\
+				hashes[i] = hash_func(keys[start + i]);	\
+			}						\
+			_##name##_aggregate_block(table, keys + start, values + start, hashes, count); \
+		}							\
+	}								\
+									\
+	static _attr_unused void name##_aggregate_partitioned(struct name *tables, unsigned int partition_bits, \
+							      const key_type *keys, const value_type *values, \
+							      size_t n)		\
+	{								\
+		if (partition_bits == 0) {				\
+			name##_aggregate(tables, keys, values, n);	\
+			return;						\
+		}							\
+		size_t num_partitions = (size_t)1 << partition_bits;	\
+		key_type *part_keys = malloc(n * sizeof(key_type) + 1); \
+		value_type *part_values = malloc(n * sizeof(value_type) + 1); \
+		name##_hash_t *hashes = malloc(2 * n * sizeof(name##_hash_t) + 1); \
+		if (unlikely(!part_keys || !part_values || !hashes)) {	\
+			abort();					\
+		}							\
+		name##_hash_t *part_hashes = hashes + n;		\
+		for (size_t i = 0; i < n; i++) {			\
+			hashes[i] = hash_func(keys[i]);			\
+		}							\
+		size_t offsets[((size_t)1 << GROUPBY_MAX_PARTITION_BITS) + 1]; \
+		_groupby_partition_offsets(hashes, n, partition_bits, offsets); \
+		for (size_t i = 0; i < n; i++) {			\
+			size_t dst = offsets[hashes[i] >> (32 - partition_bits)]++; \
+			part_keys[dst] = keys[i];			\
+			part_values[dst] = values[i];			\
+			part_hashes[dst] = hashes[i];			\
+		}							\
+		/* the scatter turned the offsets into the end of each partition */ \
+		size_t start = 0;					\
+		for (size_t p = 0; p < num_partitions; p++) {		\
+			size_t end = offsets[p];			\
+			for (size_t i = start; i < end; i += GROUPBY_BATCH_SIZE) { \
+				size_t count = end - i < GROUPBY_BATCH_SIZE ? end - i : GROUPBY_BATCH_SIZE; \
+				_##name##_aggregate_block(&tables[p], part_keys + i, part_values + i, \
+							  part_hashes + i, count); \
+			}						\
+			start = end;					\
+		}							\
+		free(part_keys);					\
+		free(part_values);					\
+		free(hashes);						\
+	}								\
+
+
+// return the number of partition bits needed so that each partition's table for an expected number of
+// groups with entries of size entry_size fits into GROUPBY_CACHE_SIZE bytes
+__AD_LINKAGE _attr_unused _attr_const unsigned int groupby_partition_bits(size_t expected_groups,
+									  size_t entry_size);
+
+// private API
+
+// compute the start offset of each of the 1 << partition_bits partitions (partitioned by the top bits
+// of the hash), offsets must have room for (1 << partition_bits) + 1 elements
+__AD_LINKAGE _attr_unused void _groupby_partition_offsets(const uint32_t *hashes, size_t n,
+							  unsigned int partition_bits, size_t *offsets);
+
+#endif
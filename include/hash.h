@@ -51,6 +51,32 @@ __AD_LINKAGE hash128_t siphash24_128(const void *in, size_t inlen, const void *k
 __AD_LINKAGE hash64_t siphash13_64(const void *in, size_t inlen, const void *key) _attr_unused _attr_pure;
 __AD_LINKAGE hash128_t siphash13_128(const void *in, size_t inlen, const void *key) _attr_unused _attr_pure;
 
+// SipHash-1-3 of 4 or 8 independent inputs at once (same output as siphash13_64 for each of them)
+// (the states are kept in SIMD registers, which helps a lot with short keys where the rounds are latency bound)
+__AD_LINKAGE void siphash13_64_x4(const void *const in[4], const size_t inlen[4], const void *key, hash64_t out[4]) _attr_unused;
+__AD_LINKAGE void siphash13_64_x8(const void *const in[8], const size_t inlen[8], const void *key, hash64_t out[8]) _attr_unused;
+
+// incremental SipHash-2-4/SipHash-1-3 (same output as the functions above for the concatenated input)
+// (the output size is chosen with the init function, use the final function of the same size)
+struct siphash_state {
+	// do not access these fields directly
+	uint64_t _v[4];
+	uint64_t _length;
+	uint8_t _buffer[8];
+	unsigned int _outlen;
+};
+
+__AD_LINKAGE void siphash24_init_64(struct siphash_state *state, const void *key) _attr_unused;
+__AD_LINKAGE void siphash24_init_128(struct siphash_state *state, const void *key) _attr_unused;
+__AD_LINKAGE void siphash24_update(struct siphash_state *state, const void *in, size_t inlen) _attr_unused;
+__AD_LINKAGE hash64_t siphash24_final_64(struct siphash_state *state) _attr_unused _attr_pure;
+__AD_LINKAGE hash128_t siphash24_final_128(struct siphash_state *state) _attr_unused _attr_pure;
+__AD_LINKAGE void siphash13_init_64(struct siphash_state *state, const void *key) _attr_unused;
+__AD_LINKAGE void siphash13_init_128(struct siphash_state *state, const void *key) _attr_unused;
+__AD_LINKAGE void siphash13_update(struct siphash_state *state, const void *in, size_t inlen) _attr_unused;
+__AD_LINKAGE hash64_t siphash13_final_64(struct siphash_state *state) _attr_unused _attr_pure;
+__AD_LINKAGE hash128_t siphash13_final_128(struct siphash_state *state) _attr_unused _attr_pure;
+
 // HalfSipHash-2-4
 // (the key must have 8 bytes)
 // (see also https://github.com/veorq/SipHash)
@@ -81,6 +107,25 @@ __AD_LINKAGE hash128_t murmurhash3_x86_128(const void *in, size_t inlen, uint32_
 __AD_LINKAGE hash64_t murmurhash3_x64_64(const void *in, size_t inlen, uint32_t seed) _attr_unused _attr_pure;
 __AD_LINKAGE hash128_t murmurhash3_x64_128(const void *in, size_t inlen, uint32_t seed) _attr_unused _attr_pure;
 
+// incremental MurmurHash3_x64_64/MurmurHash3_x64_128
+// (same output as the functions above for the concatenated input)
+struct murmurhash3_x64_state {
+	// do not access these fields directly
+	uint64_t _h[2];
+	uint64_t _length;
+	uint8_t _buffer[16];
+};
+
+__AD_LINKAGE void murmurhash3_x64_init(struct murmurhash3_x64_state *state, uint32_t seed) _attr_unused;
+__AD_LINKAGE void murmurhash3_x64_update(struct murmurhash3_x64_state *state, const void *in, size_t inlen) _attr_unused;
+__AD_LINKAGE hash64_t murmurhash3_x64_final_64(struct murmurhash3_x64_state *state) _attr_unused _attr_pure;
+__AD_LINKAGE hash128_t murmurhash3_x64_final_128(struct murmurhash3_x64_state *state) _attr_unused _attr_pure;
+
+// XXH3 (64-bit variant, identical output to XXH3_64bits_withSeed)
+// (much faster than the above on long inputs, uses AVX2 or SSE2 if the CPU supports them)
+// (see also https://github.com/Cyan4973/xxHash)
+__AD_LINKAGE hash64_t xxh3_64(const void *in, size_t inlen, uint64_t seed) _attr_unused _attr_pure;
+
 __AD_LINKAGE hash32_t hash_int32(uint32_t val) _attr_unused _attr_const;
 __AD_LINKAGE hash64_t hash_int64(uint64_t val) _attr_unused _attr_const;
 
@@ -90,4 +135,52 @@ __AD_LINKAGE hash64_t fibonacci_hash64(uint64_t val, unsigned int bits) _attr_un
 __AD_LINKAGE hash32_t hash_combine_int32(uint32_t seed, uint32_t val) _attr_unused _attr_const;
 __AD_LINKAGE hash64_t hash_combine_int64(uint64_t seed, uint64_t val) _attr_unused _attr_const;
 
+/* Consistent hashing: route (already hashed) keys to shards so that changing the set of shards only moves
+ * the keys that have to move, unlike hash % num_shards, which moves almost all of them.
+ */
+
+// Jump consistent hash (Lamping & Veach): return a bucket in [0, num_buckets) (num_buckets must not be 0)
+// Growing from n to n + 1 buckets moves 1/(n + 1) of the keys (all to the new bucket), needs no memory and
+// takes O(log n) time, but buckets can only be added or removed at the end.
+__AD_LINKAGE uint32_t jump_consistent_hash(uint64_t key, uint32_t num_buckets) _attr_unused _attr_const;
+// out[i] = jump_consistent_hash(keys[i], num_buckets) (interleaves several keys to hide the division latency)
+__AD_LINKAGE void jump_consistent_hash_batch(const uint64_t *keys, size_t count, uint32_t num_buckets,
+					     uint32_t *out) _attr_unused;
+
+/* Multi-probe consistent hashing (Appleton & O'Reilly): every shard has one point on a hash ring, a key is
+ * hashed to 'probes' positions and goes to the shard whose point follows one of them most closely.
+ * Shards can be added or removed anywhere, 21 probes give a peak-to-average load of about 1.05
+ * with memory for just one point per shard. Shards are identified by an id (e.g. the hash of their
+ * name), lookups return an index into the array of shard ids passed to multiprobe_ring_init.
+ */
+struct multiprobe_ring {
+	// do not access these fields directly
+	uint64_t *_points; // sorted
+	uint32_t *_shards; // index of the shard of each point
+	uint32_t _num_shards;
+	unsigned int _probes;
+};
+
+#define MULTIPROBE_RING_DEFAULT_PROBES 21
+
+// initialize a ring for num_shards shards (0 < num_shards < 2^32, probes > 0)
+__AD_LINKAGE void multiprobe_ring_init(struct multiprobe_ring *ring, const uint64_t *shard_ids, size_t num_shards,
+				       unsigned int probes) _attr_unused;
+__AD_LINKAGE void multiprobe_ring_destroy(struct multiprobe_ring *ring) _attr_unused;
+__AD_LINKAGE uint32_t multiprobe_ring_lookup(const struct multiprobe_ring *ring, uint64_t key) _attr_unused _attr_pure;
+__AD_LINKAGE void multiprobe_ring_lookup_batch(const struct multiprobe_ring *ring, const uint64_t *keys,
+					       size_t count, uint32_t *out) _attr_unused;
+
+/* Rendezvous (highest random weight) hashing: every shard scores the key and the highest score wins.
+ * Removing a shard only moves its own keys, adding one only takes keys from the others (in proportion to
+ * the weights), but lookups take O(num_shards) time, so this is meant for a few dozen shards.
+ * With weights (positive, NULL for equal weights) each shard receives a share of the keys proportional to
+ * its weight (score = -weight / ln(u) where u is uniform in (0, 1), see Schindelhauer & Schomaker).
+ * Return an index into shard_ids (num_shards must not be 0).
+ */
+__AD_LINKAGE uint32_t rendezvous_hash(uint64_t key, const uint64_t *shard_ids, const double *weights,
+				      size_t num_shards) _attr_unused _attr_pure;
+__AD_LINKAGE void rendezvous_hash_batch(const uint64_t *keys, size_t count, const uint64_t *shard_ids,
+					const double *weights, size_t num_shards, uint32_t *out) _attr_unused;
+
 #endif
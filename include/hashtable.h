@@ -25,9 +25,36 @@
 #include <stdlib.h>
 #include "config.h"
 #include "compiler.h"
+// (not only with HASHTABLE_TRACING, the single header generator pastes every header at its first include)
+#include "hashtable_trace.h"
 
 // #define __HASHTABLE_PROFILING
 
+/* Define HASHTABLE_TRACING before including this header to make every hashtable defined afterwards
+ * recordable: name##_set_trace(table, writer) makes all lookups, inserts, removals and clears of
+ * that table get written to a struct hashtable_trace_writer (see hashtable_trace.h).
+ */
+#ifdef HASHTABLE_TRACING
+# define _HASHTABLE_TRACE_FIELD struct hashtable_trace_writer *_trace;
+# define _HASHTABLE_TRACE_INIT(table) ((table)->_trace = NULL)
+# define _HASHTABLE_TRACE(table, op, key_ptr, key_size, hash)		\
+	do {								\
+		if ((table)->_trace) {					\
+			hashtable_trace_write((table)->_trace, (op), (key_ptr), (key_size), (hash)); \
+		}							\
+	} while (0)
+# define _HASHTABLE_TRACE_FUNCTIONS(name)				\
+	static _attr_unused void name##_set_trace(struct name *table, struct hashtable_trace_writer *writer) \
+	{								\
+		table->_trace = writer;					\
+	}
+#else
+# define _HASHTABLE_TRACE_FIELD
+# define _HASHTABLE_TRACE_INIT(table) ((void)0)
+# define _HASHTABLE_TRACE(table, op, key_ptr, key_size, hash) do {} while (0)
+# define _HASHTABLE_TRACE_FUNCTIONS(name)
+#endif
+
 // TODO documentation (see tests for now)
 // TODO split off type and function declarations for headers
 
@@ -35,6 +62,7 @@
 									\
 	struct name {							\
 		struct _hashtable impl;					\
+		_HASHTABLE_TRACE_FIELD					\
 	};								\
 									\
 	static _attr_unused bool _##name##_keys_match(const void *_key, const void *_entry) \
@@ -59,6 +87,7 @@
 	static _attr_unused void name##_init(struct name *table, name##_uint_t initial_capacity) \
 	{								\
 		_hashtable_init(&table->impl, initial_capacity, &_##name##_info); \
+		_HASHTABLE_TRACE_INIT(table);				\
 	}								\
 									\
 	static _attr_unused void name##_destroy(struct name *table)	\
@@ -81,6 +110,7 @@
 									\
 	static _attr_unused void name##_clear(struct name *table)	\
 	{								\
+		_HASHTABLE_TRACE(table, HASHTABLE_TRACE_CLEAR, NULL, 0, 0); \
 		_hashtable_clear(&table->impl, &_##name##_info);	\
 	}								\
 									\
@@ -99,6 +129,14 @@
 		return table->impl.num_entries;				\
 	}								\
 									\
+	/* number of bytes allocated for the entries and their metadata */ \
+	static _attr_unused size_t name##_memory_usage(struct name *table) \
+	{								\
+		return _hashtable_memory_usage(&table->impl, &_##name##_info); \
+	}								\
+									\
+	_HASHTABLE_TRACE_FUNCTIONS(name)				\
+									\
 	typedef struct name##_iterator {				\
 		entry_type *entry;					\
 		_hashtable_idx_t _index;				\
@@ -138,6 +176,7 @@
 	static _attr_unused entry_type *name##_lookup(struct name *table, key_type key, name##_uint_t hash) \
 	{								\
 		_hashtable_idx_t index;					\
+		_HASHTABLE_TRACE(table, HASHTABLE_TRACE_LOOKUP, &key, sizeof(key), hash); \
 		if (!_hashtable_lookup(&table->impl, &key, hash, &index, &_##name##_info)) { \
 			return NULL;					\
 		}							\
@@ -146,13 +185,32 @@
 									\
 	static _attr_unused entry_type *name##_insert(struct name *table, key_type key, name##_uint_t hash) \
 	{								\
+		_HASHTABLE_TRACE(table, HASHTABLE_TRACE_INSERT, &key, sizeof(key), hash); \
 		_hashtable_idx_t index = _hashtable_insert(&table->impl, hash, &_##name##_info); \
 		return _hashtable_entry(&table->impl, index, &_##name##_info); \
 	}								\
 									\
+	static _attr_unused entry_type *name##_lookup_or_insert(struct name *table, key_type key, name##_uint_t hash, \
+								  bool *ret_found)		\
+	{								\
+		_hashtable_idx_t index;					\
+		_HASHTABLE_TRACE(table, HASHTABLE_TRACE_LOOKUP_OR_INSERT, &key, sizeof(key), hash); \
+		bool found = _hashtable_lookup_or_insert(&table->impl, &key, hash, &index, &_##name##_info); \
+		if (ret_found) {					\
+			*ret_found = found;				\
+		}							\
+		return _hashtable_entry(&table->impl, index, &_##name##_info); \
+	}								\
+									\
+	static _attr_unused void name##_prefetch(struct name *table, name##_uint_t hash) \
+	{								\
+		_hashtable_prefetch(&table->impl, hash, &_##name##_info); \
+	}								\
+									\
 	static _attr_unused bool name##_remove(struct name *table, key_type key, name##_uint_t hash, entry_type *ret_entry) \
 	{								\
 		_hashtable_idx_t index;					\
+		_HASHTABLE_TRACE(table, HASHTABLE_TRACE_REMOVE, &key, sizeof(key), hash); \
 		if (!_hashtable_lookup(&table->impl, &key, hash, &index, &_##name##_info)) { \
 			return false;					\
 		}							\
@@ -202,6 +260,16 @@ __AD_LINKAGE _attr_unused void _hashtable_resize(struct _hashtable *table, _hash
 __AD_LINKAGE _attr_unused _attr_nodiscard
 _hashtable_idx_t _hashtable_insert(struct _hashtable *table, _hashtable_hash_t hash,
 				   const struct _hashtable_info *info);
+__AD_LINKAGE _attr_unused _attr_nodiscard
+bool _hashtable_lookup_or_insert(struct _hashtable *table, void *key, _hashtable_hash_t hash,
+				 _hashtable_idx_t *ret_index, const struct _hashtable_info *info);
+__AD_LINKAGE _attr_unused _attr_pure
+_hashtable_uint_t _hashtable_probe_length(struct _hashtable *table, _hashtable_idx_t index,
+					  const struct _hashtable_info *info);
+__AD_LINKAGE _attr_unused _attr_pure size_t _hashtable_memory_usage(const struct _hashtable *table,
+								    const struct _hashtable_info *info);
+__AD_LINKAGE _attr_unused void _hashtable_prefetch(struct _hashtable *table, _hashtable_hash_t hash,
+						    const struct _hashtable_info *info);
 __AD_LINKAGE _attr_unused void _hashtable_remove(struct _hashtable *table, _hashtable_idx_t index,
 						  const struct _hashtable_info *info);
 __AD_LINKAGE _attr_unused void _hashtable_clear(struct _hashtable *table, const struct _hashtable_info *info);
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __HASHTABLE_TRACE_INCLUDE__
+#define __HASHTABLE_TRACE_INCLUDE__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "config.h"
+#include "compiler.h"
+
+/* Binary trace format (all integers little endian):
+ * header: "ADHTRACE", u32 version, u32 key_size, u32 entry_size
+ * record: u8 op, varint timestamp delta (ns), u64 key fingerprint, u32 hash
+ */
+
+#define HASHTABLE_TRACE_VERSION 1
+
+enum hashtable_trace_op {
+	HASHTABLE_TRACE_LOOKUP,
+	HASHTABLE_TRACE_INSERT,
+	HASHTABLE_TRACE_REMOVE,
+	HASHTABLE_TRACE_LOOKUP_OR_INSERT,
+	HASHTABLE_TRACE_CLEAR,
+	HASHTABLE_TRACE_NUM_OPS,
+};
+
+struct hashtable_trace_record {
+	uint64_t timestamp; // nanoseconds since the trace was started
+	uint64_t fingerprint; // equal keys must have equal fingerprints
+	uint32_t hash;
+	enum hashtable_trace_op op;
+};
+
+typedef uint64_t (*hashtable_trace_fingerprint_t)(const void *key, size_t key_size);
+
+struct hashtable_trace_writer {
+	// do not access these fields directly
+	FILE *_file;
+	hashtable_trace_fingerprint_t _fingerprint;
+	uint64_t _start_time;
+	uint64_t _last_timestamp;
+	bool _error;
+};
+
+struct hashtable_trace_reader {
+	// do not access these fields directly
+	FILE *_file;
+	uint64_t _last_timestamp;
+	uint32_t _key_size;
+	uint32_t _entry_size;
+	bool _error;
+};
+
+// default fingerprint: a 64-bit hash of the key's bytes
+// (so keys that are pointers are identified by their address, pass your own function if that is wrong)
+__AD_LINKAGE _attr_unused _attr_pure uint64_t hashtable_trace_fingerprint(const void *key, size_t key_size);
+
+// start a trace and write the header to file (fingerprint may be NULL to use hashtable_trace_fingerprint)
+// returns false if writing failed
+__AD_LINKAGE _attr_unused bool hashtable_trace_writer_init(struct hashtable_trace_writer *writer, FILE *file,
+							    size_t key_size, size_t entry_size,
+							    hashtable_trace_fingerprint_t fingerprint);
+// record an operation on key (key may be NULL for HASHTABLE_TRACE_CLEAR) with the current time
+__AD_LINKAGE _attr_unused void hashtable_trace_write(struct hashtable_trace_writer *writer,
+						      enum hashtable_trace_op op, const void *key, size_t key_size,
+						      uint32_t hash);
+// append a record as is (timestamps must not decrease)
+__AD_LINKAGE _attr_unused void hashtable_trace_write_record(struct hashtable_trace_writer *writer,
+							     const struct hashtable_trace_record *record);
+// flush the trace (does not close the file), returns false if any write failed
+__AD_LINKAGE _attr_unused bool hashtable_trace_writer_finish(struct hashtable_trace_writer *writer);
+
+// read and check the header of a trace, returns false if it is not a valid trace
+__AD_LINKAGE _attr_unused bool hashtable_trace_reader_init(struct hashtable_trace_reader *reader, FILE *file);
+// key and entry size of the traced hashtable
+__AD_LINKAGE _attr_unused _attr_pure size_t hashtable_trace_key_size(const struct hashtable_trace_reader *reader);
+__AD_LINKAGE _attr_unused _attr_pure size_t hashtable_trace_entry_size(const struct hashtable_trace_reader *reader);
+// read the next record, returns false at the end of the trace or if the trace is corrupt
+__AD_LINKAGE _attr_unused bool hashtable_trace_read(struct hashtable_trace_reader *reader,
+						     struct hashtable_trace_record *record);
+// returns true if hashtable_trace_read stopped because of a corrupt or truncated trace
+__AD_LINKAGE _attr_unused _attr_pure bool hashtable_trace_reader_error(const struct hashtable_trace_reader *reader);
+
+#endif
@@ -1,34 +1,65 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
 #ifndef __HEAP_INCLUDE__
 #define __HEAP_INCLUDE__
 
 #include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include "compiler.h"
 
-// TODO add DEFINE_MAXHEAP or generic DEFINE_HEAP?
-// TODO document public API
-
-// 'name' is used as a prefix for the function names
-// 'type' is the element type (the heap functions operate on 'type' arrays)
-// The last argument should be a code expression that compares two elements:
-// The expression receives two pointers to array elements called 'a' and 'b' and
-// must return true if *a is less than *b or false otherwise (i.e. it must be
-// equivalent to *a < *b for integer types)
+/* DEFINE_MINHEAP(name, type, less_than_expr)
+ * 'name' is used as a prefix for the function names
+ * 'type' is the element type (the heap functions operate on 'type' arrays)
+ * The last argument should be a code expression that compares two elements:
+ * The expression receives two pointers to array elements called 'a' and 'b' and
+ * must return true if *a is less than *b or false otherwise (i.e. it must be
+ * equivalent to *a < *b for integer types)
+ * For a max-heap, invert the comparison (the _min functions then operate on the maximum)
+ *
+ * void name##_heapify(type *arr, size_t n);
+ * void name##_insert(type *arr, size_t n); // arr[n - 1] is the new element
+ * void name##_delete(type *arr, size_t n, size_t i); // the heap has n - 1 elements afterwards
+ * void name##_delete_min(type *arr, size_t n);
+ * type name##_extract_min(type *arr, size_t n);
+ * void name##_decrease_key(type *arr, size_t n, size_t i); // after arr[i] was made smaller
+ * void name##_increase_key(type *arr, size_t n, size_t i); // after arr[i] was made larger
+ * size_t name##_is_heap_until(type *arr, size_t n);
+ * bool name##_is_heap(type *arr, size_t n);
+ * void name##_sort(type *arr, size_t n); // sorts in descending order
+ */
 #define DEFINE_MINHEAP(name, type, ...)					\
 									\
-	static bool _##name##_less_than(type *a, type *b)		\
+	static _attr_unused bool _##name##_less_than(type *a, type *b)	\
 	{								\
 		return (__VA_ARGS__);					\
 	}								\
 									\
-	static inline void _##name##_swap(type *arr, size_t i, size_t j) \
+	static _attr_unused inline void _##name##_swap(type *arr, size_t i, size_t j) \
 	{								\
 		type tmp = arr[i];					\
 		arr[i] = arr[j];					\
 		arr[j] = tmp;						\
 	}								\
 									\
-	static void _##name##_sift_down_bottom_up(type *arr, size_t n, size_t i) \
+	static _attr_unused void _##name##_sift_down_bottom_up(type *arr, size_t n, size_t i) \
 	{								\
 		size_t start = i;					\
 		for (;;) {						\
@@ -59,7 +90,7 @@
 		}							\
 	}								\
 									\
-	static void _##name##_sift_down(type *arr, size_t n, size_t i)	\
+	static _attr_unused void _##name##_sift_down(type *arr, size_t n, size_t i) \
 	{								\
 		for (;;) {						\
 			size_t left = _heap_get_left_child(i);		\
@@ -79,7 +110,7 @@
 		}							\
 	}								\
 									\
-	static void _##name##_sift_up(type *arr, size_t i)		\
+	static _attr_unused void _##name##_sift_up(type *arr, size_t i)	\
 	{								\
 		while (i != 0) {					\
 			size_t parent = _heap_get_parent(i);		\
@@ -91,7 +122,7 @@
 		}							\
 	}								\
 									\
-	static void name##_heapify(type *arr, size_t n)			\
+	static _attr_unused void name##_heapify(type *arr, size_t n)	\
 	{								\
 		for (size_t i = n / 2; i-- > 0;) {			\
 			/* sift_down_bottom_up does fewer comparisons but more swaps, which seems to be more expensive for a heap of integers */ \
@@ -99,13 +130,13 @@
 		}							\
 	}								\
 									\
-	static void name##_insert(type *arr, size_t n)			\
+	static _attr_unused void name##_insert(type *arr, size_t n)	\
 	{								\
 		assert(n != 0);						\
 		_##name##_sift_up(arr, n - 1);				\
 	}								\
 									\
-	static void name##_delete(type *arr, size_t n, size_t i)	\
+	static _attr_unused void name##_delete(type *arr, size_t n, size_t i) \
 	{								\
 		assert(i < n);						\
 		if (i == n - 1) {					\
@@ -120,14 +151,14 @@
 		}							\
 	}								\
 									\
-	static void name##_delete_min(type *arr, size_t n)		\
+	static _attr_unused void name##_delete_min(type *arr, size_t n)	\
 	{								\
 		assert(n != 0);						\
 		arr[0] = arr[n - 1];					\
 		_##name##_sift_down_bottom_up(arr, n - 1, 0);		\
 	}								\
 									\
-	static type name##_extract_min(type *arr, size_t n)		\
+	static _attr_unused type name##_extract_min(type *arr, size_t n) \
 	{								\
 		assert(n != 0);						\
 		type result = arr[0];					\
@@ -135,22 +166,21 @@
 		return result;						\
 	}								\
 									\
-	static void name##_decrease_key(type *arr, size_t n, size_t i)	\
+	static _attr_unused void name##_decrease_key(type *arr, size_t n, size_t i) \
 	{								\
 		(void)n;						\
 		assert(i < n);						\
 		_##name##_sift_up(arr, i);				\
 	}								\
 									\
-	static void name##_increase_key(type *arr, size_t n, size_t i)	\
+	static _attr_unused void name##_increase_key(type *arr, size_t n, size_t i) \
 	{								\
 		assert(i < n);						\
-		/* TODO which sift_down implementation is better here? */ \
-		/* _##name##_sift_down(arr, n, i); */			\
+		/* usually called on the root, where the new value tends to sink as far as in delete_min */ \
 		_##name##_sift_down_bottom_up(arr, n, i);		\
 	}								\
 									\
-	static size_t name##_is_heap_until(type *arr, size_t n)		\
+	static _attr_unused size_t name##_is_heap_until(type *arr, size_t n) \
 	{								\
 		for (size_t i = 1; i < n; i++) {			\
 			if (_##name##_less_than(&arr[i], &arr[_heap_get_parent(i)])) { \
@@ -160,12 +190,12 @@
 		return n;						\
 	}								\
 									\
-	static bool name##_is_heap(type *arr, size_t n)			\
+	static _attr_unused bool name##_is_heap(type *arr, size_t n)	\
 	{								\
 		return name##_is_heap_until(arr, n) == n;		\
 	}								\
 									\
-	static void name##_sort(type *arr, size_t n)			\
+	static _attr_unused void name##_sort(type *arr, size_t n)	\
 	{								\
 		for (size_t i = 0; i < n; i++) {			\
 			arr[n - 1 - i] = name##_extract_min(arr, n - i); \
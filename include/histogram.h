@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __HISTOGRAM_INCLUDE__
+#define __HISTOGRAM_INCLUDE__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "compiler.h"
+
+/* Recording from several threads: give every thread its own histogram/sketch (recording is not atomic) and
+ * periodically move it into a shared one with merge + clear under a lock. Both only touch the range of
+ * buckets that was used since the last clear, so frequent merges stay cheap.
+ */
+
+/* Log-linear histogram of uint64_t values (e.g. latencies in nanoseconds) in the style of HdrHistogram.
+ * Values below 2^precision get a bucket each, above that every power of two is split into 2^precision
+ * buckets, so the relative error of a reported value is at most 2^-(precision + 1).
+ * The bucket layout only depends on the precision, so histograms with the same precision can be merged
+ * even if their max_value differs. Values above max_value are counted in the last bucket (but min, max and
+ * mean are exact).
+ */
+
+#define HISTOGRAM_MAX_PRECISION 16
+
+struct histogram {
+	// do not access these fields directly
+	uint64_t *_counts;
+	size_t _num_buckets;
+	uint64_t _total_count;
+	uint64_t _min;
+	uint64_t _max;
+	double _sum;
+	unsigned int _precision;
+};
+
+// precision must be in [1, HISTOGRAM_MAX_PRECISION]
+// (precision 7 with max_value 10^11 (100 seconds in ns) gives 0.4% relative error and takes 30 KiB)
+__AD_LINKAGE _attr_unused void histogram_init(struct histogram *hist, unsigned int precision, uint64_t max_value);
+__AD_LINKAGE _attr_unused void histogram_destroy(struct histogram *hist);
+__AD_LINKAGE _attr_unused void histogram_clear(struct histogram *hist);
+__AD_LINKAGE _attr_unused void histogram_record(struct histogram *hist, uint64_t value);
+__AD_LINKAGE _attr_unused void histogram_record_n(struct histogram *hist, uint64_t value, uint64_t count);
+// add all values of 'other' to hist (return false if their precisions differ)
+__AD_LINKAGE _attr_unused bool histogram_merge(struct histogram *hist, const struct histogram *other);
+__AD_LINKAGE _attr_unused _attr_pure uint64_t histogram_count(const struct histogram *hist);
+// min, max and mean return 0 if the histogram is empty
+__AD_LINKAGE _attr_unused _attr_pure uint64_t histogram_min(const struct histogram *hist);
+__AD_LINKAGE _attr_unused _attr_pure uint64_t histogram_max(const struct histogram *hist);
+__AD_LINKAGE _attr_unused _attr_pure double histogram_mean(const struct histogram *hist);
+// the value at quantile q in [0, 1] (0 if the histogram is empty)
+__AD_LINKAGE _attr_unused _attr_pure uint64_t histogram_quantile(const struct histogram *hist, double q);
+// out[i] = histogram_quantile(hist, quantiles[i]) in a single pass (quantiles must be sorted in ascending order)
+__AD_LINKAGE _attr_unused void histogram_quantiles(const struct histogram *hist, const double *quantiles, size_t n,
+						   uint64_t *out);
+__AD_LINKAGE _attr_unused _attr_pure size_t histogram_memory_usage(const struct histogram *hist);
+
+/* DDSketch: mergeable quantile sketch of doubles with relative accuracy alpha (every reported quantile is
+ * within a factor of 1 +- alpha of the true value) and no assumptions about the range of the values.
+ * Positive and negative values are counted in buckets of logarithmically increasing size (bucket i covers
+ * (gamma^(i-1), gamma^i] with gamma = (1 + alpha) / (1 - alpha)). If more than max_buckets buckets would be
+ * needed for one sign, the buckets closest to zero are collapsed, which only affects the accuracy of the
+ * smallest magnitudes (2048 buckets cover more than 17 orders of magnitude with alpha = 1%).
+ */
+
+struct _ddsketch_store {
+	uint64_t *counts;
+	int32_t offset; // bucket index of counts[0]
+	int32_t min_index;
+	int32_t max_index;
+	uint32_t length;
+	uint64_t total_count;
+};
+
+struct ddsketch {
+	// do not access these fields directly
+	struct _ddsketch_store _positive;
+	struct _ddsketch_store _negative;
+	uint64_t _zero_count;
+	double _gamma;
+	double _multiplier; // 1 / ln(gamma)
+	double _min;
+	double _max;
+	double _sum;
+	uint32_t _max_buckets;
+};
+
+#define DDSKETCH_DEFAULT_MAX_BUCKETS 2048
+
+// alpha must be in (0, 1), max_buckets at least 1
+__AD_LINKAGE _attr_unused void ddsketch_init(struct ddsketch *sketch, double alpha, size_t max_buckets);
+__AD_LINKAGE _attr_unused void ddsketch_destroy(struct ddsketch *sketch);
+__AD_LINKAGE _attr_unused void ddsketch_clear(struct ddsketch *sketch);
+// value must not be NaN
+__AD_LINKAGE _attr_unused void ddsketch_add(struct ddsketch *sketch, double value);
+__AD_LINKAGE _attr_unused void ddsketch_add_n(struct ddsketch *sketch, double value, uint64_t count);
+// add all values of 'other' to sketch (return false if their accuracies differ)
+__AD_LINKAGE _attr_unused bool ddsketch_merge(struct ddsketch *sketch, const struct ddsketch *other);
+__AD_LINKAGE _attr_unused _attr_pure uint64_t ddsketch_count(const struct ddsketch *sketch);
+// min, max and mean return 0 if the sketch is empty
+__AD_LINKAGE _attr_unused _attr_pure double ddsketch_min(const struct ddsketch *sketch);
+__AD_LINKAGE _attr_unused _attr_pure double ddsketch_max(const struct ddsketch *sketch);
+__AD_LINKAGE _attr_unused _attr_pure double ddsketch_mean(const struct ddsketch *sketch);
+// the value at quantile q in [0, 1] (0 if the sketch is empty)
+__AD_LINKAGE _attr_unused _attr_pure double ddsketch_quantile(const struct ddsketch *sketch, double q);
+__AD_LINKAGE _attr_unused _attr_pure size_t ddsketch_memory_usage(const struct ddsketch *sketch);
+
+#endif
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __HYPERLOGLOG_INCLUDE__
+#define __HYPERLOGLOG_INCLUDE__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "compiler.h"
+#include "dbuf.h"
+
+/* HyperLogLog sketch for estimating the number of distinct items (HyperLogLog++ representation).
+ * Items are added as 64-bit hashes, which have to be well distributed (e.g. xxh3_64(...).u64 or
+ * hash_int64(...).u64 from hash.h). With precision p the sketch has 2^p registers and a relative standard
+ * error of about 1.04 / sqrt(2^p) (p = 14: 0.8%, 16 KiB). Small sketches are stored sparsely (a sorted list
+ * of 25-bit register indices, which is also more accurate) and switch to dense registers once that
+ * would take more memory.
+ * The estimate uses Ertl's improved raw estimator ("New cardinality estimation algorithms for HyperLogLog
+ * sketches", 2017), which is unbiased over the whole range without empirical bias correction tables.
+ */
+
+#define HYPERLOGLOG_MIN_PRECISION 4
+#define HYPERLOGLOG_MAX_PRECISION 18
+
+struct hyperloglog {
+	// do not access these fields directly
+	uint8_t *_registers; // 2^precision dense registers, NULL while sparse
+	uint32_t *_sparse; // register index (25 bits) << 6 | rank
+	size_t _sparse_count;
+	size_t _sparse_sorted; // [0, _sparse_sorted) is sorted and unique, the rest was appended
+	size_t _sparse_capacity;
+	unsigned int _precision;
+};
+
+// return false if precision is not in [HYPERLOGLOG_MIN_PRECISION, HYPERLOGLOG_MAX_PRECISION]
+__AD_LINKAGE _attr_unused bool hyperloglog_init(struct hyperloglog *hll, unsigned int precision);
+__AD_LINKAGE _attr_unused void hyperloglog_destroy(struct hyperloglog *hll);
+__AD_LINKAGE _attr_unused void hyperloglog_clear(struct hyperloglog *hll);
+__AD_LINKAGE _attr_unused void hyperloglog_add(struct hyperloglog *hll, uint64_t hash);
+__AD_LINKAGE _attr_unused void hyperloglog_add_bulk(struct hyperloglog *hll, const uint64_t *hashes, size_t count);
+// add all items of 'other' to hll (return false if their precisions differ)
+__AD_LINKAGE _attr_unused bool hyperloglog_merge(struct hyperloglog *hll, const struct hyperloglog *other);
+__AD_LINKAGE _attr_unused _attr_pure double hyperloglog_estimate(const struct hyperloglog *hll);
+// number of bytes used by the sketch
+__AD_LINKAGE _attr_unused _attr_pure size_t hyperloglog_memory_usage(const struct hyperloglog *hll);
+// append a compact encoding of hll to 'out' (delta coded indices while sparse, 6 bits per register when dense)
+__AD_LINKAGE _attr_unused void hyperloglog_serialize(const struct hyperloglog *hll, struct dbuf *out);
+// initialize hll from the output of hyperloglog_serialize, return false (and leave hll uninitialized) if
+// the data is malformed
+__AD_LINKAGE _attr_unused bool hyperloglog_deserialize(struct hyperloglog *hll, const void *data, size_t size);
+
+#endif
@@ -56,4 +56,78 @@ __AD_LINKAGE _attr_unused double random_next_double_in_range(struct random_state
 __AD_LINKAGE _attr_unused void random_jump(struct random_state *state);
 __AD_LINKAGE _attr_unused void random_long_jump(struct random_state *state);
 
+// Independent streams: random_jump_n(state, k) is k random_jumps (k * 2^128 steps) in O(log k) time and
+// random_stream(state, seed, k) initializes 'state' to the k-th stream of 'seed'. Streams of the same seed never
+// overlap (bulk fills stay within their stream, see random_fill_* below) and do not depend on the order in which
+// they are created, so tasks seeded with their own index give the same results however they are scheduled.
+__AD_LINKAGE _attr_unused void random_jump_n(struct random_state *state, uint64_t k);
+__AD_LINKAGE _attr_unused void random_stream(struct random_state *state, uint64_t seed, uint64_t k);
+
+#define RANDOM_THREAD_DEFAULT_SEED 0
+
+// The calling thread's own state (no locking needed). Unless random_thread_state_init(seed, k) made it the k-th
+// stream of 'seed', it becomes the next unused stream of RANDOM_THREAD_DEFAULT_SEED on first use (in the order
+// the threads first call this, which is only reproducible for a single thread).
+__AD_LINKAGE _attr_unused void random_thread_state_init(uint64_t seed, uint64_t k);
+__AD_LINKAGE _attr_unused struct random_state *random_thread_state(void);
+
+// Fill 'buf' with n values (the same distributions as the random_next_* functions above). Large fills run
+// 8 lanes 2^64 steps apart side by side in SIMD registers, so the values are not the same as those of n
+// random_next_* calls, but they are just as reproducible. The lanes stay within the state's own stream (they
+// never reach random_jump/random_stream distances) and the state is advanced past all of them.
+__AD_LINKAGE _attr_unused void random_fill_u64(struct random_state *state, uint64_t *buf, size_t n);
+__AD_LINKAGE _attr_unused void random_fill_u32(struct random_state *state, uint32_t *buf, size_t n);
+__AD_LINKAGE _attr_unused void random_fill_double(struct random_state *state, double *buf, size_t n);
+__AD_LINKAGE _attr_unused void random_fill_u32_in_range(struct random_state *state, uint32_t *buf, size_t n,
+							uint32_t min, uint32_t max);
+__AD_LINKAGE _attr_unused void random_fill_u64_in_range(struct random_state *state, uint64_t *buf, size_t n,
+							uint64_t min, uint64_t max);
+__AD_LINKAGE _attr_unused void random_fill_double_in_range(struct random_state *state, double *buf, size_t n,
+							   double min, double max);
+
+// Shuffle the n elements of elem_size bytes at 'base' (uniformly random permutation, in place).
+// random_shuffle_large is faster for arrays that are much larger than the caches, but it allocates a copy of the
+// array (the two produce different permutations for the same state).
+__AD_LINKAGE _attr_unused void random_shuffle(struct random_state *state, void *base, size_t n, size_t elem_size);
+__AD_LINKAGE _attr_unused void random_shuffle_large(struct random_state *state, void *base, size_t n,
+						    size_t elem_size);
+
+// Counter-based generation (Philox4x32-10): random_at(key, i) is the i-th value of the stream 'key' and needs no
+// state, so values can be regenerated on demand and any thread can compute any part of a stream.
+// random_fill_at(key, counter, buf, n) stores the values counter to counter + n - 1 (vectorized).
+// random_philox4x32 is the underlying block function (128-bit counter, 64-bit key).
+__AD_LINKAGE _attr_unused _attr_const uint64_t random_at(uint64_t key, uint64_t counter);
+__AD_LINKAGE _attr_unused void random_fill_at(uint64_t key, uint64_t counter, uint64_t *buf, size_t n);
+__AD_LINKAGE _attr_unused void random_philox4x32(const uint32_t key[2], const uint32_t counter[4], uint32_t out[4]);
+
+// Non-uniform distributions (the fill variants are faster than a loop for large n, just like the uniform ones).
+// random_next_exponential returns values with mean 1 / lambda.
+__AD_LINKAGE _attr_unused double random_next_normal(struct random_state *state, double mean, double stddev);
+__AD_LINKAGE _attr_unused double random_next_exponential(struct random_state *state, double lambda);
+__AD_LINKAGE _attr_unused uint64_t random_next_poisson(struct random_state *state, double lambda);
+__AD_LINKAGE _attr_unused uint64_t random_next_binomial(struct random_state *state, uint64_t n, double p);
+__AD_LINKAGE _attr_unused void random_fill_normal(struct random_state *state, double *buf, size_t n, double mean,
+						  double stddev);
+__AD_LINKAGE _attr_unused void random_fill_exponential(struct random_state *state, double *buf, size_t n,
+						       double lambda);
+__AD_LINKAGE _attr_unused void random_fill_poisson(struct random_state *state, uint64_t *buf, size_t n,
+						   double lambda);
+__AD_LINKAGE _attr_unused void random_fill_binomial(struct random_state *state, uint64_t *buf, size_t count,
+						    uint64_t n, double p);
+
+// Zipf distribution over the ranks 0 to n - 1: rank k has probability proportional to 1 / (k + 1)^s (s >= 0).
+struct random_zipf {
+	// do not access these fields directly
+	uint64_t _n;
+	double _s;
+	double _h_integral_x1;
+	double _h_integral_n;
+	double _squeeze;
+};
+
+__AD_LINKAGE _attr_unused void random_zipf_init(struct random_zipf *zipf, uint64_t n, double s);
+__AD_LINKAGE _attr_unused uint64_t random_next_zipf(struct random_state *state, const struct random_zipf *zipf);
+__AD_LINKAGE _attr_unused void random_fill_zipf(struct random_state *state, const struct random_zipf *zipf,
+						uint64_t *buf, size_t n);
+
 #endif
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __RANDOM_SMALL_INCLUDE__
+#define __RANDOM_SMALL_INCLUDE__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "compiler.h"
+
+/* Small and fast generators for state that is embedded in many objects (per-connection jitter, randomized
+ * probing, skip list levels...). Every generator has the same functions as struct random_state (random.h),
+ * e.g. random_pcg32_next_u32_in_range(&rng, min, max):
+ *   wyrand: 8 bytes, a multiply-xorshift of a Weyl sequence (period 2^64), the fastest with 128-bit multiplication
+ *   pcg32:  16 bytes, 32-bit output, 2^63 selectable streams (period 2^64 each)
+ *   sfc64:  32 bytes like random_state, but a cheaper update without multiplication (period at least 2^64)
+ * None of them can jump, use random_state for streams that must not overlap.
+ */
+
+struct random_wyrand {
+	// do not access these fields directly
+	uint64_t _s;
+};
+
+// https://www.pcg-random.org (pcg32_random_r, XSH RR)
+struct random_pcg32 {
+	// do not access these fields directly
+	uint64_t _state;
+	uint64_t _inc; // odd, selects the stream
+};
+
+// https://pracrand.sourceforge.net (Chris Doty-Humphrey's small fast chaotic generator)
+struct random_sfc64 {
+	// do not access these fields directly
+	uint64_t _a, _b, _c;
+	uint64_t _counter;
+};
+
+__AD_LINKAGE _attr_unused void random_wyrand_init(struct random_wyrand *rng, uint64_t seed);
+// generators with different streams give different sequences even for the same seed
+__AD_LINKAGE _attr_unused void random_pcg32_init(struct random_pcg32 *rng, uint64_t seed, uint64_t stream);
+__AD_LINKAGE _attr_unused void random_sfc64_init(struct random_sfc64 *rng, uint64_t seed);
+
+#define __RANDOM_SMALL_DECLARE(name)					\
+	__AD_LINKAGE _attr_unused uint64_t name##_next_u64(struct name *rng); \
+	__AD_LINKAGE _attr_unused uint32_t name##_next_u32(struct name *rng); \
+	__AD_LINKAGE _attr_unused double name##_next_uniform_double(struct name *rng); \
+	__AD_LINKAGE _attr_unused float name##_next_uniform_float(struct name *rng); \
+	__AD_LINKAGE _attr_unused bool name##_next_bool(struct name *rng); \
+	__AD_LINKAGE _attr_unused uint32_t name##_next_u32_in_range(struct name *rng, uint32_t min, uint32_t max); \
+	__AD_LINKAGE _attr_unused uint64_t name##_next_u64_in_range(struct name *rng, uint64_t min, uint64_t max); \
+	__AD_LINKAGE _attr_unused float name##_next_float_in_range(struct name *rng, float min, float max); \
+	__AD_LINKAGE _attr_unused double name##_next_double_in_range(struct name *rng, double min, double max);
+
+__RANDOM_SMALL_DECLARE(random_wyrand)
+__RANDOM_SMALL_DECLARE(random_pcg32)
+__RANDOM_SMALL_DECLARE(random_sfc64)
+
+#undef __RANDOM_SMALL_DECLARE
+
+#endif
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __ROLLHASH_INCLUDE__
+#define __ROLLHASH_INCLUDE__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "compiler.h"
+#include "dbuf.h"
+#include "dstring.h"
+
+/* Rolling hashes over a sliding window of bytes and content-defined chunking (CDC) built on them.
+ * A rolling hash is filled with *_push until it covers 'window' bytes and then moved forward one byte at
+ * a time with *_roll (which needs the byte that leaves the window), e.g.
+ *     struct buzhash h;
+ *     buzhash_init(&h, 48);
+ *     for (size_t i = 0; i < 48; i++) buzhash_push(&h, data[i]);
+ *     for (size_t i = 48; i < len; i++) {
+ *             buzhash_roll(&h, data[i - 48], data[i]); // h.hash == buzhash_hash(data + i - 47, 48)
+ *     }
+ */
+
+// polynomial hash sum(data[i] * B^(len - 1 - i)) modulo 2^64 (only the high bits are well distributed)
+struct rabin_karp {
+	uint64_t hash;
+	// do not access these fields directly
+	uint64_t _out_factor;
+};
+
+__AD_LINKAGE _attr_unused void rabin_karp_init(struct rabin_karp *rk, size_t window);
+__AD_LINKAGE _attr_unused void rabin_karp_push(struct rabin_karp *rk, unsigned char in);
+__AD_LINKAGE _attr_unused void rabin_karp_roll(struct rabin_karp *rk, unsigned char out, unsigned char in);
+__AD_LINKAGE _attr_unused _attr_pure uint64_t rabin_karp_hash(const void *data, size_t len);
+
+// cyclic polynomial hash (xor of rotated random values per byte), all bits are usable
+struct buzhash {
+	uint64_t hash;
+	// do not access these fields directly
+	unsigned int _out_rotation;
+};
+
+__AD_LINKAGE _attr_unused void buzhash_init(struct buzhash *bh, size_t window);
+__AD_LINKAGE _attr_unused void buzhash_push(struct buzhash *bh, unsigned char in);
+__AD_LINKAGE _attr_unused void buzhash_roll(struct buzhash *bh, unsigned char out, unsigned char in);
+__AD_LINKAGE _attr_unused _attr_pure uint64_t buzhash_hash(const void *data, size_t len);
+
+// Gear hash ((hash << 1) + random value per byte), the window is implicit: bit k depends on the last k + 1
+// bytes, so there is no roll function and only the high bits cover a useful window
+__AD_LINKAGE _attr_unused _attr_const uint64_t gearhash_push(uint64_t hash, unsigned char in);
+__AD_LINKAGE _attr_unused _attr_pure uint64_t gearhash_hash(const void *data, size_t len);
+
+/* Content-defined chunking splits data at positions where the rolling hash of the preceding bytes matches
+ * a mask, so inserting or removing bytes only changes the chunks around the edit (as used for
+ * deduplication). CDC_GEAR is FastCDC (normalized chunking, cut points before min_size are skipped
+ * without hashing them and two bytes are hashed per step), the other two use the same chunk size
+ * control with a 48 byte window and are mostly there for compatibility with existing chunk stores.
+ * Chunks are never shorter than min_size (except for the last one) or longer than max_size, and average
+ * close to avg_size.
+ */
+enum cdc_algorithm {
+	CDC_GEAR,
+	CDC_BUZHASH,
+	CDC_RABIN_KARP,
+};
+
+struct cdc_chunker {
+	// do not access these fields directly
+	enum cdc_algorithm _algorithm;
+	size_t _min_size;
+	size_t _avg_size;
+	size_t _max_size;
+	uint64_t _mask_small; // used before avg_size, harder to match
+	uint64_t _mask_large; // used after avg_size, easier to match
+};
+
+struct cdc_iterator {
+	size_t offset; // the current chunk is [offset, offset + length)
+	size_t length;
+	// do not access these fields directly
+	const struct cdc_chunker *_chunker;
+	const unsigned char *_data;
+	size_t _size;
+	bool _last;
+};
+
+// return false if the sizes are invalid (64 <= min_size <= avg_size <= max_size is required,
+// avg_size is rounded down to a power of two)
+__AD_LINKAGE _attr_unused bool cdc_init(struct cdc_chunker *chunker, enum cdc_algorithm algorithm,
+					size_t min_size, size_t avg_size, size_t max_size);
+// return the length of the first chunk of data (len if data ends before a cut point and max_size)
+__AD_LINKAGE _attr_unused _attr_pure size_t cdc_next_chunk(const struct cdc_chunker *chunker, const void *data,
+							   size_t len);
+
+/* Iterate over the chunks of data:
+ *
+ * for (struct cdc_iterator iter = cdc_iter_start(&chunker, data, size, true);
+ *      !cdc_iter_finished(&iter); cdc_iter_advance(&iter)) {
+ *         store(data + iter.offset, iter.length);
+ * }
+ *
+ * If 'last' is false more data follows, so the trailing bytes that do not end in a cut point are not
+ * returned as a chunk. Once the iteration finished, iter.offset is the number of bytes consumed and the
+ * remaining ones should be passed again, followed by the next data (see cdc_iter_start_dbuf).
+ */
+__AD_LINKAGE _attr_unused struct cdc_iterator cdc_iter_start(const struct cdc_chunker *chunker, const void *data,
+							     size_t size, bool last);
+// iterate over the contents of a dbuf that is used as a stream buffer: append data, iterate with 'last'
+// set at the end of the stream, then move the bytes after iter.offset to the front (memmove + dbuf_truncate)
+__AD_LINKAGE _attr_unused struct cdc_iterator cdc_iter_start_dbuf(const struct cdc_chunker *chunker,
+								  const struct dbuf *dbuf, bool last);
+__AD_LINKAGE _attr_unused struct cdc_iterator cdc_iter_start_view(const struct cdc_chunker *chunker,
+								  struct strview view);
+__AD_LINKAGE _attr_unused _attr_pure bool cdc_iter_finished(const struct cdc_iterator *iter);
+__AD_LINKAGE _attr_unused void cdc_iter_advance(struct cdc_iterator *iter);
+
+#endif
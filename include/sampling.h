@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __SAMPLING_INCLUDE__
+#define __SAMPLING_INCLUDE__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "compiler.h"
+#include "random.h"
+
+/* Alias table (Walker, built with Vose's method): O(1) sampling from a fixed discrete distribution.
+ * Every one of the n columns holds the probability of keeping its own index and the index it is replaced with
+ * otherwise, so a sample is a single random number (its high bits pick the column, its low bits decide) and a
+ * single memory access.
+ */
+
+struct _alias_entry;
+
+struct alias_table {
+	// do not access these fields directly
+	struct _alias_entry *_entries;
+	size_t _n;
+};
+
+// index i is sampled with probability weights[i] / sum(weights) (the weights must be >= 0 and not all 0)
+__AD_LINKAGE _attr_unused void alias_table_init(struct alias_table *table, const double *weights, size_t n);
+__AD_LINKAGE _attr_unused void alias_table_destroy(struct alias_table *table);
+__AD_LINKAGE _attr_unused size_t alias_table_sample(const struct alias_table *table, struct random_state *rng);
+// store 'count' samples in 'out' (uses the bulk random fills)
+__AD_LINKAGE _attr_unused void alias_table_sample_many(const struct alias_table *table, struct random_state *rng,
+						       uint64_t *out, size_t count);
+__AD_LINKAGE _attr_unused _attr_pure size_t alias_table_size(const struct alias_table *table);
+
+/* Reservoir sampling: a uniform random sample of 'capacity' items from a stream of unknown length.
+ * The reservoir does not store the items itself: reservoir_offer says in which slot (if any) the caller has to
+ * store the next item. Algorithm L (Li, "Reservoir-sampling algorithms of time complexity O(n(1 + log(N/n)))")
+ * draws the number of items to skip until the next replacement, so skipped items cost no random numbers and
+ * reservoir_next tells which item of the stream will be taken next (streams that can seek do not even need to
+ * read the ones in between).
+ */
+
+#define RESERVOIR_SKIP SIZE_MAX
+
+struct reservoir {
+	// do not access these fields directly
+	uint64_t _seen;
+	uint64_t _next; // index of the next item that is stored
+	double _w;
+	size_t _capacity;
+};
+
+__AD_LINKAGE _attr_unused void reservoir_init(struct reservoir *reservoir, size_t capacity);
+// offer the next item of the stream: return the slot (< capacity) to store it in or RESERVOIR_SKIP
+__AD_LINKAGE _attr_unused size_t reservoir_offer(struct reservoir *reservoir, struct random_state *rng);
+// the stream index of the next item that will be stored (items before it do not need to be offered)
+__AD_LINKAGE _attr_unused _attr_pure uint64_t reservoir_next(const struct reservoir *reservoir);
+// pass over n items without offering them (they must all be before reservoir_next)
+__AD_LINKAGE _attr_unused void reservoir_skip(struct reservoir *reservoir, uint64_t n);
+// the number of items that have been offered or skipped
+__AD_LINKAGE _attr_unused _attr_pure uint64_t reservoir_seen(const struct reservoir *reservoir);
+// the number of occupied slots
+__AD_LINKAGE _attr_unused _attr_pure size_t reservoir_size(const struct reservoir *reservoir);
+
+/* Weighted reservoir sampling without replacement (Efraimidis and Spirakis, A-ExpJ): every item gets the key
+ * u^(1 / weight) and the reservoir keeps the 'capacity' items with the largest keys (in a min-heap). Like
+ * Algorithm L it jumps over the total weight that can be skipped instead of drawing a key for every item.
+ */
+
+struct _weighted_reservoir_node;
+
+struct weighted_reservoir {
+	// do not access these fields directly
+	struct _weighted_reservoir_node *_heap;
+	size_t _size;
+	size_t _capacity;
+	double _skip; // weight left to skip until the next replacement
+};
+
+__AD_LINKAGE _attr_unused void weighted_reservoir_init(struct weighted_reservoir *reservoir, size_t capacity);
+__AD_LINKAGE _attr_unused void weighted_reservoir_destroy(struct weighted_reservoir *reservoir);
+// offer the next item (weight >= 0): return the slot (< capacity) to store it in or RESERVOIR_SKIP
+__AD_LINKAGE _attr_unused size_t weighted_reservoir_offer(struct weighted_reservoir *reservoir,
+							  struct random_state *rng, double weight);
+__AD_LINKAGE _attr_unused _attr_pure size_t weighted_reservoir_size(const struct weighted_reservoir *reservoir);
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __STRDICT_INCLUDE__
+#define __STRDICT_INCLUDE__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "config.h"
+#include "compiler.h"
+#include "dstring.h"
+
+/* An immutable dictionary of strings that maps each string to its rank (its id) in sorted order.
+ * The strings are front coded in blocks of STRDICT_BLOCK_SIZE: the first string of every block is
+ * stored verbatim, every following one as the length of the prefix it shares with its predecessor plus
+ * the remaining suffix. Lookups binary search the block heads and then decode a single block.
+ * Strings are ordered by memcmp (shorter strings first if one is a prefix of the other), just like
+ * strview_compare.
+ */
+
+#ifndef STRDICT_BLOCK_SIZE
+# define STRDICT_BLOCK_SIZE 16
+#endif
+
+#define STRDICT_NOT_FOUND ((size_t)-1)
+
+struct strdict {
+	// do not access these fields directly
+	unsigned char *_data;
+	size_t *_block_offsets; // num_blocks + 1 offsets into _data
+	size_t _num_strings;
+	size_t _max_length;
+};
+
+struct strdict_iterator {
+	struct strview string;
+	size_t id;
+	// do not access these fields directly
+	const struct strdict *_dict;
+	size_t _end;
+	size_t _offset;
+	char *_buffer;
+};
+
+// build a dictionary from 'count' strictly increasing strings (e.g. an array_t(struct strview))
+// return false (and leave dict empty) if the strings are not sorted or contain duplicates
+__AD_LINKAGE _attr_unused bool strdict_init(struct strdict *dict, const struct strview *strings, size_t count);
+__AD_LINKAGE _attr_unused void strdict_destroy(struct strdict *dict);
+__AD_LINKAGE _attr_unused _attr_pure size_t strdict_size(const struct strdict *dict);
+// number of bytes used by the dictionary
+__AD_LINKAGE _attr_unused _attr_pure size_t strdict_memory_usage(const struct strdict *dict);
+// return the id of 'string' or STRDICT_NOT_FOUND
+__AD_LINKAGE _attr_unused _attr_pure size_t strdict_lookup(const struct strdict *dict, struct strview string);
+// return the number of strings in dict that are less than 'string'
+__AD_LINKAGE _attr_unused _attr_pure size_t strdict_rank(const struct strdict *dict, struct strview string);
+// return the string with the given id as a new dstr_t (id must be less than strdict_size(dict))
+__AD_LINKAGE _attr_unused _attr_nodiscard dstr_t strdict_extract(const struct strdict *dict, size_t id);
+// replace the contents of *dstrp with the string with the given id
+__AD_LINKAGE _attr_unused void strdict_extract_into(const struct strdict *dict, size_t id, dstr_t *dstrp);
+// set [*ret_first, *ret_last) to the ids of all strings that start with 'prefix'
+__AD_LINKAGE _attr_unused void strdict_prefix_range(const struct strdict *dict, struct strview prefix,
+						    size_t *ret_first, size_t *ret_last);
+
+/* Iterate over the strings with ids in [first, last) in order (iter.string is only valid until the next
+ * call to strdict_iter_advance), strdict_iter_destroy has to be called unless the iteration finished:
+ *
+ * for (struct strdict_iterator iter = strdict_iter_start(&dict, first, last);
+ *      !strdict_iter_finished(&iter); strdict_iter_advance(&iter)) {
+ *         ...
+ * }
+ */
+__AD_LINKAGE _attr_unused struct strdict_iterator strdict_iter_start(const struct strdict *dict, size_t first, size_t last);
+__AD_LINKAGE _attr_unused _attr_pure bool strdict_iter_finished(const struct strdict_iterator *iter);
+__AD_LINKAGE _attr_unused void strdict_iter_advance(struct strdict_iterator *iter);
+__AD_LINKAGE _attr_unused void strdict_iter_destroy(struct strdict_iterator *iter);
+
+#endif
@@ -393,6 +393,8 @@ static _attr_always_inline _attr_const _attr_unused uint32_t _bswap32(uint32_t x
 #endif
 }
 
+// <immintrin.h> (ia32intrin.h) defines _bswap64 as a macro for the same thing, which would rename this function
+#undef _bswap64
 static _attr_always_inline _attr_const _attr_unused uint64_t _bswap64(uint64_t x)
 {
 #ifdef HAVE_BUILTIN_BSWAP
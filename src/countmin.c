@@ -0,0 +1,287 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "compiler.h"
+#include "config.h"
+#include "countmin.h"
+#include "hash.h"
+#include "hashtable.h"
+#include "heap.h"
+#include "utils.h"
+
+// number of keys whose counters are prefetched together by count_min_add_batch
+#define __COUNT_MIN_BATCH 8
+
+static _attr_always_inline size_t _count_min_index(const struct count_min *cms, unsigned int row, uint64_t key)
+{
+	return row * cms->_width + (hash_combine_int64(cms->_seeds[row], key).u64 & (cms->_width - 1));
+}
+
+static _attr_always_inline uint64_t _count_min_update(struct count_min *cms, const size_t *indices, uint64_t count)
+{
+	uint64_t *counters = cms->_counters;
+	uint64_t estimate = UINT64_MAX;
+	for (unsigned int row = 0; row < cms->_depth; row++) {
+		estimate = counters[indices[row]] < estimate ? counters[indices[row]] : estimate;
+	}
+	estimate = estimate > UINT64_MAX - count ? UINT64_MAX : estimate + count;
+	// conservative update: only raise the counters that are below the new estimate
+	for (unsigned int row = 0; row < cms->_depth; row++) {
+		counters[indices[row]] = counters[indices[row]] < estimate ? estimate : counters[indices[row]];
+	}
+	cms->_total += count;
+	return estimate;
+}
+
+__AD_LINKAGE void count_min_init(struct count_min *cms, size_t width, unsigned int depth, uint64_t seed)
+{
+	assert(width != 0 && depth >= 1 && depth <= COUNT_MIN_MAX_DEPTH);
+	size_t rounded = 1;
+	while (rounded < width) {
+		rounded *= 2;
+	}
+	cms->_counters = calloc(rounded * depth, sizeof(cms->_counters[0]));
+	if (unlikely(!cms->_counters)) {
+		abort();
+	}
+	cms->_total = 0;
+	cms->_width = rounded;
+	cms->_depth = depth;
+	for (unsigned int row = 0; row < COUNT_MIN_MAX_DEPTH; row++) {
+		cms->_seeds[row] = row < depth ? hash_combine_int64(seed, row).u64 : 0;
+	}
+}
+
+__AD_LINKAGE void count_min_init_with_error(struct count_min *cms, double epsilon, double delta, uint64_t seed)
+{
+	assert(epsilon > 0.0 && delta > 0.0 && delta < 1.0);
+	double width = ceil(2.71828182845904523536 / epsilon);
+	double depth = ceil(log(1.0 / delta));
+	count_min_init(cms, width < 1.0 ? 1 : (size_t)width,
+		       depth < 1.0 ? 1 : depth > COUNT_MIN_MAX_DEPTH ? COUNT_MIN_MAX_DEPTH : (unsigned int)depth, seed);
+}
+
+__AD_LINKAGE void count_min_destroy(struct count_min *cms)
+{
+	free(cms->_counters);
+}
+
+__AD_LINKAGE void count_min_clear(struct count_min *cms)
+{
+	memset(cms->_counters, 0, cms->_width * cms->_depth * sizeof(cms->_counters[0]));
+	cms->_total = 0;
+}
+
+__AD_LINKAGE uint64_t count_min_add(struct count_min *cms, uint64_t key, uint64_t count)
+{
+	size_t indices[COUNT_MIN_MAX_DEPTH];
+	for (unsigned int row = 0; row < cms->_depth; row++) {
+		indices[row] = _count_min_index(cms, row, key);
+	}
+	return _count_min_update(cms, indices, count);
+}
+
+__AD_LINKAGE void count_min_add_batch(struct count_min *cms, const uint64_t *keys, size_t count)
+{
+	size_t indices[__COUNT_MIN_BATCH][COUNT_MIN_MAX_DEPTH];
+	const unsigned int depth = cms->_depth;
+	for (size_t i = 0; i < count; i += __COUNT_MIN_BATCH) {
+		size_t n = count - i < __COUNT_MIN_BATCH ? count - i : __COUNT_MIN_BATCH;
+		// compute all indices of the batch first so that the cache misses overlap
+		for (size_t j = 0; j < n; j++) {
+			for (unsigned int row = 0; row < depth; row++) {
+				indices[j][row] = _count_min_index(cms, row, keys[i + j]);
+				prefetch_write(&cms->_counters[indices[j][row]]);
+			}
+		}
+		for (size_t j = 0; j < n; j++) {
+			_count_min_update(cms, indices[j], 1);
+		}
+	}
+}
+
+__AD_LINKAGE uint64_t count_min_estimate(const struct count_min *cms, uint64_t key)
+{
+	uint64_t estimate = UINT64_MAX;
+	for (unsigned int row = 0; row < cms->_depth; row++) {
+		uint64_t counter = cms->_counters[_count_min_index(cms, row, key)];
+		estimate = counter < estimate ? counter : estimate;
+	}
+	return estimate;
+}
+
+__AD_LINKAGE uint64_t count_min_total(const struct count_min *cms)
+{
+	return cms->_total;
+}
+
+__AD_LINKAGE bool count_min_merge(struct count_min *cms, const struct count_min *other)
+{
+	if (cms->_width != other->_width || cms->_depth != other->_depth ||
+	    memcmp(cms->_seeds, other->_seeds, sizeof(cms->_seeds)) != 0) {
+		return false;
+	}
+	const size_t n = cms->_width * cms->_depth;
+	for (size_t i = 0; i < n; i++) {
+		uint64_t sum = cms->_counters[i] + other->_counters[i];
+		cms->_counters[i] = sum < cms->_counters[i] ? UINT64_MAX : sum;
+	}
+	cms->_total += other->_total;
+	return true;
+}
+
+__AD_LINKAGE size_t count_min_memory_usage(const struct count_min *cms)
+{
+	return sizeof(*cms) + cms->_width * cms->_depth * sizeof(cms->_counters[0]);
+}
+
+struct _topk_heap_node {
+	uint64_t count;
+	size_t entry;
+};
+
+DEFINE_MINHEAP(_topk_heap, struct _topk_heap_node, a->count < b->count)
+
+struct _topk_index_entry {
+	uint64_t key;
+	size_t entry;
+};
+
+DEFINE_HASHTABLE(_topk_index, uint64_t, struct _topk_index_entry, 8, (entry->key == *key))
+
+static _attr_always_inline uint32_t _topk_hash(uint64_t key)
+{
+	return (uint32_t)hash_int64(key).u64;
+}
+
+__AD_LINKAGE void topk_init(struct topk *topk, size_t k, size_t width, unsigned int depth, uint64_t seed)
+{
+	assert(k != 0 && k <= UINT32_MAX / 2);
+	count_min_init(&topk->_sketch, width, depth, seed);
+	topk->_entries = malloc(k * sizeof(topk->_entries[0]));
+	topk->_heap = malloc(k * sizeof(topk->_heap[0]));
+	if (unlikely(!topk->_entries || !topk->_heap)) {
+		abort();
+	}
+	topk->_index = _topk_index_new((_topk_index_uint_t)(2 * k));
+	topk->_size = 0;
+	topk->_k = k;
+}
+
+__AD_LINKAGE void topk_destroy(struct topk *topk)
+{
+	count_min_destroy(&topk->_sketch);
+	free(topk->_entries);
+	free(topk->_heap);
+	_topk_index_delete(topk->_index);
+}
+
+__AD_LINKAGE void topk_clear(struct topk *topk)
+{
+	count_min_clear(&topk->_sketch);
+	_topk_index_clear(topk->_index);
+	topk->_size = 0;
+}
+
+__AD_LINKAGE uint64_t topk_add(struct topk *topk, uint64_t key, uint64_t count)
+{
+	uint64_t estimate = count_min_add(&topk->_sketch, key, count);
+	uint32_t hash = _topk_hash(key);
+	struct _topk_index_entry *found = _topk_index_lookup(topk->_index, key, hash);
+	if (found) {
+		// (the heap node is updated lazily once it reaches the top of the heap)
+		topk->_entries[found->entry].count = estimate;
+		return estimate;
+	}
+
+	struct _topk_heap_node *heap = topk->_heap;
+	size_t entry;
+	if (topk->_size < topk->_k) {
+		entry = topk->_size++;
+		heap[entry].count = estimate;
+		heap[entry].entry = entry;
+		_topk_heap_insert(heap, topk->_size);
+	} else {
+		// bring the heap node with the smallest count up to date (every refresh pays for earlier increments)
+		while (heap[0].count < topk->_entries[heap[0].entry].count) {
+			heap[0].count = topk->_entries[heap[0].entry].count;
+			_topk_heap_increase_key(heap, topk->_size, 0);
+		}
+		if (estimate <= heap[0].count) {
+			return estimate;
+		}
+		entry = heap[0].entry;
+		uint64_t evicted = topk->_entries[entry].key;
+		_topk_index_remove(topk->_index, evicted, _topk_hash(evicted), NULL);
+		heap[0].count = estimate;
+		_topk_heap_increase_key(heap, topk->_size, 0);
+	}
+	topk->_entries[entry].key = key;
+	topk->_entries[entry].count = estimate;
+	struct _topk_index_entry *inserted = _topk_index_insert(topk->_index, key, hash);
+	inserted->key = key;
+	inserted->entry = entry;
+	return estimate;
+}
+
+__AD_LINKAGE bool topk_query(const struct topk *topk, uint64_t key, uint64_t *ret_count)
+{
+	struct _topk_index_entry *found = _topk_index_lookup(topk->_index, key, _topk_hash(key));
+	if (!found) {
+		return false;
+	}
+	if (ret_count) {
+		*ret_count = topk->_entries[found->entry].count;
+	}
+	return true;
+}
+
+__AD_LINKAGE uint64_t topk_estimate(const struct topk *topk, uint64_t key)
+{
+	return count_min_estimate(&topk->_sketch, key);
+}
+
+static int _topk_compare_entries(const void *_a, const void *_b)
+{
+	const struct topk_entry *a = _a;
+	const struct topk_entry *b = _b;
+	if (a->count != b->count) {
+		return a->count > b->count ? -1 : 1;
+	}
+	return a->key < b->key ? -1 : (a->key > b->key);
+}
+
+__AD_LINKAGE size_t topk_list(const struct topk *topk, struct topk_entry *out)
+{
+	memcpy(out, topk->_entries, topk->_size * sizeof(out[0]));
+	qsort(out, topk->_size, sizeof(out[0]), _topk_compare_entries);
+	return topk->_size;
+}
+
+__AD_LINKAGE size_t topk_size(const struct topk *topk)
+{
+	return topk->_size;
+}
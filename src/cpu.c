@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "cpu.h"
+#include "compiler.h"
+#include "config.h"
+
+#define __CPU_FEATURES_DETECTED (1u << 31)
+
+static unsigned int _cpu_detect_features(void)
+{
+	unsigned int features = 0;
+#if defined(HAVE_BUILTIN_CPU_SUPPORTS) && (defined(__x86_64__) || defined(__i386__))
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2")) {
+		features |= CPU_FEATURE_SSE2;
+	}
+	if (__builtin_cpu_supports("sse4.2")) {
+		features |= CPU_FEATURE_SSE4_2;
+	}
+	if (__builtin_cpu_supports("pclmul")) {
+		features |= CPU_FEATURE_PCLMUL;
+	}
+	if (__builtin_cpu_supports("popcnt")) {
+		features |= CPU_FEATURE_POPCNT;
+	}
+	if (__builtin_cpu_supports("avx2")) {
+		features |= CPU_FEATURE_AVX2;
+	}
+	if (__builtin_cpu_supports("bmi2")) {
+		features |= CPU_FEATURE_BMI2;
+	}
+	if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl") &&
+	    __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq")) {
+		features |= CPU_FEATURE_AVX512;
+	}
+#else
+	// all we know is what the compiler was allowed to use
+# ifdef __SSE2__
+	features |= CPU_FEATURE_SSE2;
+# endif
+# ifdef __SSE4_2__
+	features |= CPU_FEATURE_SSE4_2;
+# endif
+# ifdef __PCLMUL__
+	features |= CPU_FEATURE_PCLMUL;
+# endif
+# ifdef __POPCNT__
+	features |= CPU_FEATURE_POPCNT;
+# endif
+# ifdef __AVX2__
+	features |= CPU_FEATURE_AVX2;
+# endif
+# ifdef __BMI2__
+	features |= CPU_FEATURE_BMI2;
+# endif
+# if defined(__AVX512F__) && defined(__AVX512VL__) && defined(__AVX512BW__) && defined(__AVX512DQ__)
+	features |= CPU_FEATURE_AVX512;
+# endif
+#endif
+	const char *mask = getenv("ADLIB_CPU_FEATURES");
+	if (mask) {
+		features &= (unsigned int)strtoul(mask, NULL, 0);
+	}
+	return features;
+}
+
+__AD_LINKAGE unsigned int cpu_features(void)
+{
+	// racing threads all compute the same value
+	static atomic_uint cached = 0;
+	unsigned int features = atomic_load_explicit(&cached, memory_order_relaxed);
+	if (unlikely(!features)) {
+		features = _cpu_detect_features() | __CPU_FEATURES_DETECTED;
+		atomic_store_explicit(&cached, features, memory_order_relaxed);
+	}
+	return features & ~__CPU_FEATURES_DETECTED;
+}
+
+__AD_LINKAGE bool cpu_has(unsigned int features)
+{
+	return (cpu_features() & features) == features;
+}
+
+#undef __CPU_FEATURES_DETECTED
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+#include "flatmap.h"
+#include "utils.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+# include <immintrin.h>
+#endif
+
+__AD_LINKAGE size_t _flatmap_find_u32(const void *_keys, size_t n, uint32_t key)
+{
+	// the keys can be of any 4 byte integer type, so they are only accessed with memcpy and vector loads
+	const unsigned char *keys = _keys;
+	size_t i = 0;
+#if defined(__AVX2__)
+	__m256i needle = _mm256_set1_epi32((int)key);
+	for (; i + 8 <= n; i += 8) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)(keys + 4 * i));
+		unsigned int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, needle)));
+		if (mask) {
+			return i + ctz(mask);
+		}
+	}
+#elif defined(__SSE2__)
+	__m128i needle = _mm_set1_epi32((int)key);
+	for (; i + 4 <= n; i += 4) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(keys + 4 * i));
+		unsigned int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, needle)));
+		if (mask) {
+			return i + ctz(mask);
+		}
+	}
+#endif
+	for (; i < n; i++) {
+		uint32_t k;
+		memcpy(&k, keys + 4 * i, sizeof(k));
+		if (k == key) {
+			return i;
+		}
+	}
+	return n;
+}
+
+__AD_LINKAGE size_t _flatmap_find_u64(const void *_keys, size_t n, uint64_t key)
+{
+	// the keys can be of any 8 byte integer type, so they are only accessed with memcpy and vector loads
+	const unsigned char *keys = _keys;
+	size_t i = 0;
+#if defined(__AVX2__)
+	__m256i needle = _mm256_set1_epi64x((long long)key);
+	for (; i + 4 <= n; i += 4) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)(keys + 8 * i));
+		unsigned int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(v, needle)));
+		if (mask) {
+			return i + ctz(mask);
+		}
+	}
+#elif defined(__SSE2__)
+	// SSE2 has no 64-bit compare, so both 32-bit halves have to match
+	__m128i needle = _mm_set1_epi64x((long long)key);
+	for (; i + 2 <= n; i += 2) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(keys + 8 * i));
+		__m128i eq = _mm_cmpeq_epi32(v, needle);
+		eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+		unsigned int mask = _mm_movemask_pd(_mm_castsi128_pd(eq));
+		if (mask) {
+			return i + ctz(mask);
+		}
+	}
+#endif
+	for (; i < n; i++) {
+		uint64_t k;
+		memcpy(&k, keys + 8 * i, sizeof(k));
+		if (k == key) {
+			return i;
+		}
+	}
+	return n;
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "groupby.h"
+
+__AD_LINKAGE unsigned int groupby_partition_bits(size_t expected_groups, size_t entry_size)
+{
+	// budget two slots per group (a 50% load factor), each with the entry and its metadata (a hash)
+	size_t bytes_per_group = 2 * (entry_size + sizeof(uint32_t));
+	unsigned int bits = 0;
+	while (bits < GROUPBY_MAX_PARTITION_BITS &&
+	       (expected_groups >> bits) > GROUPBY_CACHE_SIZE / bytes_per_group) {
+		bits++;
+	}
+	return bits;
+}
+
+__AD_LINKAGE void _groupby_partition_offsets(const uint32_t *hashes, size_t n, unsigned int partition_bits,
+					     size_t *offsets)
+{
+	assert(1 <= partition_bits && partition_bits <= GROUPBY_MAX_PARTITION_BITS);
+	size_t num_partitions = (size_t)1 << partition_bits;
+	memset(offsets, 0, (num_partitions + 1) * sizeof(offsets[0]));
+	for (size_t i = 0; i < n; i++) {
+		offsets[(hashes[i] >> (32 - partition_bits)) + 1]++;
+	}
+	for (size_t p = 1; p <= num_partitions; p++) {
+		offsets[p] += offsets[p - 1];
+	}
+}
@@ -18,10 +18,19 @@
  */
 
 #include <assert.h>
+#include <math.h>
+#include <stdatomic.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include "hash.h"
+#include "cpu.h"
 #include "macros.h"
+#include "utils.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+# include <immintrin.h>
+#endif
 
 /*
   SipHash reference C implementation
@@ -78,33 +87,31 @@
 		v2 = __HASH_ROTL64(v2, 32);	\
 	} while (0)
 
-static _attr_always_inline void _siphash(const void *in, const size_t inlen, const void *k,
-					 uint8_t *out, const size_t outlen,
-					 const int cROUNDS, const int dROUNDS)
+static _attr_always_inline void _siphash_init(uint64_t *v, const void *k, const size_t outlen)
 {
-	const unsigned char *ni = (const unsigned char *)in;
 	const unsigned char *kk = (const unsigned char *)k;
 
 	assert((outlen == 8) || (outlen == 16));
-	uint64_t v0 = UINT64_C(0x736f6d6570736575);
-	uint64_t v1 = UINT64_C(0x646f72616e646f6d);
-	uint64_t v2 = UINT64_C(0x6c7967656e657261);
-	uint64_t v3 = UINT64_C(0x7465646279746573);
 	uint64_t k0 = __HASH_U8TO64_LE(kk);
 	uint64_t k1 = __HASH_U8TO64_LE(kk + 8);
-	uint64_t m;
-	int i;
-	const unsigned char *end = ni + inlen - (inlen % sizeof(uint64_t));
-	const int left = inlen & 7;
-	uint64_t b = ((uint64_t)inlen) << 56;
-	v3 ^= k1;
-	v2 ^= k0;
-	v1 ^= k1;
-	v0 ^= k0;
+	v[0] = UINT64_C(0x736f6d6570736575) ^ k0;
+	v[1] = UINT64_C(0x646f72616e646f6d) ^ k1;
+	v[2] = UINT64_C(0x6c7967656e657261) ^ k0;
+	v[3] = UINT64_C(0x7465646279746573) ^ k1;
 
 	if (outlen == 16) {
-		v1 ^= 0xee;
+		v[1] ^= 0xee;
 	}
+}
+
+// process nblocks 8 byte blocks
+static _attr_always_inline void _siphash_blocks(uint64_t *v, const unsigned char *ni, size_t nblocks,
+						const int cROUNDS)
+{
+	uint64_t v0 = v[0], v1 = v[1], v2 = v[2], v3 = v[3];
+	uint64_t m;
+	int i;
+	const unsigned char *end = ni + 8 * nblocks;
 
 	for (; ni != end; ni += 8) {
 		m = __HASH_U8TO64_LE(ni);
@@ -117,6 +124,15 @@ static _attr_always_inline void _siphash(const void *in, const size_t inlen, con
 		v0 ^= m;
 	}
 
+	v[0] = v0; v[1] = v1; v[2] = v2; v[3] = v3;
+}
+
+// the last message word: the last inlen % 8 bytes (ni) and the length in the most significant byte
+static _attr_always_inline uint64_t _siphash_last_word(const unsigned char *ni, const uint64_t inlen)
+{
+	const int left = inlen & 7;
+	uint64_t b = ((uint64_t)inlen) << 56;
+
 	switch (left) {
 	case 7:
 		b |= ((uint64_t)ni[6]) << 48; _attr_fallthrough;
@@ -136,6 +152,18 @@ static _attr_always_inline void _siphash(const void *in, const size_t inlen, con
 		break;
 	}
 
+	return b;
+}
+
+// process the last inlen % 8 bytes (ni) and produce the output
+static _attr_always_inline void _siphash_final(uint64_t *v, const unsigned char *ni, const uint64_t inlen,
+					       uint8_t *out, const size_t outlen,
+					       const int cROUNDS, const int dROUNDS)
+{
+	uint64_t v0 = v[0], v1 = v[1], v2 = v[2], v3 = v[3];
+	int i;
+	uint64_t b = _siphash_last_word(ni, inlen);
+
 	v3 ^= b;
 
 	for (i = 0; i < cROUNDS; ++i) {
@@ -171,6 +199,37 @@ static _attr_always_inline void _siphash(const void *in, const size_t inlen, con
 	__HASH_U64TO8_LE(out + 8, b);
 }
 
+static _attr_always_inline void _siphash(const void *in, const size_t inlen, const void *k,
+					 uint8_t *out, const size_t outlen,
+					 const int cROUNDS, const int dROUNDS)
+{
+	const unsigned char *ni = (const unsigned char *)in;
+	uint64_t v[4];
+	_siphash_init(v, k, outlen);
+	_siphash_blocks(v, ni, inlen / 8, cROUNDS);
+	_siphash_final(v, ni + inlen - (inlen % 8), inlen, out, outlen, cROUNDS, dROUNDS);
+}
+
+static _attr_always_inline void _siphash_update(struct siphash_state *state, const void *in, size_t inlen,
+						const int cROUNDS)
+{
+	const unsigned char *ni = (const unsigned char *)in;
+	size_t buffered = state->_length % 8;
+	state->_length += inlen;
+	if (buffered != 0) {
+		size_t n = 8 - buffered < inlen ? 8 - buffered : inlen;
+		memcpy(state->_buffer + buffered, ni, n);
+		if (buffered + n < 8) {
+			return;
+		}
+		_siphash_blocks(state->_v, state->_buffer, 1, cROUNDS);
+		ni += n;
+		inlen -= n;
+	}
+	_siphash_blocks(state->_v, ni, inlen / 8, cROUNDS);
+	memcpy(state->_buffer, ni + inlen - (inlen % 8), inlen % 8);
+}
+
 __AD_LINKAGE hash64_t siphash24_64(const void *in, size_t inlen, const void *key)
 {
 	hash64_t out;
@@ -199,6 +258,239 @@ __AD_LINKAGE hash128_t siphash13_128(const void *in, size_t inlen, const void *k
 	return out;
 }
 
+#ifdef HAVE_ATTR_VECTOR_SIZE
+typedef uint64_t _siphash_v4 __attribute__((vector_size(32)));
+typedef uint64_t _siphash_v8 __attribute__((vector_size(64)));
+
+# define __SIPHASH_VROTL(x, b) (((x) << (b)) | ((x) >> (64 - (b))))
+
+/* Every lane runs its own SipHash state, the last (padded) message word of a lane is treated like any other
+ * block, lanes that have already consumed all of their message words keep their state (masked blend).
+ */
+# define __SIPHASH_DEFINE_MULTI(lanes, cROUNDS, dROUNDS)		\
+	static _attr_always_inline void _siphash_x##lanes(const void *const *in, const size_t *inlen, \
+							  const void *key, hash64_t *out) \
+	{								\
+		typedef _siphash_v##lanes vec;				\
+		uint64_t v[4];						\
+		_siphash_init(v, key, 8);				\
+		vec v0 = v[0] - (vec){0};				\
+		vec v1 = v[1] - (vec){0};				\
+		vec v2 = v[2] - (vec){0};				\
+		vec v3 = v[3] - (vec){0};				\
+		vec num_words;						\
+		uint64_t last_word[lanes];				\
+		size_t max_words = 0;					\
+		for (size_t l = 0; l < (lanes); l++) {			\
+			num_words[l] = inlen[l] / 8 + 1;		\
+			max_words = inlen[l] / 8 + 1 > max_words ? inlen[l] / 8 + 1 : max_words; \
+			const unsigned char *tail = (const unsigned char *)in[l] + inlen[l] - inlen[l] % 8; \
+			last_word[l] = _siphash_last_word(tail, inlen[l]); \
+		}							\
+		for (size_t j = 0; j < max_words; j++) {		\
+			/* building the vector from scalars avoids a store forwarding stall */ \
+			vec m = {__SIPHASH_WORDS##lanes};		\
+			vec active = (vec)(j < num_words);		\
+			vec old0 = v0, old1 = v1, old2 = v2, old3 = v3; \
+			v3 ^= m;					\
+			for (int i = 0; i < (cROUNDS); i++) {		\
+				__SIPHASH_VROUND;			\
+			}						\
+			v0 ^= m;					\
+			v0 = (v0 & active) | (old0 & ~active);		\
+			v1 = (v1 & active) | (old1 & ~active);		\
+			v2 = (v2 & active) | (old2 & ~active);		\
+			v3 = (v3 & active) | (old3 & ~active);		\
+		}							\
+		v2 ^= 0xff;						\
+		for (int i = 0; i < (dROUNDS); i++) {			\
+			__SIPHASH_VROUND;				\
+		}							\
+		vec b = v0 ^ v1 ^ v2 ^ v3;				\
+		for (size_t l = 0; l < (lanes); l++) {			\
+			__HASH_U64TO8_LE(out[l].bytes, b[l]);		\
+		}							\
+	}
+
+# define __SIPHASH_WORD(l)						\
+	(j + 1 < num_words[l] ? __HASH_U8TO64_LE((const unsigned char *)in[l] + 8 * j) : last_word[l])
+# define __SIPHASH_WORDS4 __SIPHASH_WORD(0), __SIPHASH_WORD(1), __SIPHASH_WORD(2), __SIPHASH_WORD(3)
+# define __SIPHASH_WORDS8 __SIPHASH_WORDS4, __SIPHASH_WORD(4), __SIPHASH_WORD(5), __SIPHASH_WORD(6), __SIPHASH_WORD(7)
+
+# define __SIPHASH_VROUND				\
+	do {						\
+		v0 += v1;				\
+		v1 = __SIPHASH_VROTL(v1, 13);		\
+		v1 ^= v0;				\
+		v0 = __SIPHASH_VROTL(v0, 32);		\
+		v2 += v3;				\
+		v3 = __SIPHASH_VROTL(v3, 16);		\
+		v3 ^= v2;				\
+		v0 += v3;				\
+		v3 = __SIPHASH_VROTL(v3, 21);		\
+		v3 ^= v0;				\
+		v2 += v1;				\
+		v1 = __SIPHASH_VROTL(v1, 17);		\
+		v1 ^= v2;				\
+		v2 = __SIPHASH_VROTL(v2, 32);		\
+	} while (0)
+
+__SIPHASH_DEFINE_MULTI(4, 1, 3)
+__SIPHASH_DEFINE_MULTI(8, 1, 3)
+
+# undef __SIPHASH_VROTL
+# undef __SIPHASH_VROUND
+# undef __SIPHASH_WORD
+# undef __SIPHASH_WORDS4
+# undef __SIPHASH_WORDS8
+# undef __SIPHASH_DEFINE_MULTI
+#else
+static _attr_always_inline void _siphash_multi(const void *const *in, const size_t *inlen, const void *key,
+					       hash64_t *out, size_t lanes)
+{
+	for (size_t l = 0; l < lanes; l++) {
+		out[l] = siphash13_64(in[l], inlen[l], key);
+	}
+}
+# define _siphash_x4(in, inlen, key, out) _siphash_multi(in, inlen, key, out, 4)
+# define _siphash_x8(in, inlen, key, out) _siphash_multi(in, inlen, key, out, 8)
+#endif
+
+#if defined(HAVE_CPU_DISPATCH) && defined(HAVE_ATTR_VECTOR_SIZE)
+typedef void (*_siphash_multi_func)(const void *const *in, const size_t *inlen, const void *key, hash64_t *out);
+
+// the generic vector code is compiled once per ISA, the first call picks the widest one the CPU supports
+# define __SIPHASH_DEFINE_DISPATCH(lanes)				\
+	static _attr_noinline void _siphash_x##lanes##_default(const void *const *in, const size_t *inlen, \
+								const void *key, hash64_t *out) \
+	{								\
+		_siphash_x##lanes(in, inlen, key, out);			\
+	}								\
+									\
+	static _attr_noinline _attr_target("avx2") void _siphash_x##lanes##_avx2(const void *const *in, \
+										 const size_t *inlen, \
+										 const void *key, hash64_t *out) \
+	{								\
+		_siphash_x##lanes(in, inlen, key, out);			\
+	}								\
+									\
+	static _attr_noinline _attr_target("avx512f,avx512vl") void _siphash_x##lanes##_avx512(const void *const *in, \
+											       const size_t *inlen, \
+											       const void *key, \
+											       hash64_t *out) \
+	{								\
+		_siphash_x##lanes(in, inlen, key, out);			\
+	}								\
+									\
+	static void _siphash_x##lanes##_resolve(const void *const *in, const size_t *inlen, const void *key, \
+						hash64_t *out);			\
+	static _Atomic(_siphash_multi_func) _siphash_x##lanes##_impl = _siphash_x##lanes##_resolve; \
+									\
+	static void _siphash_x##lanes##_resolve(const void *const *in, const size_t *inlen, const void *key, \
+						hash64_t *out)			\
+	{								\
+		_siphash_multi_func f = _siphash_x##lanes##_default;	\
+		if (cpu_has(CPU_FEATURE_AVX512)) {			\
+			f = _siphash_x##lanes##_avx512;			\
+		} else if (cpu_has(CPU_FEATURE_AVX2)) {			\
+			f = _siphash_x##lanes##_avx2;			\
+		}							\
+		atomic_store_explicit(&_siphash_x##lanes##_impl, f, memory_order_relaxed); \
+		f(in, inlen, key, out);					\
+	}
+
+__SIPHASH_DEFINE_DISPATCH(4)
+__SIPHASH_DEFINE_DISPATCH(8)
+
+# undef __SIPHASH_DEFINE_DISPATCH
+
+__AD_LINKAGE void siphash13_64_x4(const void *const in[4], const size_t inlen[4], const void *key, hash64_t out[4])
+{
+	atomic_load_explicit(&_siphash_x4_impl, memory_order_relaxed)(in, inlen, key, out);
+}
+
+__AD_LINKAGE void siphash13_64_x8(const void *const in[8], const size_t inlen[8], const void *key, hash64_t out[8])
+{
+	atomic_load_explicit(&_siphash_x8_impl, memory_order_relaxed)(in, inlen, key, out);
+}
+#else
+__AD_LINKAGE void siphash13_64_x4(const void *const in[4], const size_t inlen[4], const void *key, hash64_t out[4])
+{
+	_siphash_x4(in, inlen, key, out);
+}
+
+__AD_LINKAGE void siphash13_64_x8(const void *const in[8], const size_t inlen[8], const void *key, hash64_t out[8])
+{
+	_siphash_x8(in, inlen, key, out);
+}
+#endif
+
+__AD_LINKAGE void siphash24_init_64(struct siphash_state *state, const void *key)
+{
+	_siphash_init(state->_v, key, 8);
+	state->_length = 0;
+	state->_outlen = 8;
+}
+
+__AD_LINKAGE void siphash24_init_128(struct siphash_state *state, const void *key)
+{
+	_siphash_init(state->_v, key, 16);
+	state->_length = 0;
+	state->_outlen = 16;
+}
+
+__AD_LINKAGE void siphash24_update(struct siphash_state *state, const void *in, size_t inlen)
+{
+	_siphash_update(state, in, inlen, 2);
+}
+
+__AD_LINKAGE hash64_t siphash24_final_64(struct siphash_state *state)
+{
+	hash64_t out;
+	assert(state->_outlen == sizeof(out));
+	_siphash_final(state->_v, state->_buffer, state->_length, out.bytes, sizeof(out), 2, 4);
+	return out;
+}
+
+__AD_LINKAGE hash128_t siphash24_final_128(struct siphash_state *state)
+{
+	hash128_t out;
+	assert(state->_outlen == sizeof(out));
+	_siphash_final(state->_v, state->_buffer, state->_length, out.bytes, sizeof(out), 2, 4);
+	return out;
+}
+
+__AD_LINKAGE void siphash13_init_64(struct siphash_state *state, const void *key)
+{
+	siphash24_init_64(state, key);
+}
+
+__AD_LINKAGE void siphash13_init_128(struct siphash_state *state, const void *key)
+{
+	siphash24_init_128(state, key);
+}
+
+__AD_LINKAGE void siphash13_update(struct siphash_state *state, const void *in, size_t inlen)
+{
+	_siphash_update(state, in, inlen, 1);
+}
+
+__AD_LINKAGE hash64_t siphash13_final_64(struct siphash_state *state)
+{
+	hash64_t out;
+	assert(state->_outlen == sizeof(out));
+	_siphash_final(state->_v, state->_buffer, state->_length, out.bytes, sizeof(out), 1, 3);
+	return out;
+}
+
+__AD_LINKAGE hash128_t siphash13_final_128(struct siphash_state *state)
+{
+	hash128_t out;
+	assert(state->_outlen == sizeof(out));
+	_siphash_final(state->_v, state->_buffer, state->_length, out.bytes, sizeof(out), 1, 3);
+	return out;
+}
+
 #define __HSIPROUND				\
 	do {					\
 		v0 += v1;			\
@@ -527,16 +819,17 @@ __AD_LINKAGE hash64_t murmurhash3_x86_64(const void *in, size_t inlen, uint32_t
 	return out64;
 }
 
-static _attr_always_inline void _murmurhash3_x64_128(const void *in, size_t len, uint32_t seed, void *out)
-{
-	const uint8_t *data = (const uint8_t *)in;
-	const size_t nblocks = len / 16;
+#define __MURMUR_X64_C1 UINT64_C(0x87c37b91114253d5)
+#define __MURMUR_X64_C2 UINT64_C(0x4cf5ad432745937f)
 
-	uint64_t h1 = seed;
-	uint64_t h2 = seed;
+// process nblocks 16 byte blocks
+static _attr_always_inline void _murmurhash3_x64_blocks(uint64_t *h, const uint8_t *data, size_t nblocks)
+{
+	uint64_t h1 = h[0];
+	uint64_t h2 = h[1];
 
-	const uint64_t c1 = UINT64_C(0x87c37b91114253d5);
-	const uint64_t c2 = UINT64_C(0x4cf5ad432745937f);
+	const uint64_t c1 = __MURMUR_X64_C1;
+	const uint64_t c2 = __MURMUR_X64_C2;
 
 	const uint64_t *blocks = (const uint64_t *)data;
 
@@ -553,7 +846,18 @@ static _attr_always_inline void _murmurhash3_x64_128(const void *in, size_t len,
 		h2 = __HASH_ROTL64(h2, 31); h2 += h1; h2 = h2 * 5 + UINT32_C(0x38495ab5);
 	}
 
-	const uint8_t *tail = (const uint8_t *)(data + nblocks * 16);
+	h[0] = h1;
+	h[1] = h2;
+}
+
+// process the last len % 16 bytes (tail) and produce the output
+static _attr_always_inline void _murmurhash3_x64_final(uint64_t *h, const uint8_t *tail, uint64_t len, void *out)
+{
+	uint64_t h1 = h[0];
+	uint64_t h2 = h[1];
+
+	const uint64_t c1 = __MURMUR_X64_C1;
+	const uint64_t c2 = __MURMUR_X64_C2;
 
 	uint64_t k1 = 0;
 	uint64_t k2 = 0;
@@ -597,6 +901,15 @@ static _attr_always_inline void _murmurhash3_x64_128(const void *in, size_t len,
 	__HASH_U64TO8_LE(o, h2);
 }
 
+static _attr_always_inline void _murmurhash3_x64_128(const void *in, size_t len, uint32_t seed, void *out)
+{
+	const uint8_t *data = (const uint8_t *)in;
+	const size_t nblocks = len / 16;
+	uint64_t h[2] = {seed, seed};
+	_murmurhash3_x64_blocks(h, data, nblocks);
+	_murmurhash3_x64_final(h, data + nblocks * 16, len, out);
+}
+
 __AD_LINKAGE hash128_t murmurhash3_x64_128(const void *in, size_t inlen, uint32_t seed)
 {
 	hash128_t out;
@@ -612,6 +925,402 @@ __AD_LINKAGE hash64_t murmurhash3_x64_64(const void *in, size_t inlen, uint32_t
 	return out64;
 }
 
+__AD_LINKAGE void murmurhash3_x64_init(struct murmurhash3_x64_state *state, uint32_t seed)
+{
+	state->_h[0] = seed;
+	state->_h[1] = seed;
+	state->_length = 0;
+}
+
+__AD_LINKAGE void murmurhash3_x64_update(struct murmurhash3_x64_state *state, const void *in, size_t inlen)
+{
+	const uint8_t *data = (const uint8_t *)in;
+	size_t buffered = state->_length % 16;
+	state->_length += inlen;
+	if (buffered != 0) {
+		size_t n = 16 - buffered < inlen ? 16 - buffered : inlen;
+		memcpy(state->_buffer + buffered, data, n);
+		if (buffered + n < 16) {
+			return;
+		}
+		_murmurhash3_x64_blocks(state->_h, state->_buffer, 1);
+		data += n;
+		inlen -= n;
+	}
+	_murmurhash3_x64_blocks(state->_h, data, inlen / 16);
+	memcpy(state->_buffer, data + inlen - (inlen % 16), inlen % 16);
+}
+
+__AD_LINKAGE hash128_t murmurhash3_x64_final_128(struct murmurhash3_x64_state *state)
+{
+	hash128_t out;
+	_murmurhash3_x64_final(state->_h, state->_buffer, state->_length, out.bytes);
+	return out;
+}
+
+__AD_LINKAGE hash64_t murmurhash3_x64_final_64(struct murmurhash3_x64_state *state)
+{
+	hash128_t out128 = murmurhash3_x64_final_128(state);
+	hash64_t out64;
+	memcpy(out64.bytes, out128.bytes, sizeof(out64));
+	return out64;
+}
+
+// XXH3 (64-bit variant) from xxHash by Yann Collet (BSD 2-Clause License)
+// (see also https://github.com/Cyan4973/xxHash)
+
+#define __XXH_PRIME32_1 UINT32_C(0x9e3779b1)
+#define __XXH_PRIME32_2 UINT32_C(0x85ebca77)
+#define __XXH_PRIME32_3 UINT32_C(0xc2b2ae3d)
+#define __XXH_PRIME64_1 UINT64_C(0x9e3779b185ebca87)
+#define __XXH_PRIME64_2 UINT64_C(0xc2b2ae3d27d4eb4f)
+#define __XXH_PRIME64_3 UINT64_C(0x165667b19e3779f9)
+#define __XXH_PRIME64_4 UINT64_C(0x85ebca77c2b2ae63)
+#define __XXH_PRIME64_5 UINT64_C(0x27d4eb2f165667c5)
+#define __XXH_PRIME_MX1 UINT64_C(0x165667919e3779f9)
+#define __XXH_PRIME_MX2 UINT64_C(0x9fb21c651e98df25)
+
+#define __XXH3_SECRET_SIZE   192
+#define __XXH3_STRIPE_LEN    64
+#define __XXH3_ACC_NB        8
+#define __XXH3_STRIPES_PER_BLOCK ((__XXH3_SECRET_SIZE - __XXH3_STRIPE_LEN) / 8)
+#define __XXH3_BLOCK_LEN     (__XXH3_STRIPE_LEN * __XXH3_STRIPES_PER_BLOCK)
+#define __XXH3_MIDSIZE_MAX   240
+
+static const _Alignas(64) uint8_t _xxh3_secret[__XXH3_SECRET_SIZE] = {
+	0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+	0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+	0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+	0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+	0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+	0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+	0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+	0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+	0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+	0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+	0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+	0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+static _attr_always_inline uint32_t _xxh3_read32(const uint8_t *p)
+{
+	return __HASH_U8TO32_LE(p);
+}
+
+static _attr_always_inline uint64_t _xxh3_read64(const uint8_t *p)
+{
+	return __HASH_U8TO64_LE(p);
+}
+
+static _attr_always_inline uint64_t _xxh3_mul128_fold64(uint64_t a, uint64_t b)
+{
+#ifdef __SIZEOF_INT128__
+	unsigned __int128 product = (unsigned __int128)a * b;
+	return (uint64_t)product ^ (uint64_t)(product >> 64);
+#else
+	uint64_t lo_lo = (a & 0xffffffff) * (b & 0xffffffff);
+	uint64_t hi_lo = (a >> 32) * (b & 0xffffffff);
+	uint64_t lo_hi = (a & 0xffffffff) * (b >> 32);
+	uint64_t hi_hi = (a >> 32) * (b >> 32);
+	uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffffffff) + lo_hi;
+	uint64_t upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+	uint64_t lower = (cross << 32) | (lo_lo & 0xffffffff);
+	return lower ^ upper;
+#endif
+}
+
+static _attr_always_inline uint64_t _xxh3_xxh64_avalanche(uint64_t h)
+{
+	h ^= h >> 33;
+	h *= __XXH_PRIME64_2;
+	h ^= h >> 29;
+	h *= __XXH_PRIME64_3;
+	h ^= h >> 32;
+	return h;
+}
+
+static _attr_always_inline uint64_t _xxh3_avalanche(uint64_t h)
+{
+	h ^= h >> 37;
+	h *= __XXH_PRIME_MX1;
+	h ^= h >> 32;
+	return h;
+}
+
+static _attr_always_inline uint64_t _xxh3_rrmxmx(uint64_t h, uint64_t len)
+{
+	h ^= __HASH_ROTL64(h, 49) ^ __HASH_ROTL64(h, 24);
+	h *= __XXH_PRIME_MX2;
+	h ^= (h >> 35) + len;
+	h *= __XXH_PRIME_MX2;
+	h ^= h >> 28;
+	return h;
+}
+
+static _attr_always_inline uint64_t _xxh3_mix16(const uint8_t *in, const uint8_t *secret, uint64_t seed)
+{
+	uint64_t lo = _xxh3_read64(in);
+	uint64_t hi = _xxh3_read64(in + 8);
+	return _xxh3_mul128_fold64(lo ^ (_xxh3_read64(secret) + seed), hi ^ (_xxh3_read64(secret + 8) - seed));
+}
+
+// the short input paths (up to 16 bytes) handle typical hashtable keys without any loops
+static _attr_always_inline uint64_t _xxh3_0to16(const uint8_t *in, size_t len, uint64_t seed)
+{
+	const uint8_t *secret = _xxh3_secret;
+	if (len > 8) {
+		uint64_t bitflip1 = (_xxh3_read64(secret + 24) ^ _xxh3_read64(secret + 32)) + seed;
+		uint64_t bitflip2 = (_xxh3_read64(secret + 40) ^ _xxh3_read64(secret + 48)) - seed;
+		uint64_t lo = _xxh3_read64(in) ^ bitflip1;
+		uint64_t hi = _xxh3_read64(in + len - 8) ^ bitflip2;
+		uint64_t acc = len + _bswap64(lo) + hi + _xxh3_mul128_fold64(lo, hi);
+		return _xxh3_avalanche(acc);
+	}
+	if (len >= 4) {
+		seed ^= (uint64_t)_bswap32((uint32_t)seed) << 32;
+		uint32_t in1 = _xxh3_read32(in);
+		uint32_t in2 = _xxh3_read32(in + len - 4);
+		uint64_t bitflip = (_xxh3_read64(secret + 8) ^ _xxh3_read64(secret + 16)) - seed;
+		uint64_t keyed = (in2 + ((uint64_t)in1 << 32)) ^ bitflip;
+		return _xxh3_rrmxmx(keyed, len);
+	}
+	if (len > 0) {
+		uint32_t combined = ((uint32_t)in[0] << 16) | ((uint32_t)in[len >> 1] << 24) |
+			(uint32_t)in[len - 1] | ((uint32_t)len << 8);
+		uint64_t bitflip = (_xxh3_read32(secret) ^ _xxh3_read32(secret + 4)) + seed;
+		return _xxh3_xxh64_avalanche((uint64_t)combined ^ bitflip);
+	}
+	return _xxh3_xxh64_avalanche(seed ^ _xxh3_read64(secret + 56) ^ _xxh3_read64(secret + 64));
+}
+
+static _attr_always_inline uint64_t _xxh3_17to128(const uint8_t *in, size_t len, uint64_t seed)
+{
+	const uint8_t *secret = _xxh3_secret;
+	uint64_t acc = len * __XXH_PRIME64_1;
+	if (len > 32) {
+		if (len > 64) {
+			if (len > 96) {
+				acc += _xxh3_mix16(in + 48, secret + 96, seed);
+				acc += _xxh3_mix16(in + len - 64, secret + 112, seed);
+			}
+			acc += _xxh3_mix16(in + 32, secret + 64, seed);
+			acc += _xxh3_mix16(in + len - 48, secret + 80, seed);
+		}
+		acc += _xxh3_mix16(in + 16, secret + 32, seed);
+		acc += _xxh3_mix16(in + len - 32, secret + 48, seed);
+	}
+	acc += _xxh3_mix16(in, secret, seed);
+	acc += _xxh3_mix16(in + len - 16, secret + 16, seed);
+	return _xxh3_avalanche(acc);
+}
+
+static _attr_noinline uint64_t _xxh3_129to240(const uint8_t *in, size_t len, uint64_t seed)
+{
+	const uint8_t *secret = _xxh3_secret;
+	uint64_t acc = len * __XXH_PRIME64_1;
+	size_t rounds = len / 16;
+	for (size_t i = 0; i < 8; i++) {
+		acc += _xxh3_mix16(in + 16 * i, secret + 16 * i, seed);
+	}
+	acc = _xxh3_avalanche(acc);
+	for (size_t i = 8; i < rounds; i++) {
+		acc += _xxh3_mix16(in + 16 * i, secret + 16 * (i - 8) + 3, seed);
+	}
+	acc += _xxh3_mix16(in + len - 16, secret + 136 - 17, seed);
+	return _xxh3_avalanche(acc);
+}
+
+// process one 64 byte stripe (acc[i ^ 1] += data[i], acc[i] += lo32(data[i] ^ key[i]) * hi32(data[i] ^ key[i]))
+static _attr_always_inline void _xxh3_accumulate_512_scalar(uint64_t *restrict acc, const uint8_t *restrict in,
+							    const uint8_t *restrict secret)
+{
+	for (size_t i = 0; i < __XXH3_ACC_NB; i++) {
+		uint64_t data = _xxh3_read64(in + 8 * i);
+		uint64_t data_key = data ^ _xxh3_read64(secret + 8 * i);
+		acc[i ^ 1] += data;
+		acc[i] += (data_key & 0xffffffff) * (data_key >> 32);
+	}
+}
+
+static _attr_always_inline void _xxh3_scramble_scalar(uint64_t *restrict acc, const uint8_t *restrict secret)
+{
+	for (size_t i = 0; i < __XXH3_ACC_NB; i++) {
+		uint64_t a = acc[i];
+		a ^= a >> 47;
+		a ^= _xxh3_read64(secret + 8 * i);
+		acc[i] = a * __XXH_PRIME32_1;
+	}
+}
+
+#if defined(HAVE_CPU_DISPATCH) || defined(__SSE2__)
+static _attr_always_inline _attr_target("sse2") void _xxh3_accumulate_512_sse2(uint64_t *restrict acc,
+									      const uint8_t *restrict in,
+									      const uint8_t *restrict secret)
+{
+	for (size_t i = 0; i < 4; i++) {
+		__m128i data = _mm_loadu_si128((const __m128i *)in + i);
+		__m128i key = _mm_loadu_si128((const __m128i *)secret + i);
+		__m128i data_key = _mm_xor_si128(data, key);
+		__m128i data_key_hi = _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+		__m128i product = _mm_mul_epu32(data_key, data_key_hi);
+		__m128i data_swap = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+		__m128i a = _mm_load_si128((const __m128i *)acc + i);
+		a = _mm_add_epi64(_mm_add_epi64(a, data_swap), product);
+		_mm_store_si128((__m128i *)acc + i, a);
+	}
+}
+
+static _attr_always_inline _attr_target("sse2") void _xxh3_scramble_sse2(uint64_t *restrict acc,
+									const uint8_t *restrict secret)
+{
+	const __m128i prime = _mm_set1_epi32((int)__XXH_PRIME32_1);
+	for (size_t i = 0; i < 4; i++) {
+		__m128i a = _mm_load_si128((const __m128i *)acc + i);
+		a = _mm_xor_si128(a, _mm_srli_epi64(a, 47));
+		a = _mm_xor_si128(a, _mm_loadu_si128((const __m128i *)secret + i));
+		__m128i hi = _mm_shuffle_epi32(a, _MM_SHUFFLE(0, 3, 0, 1));
+		__m128i product_lo = _mm_mul_epu32(a, prime);
+		__m128i product_hi = _mm_mul_epu32(hi, prime);
+		a = _mm_add_epi64(product_lo, _mm_slli_epi64(product_hi, 32));
+		_mm_store_si128((__m128i *)acc + i, a);
+	}
+}
+#endif
+
+#if defined(HAVE_CPU_DISPATCH) || defined(__AVX2__)
+static _attr_always_inline _attr_target("avx2") void _xxh3_accumulate_512_avx2(uint64_t *restrict acc,
+									      const uint8_t *restrict in,
+									      const uint8_t *restrict secret)
+{
+	for (size_t i = 0; i < 2; i++) {
+		__m256i data = _mm256_loadu_si256((const __m256i *)in + i);
+		__m256i key = _mm256_loadu_si256((const __m256i *)secret + i);
+		__m256i data_key = _mm256_xor_si256(data, key);
+		__m256i data_key_hi = _mm256_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1));
+		__m256i product = _mm256_mul_epu32(data_key, data_key_hi);
+		__m256i data_swap = _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+		__m256i a = _mm256_load_si256((const __m256i *)acc + i);
+		a = _mm256_add_epi64(_mm256_add_epi64(a, data_swap), product);
+		_mm256_store_si256((__m256i *)acc + i, a);
+	}
+}
+
+static _attr_always_inline _attr_target("avx2") void _xxh3_scramble_avx2(uint64_t *restrict acc,
+									const uint8_t *restrict secret)
+{
+	const __m256i prime = _mm256_set1_epi32((int)__XXH_PRIME32_1);
+	for (size_t i = 0; i < 2; i++) {
+		__m256i a = _mm256_load_si256((const __m256i *)acc + i);
+		a = _mm256_xor_si256(a, _mm256_srli_epi64(a, 47));
+		a = _mm256_xor_si256(a, _mm256_loadu_si256((const __m256i *)secret + i));
+		__m256i hi = _mm256_shuffle_epi32(a, _MM_SHUFFLE(0, 3, 0, 1));
+		__m256i product_lo = _mm256_mul_epu32(a, prime);
+		__m256i product_hi = _mm256_mul_epu32(hi, prime);
+		a = _mm256_add_epi64(product_lo, _mm256_slli_epi64(product_hi, 32));
+		_mm256_store_si256((__m256i *)acc + i, a);
+	}
+}
+#endif
+
+#define __XXH3_DEFINE_LONG(isa, ...)					\
+	static __VA_ARGS__ _attr_noinline uint64_t _xxh3_long_##isa(const uint8_t *in, size_t len, uint64_t seed) \
+	{								\
+		_Alignas(64) uint8_t custom_secret[__XXH3_SECRET_SIZE];	\
+		const uint8_t *secret = _xxh3_secret;			\
+		if (seed != 0) {					\
+			for (size_t i = 0; i < __XXH3_SECRET_SIZE; i += 16) { \
+				uint64_t lo = _xxh3_read64(_xxh3_secret + i) + seed; \
+				uint64_t hi = _xxh3_read64(_xxh3_secret + i + 8) - seed; \
+				__HASH_U64TO8_LE(custom_secret + i, lo); \
+				__HASH_U64TO8_LE(custom_secret + i + 8, hi); \
+			}						\
+			secret = custom_secret;				\
+		}							\
+									\
+		_Alignas(32) uint64_t acc[__XXH3_ACC_NB] = {		\
+			__XXH_PRIME32_3, __XXH_PRIME64_1, __XXH_PRIME64_2, __XXH_PRIME64_3, \
+			__XXH_PRIME64_4, __XXH_PRIME32_2, __XXH_PRIME64_5, __XXH_PRIME32_1, \
+		};							\
+		size_t num_blocks = (len - 1) / __XXH3_BLOCK_LEN;	\
+		for (size_t n = 0; n < num_blocks; n++) {		\
+			const uint8_t *block = in + n * __XXH3_BLOCK_LEN; \
+			for (size_t s = 0; s < __XXH3_STRIPES_PER_BLOCK; s++) { \
+				_xxh3_accumulate_512_##isa(acc, block + s * __XXH3_STRIPE_LEN, secret + s * 8); \
+			}						\
+			_xxh3_scramble_##isa(acc, secret + __XXH3_SECRET_SIZE - __XXH3_STRIPE_LEN); \
+		}							\
+		const uint8_t *block = in + num_blocks * __XXH3_BLOCK_LEN; \
+		size_t num_stripes = ((len - 1) - num_blocks * __XXH3_BLOCK_LEN) / __XXH3_STRIPE_LEN; \
+		for (size_t s = 0; s < num_stripes; s++) {		\
+			_xxh3_accumulate_512_##isa(acc, block + s * __XXH3_STRIPE_LEN, secret + s * 8); \
+		}							\
+		/* the last stripe overlaps with the previous one (unless len is a multiple of 64) */ \
+		_xxh3_accumulate_512_##isa(acc, in + len - __XXH3_STRIPE_LEN, \
+					   secret + __XXH3_SECRET_SIZE - __XXH3_STRIPE_LEN - 7); \
+									\
+		uint64_t result = len * __XXH_PRIME64_1;		\
+		for (size_t i = 0; i < 4; i++) {			\
+			result += _xxh3_mul128_fold64(acc[2 * i] ^ _xxh3_read64(secret + 11 + 16 * i), \
+						      acc[2 * i + 1] ^ _xxh3_read64(secret + 11 + 16 * i + 8)); \
+		}							\
+		return _xxh3_avalanche(result);				\
+	}
+
+__XXH3_DEFINE_LONG(scalar)
+#if defined(HAVE_CPU_DISPATCH) || defined(__SSE2__)
+__XXH3_DEFINE_LONG(sse2, _attr_target("sse2"))
+#endif
+#if defined(HAVE_CPU_DISPATCH) || defined(__AVX2__)
+__XXH3_DEFINE_LONG(avx2, _attr_target("avx2"))
+#endif
+
+#undef __XXH3_DEFINE_LONG
+
+#if defined(HAVE_CPU_DISPATCH)
+typedef uint64_t (*_xxh3_long_func)(const uint8_t *in, size_t len, uint64_t seed);
+
+static uint64_t _xxh3_long_resolve(const uint8_t *in, size_t len, uint64_t seed);
+static _Atomic(_xxh3_long_func) _xxh3_long_impl = _xxh3_long_resolve;
+
+static uint64_t _xxh3_long_resolve(const uint8_t *in, size_t len, uint64_t seed)
+{
+	_xxh3_long_func f = _xxh3_long_scalar;
+	if (cpu_has(CPU_FEATURE_AVX2)) {
+		f = _xxh3_long_avx2;
+	} else if (cpu_has(CPU_FEATURE_SSE2)) {
+		f = _xxh3_long_sse2;
+	}
+	atomic_store_explicit(&_xxh3_long_impl, f, memory_order_relaxed);
+	return f(in, len, seed);
+}
+
+# define _xxh3_long(in, len, seed) atomic_load_explicit(&_xxh3_long_impl, memory_order_relaxed)(in, len, seed)
+#elif defined(__AVX2__)
+# define _xxh3_long _xxh3_long_avx2
+#elif defined(__SSE2__)
+# define _xxh3_long _xxh3_long_sse2
+#else
+# define _xxh3_long _xxh3_long_scalar
+#endif
+
+__AD_LINKAGE hash64_t xxh3_64(const void *in, size_t inlen, uint64_t seed)
+{
+	const uint8_t *p = in;
+	uint64_t h;
+	if (inlen <= 16) {
+		h = _xxh3_0to16(p, inlen, seed);
+	} else if (inlen <= 128) {
+		h = _xxh3_17to128(p, inlen, seed);
+	} else if (inlen <= __XXH3_MIDSIZE_MAX) {
+		h = _xxh3_129to240(p, inlen, seed);
+	} else {
+		h = _xxh3_long(p, inlen, seed);
+	}
+	hash64_t out;
+	__HASH_U64TO8_LE(out.bytes, h);
+	return out;
+}
+
 __AD_LINKAGE hash32_t hash_int32(uint32_t val)
 {
 	hash32_t out;
@@ -662,6 +1371,183 @@ __AD_LINKAGE hash64_t hash_combine_int64(uint64_t seed, uint64_t val)
 	// return murmurhash3_x64_64(&buffer, sizeof(buffer), 0);
 }
 
+__AD_LINKAGE uint32_t jump_consistent_hash(uint64_t key, uint32_t num_buckets)
+{
+	// https://arxiv.org/abs/1406.2294
+	int64_t b = -1;
+	int64_t j = 0;
+	while (j < num_buckets) {
+		b = j;
+		key = key * UINT64_C(2862933555777941757) + 1;
+		j = (int64_t)((b + 1) * ((double)(INT64_C(1) << 31) / (double)((key >> 33) + 1)));
+	}
+	return (uint32_t)b;
+}
+
+#define __JUMP_LANES 4
+
+__AD_LINKAGE void jump_consistent_hash_batch(const uint64_t *keys, size_t count, uint32_t num_buckets,
+					     uint32_t *out)
+{
+	size_t batched = count - count % __JUMP_LANES;
+	for (size_t i = 0; i < batched; i += __JUMP_LANES) {
+		uint64_t k[__JUMP_LANES];
+		int64_t b[__JUMP_LANES];
+		int64_t j[__JUMP_LANES];
+		for (size_t l = 0; l < __JUMP_LANES; l++) {
+			k[l] = keys[i + l];
+			b[l] = -1;
+			j[l] = 0;
+		}
+		// the lanes step together (lanes that are done keep their values), so the divisions overlap
+		bool active;
+		do {
+			active = false;
+			for (size_t l = 0; l < __JUMP_LANES; l++) {
+				bool live = j[l] < num_buckets;
+				uint64_t next_k = k[l] * UINT64_C(2862933555777941757) + 1;
+				int64_t next_j = (int64_t)((j[l] + 1) * ((double)(INT64_C(1) << 31) /
+									 (double)((next_k >> 33) + 1)));
+				b[l] = live ? j[l] : b[l];
+				k[l] = live ? next_k : k[l];
+				j[l] = live ? next_j : j[l];
+				active |= live;
+			}
+		} while (active);
+		for (size_t l = 0; l < __JUMP_LANES; l++) {
+			out[i + l] = (uint32_t)b[l];
+		}
+	}
+	for (size_t i = batched; i < count; i++) {
+		out[i] = jump_consistent_hash(keys[i], num_buckets);
+	}
+}
+
+#undef __JUMP_LANES
+
+struct _multiprobe_point {
+	uint64_t point;
+	uint32_t shard;
+};
+
+static int _multiprobe_compare_points(const void *_a, const void *_b)
+{
+	const struct _multiprobe_point *a = _a;
+	const struct _multiprobe_point *b = _b;
+	if (a->point != b->point) {
+		return a->point < b->point ? -1 : 1;
+	}
+	return a->shard < b->shard ? -1 : (a->shard > b->shard);
+}
+
+__AD_LINKAGE void multiprobe_ring_init(struct multiprobe_ring *ring, const uint64_t *shard_ids, size_t num_shards,
+				       unsigned int probes)
+{
+	assert(num_shards > 0 && num_shards <= UINT32_MAX && probes > 0);
+	struct _multiprobe_point *points = malloc(num_shards * sizeof(points[0]));
+	ring->_points = malloc(num_shards * sizeof(ring->_points[0]));
+	ring->_shards = malloc(num_shards * sizeof(ring->_shards[0]));
+	if (unlikely(!points || !ring->_points || !ring->_shards)) {
+		abort();
+	}
+	for (size_t i = 0; i < num_shards; i++) {
+		points[i].point = hash_int64(shard_ids[i]).u64;
+		points[i].shard = (uint32_t)i;
+	}
+	qsort(points, num_shards, sizeof(points[0]), _multiprobe_compare_points);
+	for (size_t i = 0; i < num_shards; i++) {
+		ring->_points[i] = points[i].point;
+		ring->_shards[i] = points[i].shard;
+	}
+	free(points);
+	ring->_num_shards = (uint32_t)num_shards;
+	ring->_probes = probes;
+}
+
+__AD_LINKAGE void multiprobe_ring_destroy(struct multiprobe_ring *ring)
+{
+	free(ring->_points);
+	free(ring->_shards);
+	ring->_points = NULL;
+	ring->_shards = NULL;
+	ring->_num_shards = 0;
+}
+
+__AD_LINKAGE uint32_t multiprobe_ring_lookup(const struct multiprobe_ring *ring, uint64_t key)
+{
+	const uint64_t *points = ring->_points;
+	uint64_t best_distance = UINT64_MAX;
+	size_t best = 0;
+	// the probe positions are generated by double hashing (as in https://github.com/dgryski/go-mpchash)
+	uint64_t position = hash_int64(key).u64;
+	uint64_t step = hash_combine_int64(key, 1).u64 | 1;
+	for (unsigned int p = 0; p < ring->_probes; p++, position += step) {
+		// branchless lower bound (the first point >= position, wrapping around to the first point)
+		const uint64_t *base = points;
+		size_t n = ring->_num_shards;
+		while (n > 1) {
+			size_t half = n / 2;
+			base = base[half] < position ? base + half : base;
+			n -= half;
+		}
+		size_t index = (size_t)(base - points) + (*base < position);
+		index = index == ring->_num_shards ? 0 : index;
+		uint64_t distance = points[index] - position;
+		// (branchless, the probes are independent and can overlap)
+		bool better = distance < best_distance;
+		best = better ? index : best;
+		best_distance = better ? distance : best_distance;
+	}
+	return ring->_shards[best];
+}
+
+__AD_LINKAGE void multiprobe_ring_lookup_batch(const struct multiprobe_ring *ring, const uint64_t *keys,
+					       size_t count, uint32_t *out)
+{
+	for (size_t i = 0; i < count; i++) {
+		out[i] = multiprobe_ring_lookup(ring, keys[i]);
+	}
+}
+
+__AD_LINKAGE uint32_t rendezvous_hash(uint64_t key, const uint64_t *shard_ids, const double *weights,
+				      size_t num_shards)
+{
+	assert(num_shards > 0);
+	size_t best = 0;
+	if (!weights) {
+		uint64_t best_score = 0;
+		for (size_t i = 0; i < num_shards; i++) {
+			uint64_t score = hash_combine_int64(shard_ids[i], key).u64;
+			if (score > best_score || i == 0) {
+				best_score = score;
+				best = i;
+			}
+		}
+		return (uint32_t)best;
+	}
+	double best_score = -1;
+	for (size_t i = 0; i < num_shards; i++) {
+		uint64_t h = hash_combine_int64(shard_ids[i], key).u64;
+		// u is uniform in (0, 1), so -ln(u) is exponentially distributed and the shard with the
+		// highest weight / -ln(u) wins with probability weight / sum(weights)
+		double u = ((double)(h >> 11) + 0.5) * 0x1.0p-53;
+		double score = weights[i] / -log(u);
+		if (score > best_score) {
+			best_score = score;
+			best = i;
+		}
+	}
+	return (uint32_t)best;
+}
+
+__AD_LINKAGE void rendezvous_hash_batch(const uint64_t *keys, size_t count, const uint64_t *shard_ids,
+					const double *weights, size_t num_shards, uint32_t *out)
+{
+	for (size_t i = 0; i < count; i++) {
+		out[i] = rendezvous_hash(keys[i], shard_ids, weights, num_shards);
+	}
+}
+
 #undef __HASH_ROTL32
 #undef __HASH_ROTL64
 #undef __HASH_U32TO8_LE
@@ -669,4 +1555,22 @@ __AD_LINKAGE hash64_t hash_combine_int64(uint64_t seed, uint64_t val)
 #undef __HASH_U8TO32_LE
 #undef __HASH_U8TO64_LE
 #undef __SIPROUND
+#undef __MURMUR_X64_C1
+#undef __MURMUR_X64_C2
 #undef __HSIPROUND
+#undef __XXH_PRIME32_1
+#undef __XXH_PRIME32_2
+#undef __XXH_PRIME32_3
+#undef __XXH_PRIME64_1
+#undef __XXH_PRIME64_2
+#undef __XXH_PRIME64_3
+#undef __XXH_PRIME64_4
+#undef __XXH_PRIME64_5
+#undef __XXH_PRIME_MX1
+#undef __XXH_PRIME_MX2
+#undef __XXH3_SECRET_SIZE
+#undef __XXH3_STRIPE_LEN
+#undef __XXH3_ACC_NB
+#undef __XXH3_STRIPES_PER_BLOCK
+#undef __XXH3_BLOCK_LEN
+#undef __XXH3_MIDSIZE_MAX
@@ -23,12 +23,11 @@
 #include <string.h>
 #include "hashtable.h"
 #include "macros.h"
+#include "utils.h"
 
 // TODO ordered hashtable implementation (insertion order) (see python dict) (how to share code?)
 // TODO add generation and check it during iteration?
 // TODO make it possible to choose the implementation for each instance? (probably too slow or messy...)
-// TODO make _hashtable_lookup return the first eligable slot for insertion to speed up subsequent insertion
-//      and make hashtable_set (lookup + insert) helper
 
 /* Memory layout:
  * For in-place resizing the memory layout needs to look like this (e=entry, m=metadata):
@@ -451,6 +450,58 @@ __AD_LINKAGE _hashtable_idx_t _hashtable_insert(struct _hashtable *table, _hasht
 	return _hashtable_do_insert(table, hash, info);
 }
 
+__AD_LINKAGE bool _hashtable_lookup_or_insert(struct _hashtable *table, void *key, _hashtable_hash_t hash,
+					      _hashtable_idx_t *ret_index, const struct _hashtable_info *info)
+{
+	hash = _hashtable_sanitize_hash(hash);
+	// remember the first slot that _hashtable_do_insert would pick so we don't have to probe again
+	_hashtable_metadata_t *slot = NULL;
+	_hashtable_idx_t slot_index = 0;
+	for (struct _hashtable_probe_iter iter = _hashtable_probe_iter_start(table, hash);;
+	     _hashtable_probe_iter_advance(&iter)) {
+		_hashtable_idx_t index = iter.index;
+		_hashtable_metadata_t *m = _hashtable_metadata(table, index, info);
+		if (m->hash < __HASHTABLE_MIN_VALID_HASH) {
+			if (!slot) {
+				slot = m;
+				slot_index = index;
+			}
+			if (m->hash == __HASHTABLE_EMPTY_HASH) {
+				break;
+			}
+			continue;
+		}
+		if (hash == m->hash && info->keys_match(key, _hashtable_entry(table, index, info))) {
+			*ret_index = index;
+			return true;
+		}
+	}
+
+	table->num_entries++;
+	if (slot->hash == __HASHTABLE_TOMBSTONE_HASH) {
+		table->num_tombstones--;
+	} else if ((table->num_entries + table->num_tombstones) > table->max_entries) {
+		_hashtable_grow(table, 2 * table->capacity, info);
+		*ret_index = _hashtable_do_insert(table, hash, info);
+		return false;
+	}
+	slot->hash = hash;
+	*ret_index = slot_index;
+	return false;
+}
+
+__AD_LINKAGE _hashtable_uint_t _hashtable_probe_length(struct _hashtable *table, _hashtable_idx_t index,
+						       const struct _hashtable_info *info)
+{
+	_hashtable_hash_t hash = _hashtable_metadata(table, index, info)->hash;
+	_hashtable_uint_t length = 1;
+	for (struct _hashtable_probe_iter iter = _hashtable_probe_iter_start(table, hash);
+	     iter.index != index; _hashtable_probe_iter_advance(&iter)) {
+		length++;
+	}
+	return length;
+}
+
 __AD_LINKAGE void _hashtable_remove(struct _hashtable *table, _hashtable_idx_t index,
 				    const struct _hashtable_info *info)
 {
@@ -584,7 +635,18 @@ __AD_LINKAGE bool _hashtable_lookup(struct _hashtable *table, void *key, _hashta
 	return false;
 }
 
-__AD_LINKAGE _hashtable_idx_t _hashtable_get_next(struct _hashtable *table, size_t start,
+__AD_LINKAGE _hashtable_uint_t _hashtable_probe_length(struct _hashtable *table, _hashtable_idx_t index,
+						       const struct _hashtable_info *info)
+{
+	// a lookup only inspects the slots that are marked in the neighborhood bitmap of the home slot
+	_hashtable_idx_t home = _hashtable_hash_to_index(table, _hashtable_metadata(table, index, info)->hash);
+	_hashtable_bitmap_t bitmap = _hashtable_metadata(table, home, info)->bitmap;
+	_hashtable_uint_t distance = _hashtable_wrap_index(index - home, table->capacity);
+	_hashtable_bitmap_t mask = ((_hashtable_bitmap_t)2 << distance) - 1;
+	return popcount(bitmap & mask);
+}
+
+__AD_LINKAGE _hashtable_idx_t _hashtable_get_next(struct _hashtable *table, _hashtable_idx_t start,
 						  const struct _hashtable_info *info)
 {
 	for (_hashtable_idx_t index = start; index < table->capacity; index++) {
@@ -1040,7 +1102,13 @@ __AD_LINKAGE bool _hashtable_lookup(struct _hashtable *table, void *key, _hashta
 	return false;
 }
 
-__AD_LINKAGE _hashtable_idx_t _hashtable_get_next(struct _hashtable *table, size_t start,
+__AD_LINKAGE _hashtable_uint_t _hashtable_probe_length(struct _hashtable *table, _hashtable_idx_t index,
+						       const struct _hashtable_info *info)
+{
+	return _hashtable_get_distance(table, index, info) + 1;
+}
+
+__AD_LINKAGE _hashtable_idx_t _hashtable_get_next(struct _hashtable *table, _hashtable_idx_t start,
 						  const struct _hashtable_info *info)
 {
 	for (_hashtable_idx_t index = start; index < table->capacity; index++) {
@@ -1323,3 +1391,29 @@ __AD_LINKAGE void _hashtable_clear(struct _hashtable *table, const struct _hasht
 #else
 # error "No hashtable implementation selected"
 #endif
+
+#if !defined(HASHTABLE_QUADRATIC)
+__AD_LINKAGE bool _hashtable_lookup_or_insert(struct _hashtable *table, void *key, _hashtable_hash_t hash,
+					      _hashtable_idx_t *ret_index, const struct _hashtable_info *info)
+{
+	// insertion may displace other entries, so there is no slot we could remember during the lookup
+	if (_hashtable_lookup(table, key, hash, ret_index, info)) {
+		return true;
+	}
+	*ret_index = _hashtable_insert(table, hash, info);
+	return false;
+}
+#endif
+
+__AD_LINKAGE size_t _hashtable_memory_usage(const struct _hashtable *table, const struct _hashtable_info *info)
+{
+	return (size_t)table->capacity * (info->entry_size + sizeof(_hashtable_metadata_t));
+}
+
+__AD_LINKAGE void _hashtable_prefetch(struct _hashtable *table, _hashtable_hash_t hash,
+				      const struct _hashtable_info *info)
+{
+	_hashtable_idx_t index = _hashtable_hash_to_index(table, _hashtable_sanitize_hash(hash));
+	prefetch(_hashtable_metadata(table, index, info));
+	prefetch(_hashtable_entry(table, index, info));
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+#include <time.h>
+#include "hash.h"
+#include "hashtable_trace.h"
+
+static const char _hashtable_trace_magic[8] = "ADHTRACE";
+
+static uint64_t _hashtable_trace_now(void)
+{
+	struct timespec ts;
+#ifdef CLOCK_MONOTONIC
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+	timespec_get(&ts, TIME_UTC);
+#endif
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static size_t _hashtable_trace_put_u32(unsigned char *p, uint32_t x)
+{
+	for (size_t i = 0; i < 4; i++) {
+		p[i] = (unsigned char)(x >> (8 * i));
+	}
+	return 4;
+}
+
+static size_t _hashtable_trace_put_u64(unsigned char *p, uint64_t x)
+{
+	for (size_t i = 0; i < 8; i++) {
+		p[i] = (unsigned char)(x >> (8 * i));
+	}
+	return 8;
+}
+
+static size_t _hashtable_trace_put_varint(unsigned char *p, uint64_t x)
+{
+	size_t n = 0;
+	while (x >= 0x80) {
+		p[n++] = (unsigned char)(x | 0x80);
+		x >>= 7;
+	}
+	p[n++] = (unsigned char)x;
+	return n;
+}
+
+static bool _hashtable_trace_get_bytes(struct hashtable_trace_reader *reader, unsigned char *p, size_t n)
+{
+	if (fread(p, 1, n, reader->_file) != n) {
+		reader->_error = true;
+		return false;
+	}
+	return true;
+}
+
+static uint64_t _hashtable_trace_load_le(const unsigned char *p, size_t n)
+{
+	uint64_t x = 0;
+	for (size_t i = 0; i < n; i++) {
+		x |= (uint64_t)p[i] << (8 * i);
+	}
+	return x;
+}
+
+__AD_LINKAGE uint64_t hashtable_trace_fingerprint(const void *key, size_t key_size)
+{
+	return murmurhash3_x64_64(key, key_size, 0).u64;
+}
+
+__AD_LINKAGE bool hashtable_trace_writer_init(struct hashtable_trace_writer *writer, FILE *file,
+					      size_t key_size, size_t entry_size,
+					      hashtable_trace_fingerprint_t fingerprint)
+{
+	writer->_file = file;
+	writer->_fingerprint = fingerprint ? fingerprint : hashtable_trace_fingerprint;
+	writer->_start_time = _hashtable_trace_now();
+	writer->_last_timestamp = 0;
+	writer->_error = false;
+
+	unsigned char header[sizeof(_hashtable_trace_magic) + 3 * 4];
+	size_t n = sizeof(_hashtable_trace_magic);
+	memcpy(header, _hashtable_trace_magic, n);
+	n += _hashtable_trace_put_u32(header + n, HASHTABLE_TRACE_VERSION);
+	n += _hashtable_trace_put_u32(header + n, (uint32_t)key_size);
+	n += _hashtable_trace_put_u32(header + n, (uint32_t)entry_size);
+	if (fwrite(header, 1, n, file) != n) {
+		writer->_error = true;
+	}
+	return !writer->_error;
+}
+
+__AD_LINKAGE void hashtable_trace_write_record(struct hashtable_trace_writer *writer,
+					       const struct hashtable_trace_record *record)
+{
+	unsigned char buf[1 + 10 + 8 + 4];
+	size_t n = 0;
+	uint64_t delta = 0;
+	if (record->timestamp > writer->_last_timestamp) {
+		delta = record->timestamp - writer->_last_timestamp;
+		writer->_last_timestamp = record->timestamp;
+	}
+	buf[n++] = (unsigned char)record->op;
+	n += _hashtable_trace_put_varint(buf + n, delta);
+	n += _hashtable_trace_put_u64(buf + n, record->fingerprint);
+	n += _hashtable_trace_put_u32(buf + n, record->hash);
+	if (fwrite(buf, 1, n, writer->_file) != n) {
+		writer->_error = true;
+	}
+}
+
+__AD_LINKAGE void hashtable_trace_write(struct hashtable_trace_writer *writer, enum hashtable_trace_op op,
+					const void *key, size_t key_size, uint32_t hash)
+{
+	struct hashtable_trace_record record = {
+		.timestamp = _hashtable_trace_now() - writer->_start_time,
+		.fingerprint = key ? writer->_fingerprint(key, key_size) : 0,
+		.hash = hash,
+		.op = op,
+	};
+	hashtable_trace_write_record(writer, &record);
+}
+
+__AD_LINKAGE bool hashtable_trace_writer_finish(struct hashtable_trace_writer *writer)
+{
+	if (fflush(writer->_file) != 0) {
+		writer->_error = true;
+	}
+	return !writer->_error;
+}
+
+__AD_LINKAGE bool hashtable_trace_reader_init(struct hashtable_trace_reader *reader, FILE *file)
+{
+	reader->_file = file;
+	reader->_last_timestamp = 0;
+	reader->_error = false;
+
+	unsigned char header[sizeof(_hashtable_trace_magic) + 3 * 4];
+	if (!_hashtable_trace_get_bytes(reader, header, sizeof(header))) {
+		return false;
+	}
+	const unsigned char *p = header + sizeof(_hashtable_trace_magic);
+	if (memcmp(header, _hashtable_trace_magic, sizeof(_hashtable_trace_magic)) != 0 ||
+	    _hashtable_trace_load_le(p, 4) != HASHTABLE_TRACE_VERSION) {
+		reader->_error = true;
+		return false;
+	}
+	reader->_key_size = (uint32_t)_hashtable_trace_load_le(p + 4, 4);
+	reader->_entry_size = (uint32_t)_hashtable_trace_load_le(p + 8, 4);
+	return true;
+}
+
+__AD_LINKAGE size_t hashtable_trace_key_size(const struct hashtable_trace_reader *reader)
+{
+	return reader->_key_size;
+}
+
+__AD_LINKAGE size_t hashtable_trace_entry_size(const struct hashtable_trace_reader *reader)
+{
+	return reader->_entry_size;
+}
+
+__AD_LINKAGE bool hashtable_trace_read(struct hashtable_trace_reader *reader, struct hashtable_trace_record *record)
+{
+	int op = getc(reader->_file);
+	if (op == EOF) {
+		return false;
+	}
+	if (op >= HASHTABLE_TRACE_NUM_OPS) {
+		reader->_error = true;
+		return false;
+	}
+
+	uint64_t delta = 0;
+	for (unsigned int shift = 0;; shift += 7) {
+		int c = getc(reader->_file);
+		if (c == EOF || shift > 63) {
+			reader->_error = true;
+			return false;
+		}
+		delta |= (uint64_t)(c & 0x7f) << shift;
+		if (!(c & 0x80)) {
+			break;
+		}
+	}
+
+	unsigned char buf[8 + 4];
+	if (!_hashtable_trace_get_bytes(reader, buf, sizeof(buf))) {
+		return false;
+	}
+	reader->_last_timestamp += delta;
+	record->timestamp = reader->_last_timestamp;
+	record->fingerprint = _hashtable_trace_load_le(buf, 8);
+	record->hash = (uint32_t)_hashtable_trace_load_le(buf + 8, 4);
+	record->op = (enum hashtable_trace_op)op;
+	return true;
+}
+
+__AD_LINKAGE bool hashtable_trace_reader_error(const struct hashtable_trace_reader *reader)
+{
+	return reader->_error;
+}
@@ -0,0 +1,2 @@
+// this file is just a dummy to ensure that heap.h is included in the single header library
+#include "heap.h"
@@ -0,0 +1,456 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "compiler.h"
+#include "config.h"
+#include "histogram.h"
+#include "utils.h"
+
+static _attr_always_inline size_t _histogram_index(unsigned int precision, uint64_t value)
+{
+	// values below 2^precision have shift 0 and map to themselves
+	unsigned int shift = ilog2(value | (UINT64_C(1) << precision)) - precision;
+	return ((size_t)shift << precision) + (size_t)(value >> shift);
+}
+
+static _attr_always_inline size_t _histogram_clamped_index(const struct histogram *hist, uint64_t value)
+{
+	size_t index = _histogram_index(hist->_precision, value);
+	return index < hist->_num_buckets ? index : hist->_num_buckets - 1;
+}
+
+// the midpoint of a bucket
+static uint64_t _histogram_bucket_value(unsigned int precision, size_t index)
+{
+	if (index < ((size_t)1 << precision)) {
+		return index;
+	}
+	unsigned int shift = (unsigned int)(index >> precision) - 1;
+	uint64_t lower = (uint64_t)(index - ((size_t)shift << precision)) << shift;
+	return lower + ((UINT64_C(1) << shift) >> 1);
+}
+
+__AD_LINKAGE void histogram_init(struct histogram *hist, unsigned int precision, uint64_t max_value)
+{
+	assert(precision >= 1 && precision <= HISTOGRAM_MAX_PRECISION);
+	hist->_precision = precision;
+	hist->_num_buckets = _histogram_index(precision, max_value) + 1;
+	hist->_counts = calloc(hist->_num_buckets, sizeof(hist->_counts[0]));
+	if (unlikely(!hist->_counts)) {
+		abort();
+	}
+	hist->_total_count = 0;
+	hist->_min = UINT64_MAX;
+	hist->_max = 0;
+	hist->_sum = 0.0;
+}
+
+__AD_LINKAGE void histogram_destroy(struct histogram *hist)
+{
+	free(hist->_counts);
+}
+
+__AD_LINKAGE void histogram_clear(struct histogram *hist)
+{
+	if (hist->_total_count != 0) {
+		// only the buckets between min and max can be non-zero
+		size_t lo = _histogram_clamped_index(hist, hist->_min);
+		size_t hi = _histogram_clamped_index(hist, hist->_max);
+		memset(&hist->_counts[lo], 0, (hi - lo + 1) * sizeof(hist->_counts[0]));
+	}
+	hist->_total_count = 0;
+	hist->_min = UINT64_MAX;
+	hist->_max = 0;
+	hist->_sum = 0.0;
+}
+
+__AD_LINKAGE void histogram_record(struct histogram *hist, uint64_t value)
+{
+	hist->_counts[_histogram_clamped_index(hist, value)]++;
+	hist->_total_count++;
+	hist->_min = value < hist->_min ? value : hist->_min;
+	hist->_max = value > hist->_max ? value : hist->_max;
+	hist->_sum += (double)value;
+}
+
+__AD_LINKAGE void histogram_record_n(struct histogram *hist, uint64_t value, uint64_t count)
+{
+	if (count == 0) {
+		return;
+	}
+	hist->_counts[_histogram_clamped_index(hist, value)] += count;
+	hist->_total_count += count;
+	hist->_min = value < hist->_min ? value : hist->_min;
+	hist->_max = value > hist->_max ? value : hist->_max;
+	hist->_sum += (double)value * (double)count;
+}
+
+__AD_LINKAGE bool histogram_merge(struct histogram *hist, const struct histogram *other)
+{
+	if (hist->_precision != other->_precision) {
+		return false;
+	}
+	if (other->_total_count == 0) {
+		return true;
+	}
+	size_t lo = _histogram_clamped_index(other, other->_min);
+	size_t hi = _histogram_clamped_index(other, other->_max);
+	// buckets beyond our last one are added to it
+	size_t end = hi + 1 < hist->_num_buckets ? hi + 1 : hist->_num_buckets;
+	size_t i = lo;
+	for (; i < end; i++) {
+		hist->_counts[i] += other->_counts[i];
+	}
+	for (; i <= hi; i++) {
+		hist->_counts[hist->_num_buckets - 1] += other->_counts[i];
+	}
+	hist->_total_count += other->_total_count;
+	hist->_min = other->_min < hist->_min ? other->_min : hist->_min;
+	hist->_max = other->_max > hist->_max ? other->_max : hist->_max;
+	hist->_sum += other->_sum;
+	return true;
+}
+
+__AD_LINKAGE uint64_t histogram_count(const struct histogram *hist)
+{
+	return hist->_total_count;
+}
+
+__AD_LINKAGE uint64_t histogram_min(const struct histogram *hist)
+{
+	return hist->_total_count ? hist->_min : 0;
+}
+
+__AD_LINKAGE uint64_t histogram_max(const struct histogram *hist)
+{
+	return hist->_max;
+}
+
+__AD_LINKAGE double histogram_mean(const struct histogram *hist)
+{
+	return hist->_total_count ? hist->_sum / (double)hist->_total_count : 0.0;
+}
+
+// the (0-based) rank of quantile q among 'count' values
+static uint64_t _quantile_rank(double q, uint64_t count)
+{
+	q = q < 0.0 ? 0.0 : q > 1.0 ? 1.0 : q;
+	return (uint64_t)(q * (double)(count - 1));
+}
+
+__AD_LINKAGE uint64_t histogram_quantile(const struct histogram *hist, double q)
+{
+	uint64_t result;
+	histogram_quantiles(hist, &q, 1, &result);
+	return result;
+}
+
+__AD_LINKAGE void histogram_quantiles(const struct histogram *hist, const double *quantiles, size_t n,
+				      uint64_t *out)
+{
+	if (hist->_total_count == 0) {
+		memset(out, 0, n * sizeof(out[0]));
+		return;
+	}
+	size_t index = _histogram_clamped_index(hist, hist->_min);
+	size_t hi = _histogram_clamped_index(hist, hist->_max);
+	uint64_t cumulative = hist->_counts[index];
+	for (size_t i = 0; i < n; i++) {
+		assert(i == 0 || quantiles[i - 1] <= quantiles[i]);
+		uint64_t rank = _quantile_rank(quantiles[i], hist->_total_count);
+		while (cumulative <= rank && index < hi) {
+			cumulative += hist->_counts[++index];
+		}
+		uint64_t value = _histogram_bucket_value(hist->_precision, index);
+		value = value < hist->_min || rank == 0 ? hist->_min : value;
+		out[i] = value > hist->_max || rank == hist->_total_count - 1 ? hist->_max : value;
+	}
+}
+
+__AD_LINKAGE size_t histogram_memory_usage(const struct histogram *hist)
+{
+	return sizeof(*hist) + hist->_num_buckets * sizeof(hist->_counts[0]);
+}
+
+// store buckets are allocated in chunks of at least this many (but never more than max_buckets)
+#define __DDSKETCH_INITIAL_BUCKETS 128
+// keeps bucket indices far away from overflow (only reachable with an absurdly small alpha)
+#define __DDSKETCH_MAX_INDEX (INT32_MAX / 4)
+
+static void _ddsketch_store_init(struct _ddsketch_store *store)
+{
+	store->counts = NULL;
+	store->offset = 0;
+	store->min_index = 0;
+	store->max_index = 0;
+	store->length = 0;
+	store->total_count = 0;
+}
+
+static void _ddsketch_store_clear(struct _ddsketch_store *store)
+{
+	if (store->total_count != 0) {
+		memset(&store->counts[store->min_index - store->offset], 0,
+		       (size_t)(store->max_index - store->min_index + 1) * sizeof(store->counts[0]));
+	}
+	store->total_count = 0;
+}
+
+// reallocate the store so that it covers 'index', collapsing the lowest buckets if the range would exceed
+// max_buckets, and return the index that should be used instead of 'index'
+static _attr_noinline int32_t _ddsketch_store_extend(struct _ddsketch_store *store, int32_t index,
+						     uint32_t max_buckets)
+{
+	int32_t lo = index;
+	int32_t hi = index;
+	if (store->total_count != 0) {
+		lo = store->min_index < index ? store->min_index : index;
+		hi = store->max_index > index ? store->max_index : index;
+	}
+	if ((int64_t)hi - lo + 1 > max_buckets) {
+		lo = hi - (int32_t)max_buckets + 1;
+	}
+	uint32_t span = (uint32_t)(hi - lo + 1);
+	if (store->total_count == 0 && store->counts && span <= store->length) {
+		// an empty store can just be moved
+		store->offset = lo - (int32_t)(store->length - span) / 2;
+		store->min_index = store->max_index = index;
+		return index;
+	}
+
+	uint32_t length = store->length * 2 > __DDSKETCH_INITIAL_BUCKETS ? store->length * 2 :
+		__DDSKETCH_INITIAL_BUCKETS;
+	length = length > span ? length : span;
+	length = length < max_buckets ? length : max_buckets;
+	uint64_t *counts = calloc(length, sizeof(counts[0]));
+	if (unlikely(!counts)) {
+		abort();
+	}
+	int32_t offset = lo - (int32_t)(length - span) / 2;
+	if (store->total_count != 0) {
+		for (int32_t i = store->min_index; i <= store->max_index; i++) {
+			int32_t j = i < lo ? lo : i;
+			counts[j - offset] += store->counts[i - store->offset];
+		}
+		store->min_index = store->min_index < lo ? lo : store->min_index;
+	} else {
+		store->min_index = store->max_index = index < lo ? lo : index;
+	}
+	free(store->counts);
+	store->counts = counts;
+	store->offset = offset;
+	store->length = length;
+	return index < lo ? lo : index;
+}
+
+static _attr_always_inline void _ddsketch_store_add(struct _ddsketch_store *store, int32_t index, uint64_t count,
+						    uint32_t max_buckets)
+{
+	if (unlikely(store->total_count == 0 || index < store->offset ||
+		     index >= store->offset + (int32_t)store->length)) {
+		index = _ddsketch_store_extend(store, index, max_buckets);
+	}
+	store->counts[index - store->offset] += count;
+	store->min_index = index < store->min_index ? index : store->min_index;
+	store->max_index = index > store->max_index ? index : store->max_index;
+	store->total_count += count;
+}
+
+static _attr_always_inline int32_t _ddsketch_index(const struct ddsketch *sketch, double magnitude)
+{
+	double index = ceil(log(magnitude) * sketch->_multiplier);
+	index = index < -__DDSKETCH_MAX_INDEX ? -__DDSKETCH_MAX_INDEX : index;
+	return (int32_t)(index > __DDSKETCH_MAX_INDEX ? __DDSKETCH_MAX_INDEX : index);
+}
+
+// a value whose relative error is at most alpha for the whole bucket (gamma^(index-1), gamma^index]
+static double _ddsketch_bucket_value(const struct ddsketch *sketch, int32_t index)
+{
+	return 2.0 * exp(index / sketch->_multiplier) / (sketch->_gamma + 1.0);
+}
+
+__AD_LINKAGE void ddsketch_init(struct ddsketch *sketch, double alpha, size_t max_buckets)
+{
+	assert(alpha > 0.0 && alpha < 1.0 && max_buckets >= 1);
+	sketch->_gamma = (1.0 + alpha) / (1.0 - alpha);
+	sketch->_multiplier = 1.0 / log(sketch->_gamma);
+	sketch->_max_buckets = max_buckets < INT32_MAX / 2 ? (uint32_t)max_buckets : INT32_MAX / 2;
+	_ddsketch_store_init(&sketch->_positive);
+	_ddsketch_store_init(&sketch->_negative);
+	sketch->_zero_count = 0;
+	sketch->_min = INFINITY;
+	sketch->_max = -INFINITY;
+	sketch->_sum = 0.0;
+}
+
+__AD_LINKAGE void ddsketch_destroy(struct ddsketch *sketch)
+{
+	free(sketch->_positive.counts);
+	free(sketch->_negative.counts);
+}
+
+__AD_LINKAGE void ddsketch_clear(struct ddsketch *sketch)
+{
+	_ddsketch_store_clear(&sketch->_positive);
+	_ddsketch_store_clear(&sketch->_negative);
+	sketch->_zero_count = 0;
+	sketch->_min = INFINITY;
+	sketch->_max = -INFINITY;
+	sketch->_sum = 0.0;
+}
+
+__AD_LINKAGE void ddsketch_add_n(struct ddsketch *sketch, double value, uint64_t count)
+{
+	assert(!isnan(value));
+	if (count == 0) {
+		return;
+	}
+	if (value > 0.0) {
+		_ddsketch_store_add(&sketch->_positive, _ddsketch_index(sketch, value), count, sketch->_max_buckets);
+	} else if (value < 0.0) {
+		_ddsketch_store_add(&sketch->_negative, _ddsketch_index(sketch, -value), count, sketch->_max_buckets);
+	} else {
+		sketch->_zero_count += count;
+	}
+	sketch->_min = value < sketch->_min ? value : sketch->_min;
+	sketch->_max = value > sketch->_max ? value : sketch->_max;
+	sketch->_sum += value * (double)count;
+}
+
+__AD_LINKAGE void ddsketch_add(struct ddsketch *sketch, double value)
+{
+	ddsketch_add_n(sketch, value, 1);
+}
+
+static void _ddsketch_store_merge(struct _ddsketch_store *store, const struct _ddsketch_store *other,
+				  uint32_t max_buckets)
+{
+	if (other->total_count == 0) {
+		return;
+	}
+	// (adding the highest bucket first means that at most one more extension is needed)
+	for (int32_t i = other->max_index; i >= other->min_index; i--) {
+		uint64_t count = other->counts[i - other->offset];
+		if (count != 0) {
+			_ddsketch_store_add(store, i, count, max_buckets);
+		}
+	}
+}
+
+__AD_LINKAGE bool ddsketch_merge(struct ddsketch *sketch, const struct ddsketch *other)
+{
+	if (sketch->_gamma != other->_gamma) {
+		return false;
+	}
+	if (sketch == other) {
+		// (adding a sketch to itself doubles every count)
+		struct _ddsketch_store *stores[2] = {&sketch->_positive, &sketch->_negative};
+		for (size_t s = 0; s < 2; s++) {
+			for (uint32_t i = 0; stores[s]->total_count != 0 && i < stores[s]->length; i++) {
+				stores[s]->counts[i] *= 2;
+			}
+			stores[s]->total_count *= 2;
+		}
+		sketch->_zero_count *= 2;
+		sketch->_sum *= 2.0;
+		return true;
+	}
+	_ddsketch_store_merge(&sketch->_positive, &other->_positive, sketch->_max_buckets);
+	_ddsketch_store_merge(&sketch->_negative, &other->_negative, sketch->_max_buckets);
+	sketch->_zero_count += other->_zero_count;
+	sketch->_min = other->_min < sketch->_min ? other->_min : sketch->_min;
+	sketch->_max = other->_max > sketch->_max ? other->_max : sketch->_max;
+	sketch->_sum += other->_sum;
+	return true;
+}
+
+__AD_LINKAGE uint64_t ddsketch_count(const struct ddsketch *sketch)
+{
+	return sketch->_negative.total_count + sketch->_zero_count + sketch->_positive.total_count;
+}
+
+__AD_LINKAGE double ddsketch_min(const struct ddsketch *sketch)
+{
+	return ddsketch_count(sketch) ? sketch->_min : 0.0;
+}
+
+__AD_LINKAGE double ddsketch_max(const struct ddsketch *sketch)
+{
+	return ddsketch_count(sketch) ? sketch->_max : 0.0;
+}
+
+__AD_LINKAGE double ddsketch_mean(const struct ddsketch *sketch)
+{
+	uint64_t count = ddsketch_count(sketch);
+	return count ? sketch->_sum / (double)count : 0.0;
+}
+
+__AD_LINKAGE double ddsketch_quantile(const struct ddsketch *sketch, double q)
+{
+	uint64_t count = ddsketch_count(sketch);
+	if (count == 0) {
+		return 0.0;
+	}
+	uint64_t rank = _quantile_rank(q, count);
+	if (rank == 0 || rank == count - 1) {
+		return rank == 0 ? sketch->_min : sketch->_max;
+	}
+	double value;
+	const struct _ddsketch_store *negative = &sketch->_negative;
+	const struct _ddsketch_store *positive = &sketch->_positive;
+	if (rank < negative->total_count) {
+		// negative values in ascending order are the buckets with descending index
+		uint64_t cumulative = 0;
+		int32_t i = negative->max_index;
+		for (; i > negative->min_index; i--) {
+			cumulative += negative->counts[i - negative->offset];
+			if (cumulative > rank) {
+				break;
+			}
+		}
+		value = -_ddsketch_bucket_value(sketch, i);
+	} else if (rank < negative->total_count + sketch->_zero_count) {
+		value = 0.0;
+	} else {
+		rank -= negative->total_count + sketch->_zero_count;
+		uint64_t cumulative = 0;
+		int32_t i = positive->min_index;
+		for (; i < positive->max_index; i++) {
+			cumulative += positive->counts[i - positive->offset];
+			if (cumulative > rank) {
+				break;
+			}
+		}
+		value = _ddsketch_bucket_value(sketch, i);
+	}
+	value = value < sketch->_min ? sketch->_min : value;
+	return value > sketch->_max ? sketch->_max : value;
+}
+
+__AD_LINKAGE size_t ddsketch_memory_usage(const struct ddsketch *sketch)
+{
+	return sizeof(*sketch) + (sketch->_positive.length + sketch->_negative.length) * sizeof(uint64_t);
+}
@@ -0,0 +1,538 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <math.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "compiler.h"
+#include "config.h"
+#include "cpu.h"
+#include "dbuf.h"
+#include "hyperloglog.h"
+#include "utils.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+# include <immintrin.h>
+#endif
+
+// sparse entries store the register index at this precision (idx << 6 | rank)
+#define __HLL_SPARSE_PRECISION 25
+#define __HLL_SPARSE_MIN_CAPACITY 16
+
+// the sparse list never takes more than the 2^precision bytes of the dense registers (in entries)
+#define __HLL_SPARSE_LIMIT(p) (((size_t)1 << (p)) / sizeof(uint32_t))
+
+static _attr_always_inline uint32_t _hyperloglog_sparse_entry(uint64_t hash)
+{
+	const unsigned int sp = __HLL_SPARSE_PRECISION;
+	uint32_t idx = (uint32_t)(hash >> (64 - sp));
+	uint32_t rank = clz((hash << sp) | (UINT64_C(1) << (sp - 1))) + 1;
+	return idx << 6 | rank;
+}
+
+static _attr_always_inline void _hyperloglog_dense_add(uint8_t *registers, unsigned int p, uint64_t hash)
+{
+	size_t idx = (size_t)(hash >> (64 - p));
+	uint8_t rank = (uint8_t)(clz((hash << p) | (UINT64_C(1) << (p - 1))) + 1);
+	registers[idx] = registers[idx] < rank ? rank : registers[idx];
+}
+
+// the dense register and rank that a sparse entry maps to
+static _attr_always_inline void _hyperloglog_dense_add_entry(uint8_t *registers, unsigned int p, uint32_t entry)
+{
+	const unsigned int shift = __HLL_SPARSE_PRECISION - p;
+	uint32_t sparse_idx = entry >> 6;
+	uint32_t low = sparse_idx & ((UINT32_C(1) << shift) - 1);
+	uint8_t rank = (uint8_t)(low ? shift - ilog2(low) : shift + (entry & 63));
+	size_t idx = sparse_idx >> shift;
+	registers[idx] = registers[idx] < rank ? rank : registers[idx];
+}
+
+static void _hyperloglog_max_scalar(uint8_t *dst, const uint8_t *src, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		dst[i] = dst[i] < src[i] ? src[i] : dst[i];
+	}
+}
+
+// (the number of registers is always a multiple of 16)
+#if defined(HAVE_CPU_DISPATCH) || defined(__SSE2__)
+static _attr_target("sse2") void _hyperloglog_max_sse2(uint8_t *dst, const uint8_t *src, size_t n)
+{
+	for (size_t i = 0; i < n; i += 16) {
+		__m128i a = _mm_loadu_si128((const __m128i *)(dst + i));
+		__m128i b = _mm_loadu_si128((const __m128i *)(src + i));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_max_epu8(a, b));
+	}
+}
+#endif
+
+#if defined(HAVE_CPU_DISPATCH) || defined(__AVX2__)
+static _attr_target("avx2") void _hyperloglog_max_avx2(uint8_t *dst, const uint8_t *src, size_t n)
+{
+	size_t i = 0;
+	for (; i + 32 <= n; i += 32) {
+		__m256i a = _mm256_loadu_si256((const __m256i *)(dst + i));
+		__m256i b = _mm256_loadu_si256((const __m256i *)(src + i));
+		_mm256_storeu_si256((__m256i *)(dst + i), _mm256_max_epu8(a, b));
+	}
+	if (i < n) {
+		__m128i a = _mm_loadu_si128((const __m128i *)(dst + i));
+		__m128i b = _mm_loadu_si128((const __m128i *)(src + i));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_max_epu8(a, b));
+	}
+}
+#endif
+
+#if defined(HAVE_CPU_DISPATCH)
+typedef void (*_hyperloglog_max_func)(uint8_t *dst, const uint8_t *src, size_t n);
+
+static void _hyperloglog_max_resolve(uint8_t *dst, const uint8_t *src, size_t n);
+static _Atomic(_hyperloglog_max_func) _hyperloglog_max_impl = _hyperloglog_max_resolve;
+
+static void _hyperloglog_max_resolve(uint8_t *dst, const uint8_t *src, size_t n)
+{
+	_hyperloglog_max_func f = _hyperloglog_max_scalar;
+	if (cpu_has(CPU_FEATURE_AVX2)) {
+		f = _hyperloglog_max_avx2;
+	} else if (cpu_has(CPU_FEATURE_SSE2)) {
+		f = _hyperloglog_max_sse2;
+	}
+	atomic_store_explicit(&_hyperloglog_max_impl, f, memory_order_relaxed);
+	f(dst, src, n);
+}
+
+# define _hyperloglog_max(dst, src, n) atomic_load_explicit(&_hyperloglog_max_impl, memory_order_relaxed)(dst, src, n)
+#elif defined(__AVX2__)
+# define _hyperloglog_max _hyperloglog_max_avx2
+#elif defined(__SSE2__)
+# define _hyperloglog_max _hyperloglog_max_sse2
+#else
+# define _hyperloglog_max _hyperloglog_max_scalar
+#endif
+
+static int _hyperloglog_compare_entries(const void *_a, const void *_b)
+{
+	uint32_t a = *(const uint32_t *)_a;
+	uint32_t b = *(const uint32_t *)_b;
+	return a < b ? -1 : (a > b);
+}
+
+// sort 'entries' and keep only the highest rank of every index, return the new count
+static size_t _hyperloglog_sort_unique(uint32_t *entries, size_t count)
+{
+	if (count == 0) {
+		return 0;
+	}
+	qsort(entries, count, sizeof(entries[0]), _hyperloglog_compare_entries);
+	size_t n = 0;
+	for (size_t i = 1; i < count; i++) {
+		if ((entries[i] >> 6) != (entries[n] >> 6)) {
+			n++;
+		}
+		entries[n] = entries[i]; // (ranks are sorted too, so the last one wins)
+	}
+	return n + 1;
+}
+
+// merge the appended entries into the sorted prefix
+static void _hyperloglog_compact(struct hyperloglog *hll)
+{
+	uint32_t *sparse = hll->_sparse;
+	size_t sorted = hll->_sparse_sorted;
+	size_t tail = _hyperloglog_sort_unique(sparse + sorted, hll->_sparse_count - sorted);
+	if (sorted == 0) {
+		hll->_sparse_count = hll->_sparse_sorted = tail;
+		return;
+	}
+	uint32_t *merged = malloc(hll->_sparse_capacity * sizeof(merged[0]));
+	if (unlikely(!merged)) {
+		abort();
+	}
+	const uint32_t *a = sparse;
+	const uint32_t *a_end = sparse + sorted;
+	const uint32_t *b = sparse + sorted;
+	const uint32_t *b_end = b + tail;
+	size_t n = 0;
+	while (a != a_end && b != b_end) {
+		if ((*a >> 6) == (*b >> 6)) {
+			merged[n++] = *a < *b ? *b : *a;
+			a++;
+			b++;
+		} else {
+			merged[n++] = *a < *b ? *a++ : *b++;
+		}
+	}
+	while (a != a_end) {
+		merged[n++] = *a++;
+	}
+	while (b != b_end) {
+		merged[n++] = *b++;
+	}
+	free(sparse);
+	hll->_sparse = merged;
+	hll->_sparse_count = hll->_sparse_sorted = n;
+}
+
+static void _hyperloglog_to_dense(struct hyperloglog *hll)
+{
+	const unsigned int p = hll->_precision;
+	uint8_t *registers = calloc((size_t)1 << p, 1);
+	if (unlikely(!registers)) {
+		abort();
+	}
+	for (size_t i = 0; i < hll->_sparse_count; i++) {
+		_hyperloglog_dense_add_entry(registers, p, hll->_sparse[i]);
+	}
+	free(hll->_sparse);
+	hll->_registers = registers;
+	hll->_sparse = NULL;
+	hll->_sparse_count = hll->_sparse_sorted = hll->_sparse_capacity = 0;
+}
+
+static void _hyperloglog_sparse_add(struct hyperloglog *hll, uint32_t entry)
+{
+	if (hll->_sparse_count == hll->_sparse_capacity) {
+		if (hll->_sparse_count != 0) {
+			_hyperloglog_compact(hll);
+		}
+		// keep at least half of the capacity for appending so that compactions stay amortized
+		if (2 * hll->_sparse_count >= hll->_sparse_capacity) {
+			size_t limit = __HLL_SPARSE_LIMIT(hll->_precision);
+			if (hll->_sparse_capacity >= limit) {
+				// growing further would take more memory than the dense registers
+				_hyperloglog_to_dense(hll);
+				_hyperloglog_dense_add_entry(hll->_registers, hll->_precision, entry);
+				return;
+			}
+			size_t capacity = hll->_sparse_capacity ? 2 * hll->_sparse_capacity : __HLL_SPARSE_MIN_CAPACITY;
+			capacity = min(capacity, limit);
+			uint32_t *sparse = realloc(hll->_sparse, capacity * sizeof(sparse[0]));
+			if (unlikely(!sparse)) {
+				abort();
+			}
+			hll->_sparse = sparse;
+			hll->_sparse_capacity = capacity;
+		}
+	}
+	hll->_sparse[hll->_sparse_count++] = entry;
+}
+
+// return the sorted unique sparse entries (a copy that has to be freed if *ret_copy is set)
+static const uint32_t *_hyperloglog_sorted_entries(const struct hyperloglog *hll, size_t *ret_count, bool *ret_copy)
+{
+	if (hll->_sparse_sorted == hll->_sparse_count) {
+		*ret_count = hll->_sparse_count;
+		*ret_copy = false;
+		return hll->_sparse;
+	}
+	uint32_t *entries = malloc(hll->_sparse_count * sizeof(entries[0]));
+	if (unlikely(!entries)) {
+		abort();
+	}
+	memcpy(entries, hll->_sparse, hll->_sparse_count * sizeof(entries[0]));
+	*ret_count = _hyperloglog_sort_unique(entries, hll->_sparse_count);
+	*ret_copy = true;
+	return entries;
+}
+
+__AD_LINKAGE bool hyperloglog_init(struct hyperloglog *hll, unsigned int precision)
+{
+	if (precision < HYPERLOGLOG_MIN_PRECISION || precision > HYPERLOGLOG_MAX_PRECISION) {
+		return false;
+	}
+	hll->_registers = NULL;
+	hll->_sparse = NULL;
+	hll->_sparse_count = 0;
+	hll->_sparse_sorted = 0;
+	hll->_sparse_capacity = 0;
+	hll->_precision = precision;
+	return true;
+}
+
+__AD_LINKAGE void hyperloglog_destroy(struct hyperloglog *hll)
+{
+	free(hll->_registers);
+	free(hll->_sparse);
+}
+
+__AD_LINKAGE void hyperloglog_clear(struct hyperloglog *hll)
+{
+	hyperloglog_destroy(hll);
+	hyperloglog_init(hll, hll->_precision);
+}
+
+__AD_LINKAGE void hyperloglog_add(struct hyperloglog *hll, uint64_t hash)
+{
+	if (hll->_registers) {
+		_hyperloglog_dense_add(hll->_registers, hll->_precision, hash);
+	} else {
+		_hyperloglog_sparse_add(hll, _hyperloglog_sparse_entry(hash));
+	}
+}
+
+__AD_LINKAGE void hyperloglog_add_bulk(struct hyperloglog *hll, const uint64_t *hashes, size_t count)
+{
+	size_t i = 0;
+	for (; i < count && !hll->_registers; i++) {
+		_hyperloglog_sparse_add(hll, _hyperloglog_sparse_entry(hashes[i]));
+	}
+	uint8_t *registers = hll->_registers;
+	const unsigned int p = hll->_precision;
+	for (; i < count; i++) {
+		_hyperloglog_dense_add(registers, p, hashes[i]);
+	}
+}
+
+__AD_LINKAGE bool hyperloglog_merge(struct hyperloglog *hll, const struct hyperloglog *other)
+{
+	if (hll->_precision != other->_precision) {
+		return false;
+	}
+	if (hll == other) {
+		return true;
+	}
+	if (other->_registers) {
+		if (!hll->_registers) {
+			_hyperloglog_to_dense(hll);
+		}
+		_hyperloglog_max(hll->_registers, other->_registers, (size_t)1 << hll->_precision);
+		return true;
+	}
+	for (size_t i = 0; i < other->_sparse_count; i++) {
+		if (hll->_registers) {
+			_hyperloglog_dense_add_entry(hll->_registers, hll->_precision, other->_sparse[i]);
+		} else {
+			_hyperloglog_sparse_add(hll, other->_sparse[i]);
+		}
+	}
+	return true;
+}
+
+static double _hyperloglog_sigma(double x)
+{
+	if (x == 1.0) {
+		return INFINITY;
+	}
+	double y = 1.0;
+	double z = x;
+	double prev;
+	do {
+		x *= x;
+		prev = z;
+		z += x * y;
+		y += y;
+	} while (z != prev);
+	return z;
+}
+
+static double _hyperloglog_tau(double x)
+{
+	if (x == 0.0 || x == 1.0) {
+		return 0.0;
+	}
+	double y = 1.0;
+	double z = 1.0 - x;
+	double prev;
+	do {
+		x = sqrt(x);
+		prev = z;
+		y *= 0.5;
+		z -= (1.0 - x) * (1.0 - x) * y;
+	} while (z != prev);
+	return z / 3.0;
+}
+
+// Ertl's estimator from the register histogram (ranks 0 to q + 1, m registers)
+static double _hyperloglog_estimate_histogram(const uint32_t *histogram, unsigned int q, double m)
+{
+	double z = m * _hyperloglog_tau(1.0 - histogram[q + 1] / m);
+	for (unsigned int k = q; k >= 1; k--) {
+		z = 0.5 * (z + histogram[k]);
+	}
+	z += m * _hyperloglog_sigma(histogram[0] / m);
+	return m * m / (2.0 * 0.69314718055994530942 * z); // (alpha_inf = 1 / (2 ln 2))
+}
+
+__AD_LINKAGE double hyperloglog_estimate(const struct hyperloglog *hll)
+{
+	uint32_t histogram[66] = {0};
+	if (hll->_registers) {
+		const unsigned int p = hll->_precision;
+		const size_t m = (size_t)1 << p;
+		for (size_t i = 0; i < m; i++) {
+			histogram[hll->_registers[i]]++;
+		}
+		return _hyperloglog_estimate_histogram(histogram, 64 - p, (double)m);
+	}
+	size_t count;
+	bool copy;
+	const uint32_t *entries = _hyperloglog_sorted_entries(hll, &count, &copy);
+	for (size_t i = 0; i < count; i++) {
+		histogram[entries[i] & 63]++;
+	}
+	histogram[0] = (uint32_t)(((size_t)1 << __HLL_SPARSE_PRECISION) - count);
+	if (copy) {
+		free((void *)entries);
+	}
+	return _hyperloglog_estimate_histogram(histogram, 64 - __HLL_SPARSE_PRECISION,
+					       (double)((size_t)1 << __HLL_SPARSE_PRECISION));
+}
+
+__AD_LINKAGE size_t hyperloglog_memory_usage(const struct hyperloglog *hll)
+{
+	if (hll->_registers) {
+		return sizeof(*hll) + ((size_t)1 << hll->_precision);
+	}
+	return sizeof(*hll) + hll->_sparse_capacity * sizeof(hll->_sparse[0]);
+}
+
+static void _hyperloglog_put_varint(struct dbuf *dbuf, size_t x)
+{
+	while (x >= 0x80) {
+		dbuf_add_byte(dbuf, (unsigned char)(x | 0x80));
+		x >>= 7;
+	}
+	dbuf_add_byte(dbuf, (unsigned char)x);
+}
+
+static bool _hyperloglog_get_varint(const unsigned char **pp, const unsigned char *end, size_t *ret)
+{
+	const unsigned char *p = *pp;
+	size_t x = 0;
+	for (unsigned int shift = 0; p != end && shift < 8 * sizeof(x); shift += 7) {
+		x |= (size_t)(*p & 0x7f) << shift;
+		if (!(*p++ & 0x80)) {
+			*pp = p;
+			*ret = x;
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Format: one byte with the precision (and 0x80 if dense), followed by either
+ *  - sparse: the number of entries and the differences between consecutive sorted entries as varints
+ *  - dense: the registers packed into 6 bits each (4 registers in 3 bytes, little-endian)
+ */
+__AD_LINKAGE void hyperloglog_serialize(const struct hyperloglog *hll, struct dbuf *out)
+{
+	const unsigned int p = hll->_precision;
+	if (hll->_registers) {
+		const size_t m = (size_t)1 << p;
+		dbuf_add_byte(out, (unsigned char)(p | 0x80));
+		unsigned char *dst = dbuf_add_uninitialized(out, m / 4 * 3);
+		for (size_t i = 0; i < m; i += 4) {
+			const uint8_t *r = &hll->_registers[i];
+			uint32_t packed = r[0] | (uint32_t)r[1] << 6 | (uint32_t)r[2] << 12 | (uint32_t)r[3] << 18;
+			*dst++ = (unsigned char)packed;
+			*dst++ = (unsigned char)(packed >> 8);
+			*dst++ = (unsigned char)(packed >> 16);
+		}
+		return;
+	}
+	size_t count;
+	bool copy;
+	const uint32_t *entries = _hyperloglog_sorted_entries(hll, &count, &copy);
+	dbuf_add_byte(out, (unsigned char)p);
+	_hyperloglog_put_varint(out, count);
+	uint32_t prev = 0;
+	for (size_t i = 0; i < count; i++) {
+		_hyperloglog_put_varint(out, entries[i] - prev);
+		prev = entries[i];
+	}
+	if (copy) {
+		free((void *)entries);
+	}
+}
+
+__AD_LINKAGE bool hyperloglog_deserialize(struct hyperloglog *hll, const void *data, size_t size)
+{
+	const unsigned char *p = data;
+	const unsigned char *end = p + size;
+	if (size == 0 || !hyperloglog_init(hll, *p & 0x7f)) {
+		return false;
+	}
+	const unsigned int precision = hll->_precision;
+	const bool dense = *p++ & 0x80;
+	if (dense) {
+		const size_t m = (size_t)1 << precision;
+		if ((size_t)(end - p) != m / 4 * 3) {
+			return false;
+		}
+		uint8_t *registers = malloc(m);
+		if (unlikely(!registers)) {
+			abort();
+		}
+		uint8_t max_rank = 0;
+		for (size_t i = 0; i < m; i += 4, p += 3) {
+			uint32_t packed = p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16;
+			for (size_t j = 0; j < 4; j++) {
+				registers[i + j] = (packed >> (6 * j)) & 63;
+				max_rank = registers[i + j] > max_rank ? registers[i + j] : max_rank;
+			}
+		}
+		if (max_rank > 64 - precision + 1) {
+			free(registers);
+			return false;
+		}
+		hll->_registers = registers;
+		return true;
+	}
+	const size_t max_entries = (size_t)1 << __HLL_SPARSE_PRECISION;
+	size_t count;
+	if (!_hyperloglog_get_varint(&p, end, &count) || count > max_entries || count > (size_t)(end - p)) {
+		return false;
+	}
+	uint32_t *entries = malloc((count ? count : 1) * sizeof(entries[0]));
+	if (unlikely(!entries)) {
+		abort();
+	}
+	uint64_t entry = 0;
+	for (size_t i = 0; i < count; i++) {
+		size_t delta;
+		if (!_hyperloglog_get_varint(&p, end, &delta) || delta > max_entries << 6) {
+			goto error;
+		}
+		uint64_t next = entry + delta;
+		unsigned int rank = next & 63;
+		// indices have to be strictly increasing and ranks in [1, 64 - __HLL_SPARSE_PRECISION + 1]
+		if ((i != 0 && (next >> 6) <= (entry >> 6)) || next >> 6 >= max_entries ||
+		    rank == 0 || rank > 64 - __HLL_SPARSE_PRECISION + 1) {
+			goto error;
+		}
+		entries[i] = (uint32_t)next;
+		entry = next;
+	}
+	if (p != end) {
+		goto error;
+	}
+	hll->_sparse = entries;
+	// (switches to dense on the next add if the sketch was serialized just before that)
+	hll->_sparse_count = hll->_sparse_sorted = hll->_sparse_capacity = count;
+	return true;
+
+error:
+	free(entries);
+	return false;
+}
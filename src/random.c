@@ -18,8 +18,17 @@
  */
 
 #include <assert.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cpu.h"
 #include "random.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+# include <immintrin.h>
+#endif
+
 /* http://prng.di.unimi.it/splitmix64.c
 
    Written in 2015 by Sebastiano Vigna (vigna@acm.org)
@@ -83,7 +92,7 @@ __AD_LINKAGE void random_state_init(struct random_state *state, uint64_t seed)
 
 __AD_LINKAGE uint64_t random_next_u64(struct random_state *state)
 {
-#define rotl(x, k) ((uint64_t)(x) << (k)) | ((uint64_t)(x) >> (64 - (k)))
+#define rotl(x, k) (((uint64_t)(x) << (k)) | ((uint64_t)(x) >> (64 - (k))))
 	const uint64_t result = rotl(state->s[1] * 5, 7) * 9;
 
 	const uint64_t t = state->s[1] << 17;
@@ -254,3 +263,1782 @@ __AD_LINKAGE void random_long_jump(struct random_state *state)
 	state->s[2] = s2;
 	state->s[3] = s3;
 }
+
+/* Streams: the state after j steps is x^j modulo the characteristic polynomial P of xoshiro256 (degree 256)
+ * applied to the state, so jumping k * 2^128 steps is (x^(2^128))^k mod P, i.e. O(log k) multiplications of
+ * 256-bit polynomials over GF(2) followed by the same 256-step application as random_jump.
+ */
+
+// P without the x^256 term
+static const uint64_t _random_charpoly[4] = {
+	0x9d116f2bb0f0f001, 0x0280002bcefd1a5e, 0x04b4edcf26259f85, 0x0003c03c3f3ecb19
+};
+
+// x^(2^128) mod P (the JUMP polynomial)
+static const uint64_t _random_jump_poly[4] = {
+	0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c
+};
+
+static void _random_poly_mulmod(uint64_t r[4], const uint64_t a[4], const uint64_t b[4])
+{
+	uint64_t acc[4] = {0};
+	uint64_t x[4] = {b[0], b[1], b[2], b[3]};
+	for (size_t i = 0; i < 256; i++) {
+		uint64_t mask = -((a[i / 64] >> (i % 64)) & 1);
+		for (size_t j = 0; j < 4; j++) {
+			acc[j] ^= x[j] & mask;
+		}
+		// x *= x (mod P)
+		uint64_t carry = -(x[3] >> 63);
+		x[3] = (x[3] << 1) | (x[2] >> 63);
+		x[2] = (x[2] << 1) | (x[1] >> 63);
+		x[1] = (x[1] << 1) | (x[0] >> 63);
+		x[0] = x[0] << 1;
+		for (size_t j = 0; j < 4; j++) {
+			x[j] ^= _random_charpoly[j] & carry;
+		}
+	}
+	memcpy(r, acc, sizeof(acc));
+}
+
+__AD_LINKAGE void random_jump_n(struct random_state *state, uint64_t k)
+{
+	if (k == 0) {
+		return;
+	}
+	uint64_t poly[4] = {1, 0, 0, 0};
+	uint64_t base[4];
+	memcpy(base, _random_jump_poly, sizeof(base));
+	for (;;) {
+		if (k & 1) {
+			_random_poly_mulmod(poly, poly, base);
+		}
+		k >>= 1;
+		if (k == 0) {
+			break;
+		}
+		_random_poly_mulmod(base, base, base);
+	}
+
+	struct random_state result = {{0, 0, 0, 0}};
+	for (size_t b = 0; b < 256; b++) {
+		uint64_t mask = -((poly[b / 64] >> (b % 64)) & 1);
+		for (size_t j = 0; j < 4; j++) {
+			result.s[j] ^= state->s[j] & mask;
+		}
+		random_next_u64(state);
+	}
+	*state = result;
+}
+
+__AD_LINKAGE void random_stream(struct random_state *state, uint64_t seed, uint64_t k)
+{
+	random_state_init(state, seed);
+	random_jump_n(state, k);
+}
+
+static _Thread_local struct random_state _random_thread_state;
+static _Thread_local bool _random_thread_state_initialized;
+static atomic_uint_fast64_t _random_thread_next_stream;
+
+__AD_LINKAGE void random_thread_state_init(uint64_t seed, uint64_t k)
+{
+	random_stream(&_random_thread_state, seed, k);
+	_random_thread_state_initialized = true;
+}
+
+__AD_LINKAGE struct random_state *random_thread_state(void)
+{
+	if (unlikely(!_random_thread_state_initialized)) {
+		uint64_t k = atomic_fetch_add_explicit(&_random_thread_next_stream, 1, memory_order_relaxed);
+		random_thread_state_init(RANDOM_THREAD_DEFAULT_SEED, k);
+	}
+	return &_random_thread_state;
+}
+
+/* Bulk generation: 8 interleaved xoshiro256** lanes, lane k starts k * 2^64 steps ahead of the state. That is
+ * less than a jump, so a fill stays within its own stream and never runs into the streams that random_jump
+ * and random_stream derive from the same state. Steps commute with each other, so after a fill the state is
+ * replaced by the last lane, which is past every value the fill used, and no two fills overlap. A stream has
+ * room for about 2^61 fills before it would reach the next one.
+ * The output differs from calling random_next_* in a loop, but is just as reproducible.
+ */
+
+#define __RANDOM_LANES 8
+// deriving the lanes takes 256 steps, below this many values the scalar loop is faster
+#define __RANDOM_FILL_MIN 1024
+#define __RANDOM_BLOCK 256
+
+struct _random_lanes {
+	uint64_t s[4][__RANDOM_LANES];
+};
+
+/* Lane k is x^(k * 2^64) modulo the characteristic polynomial of xoshiro256 applied to the state. Bit k of
+ * entry b is the coefficient of x^b of that polynomial (lane 0 is just x^0).
+ */
+static const uint8_t _random_lane_jump_bits[256] = {
+	0x9d, 0x34, 0xa2, 0x04, 0x82, 0xd8, 0x46, 0xb4, 0x1a, 0x7e, 0x9e, 0x8c, 0xa4, 0x8c, 0x98, 0xc4,
+	0x4e, 0xf6, 0x72, 0xba, 0x74, 0xa6, 0xae, 0x3c, 0x82, 0xb8, 0x0c, 0x22, 0x90, 0x7c, 0x9c, 0xa4,
+	0x90, 0xac, 0x00, 0x0e, 0x50, 0x82, 0xe2, 0x0e, 0xc4, 0xa6, 0x3e, 0xc4, 0x3e, 0xe8, 0xe4, 0x38,
+	0x34, 0xac, 0x0a, 0x2a, 0x5e, 0x3a, 0xd0, 0x38, 0x96, 0xb0, 0x68, 0x44, 0x62, 0xe6, 0x5c, 0xc2,
+	0x0c, 0x4e, 0xa6, 0x9c, 0xd4, 0x48, 0x7c, 0x1c, 0x2e, 0xc4, 0xb0, 0xfc, 0x0a, 0xf2, 0x06, 0x92,
+	0xbc, 0xd0, 0xd0, 0x92, 0x22, 0xc6, 0xc2, 0x40, 0x58, 0x98, 0x4e, 0x6a, 0x48, 0x60, 0xb0, 0x3a,
+	0x5a, 0x76, 0x28, 0x1a, 0xce, 0x5c, 0x0e, 0x50, 0x6c, 0x2c, 0x4a, 0x9a, 0x5c, 0xbe, 0xb6, 0x58,
+	0x06, 0x70, 0x0e, 0xc6, 0x08, 0xc0, 0x54, 0x14, 0x1c, 0x42, 0x72, 0x34, 0xca, 0xee, 0xf4, 0x3e,
+	0x98, 0x0e, 0xbc, 0xaa, 0x9c, 0xd0, 0xa8, 0xe4, 0xb4, 0x62, 0xbc, 0x54, 0x10, 0x58, 0xd6, 0x52,
+	0x06, 0x04, 0x9a, 0x54, 0x84, 0xb0, 0x00, 0x0a, 0x6a, 0xc6, 0x32, 0xc0, 0xb8, 0x98, 0xd6, 0xec,
+	0xe0, 0xd8, 0xe4, 0x5e, 0xae, 0x68, 0x3c, 0xb4, 0xe6, 0xba, 0x9e, 0x2e, 0x6a, 0xc2, 0x56, 0x0e,
+	0xc4, 0x32, 0x10, 0x4e, 0xe2, 0xea, 0xbe, 0xfe, 0x54, 0x98, 0x42, 0x08, 0xd6, 0x6e, 0x1c, 0x18,
+	0x5a, 0x30, 0x44, 0x22, 0xbe, 0x96, 0xfe, 0x26, 0xca, 0x4a, 0x52, 0x66, 0x6a, 0x96, 0x20, 0x7a,
+	0x7a, 0xec, 0x1c, 0xa2, 0xea, 0x18, 0x54, 0x90, 0x38, 0xa8, 0x2a, 0xca, 0x86, 0x6a, 0x5e, 0x56,
+	0xa2, 0x1e, 0xec, 0x8e, 0xe6, 0x6a, 0x26, 0xe2, 0xcc, 0x82, 0xac, 0x30, 0x00, 0xda, 0x74, 0xe6,
+	0x70, 0xec, 0xc2, 0xc8, 0x20, 0x1e, 0x5a, 0xb2, 0x60, 0xde, 0xf4, 0x2c, 0x5e, 0x78, 0x20, 0x78,
+};
+
+static void _random_lanes_finish(const struct _random_lanes *lanes, struct random_state *state)
+{
+	for (size_t j = 0; j < 4; j++) {
+		state->s[j] = lanes->s[j][__RANDOM_LANES - 1];
+	}
+}
+
+#ifdef HAVE_ATTR_VECTOR_SIZE
+typedef uint64_t _random_v8 __attribute__((vector_size(8 * __RANDOM_LANES)));
+
+// all seven lane offsets in a single pass over the first 256 states (every lane accumulates the states it needs)
+static _attr_always_inline void _random_lanes_init(struct _random_lanes *lanes, const struct random_state *state)
+{
+	const _random_v8 lane_bit = {1, 2, 4, 8, 16, 32, 64, 128};
+	struct random_state s = *state;
+	_random_v8 acc0 = {0}, acc1 = {0}, acc2 = {0}, acc3 = {0};
+	for (size_t b = 0; b < 256; b++) {
+		_random_v8 mask = (_random_v8)(((_random_lane_jump_bits[b] + (_random_v8){0}) & lane_bit) != 0);
+		acc0 ^= s.s[0] & mask;
+		acc1 ^= s.s[1] & mask;
+		acc2 ^= s.s[2] & mask;
+		acc3 ^= s.s[3] & mask;
+		random_next_u64(&s);
+	}
+	memcpy(lanes->s[0], &acc0, sizeof(acc0));
+	memcpy(lanes->s[1], &acc1, sizeof(acc1));
+	memcpy(lanes->s[2], &acc2, sizeof(acc2));
+	memcpy(lanes->s[3], &acc3, sizeof(acc3));
+}
+
+// out[i * 8 + k] is the i-th output of lane k (count must be a multiple of 8)
+static _attr_always_inline void _random_lanes_generate(struct _random_lanes *lanes, void *out, size_t count)
+{
+	_random_v8 s0, s1, s2, s3;
+	memcpy(&s0, lanes->s[0], sizeof(s0));
+	memcpy(&s1, lanes->s[1], sizeof(s1));
+	memcpy(&s2, lanes->s[2], sizeof(s2));
+	memcpy(&s3, lanes->s[3], sizeof(s3));
+	for (size_t i = 0; i < count; i += __RANDOM_LANES) {
+		// (there is no 64-bit vector multiplication before AVX-512, 5 and 9 are a shift and an add)
+		_random_v8 x = s1 + (s1 << 2);
+		x = (x << 7) | (x >> 57);
+		x = x + (x << 3);
+		memcpy((unsigned char *)out + i * sizeof(uint64_t), &x, sizeof(x));
+		_random_v8 t = s1 << 17;
+		s2 ^= s0;
+		s3 ^= s1;
+		s1 ^= s2;
+		s0 ^= s3;
+		s2 ^= t;
+		s3 = (s3 << 45) | (s3 >> 19);
+	}
+	memcpy(lanes->s[0], &s0, sizeof(s0));
+	memcpy(lanes->s[1], &s1, sizeof(s1));
+	memcpy(lanes->s[2], &s2, sizeof(s2));
+	memcpy(lanes->s[3], &s3, sizeof(s3));
+}
+#else
+static _attr_always_inline void _random_lanes_init(struct _random_lanes *lanes, const struct random_state *state)
+{
+	struct random_state s = *state;
+	memset(lanes, 0, sizeof(*lanes));
+	for (size_t b = 0; b < 256; b++) {
+		unsigned int bits = _random_lane_jump_bits[b];
+		for (size_t k = 0; k < __RANDOM_LANES; k++) {
+			uint64_t mask = -(uint64_t)((bits >> k) & 1);
+			for (size_t j = 0; j < 4; j++) {
+				lanes->s[j][k] ^= s.s[j] & mask;
+			}
+		}
+		random_next_u64(&s);
+	}
+}
+
+static _attr_always_inline void _random_lanes_generate(struct _random_lanes *lanes, void *out, size_t count)
+{
+	for (size_t i = 0; i < count; i += __RANDOM_LANES) {
+		for (size_t k = 0; k < __RANDOM_LANES; k++) {
+			struct random_state s = {{lanes->s[0][k], lanes->s[1][k], lanes->s[2][k], lanes->s[3][k]}};
+			uint64_t x = random_next_u64(&s);
+			memcpy((unsigned char *)out + (i + k) * sizeof(uint64_t), &x, sizeof(x));
+			for (size_t j = 0; j < 4; j++) {
+				lanes->s[j][k] = s.s[j];
+			}
+		}
+	}
+}
+#endif
+
+/* The vector code is compiled once per ISA (8 lanes are two AVX2 or four SSE2 registers per state word).
+ * generate(lanes, NULL, 0) only derives the lanes, otherwise 'count' (a multiple of 8) 64-bit values are
+ * stored to 'out' (which can have any type).
+ */
+#define __RANDOM_DEFINE_GENERATE(suffix, ...)				\
+	static _attr_noinline __VA_ARGS__ void _random_generate_##suffix(struct _random_lanes *lanes, \
+									  const struct random_state *state, \
+									  void *out, size_t count) \
+	{								\
+		if (state) {						\
+			_random_lanes_init(lanes, state);		\
+		}							\
+		_random_lanes_generate(lanes, out, count);		\
+	}
+
+__RANDOM_DEFINE_GENERATE(default)
+#if defined(HAVE_CPU_DISPATCH) && defined(HAVE_ATTR_VECTOR_SIZE)
+__RANDOM_DEFINE_GENERATE(avx2, _attr_target("avx2"))
+__RANDOM_DEFINE_GENERATE(avx512, _attr_target("avx512f"))
+
+typedef void (*_random_generate_func)(struct _random_lanes *lanes, const struct random_state *state, void *out,
+				      size_t count);
+
+static void _random_generate_resolve(struct _random_lanes *lanes, const struct random_state *state, void *out,
+				     size_t count);
+static _Atomic(_random_generate_func) _random_generate_impl = _random_generate_resolve;
+
+static void _random_generate_resolve(struct _random_lanes *lanes, const struct random_state *state, void *out,
+				     size_t count)
+{
+	_random_generate_func f = _random_generate_default;
+	if (cpu_has(CPU_FEATURE_AVX512)) {
+		f = _random_generate_avx512;
+	} else if (cpu_has(CPU_FEATURE_AVX2)) {
+		f = _random_generate_avx2;
+	}
+	atomic_store_explicit(&_random_generate_impl, f, memory_order_relaxed);
+	f(lanes, state, out, count);
+}
+
+# define _random_generate(lanes, state, out, count)			\
+	atomic_load_explicit(&_random_generate_impl, memory_order_relaxed)(lanes, state, out, count)
+#else
+# define _random_generate _random_generate_default
+#endif
+
+#undef __RANDOM_DEFINE_GENERATE
+
+// fill buf with raw lane outputs (values_per_u64 values per output) or return after scalar_call for small n
+#define __RANDOM_FILL(state, buf, n, values_per_u64, scalar_call)	\
+	do {								\
+		if ((n) < __RANDOM_FILL_MIN) {				\
+			for (size_t i = 0; i < (n); i++) {		\
+				(buf)[i] = (scalar_call);		\
+			}						\
+			return;						\
+		}							\
+		struct _random_lanes lanes;				\
+		const size_t per_call = __RANDOM_LANES * (values_per_u64); \
+		size_t bulk = (n) - (n) % per_call;			\
+		_random_generate(&lanes, (state), (buf), bulk / (values_per_u64)); \
+		if (bulk != (n)) {					\
+			uint64_t tail[__RANDOM_LANES];			\
+			_random_generate(&lanes, NULL, tail, __RANDOM_LANES); \
+			memcpy(&(buf)[bulk], tail, ((n) - bulk) * sizeof((buf)[0])); \
+		}							\
+		_random_lanes_finish(&lanes, (state));			\
+	} while (0)
+
+__AD_LINKAGE void random_fill_u64(struct random_state *state, uint64_t *buf, size_t n)
+{
+	__RANDOM_FILL(state, buf, n, 1, random_next_u64(state));
+}
+
+// (both halves of every output are used)
+__AD_LINKAGE void random_fill_u32(struct random_state *state, uint32_t *buf, size_t n)
+{
+	__RANDOM_FILL(state, buf, n, 2, random_next_u32(state));
+}
+
+__AD_LINKAGE void random_fill_double(struct random_state *state, double *buf, size_t n)
+{
+	random_fill_double_in_range(state, buf, n, 0.0, 1.0);
+}
+
+__AD_LINKAGE void random_fill_double_in_range(struct random_state *state, double *buf, size_t n, double min,
+					      double max)
+{
+	assert(min <= max);
+	// the raw outputs are written to buf and converted in place (53 bits like random_next_uniform_double, the
+	// shifted value fits into an int64_t, whose conversion is cheaper than that of an uint64_t)
+	__RANDOM_FILL(state, buf, n, 1, random_next_double_in_range(state, min, max));
+	for (size_t i = 0; i < n; i++) {
+		uint64_t x;
+		memcpy(&x, &buf[i], sizeof(x));
+		double d = (int64_t)(x >> 11) * 0x1.0p-53;
+		buf[i] = min + d * (max - min);
+	}
+}
+
+/* The bounded variants reject values like random_next_*_in_range, so they consume the lane outputs in blocks
+ * and keep going until n values were accepted.
+ */
+__AD_LINKAGE void random_fill_u32_in_range(struct random_state *state, uint32_t *buf, size_t n, uint32_t min,
+					   uint32_t max)
+{
+	assert(min <= max);
+	if (n < __RANDOM_FILL_MIN) {
+		for (size_t i = 0; i < n; i++) {
+			buf[i] = random_next_u32_in_range(state, min, max);
+		}
+		return;
+	}
+	uint32_t s = max - min + 1;
+	if (unlikely(s == 0)) {
+		random_fill_u32(state, buf, n);
+		return;
+	}
+	uint32_t t = (-s) % s;
+	struct _random_lanes lanes;
+	uint32_t block[2 * __RANDOM_BLOCK];
+	const struct random_state *init = state;
+	size_t i = 0;
+	while (i < n) {
+		_random_generate(&lanes, init, block, __RANDOM_BLOCK);
+		init = NULL;
+		size_t end = n - i < 2 * __RANDOM_BLOCK ? n - i : 2 * __RANDOM_BLOCK;
+		bool rejected = false;
+		for (size_t j = 0; j < end; j++) {
+			uint64_t m = (uint64_t)block[j] * s;
+			buf[i + j] = min + (uint32_t)(m >> 32);
+			rejected |= (uint32_t)m < t;
+		}
+		if (likely(!rejected)) {
+			i += end;
+			continue;
+		}
+		// (rare unless the range is close to 2^32) redo the block and skip the rejected values
+		for (size_t j = 0; j < end; j++) {
+			uint64_t m = (uint64_t)block[j] * s;
+			buf[i] = min + (uint32_t)(m >> 32);
+			i += (uint32_t)m >= t;
+		}
+	}
+	_random_lanes_finish(&lanes, state);
+}
+
+__AD_LINKAGE void random_fill_u64_in_range(struct random_state *state, uint64_t *buf, size_t n, uint64_t min,
+					   uint64_t max)
+{
+	assert(min <= max);
+	if (n < __RANDOM_FILL_MIN) {
+		for (size_t i = 0; i < n; i++) {
+			buf[i] = random_next_u64_in_range(state, min, max);
+		}
+		return;
+	}
+	uint64_t s = max - min + 1;
+	if (unlikely(s == 0)) {
+		random_fill_u64(state, buf, n);
+		return;
+	}
+	struct _random_lanes lanes;
+	uint64_t block[__RANDOM_BLOCK];
+	const struct random_state *init = state;
+	size_t i = 0;
+#ifdef __SIZEOF_INT128__
+	typedef unsigned __int128 uint128_t;
+	uint64_t t = (-s) % s;
+	while (i < n) {
+		_random_generate(&lanes, init, block, __RANDOM_BLOCK);
+		init = NULL;
+		size_t end = n - i < __RANDOM_BLOCK ? n - i : __RANDOM_BLOCK;
+		bool rejected = false;
+		for (size_t j = 0; j < end; j++) {
+			uint128_t m = (uint128_t)block[j] * s;
+			buf[i + j] = min + (uint64_t)(m >> 64);
+			rejected |= (uint64_t)m < t;
+		}
+		if (likely(!rejected)) {
+			i += end;
+			continue;
+		}
+		for (size_t j = 0; j < end; j++) {
+			uint128_t m = (uint128_t)block[j] * s;
+			buf[i] = min + (uint64_t)(m >> 64);
+			i += (uint64_t)m >= t;
+		}
+	}
+#else
+	uint64_t remainder = UINT64_MAX % s;
+	while (i < n) {
+		_random_generate(&lanes, init, block, __RANDOM_BLOCK);
+		init = NULL;
+		size_t end = n - i < __RANDOM_BLOCK ? n - i : __RANDOM_BLOCK;
+		for (size_t j = 0; j < end; j++) {
+			buf[i] = min + block[j] % s;
+			i += block[j] < UINT64_MAX - remainder;
+		}
+	}
+#endif
+	_random_lanes_finish(&lanes, state);
+}
+
+
+/* Non-uniform distributions. Every sampler is written once against a source of 64-bit values (and inlined for
+ * each): the state itself for the random_next_* functions, or blocks of lane outputs for the random_fill_*
+ * functions.
+ */
+
+typedef uint64_t (*_random_source_func)(void *source);
+
+static inline uint64_t _random_source_state(void *source)
+{
+	return random_next_u64(source);
+}
+
+struct _random_buffer {
+	struct _random_lanes lanes;
+	size_t pos;
+	uint64_t values[__RANDOM_BLOCK];
+};
+
+static inline uint64_t _random_source_buffer(void *source)
+{
+	struct _random_buffer *buffer = source;
+	if (unlikely(buffer->pos == __RANDOM_BLOCK)) {
+		_random_generate(&buffer->lanes, NULL, buffer->values, __RANDOM_BLOCK);
+		buffer->pos = 0;
+	}
+	return buffer->values[buffer->pos++];
+}
+
+static _attr_always_inline double _random_uniform(_random_source_func next, void *source)
+{
+	return (next(source) >> 11) * 0x1.0p-53;
+}
+
+// buf[i] = sampler(next, source, ...) for i < n
+#define __RANDOM_FILL_WITH(state, buf, n, sampler, ...)			\
+	do {								\
+		if ((n) < __RANDOM_FILL_MIN) {				\
+			for (size_t i = 0; i < (n); i++) {		\
+				(buf)[i] = sampler(_random_source_state, (state), __VA_ARGS__); \
+			}						\
+			break;						\
+		}							\
+		struct _random_buffer buffer;				\
+		_random_generate(&buffer.lanes, (state), buffer.values, __RANDOM_BLOCK); \
+		buffer.pos = 0;						\
+		for (size_t i = 0; i < (n); i++) {			\
+			(buf)[i] = sampler(_random_source_buffer, &buffer, __VA_ARGS__); \
+		}							\
+		_random_lanes_finish(&buffer.lanes, (state));		\
+	} while (0)
+
+// log(gamma(x)) for x >= 1 (lgamma is not thread-safe because of signgam)
+static double _random_log_gamma(double x)
+{
+	static const double a[10] = {
+		8.333333333333333e-02, -2.777777777777778e-03, 7.936507936507937e-04, -5.952380952380952e-04,
+		8.417508417508418e-04, -1.917526917526918e-03, 6.410256410256410e-03, -2.955065359477124e-02,
+		1.796443723688307e-01, -1.39243221690590e+00
+	};
+	if (x == 1.0 || x == 2.0) {
+		return 0.0;
+	}
+	// Stirling series, shifted up to 7 first
+	unsigned int n = x < 7.0 ? (unsigned int)(7.0 - x) : 0;
+	double x0 = x + n;
+	double x2 = 1.0 / (x0 * x0);
+	double g = a[9];
+	for (int k = 8; k >= 0; k--) {
+		g = g * x2 + a[k];
+	}
+	double result = g / x0 + 0.9189385332046727 + (x0 - 0.5) * log(x0) - x0;
+	for (unsigned int k = 0; k < n; k++) {
+		x0 -= 1.0;
+		result -= log(x0);
+	}
+	return result;
+}
+
+/* Ziggurats with 256 layers (Marsaglia and Tsang, "The Ziggurat Method for Generating Random Variables").
+ * k[i] is the acceptance threshold of layer i, w[i] scales an integer to x and f[i] is the density at the edge of
+ * layer i. The tables are precomputed so that the values do not depend on the platform's libm.
+ */
+
+#define __RANDOM_NORMAL_R 3.6541528853610088
+#define __RANDOM_NORMAL_INV_R 0.27366123732975828
+#define __RANDOM_EXP_R 7.6971174701310497
+
+static const uint64_t _random_normal_k[256] = {
+	0x000ef33d8025bc39, 0x0000000000000000, 0x000c08be98f2acaa, 0x000da354faba4236,
+	0x000e51f67ec049b5, 0x000eb255e9d2fa41, 0x000eef4b817e221c, 0x000f19470af9cc80,
+	0x000f37ed61ff712f, 0x000f4f469560df95, 0x000f61a5e41b6be3, 0x000f707a75536926,
+	0x000f7cb2ec281ec3, 0x000f86f10c6337d8, 0x000f8fa657830a7d, 0x000f9724c74db926,
+	0x000f9da907dbe051, 0x000fa360f581e82e, 0x000fa86fde5b3bbf, 0x000facf160d34659,
+	0x000fb0fb6718ac00, 0x000fb49f8d5368f8, 0x000fb7ec2366f3bd, 0x000fbaece9a1db42,
+	0x000fbdab9d0402f5, 0x000fc03060ff6415, 0x000fc28210379aaa, 0x000fc4a67ae254c2,
+	0x000fc6a2977ae7a3, 0x000fc87aa928908b, 0x000fca325e4bd8d4, 0x000fcbcce9021dc6,
+	0x000fcd4d12f834c6, 0x000fceb54d8fe7e7, 0x000fd007bf1dc4c6, 0x000fd1464dd6c0ba,
+	0x000fd272a8e2f060, 0x000fd38e4ff0c565, 0x000fd49a9990b0f2, 0x000fd598b8920bf9,
+	0x000fd689c08e96bd, 0x000fd76ea9c8e52a, 0x000fd848547b0606, 0x000fd9178bad29cb,
+	0x000fd9dd07a7ab31, 0x000fda9970105c08, 0x000fdb4d5dc02bb8, 0x000fdbf95c5bfa83,
+	0x000fdc9debb99848, 0x000fdd3b8118707f, 0x000fddd288342d86, 0x000fde6364369d6f,
+	0x000fdeee708d4f6d, 0x000fdf7401a6b25e, 0x000fdff46599eb80, 0x000fe06fe4bc2343,
+	0x000fe0e6c225a0b8, 0x000fe1593c28b6ba, 0x000fe1c78cbc3e15, 0x000fe231e9db1b32,
+	0x000fe29885da1a27, 0x000fe2fb8fb54027, 0x000fe35b33558bf6, 0x000fe3b799cffee1,
+	0x000fe410e99eac3f, 0x000fe46746d475ff, 0x000fe4bad34c082f, 0x000fe50baed29401,
+	0x000fe559f74ebb5c, 0x000fe5a5c8e410ff, 0x000fe5ef3e13857d, 0x000fe6366fd90f74,
+	0x000fe67b75c6d47c, 0x000fe6be661e10b4, 0x000fe6ff55e5f402, 0x000fe73e5900a617,
+	0x000fe77b823e9d56, 0x000fe7b6e3706fc3, 0x000fe7f08d77416b, 0x000fe8289053efb9,
+	0x000fe85efb35166d, 0x000fe893dc84079b, 0x000fe8c741f0cdf7, 0x000fe8f9387d4e36,
+	0x000fe929cc879a62, 0x000fe95909d38833, 0x000fe986fb9399ee, 0x000fe9b3ac7147b7,
+	0x000fe9df2694b62a, 0x000fea0973abe5d4, 0x000fea329cf16600, 0x000fea5aab32948c,
+	0x000fea81a6d5737c, 0x000feaa797de1c56, 0x000feacc85f3d889, 0x000feaf07865e5a9,
+	0x000feb13762feb82, 0x000feb3585fe29bd, 0x000feb56ae316229, 0x000feb76f4e28470,
+	0x000feb965fe61f8d, 0x000febb4f4cf9cf9, 0x000febd2b8f4494f, 0x000febefb16e2dbf,
+	0x000fec0be31ebd6c, 0x000fec2752b1599a, 0x000fec42049daf5b, 0x000fec5bfd29f121,
+	0x000fec75406cee81, 0x000fec8dd2500c42, 0x000feca5b6911ea1, 0x000fecbcf0c42790,
+	0x000fecd38454faa9, 0x000fece97488c84a, 0x000fecfec47f914f, 0x000fed13773584c1,
+	0x000fed278f84489e, 0x000fed3b10242ee8, 0x000fed4dfbad580b, 0x000fed605498c37c,
+	0x000fed721d414f89, 0x000fed8357e4a924, 0x000fed9406a42c6d, 0x000feda42b85b6a9,
+	0x000fedb3c8746a5a, 0x000fedc2df4165fa, 0x000fedd171a46dfc, 0x000feddf813c8a7d,
+	0x000feded0f90992c, 0x000fedfa1e0fd3c1, 0x000fee06ae124b73, 0x000fee12c0d959b5,
+	0x000fee1e57900690, 0x000fee29734b64d6, 0x000fee34150ae46f, 0x000fee3e3db89af0,
+	0x000fee47ee2982a8, 0x000fee51271db03c, 0x000fee59e9407ef7, 0x000fee623528b3e5,
+	0x000fee6a0b5897a9, 0x000fee716c3e0733, 0x000fee7858327b3b, 0x000fee7ecf7b0674,
+	0x000fee84d2484a6e, 0x000fee8a60b662ff, 0x000fee8f7accc80f, 0x000fee94207e2598,
+	0x000fee9851a829aa, 0x000fee9c0e13481a, 0x000fee9f557273b4, 0x000feea22762cc70,
+	0x000feea4836b426d, 0x000feea668fc2d34, 0x000feea7d76ed6bd, 0x000feea8ce04f9ce,
+	0x000feea94be83300, 0x000feea9502963d4, 0x000feea8d9c00723, 0x000feea7e789761a,
+	0x000feea678481cec, 0x000feea48aa29e4a, 0x000feea21d22e4a2, 0x000fee9f2e351fed,
+	0x000fee9bbc26aef8, 0x000fee97c524f2ad, 0x000fee93473c0a03, 0x000fee8e405574e0,
+	0x000fee88ae369c44, 0x000fee828e7f3dc9, 0x000fee7bdea7b854, 0x000fee749bff37cb,
+	0x000fee6cc3a9bd2c, 0x000fee64529e004d, 0x000fee5b45a32857, 0x000fee51994e5785,
+	0x000fee474a00069e, 0x000fee3c53e12c1e, 0x000fee30b2e02aa7, 0x000fee2462ad81d4,
+	0x000fee175eb83c2a, 0x000fee09a22a1417, 0x000fedfb27e3499c, 0x000fedebea76213e,
+	0x000feddbe422044f, 0x000fedcb0ece39a5, 0x000fedb964042cc6, 0x000feda6dce9389c,
+	0x000fed937237e95f, 0x000fed7f1c38a80a, 0x000fed69d2b9bffe, 0x000fed538d06add3,
+	0x000fed3c41dea3f7, 0x000fed23e76a2fac, 0x000fed0a732fe617, 0x000fecefda07fe08,
+	0x000fecd4100eb78c, 0x000fecb708956e89, 0x000fec98b6123096, 0x000fec790a0da94e,
+	0x000fec57f50f31d4, 0x000fec356686c938, 0x000fec114cb4b30b, 0x000febeb948e6fa7,
+	0x000febc429a0b668, 0x000feb9af5ee0cb3, 0x000feb6fe1c98519, 0x000feb42d3ad1f75,
+	0x000feb13b00b2d23, 0x000feae2591a02c0, 0x000feaaeae99222d, 0x000fea788d8ee2fe,
+	0x000fea3fcffd73bc, 0x000fea044c8dd9ce, 0x000fe9c5d62f5612, 0x000fe9843ba9477a,
+	0x000fe93f471d4700, 0x000fe8f6bd76c5ad, 0x000fe8aa5dc4e8bd, 0x000fe859e07ab1c1,
+	0x000fe804f690a917, 0x000fe7ab48823396, 0x000fe74c751f6a7c, 0x000fe6e8102aa1d9,
+	0x000fe67da0b6abaf, 0x000fe60c9f383055, 0x000fe5947338f718, 0x000fe51470977256,
+	0x000fe48bd436f42d, 0x000fe3f9bffd1e0d, 0x000fe35d35eeb171, 0x000fe2b5122fe4d2,
+	0x000fe2000399552b, 0x000fe13c827882e8, 0x000fe068c4ee6783, 0x000fdf82b02b717d,
+	0x000fde87c57efe7c, 0x000fdd7509c63bce, 0x000fdc46e529bee3, 0x000fdaf8f82e0252,
+	0x000fd985e1b2ba43, 0x000fd7e6ef48ced0, 0x000fd613adbd64d6, 0x000fd40149e2efda,
+	0x000fd1a1a7b4c772, 0x000fcee204761f61, 0x000fcba8d85e1171, 0x000fc7d26ecd2cde,
+	0x000fc32b2f1e22a1, 0x000fbd6581c0b7e7, 0x000fb606c40053d6, 0x000fac40582a2805,
+	0x000f9e971e014510, 0x000f89fa48a41d49, 0x000f66c5f7f02f1a, 0x000f1a5a4b331a0a,
+};
+
+static const double _random_normal_w[256] = {
+	0x1.f493b78164498p-51, 0x1.b8d0be3d69918p-55, 0x1.250af3c200a69p-54,
+	0x1.57cb9383ae550p-54, 0x1.801fce827fac5p-54, 0x1.a230c2e46389ep-54,
+	0x1.c004d2f328d93p-54, 0x1.dac2f5a6f3120p-54, 0x1.f32482d4807a6p-54,
+	0x1.04d32278c832ep-53, 0x1.0f5053b004b4ep-53, 0x1.192a6973f450ap-53,
+	0x1.227a28f78456ap-53, 0x1.2b52e38621b30p-53, 0x1.33c3fc055e9edp-53,
+	0x1.3bd9ec1a11c06p-53, 0x1.439ef8dfe170ap-53, 0x1.4b1bb363c898dp-53,
+	0x1.5257562196c1cp-53, 0x1.59580a70673c9p-53, 0x1.60231cfd82f9bp-53,
+	0x1.66bd261a2377ep-53, 0x1.6d2a291feca73p-53, 0x1.736dad345c6b6p-53,
+	0x1.798ad10b200f0p-53, 0x1.7f845ad45d397p-53, 0x1.855cc5341f023p-53,
+	0x1.8b1649e7a632cp-53, 0x1.90b2ea94dc2a8p-53, 0x1.96347822b1818p-53,
+	0x1.9b9c98e37c43bp-53, 0x1.a0eccdca3ab98p-53, 0x1.a62676d76d6f5p-53,
+	0x1.ab4ad6e0f24bap-53, 0x1.b05b16d127fd5p-53, 0x1.b5584874191dap-53,
+	0x1.ba4368e51bb30p-53, 0x1.bf1d62abea23bp-53, 0x1.c3e70f95872e0p-53,
+	0x1.c8a13a531630bp-53, 0x1.cd4c9fe7151cap-53, 0x1.d1e9f0e7fe5f7p-53,
+	0x1.d679d29e3510dp-53, 0x1.dafce0022edeep-53, 0x1.df73aa9f0ae8dp-53,
+	0x1.e3debb5d2292dp-53, 0x1.e83e93379ad08p-53, 0x1.ec93abdf8c395p-53,
+	0x1.f0de784efa595p-53, 0x1.f51f654d83c88p-53, 0x1.f956d9e87202bp-53,
+	0x1.fd8537df97991p-53, 0x1.00d56e041db89p-52, 0x1.02e40f5393759p-52,
+	0x1.04eea9e164ed4p-52, 0x1.06f565b7249f9p-52, 0x1.08f8690719efdp-52,
+	0x1.0af7d84bc0d06p-52, 0x1.0cf3d664b796dp-52, 0x1.0eec84b15b64dp-52,
+	0x1.10e203294c4bdp-52, 0x1.12d470730bf74p-52, 0x1.14c3e9f8e41d8p-52,
+	0x1.16b08bfc3d191p-52, 0x1.189a71a788c7ep-52, 0x1.1a81b51ee20a3p-52,
+	0x1.1c666f8f7deb3p-52, 0x1.1e48b93e088dcp-52, 0x1.2028a99405610p-52,
+	0x1.2206572c47d17p-52, 0x1.23e1d7de97a07p-52, 0x1.25bb40ca92399p-52,
+	0x1.2792a661d8bcdp-52, 0x1.29681c7199017p-52, 0x1.2b3bb62b7e880p-52,
+	0x1.2d0d862e172a1p-52, 0x1.2edd9e8cb647fp-52, 0x1.30ac10d6e0469p-52,
+	0x1.3278ee1f4755fp-52, 0x1.3444470261b6ap-52, 0x1.360e2baca1034p-52,
+	0x1.37d6abe05165dp-52, 0x1.399dd6fb270e9p-52, 0x1.3b63bbfb7fc17p-52,
+	0x1.3d2869855dd80p-52, 0x1.3eebede721aacp-52, 0x1.40ae571e05f24p-52,
+	0x1.426fb2da63591p-52, 0x1.44300e83bf25ap-52, 0x1.45ef773ca8993p-52,
+	0x1.47adf9e6685eap-52, 0x1.496ba3248525ep-52, 0x1.4b287f6020506p-52,
+	0x1.4ce49acb2d5fdp-52, 0x1.4ea0016386a9cp-52, 0x1.505abef5e1a6dp-52,
+	0x1.5214df20a50d8p-52, 0x1.53ce6d56a2c3dp-52, 0x1.558774e1b7925p-52,
+	0x1.574000e552644p-52, 0x1.58f81c60e4c4cp-52, 0x1.5aafd2323e2fbp-52,
+	0x1.5c672d17d3b48p-52, 0x1.5e1e37b2f5545p-52, 0x1.5fd4fc89f270fp-52,
+	0x1.618b860a2e8ffp-52, 0x1.6341de8a27a41p-52, 0x1.64f8104b6f00cp-52,
+	0x1.66ae257c960d3p-52, 0x1.6864283b0fbf7p-52, 0x1.6a1a229507dcfp-52,
+	0x1.6bd01e8b30f36p-52, 0x1.6d86261289f28p-52, 0x1.6f3c43161c483p-52,
+	0x1.70f27f78b3573p-52, 0x1.72a8e5168e1a6p-52, 0x1.745f7dc70bc13p-52,
+	0x1.7616535e540adp-52, 0x1.77cd6faefc22dp-52, 0x1.7984dc8ba8bcbp-52,
+	0x1.7b3ca3c8ae294p-52, 0x1.7cf4cf3daf1d9p-52, 0x1.7ead68c73ae15p-52,
+	0x1.80667a486b99ep-52, 0x1.82200dac85645p-52, 0x1.83da2ce896f32p-52,
+	0x1.8594e1fd1c628p-52, 0x1.875036f7a4f7ep-52, 0x1.890c35f47c831p-52,
+	0x1.8ac8e92059192p-52, 0x1.8c865aba0de35p-52, 0x1.8e44951443c0ap-52,
+	0x1.9003a297387bcp-52, 0x1.91c38dc2855bcp-52, 0x1.9384612eeddb8p-52,
+	0x1.954627903758cp-52, 0x1.9708ebb70a936p-52, 0x1.98ccb892dfdbfp-52,
+	0x1.9a919933f6d92p-52, 0x1.9c5798cd5ad43p-52, 0x1.9e1ec2b6f486dp-52,
+	0x1.9fe7226faa6eap-52, 0x1.a1b0c39f90b75p-52, 0x1.a37bb21a29d81p-52,
+	0x1.a547f9e0b90efp-52, 0x1.a715a724a7f4dp-52, 0x1.a8e4c64a00726p-52,
+	0x1.aab563e9fc731p-52, 0x1.ac878cd5acc36p-52, 0x1.ae5b4e18b89dep-52,
+	0x1.b030b4fc37800p-52, 0x1.b207cf09a6f7ep-52, 0x1.b3e0aa0dfe361p-52,
+	0x1.b5bb541ce14a1p-52, 0x1.b797db93f6101p-52, 0x1.b9764f1e5cf51p-52,
+	0x1.bb56bdb84fdbep-52, 0x1.bd3936b2e992ep-52, 0x1.bf1dc9b81874ap-52,
+	0x1.c10486cebefa2p-52, 0x1.c2ed7e5f05369p-52, 0x1.c4d8c136de693p-52,
+	0x1.c6c6608ec60b5p-52, 0x1.c8b66e0eb8000p-52, 0x1.caa8fbd367ccdp-52,
+	0x1.cc9e1c73bb0eap-52, 0x1.ce95e3068bacap-52, 0x1.d0906328b6a39p-52,
+	0x1.d28db1037ca23p-52, 0x1.d48de1533a181p-52, 0x1.d691096e7cc94p-52,
+	0x1.d8973f4d7d74dp-52, 0x1.daa0999204a4dp-52, 0x1.dcad2f8fc2520p-52,
+	0x1.debd195520a7ep-52, 0x1.e0d06fb49ae98p-52, 0x1.e2e74c4ea23a7p-52,
+	0x1.e501c99c1ae6fp-52, 0x1.e72002f97db41p-52, 0x1.e94214b2a9c5cp-52,
+	0x1.eb681c0f74c90p-52, 0x1.ed923761084f7p-52, 0x1.efc086101ca9bp-52,
+	0x1.f1f328ac23146p-52, 0x1.f42a40fb72bc7p-52, 0x1.f665f20c8dff6p-52,
+	0x1.f8a6604897644p-52, 0x1.faebb187101b4p-52, 0x1.fd360d22fc6aep-52,
+	0x1.ff859c118d567p-52, 0x1.00ed447d3903dp-51, 0x1.021a8028fb929p-51,
+	0x1.034a983a8f2a6p-51, 0x1.047da4e3ee5dbp-51, 0x1.05b3bf6ada3acp-51,
+	0x1.06ed023a716b0p-51, 0x1.082988f631e79p-51, 0x1.0969708e892d0p-51,
+	0x1.0aacd7571b15ap-51, 0x1.0bf3dd1eec4f7p-51, 0x1.0d3ea34aa2df9p-51,
+	0x1.0e8d4cf115675p-51, 0x1.0fdffefa690b2p-51, 0x1.1136e04206156p-51,
+	0x1.129219bbb4e64p-51, 0x1.13f1d69c3fab5p-51, 0x1.1556448601f9dp-51,
+	0x1.16bf93b9de06ep-51, 0x1.182df74d203f5p-51, 0x1.19a1a564edd5ap-51,
+	0x1.1b1ad777f2157p-51, 0x1.1c99ca9719877p-51, 0x1.1e1ebfbe4a036p-51,
+	0x1.1fa9fc2e2cb18p-51, 0x1.213bc9d04beb3p-51, 0x1.22d477a6fc63bp-51,
+	0x1.24745a4ac8e8bp-51, 0x1.261bcc7764b62p-51, 0x1.27cb2faa84bcbp-51,
+	0x1.2982ecd770131p-51, 0x1.2b4375329fd27p-51, 0x1.2d0d43196ce88p-51,
+	0x1.2ee0db1a96c02p-51, 0x1.30becd256a217p-51, 0x1.32a7b5e6897e9p-51,
+	0x1.349c405ae0606p-51, 0x1.369d27a339bc1p-51, 0x1.38ab3925634a9p-51,
+	0x1.3ac7570ae7cb8p-51, 0x1.3cf27b316f883p-51, 0x1.3f2dbaa60e871p-51,
+	0x1.417a49cb9d9f6p-51, 0x1.43d98155452d1p-51, 0x1.464ce44a72e74p-51,
+	0x1.48d62759c383dp-51, 0x1.4b7739d6b4eccp-51, 0x1.4e3250dcd7dccp-51,
+	0x1.5109f53e9a131p-51, 0x1.54011523a7359p-51, 0x1.571b1a94ad95ap-51,
+	0x1.5a5c08b718342p-51, 0x1.5dc8a243ac693p-51, 0x1.61669cf86140fp-51,
+	0x1.653ce7b0060dfp-51, 0x1.69540be9fdbedp-51, 0x1.6db6b8d09d896p-51,
+	0x1.72728f05f70d7p-51, 0x1.779955608fd5bp-51, 0x1.7d42df4d6c5c3p-51,
+	0x1.839030529e9c6p-51, 0x1.8ab0fbfaa7412p-51, 0x1.92ee0946f3d1ap-51,
+	0x1.9cbee014050dfp-51, 0x1.a8fdc7894718cp-51, 0x1.b981f3878f995p-51,
+	0x1.d3bb48209ad33p-51,
+};
+
+static const double _random_normal_f[256] = {
+	0x1.0000000000000p+0, 0x1.f446ac97c0265p-1, 0x1.eb7545b6e5a2dp-1,
+	0x1.e3f11e0296bb2p-1, 0x1.dd36fa70635f9p-1, 0x1.d70920658fa12p-1,
+	0x1.d144978a24289p-1, 0x1.cbd33a8a84602p-1, 0x1.c6a5eceaa82b8p-1,
+	0x1.c1b1cd9efb947p-1, 0x1.bceeb4ee2d08dp-1, 0x1.b85653a90e040p-1,
+	0x1.b3e3a8235bfdap-1, 0x1.af92a3f6dc413p-1, 0x1.ab5fef17af9c6p-1,
+	0x1.a748bd5519883p-1, 0x1.a34aafdf6780cp-1, 0x1.9f63bee65e399p-1,
+	0x1.9b9228d24c563p-1, 0x1.97d4657623514p-1, 0x1.94291c21c3052p-1,
+	0x1.908f1bd322352p-1, 0x1.8d0554fe6b8dcp-1, 0x1.898ad48bb899ap-1,
+	0x1.861ebfc3863d6p-1, 0x1.82c050f577355p-1, 0x1.7f6ed4b218395p-1,
+	0x1.7c29a779d0627p-1, 0x1.78f033ca14bc9p-1, 0x1.75c1f0771708dp-1,
+	0x1.729e5f44002a7p-1, 0x1.6f850baeb0dfbp-1, 0x1.6c7589e63eb25p-1,
+	0x1.696f75e51c96bp-1, 0x1.667272a936f1ep-1, 0x1.637e2985595dfp-1,
+	0x1.609249880ae0ap-1, 0x1.5dae86f4b84fep-1, 0x1.5ad29acc8e01cp-1,
+	0x1.57fe4264d0f30p-1, 0x1.55313f08e1e03p-1, 0x1.526b55a65eabbp-1,
+	0x1.4fac4e8213283p-1, 0x1.4cf3f4f49c91ep-1, 0x1.4a42172dccb23p-1,
+	0x1.479685fdfc714p-1, 0x1.44f114a49abddp-1, 0x1.425198a35d3b3p-1,
+	0x1.3fb7e9958cdc7p-1, 0x1.3d23e10afa266p-1, 0x1.3a955a6633c57p-1,
+	0x1.380c32bda6eadp-1, 0x1.358848bf5bd57p-1, 0x1.33097c970a541p-1,
+	0x1.308fafd64a29fp-1, 0x1.2e1ac55eaa449p-1, 0x1.2baaa14d7fc57p-1,
+	0x1.293f28e9432dbp-1, 0x1.26d8429056971p-1, 0x1.2475d5a913eccp-1,
+	0x1.2217ca9305a04p-1, 0x1.1fbe0a992f702p-1, 0x1.1d687fe54f920p-1,
+	0x1.1b17157402fa1p-1, 0x1.18c9b709b99bdp-1, 0x1.168051286962ap-1,
+	0x1.143ad105f04d3p-1, 0x1.11f924831795cp-1, 0x1.0fbb3a232b228p-1,
+	0x1.0d81010419aaap-1, 0x1.0b4a68d7130b1p-1, 0x1.091761d99b381p-1,
+	0x1.06e7dccf09138p-1, 0x1.04bbcafa69335p-1, 0x1.02931e18bd539p-1,
+	0x1.006dc85b91cdep-1, 0x1.fc9778c7c5ff1p-2, 0x1.f859da7a9a13dp-2,
+	0x1.f4229cb301990p-2, 0x1.eff1a717f2c62p-2, 0x1.ebc6e20bdba59p-2,
+	0x1.e7a236a4f5d07p-2, 0x1.e3838ea603307p-2, 0x1.df6ad4776cfd2p-2,
+	0x1.db57f320beac8p-2, 0x1.d74ad6427709cp-2, 0x1.d3436a102a142p-2,
+	0x1.cf419b4aeea8ep-2, 0x1.cb45573c135cbp-2, 0x1.c74e8bb0163b2p-2,
+	0x1.c35d26f1db70fp-2, 0x1.bf7117c61f2dep-2, 0x1.bb8a4d671f4cdp-2,
+	0x1.b7a8b780798d0p-2, 0x1.b3cc462b3b5fcp-2, 0x1.aff4e9ea20806p-2,
+	0x1.ac2293a5fdbd7p-2, 0x1.a85534aa55844p-2, 0x1.a48cbea213e9ep-2,
+	0x1.a0c923947011ep-2, 0x1.9d0a55e1f0f53p-2, 0x1.9950484193ad3p-2,
+	0x1.959aedbe1183bp-2, 0x1.91ea39b344260p-2, 0x1.8e3e1fcba6703p-2,
+	0x1.8a9693fdf061cp-2, 0x1.86f38a8accdf4p-2, 0x1.8354f7faa7fc5p-2,
+	0x1.7fbad11b949adp-2, 0x1.7c250aff48400p-2, 0x1.78939af92c0f3p-2,
+	0x1.7506769c81eafp-2, 0x1.717d93ba9cccdp-2, 0x1.6df8e8612b6ecp-2,
+	0x1.6a786ad894727p-2, 0x1.66fc11a2633afp-2, 0x1.6383d377c4babp-2,
+	0x1.600fa74813828p-2, 0x1.5c9f843772671p-2, 0x1.5933619d751bcp-2,
+	0x1.55cb3703d62d1p-2, 0x1.5266fc2539c94p-2, 0x1.4f06a8ebfcd13p-2,
+	0x1.4baa35710fafep-2, 0x1.485199fadc80dp-2, 0x1.44fccefc38117p-2,
+	0x1.41abcd135d515p-2, 0x1.3e5e8d08f2cbbp-2, 0x1.3b1507cf19c77p-2,
+	0x1.37cf368086b2cp-2, 0x1.348d125fa283fp-2, 0x1.314e94d5b4bbep-2,
+	0x1.2e13b77215be5p-2, 0x1.2adc73e96934ep-2, 0x1.27a8c414e0385p-2,
+	0x1.2478a1f182fe8p-2, 0x1.214c079f81cf7p-2, 0x1.1e22ef618d06bp-2,
+	0x1.1afd539c33ea1p-2, 0x1.17db2ed54a239p-2, 0x1.14bc7bb353ab8p-2,
+	0x1.11a134fcf6f75p-2, 0x1.0e8955987541ap-2, 0x1.0b74d88b28c36p-2,
+	0x1.0863b8f908b9bp-2, 0x1.0555f22433149p-2, 0x1.024b7f6c7baf9p-2,
+	0x1.fe88b89e01ed8p-3, 0x1.f88108cb8bb6bp-3, 0x1.f27fe6cea202ap-3,
+	0x1.ec854a4ca21c2p-3, 0x1.e6912b228c089p-3, 0x1.e0a381645f35fp-3,
+	0x1.dabc455c81015p-3, 0x1.d4db6f8b2cf92p-3, 0x1.cf00f8a5eec4bp-3,
+	0x1.c92cd99725a10p-3, 0x1.c35f0b7d91641p-3, 0x1.bd9787abe8fdep-3,
+	0x1.b7d647a87a72bp-3, 0x1.b21b452cd4505p-3, 0x1.ac667a2578a1bp-3,
+	0x1.a6b7e0b1996e0p-3, 0x1.a10f7322decf1p-3, 0x1.9b6d2bfd36b63p-3,
+	0x1.95d105f6ae788p-3, 0x1.903afbf756425p-3, 0x1.8aab09192e973p-3,
+	0x1.852128a8200b0p-3, 0x1.7f9d5621fd650p-3, 0x1.7a1f8d3690665p-3,
+	0x1.74a7c9c7b1751p-3, 0x1.6f3607e96a72fp-3, 0x1.69ca43e2250e8p-3,
+	0x1.64647a2ae4e9cp-3, 0x1.5f04a76f8df6fp-3, 0x1.59aac88f3775cp-3,
+	0x1.5456da9c8c09dp-3, 0x1.4f08dade376a4p-3, 0x1.49c0c6cf6238ep-3,
+	0x1.447e9c203c9b4p-3, 0x1.3f4258b698410p-3, 0x1.3a0bfaae928d4p-3,
+	0x1.34db805b4fafap-3, 0x1.2fb0e847c7863p-3, 0x1.2a8c3137a53a6p-3,
+	0x1.256d5a283a9d2p-3, 0x1.20546251885e5p-3, 0x1.1b4149275c58ap-3,
+	0x1.16340e5a87443p-3, 0x1.112cb1da2b434p-3, 0x1.0c2b33d524dd1p-3,
+	0x1.072f94bb9023dp-3, 0x1.0239d5406be88p-3, 0x1.fa93ecb6ba232p-4,
+	0x1.f0bff29528b67p-4, 0x1.e6f7bf29b1feap-4, 0x1.dd3b561776082p-4,
+	0x1.d38abb9be0731p-4, 0x1.c9e5f493be6bdp-4, 0x1.c04d0680b802cp-4,
+	0x1.b6bff78f34fb7p-4, 0x1.ad3ece9cb6128p-4, 0x1.a3c9933eacaf5p-4,
+	0x1.9a604dc9dc0fep-4, 0x1.9103075a50413p-4, 0x1.87b1c9dbf893ep-4,
+	0x1.7e6ca013f4e4dp-4, 0x1.753395aaa6d7fp-4, 0x1.6c06b7369a3e7p-4,
+	0x1.62e612485a445p-4, 0x1.59d1b5774bb6bp-4, 0x1.50c9b06fa7e17p-4,
+	0x1.47ce1401b7223p-4, 0x1.3edef2326e83cp-4, 0x1.35fc5e4d989d0p-4,
+	0x1.2d266cf9b7a28p-4, 0x1.245d344dd5460p-4, 0x1.1ba0cbe97ce08p-4,
+	0x1.12f14d0f259e6p-4, 0x1.0a4ed2c15d631p-4, 0x1.01b979e31226fp-4,
+	0x1.f262c2b6ce583p-5, 0x1.e16d547b2c47cp-5, 0x1.d092efeae600ap-5,
+	0x1.bfd3e0f289491p-5, 0x1.af3079038c597p-5, 0x1.9ea90f929b758p-5,
+	0x1.8e3e02a691375p-5, 0x1.7defb77af80c9p-5, 0x1.6dbe9b3992600p-5,
+	0x1.5dab23cf2ff69p-5, 0x1.4db5d0e1174f2p-5, 0x1.3ddf2ce993869p-5,
+	0x1.2e27ce83e3a4fp-5, 0x1.1e9059f1fac92p-5, 0x1.0f1982e96be0fp-5,
+	0x1.ff881d7191a2cp-6, 0x1.e121adb82f964p-6, 0x1.c301983cd6ea9p-6,
+	0x1.a529f4e234a42p-6, 0x1.879d1b6011823p-6, 0x1.6a5daf40c0f87p-6,
+	0x1.4d6eaf2fbf966p-6, 0x1.30d388daba032p-6, 0x1.1490334606b67p-6,
+	0x1.f152a4f734696p-7, 0x1.ba48d274febdcp-7, 0x1.841040d8df3cap-7,
+	0x1.4eb96421b129fp-7, 0x1.1a5922995660bp-7, 0x1.ce160f8ecbd47p-8,
+	0x1.69ea8d90cf658p-8, 0x1.08a1f03b0d9d6p-8, 0x1.55f9f43c1d644p-9,
+	0x1.4a605b6b9f70fp-10,
+};
+
+static const uint64_t _random_exp_k[256] = {
+	0x001c5214272497c5, 0x0000000000000000, 0x00137d5bd79c3125, 0x00186ef58e3f3bf1,
+	0x001a9bb7320eb09b, 0x001bd127f7194472, 0x001c951d0f886513, 0x001d1bfe2d5c3970,
+	0x001d7e5bd56b18b2, 0x001dc934dd172c6e, 0x001e0409dfac9dc8, 0x001e337b71d47835,
+	0x001e5a8b177cb7a0, 0x001e7b42096f046d, 0x001e970daf08ae3c, 0x001eaef5b14ef09e,
+	0x001ec3bd07b46557, 0x001ed5f6f08799cd, 0x001ee614ae6e5689, 0x001ef46eca361ccf,
+	0x001f014b76ddd4a3, 0x001f0ce313a796b5, 0x001f176369f1f77a, 0x001f20f20c452570,
+	0x001f29ae1951a875, 0x001f31b18fb95534, 0x001f39125157c107, 0x001f3fe2eb6e694c,
+	0x001f463332d788fb, 0x001f4c10bf1d3a11, 0x001f51874c5c3323, 0x001f56a109c3ecc1,
+	0x001f5b66d9099995, 0x001f5fe08210d08e, 0x001f6414dd445770, 0x001f6809f685967a,
+	0x001f6bc52a2b02e7, 0x001f6f4b3d32e4f4, 0x001f72a07190f139, 0x001f75c8974d09d9,
+	0x001f78c71b045cc0, 0x001f7b9f12413ff5, 0x001f7e5346079f8a, 0x001f80e63be21139,
+	0x001f835a3dad9162, 0x001f85b16056b913, 0x001f87ed89b24263, 0x001f8a10759374fc,
+	0x001f8c1bba3d39ad, 0x001f8e10cc45d04b, 0x001f8ff102013e16, 0x001f91bd968358e2,
+	0x001f9377ac47afd7, 0x001f95204f8b64db, 0x001f96b878633894, 0x001f98410c968891,
+	0x001f99bae146ba81, 0x001f9b26bc697f01, 0x001f9c85561b717a, 0x001f9dd759cfd804,
+	0x001f9f1d6761a1cf, 0x001fa058140936c0, 0x001fa187eb3a333b, 0x001fa2ad6f6bc4fc,
+	0x001fa3c91ace0683, 0x001fa4db5fee6aa3, 0x001fa5e4aa4d097f, 0x001fa6e55ee46782,
+	0x001fa7dddca51ec5, 0x001fa8ce7ce6a876, 0x001fa9b793ce5ff0, 0x001faa9970adb858,
+	0x001fab745e588231, 0x001fac48a3740585, 0x001fad1682bf9feb, 0x001fadde3b5782c2,
+	0x001faea008f21d6c, 0x001faf5c2418b07f, 0x001fb012c25b7a13, 0x001fb0c41681dff5,
+	0x001fb17050b6f1fc, 0x001fb2179eb29639, 0x001fb2ba2bdfa84b, 0x001fb358217f4e19,
+	0x001fb3f1a6c9be0d, 0x001fb486e10cacd7, 0x001fb517f3c793fe, 0x001fb5a500c5fdaa,
+	0x001fb62e2837fe5a, 0x001fb6b388c9010b, 0x001fb7353fb50798, 0x001fb7b368dc7da8,
+	0x001fb82e1ed6ba0a, 0x001fb8a57b0347f6, 0x001fb919959a0f74, 0x001fb98a85ba7204,
+	0x001fb9f861796f26, 0x001fba633deee287, 0x001fbacb2f41ec17, 0x001fbb3048b49145,
+	0x001fbb929caea4e4, 0x001fbbf23cc8029d, 0x001fbc4f39d22996, 0x001fbca9a3e140d5,
+	0x001fbd018a548fa0, 0x001fbd56fbde729c, 0x001fbdaa068bd66c, 0x001fbdfab7cb3f42,
+	0x001fbe491c7364df, 0x001fbe9540c96960, 0x001fbedf3086b129, 0x001fbf26f6de6175,
+	0x001fbf6c9e828ae3, 0x001fbfb031a904c4, 0x001fbff1ba0ffdb2, 0x001fc03141024589,
+	0x001fc06ecf5b54b4, 0x001fc0aa6d8b1428, 0x001fc0e42399698b, 0x001fc11bf9298a65,
+	0x001fc151f57d1943, 0x001fc1861f770f4c, 0x001fc1b87d9e74b4, 0x001fc1e91620ea43,
+	0x001fc217eed505df, 0x001fc2450d3c8400, 0x001fc27076864fc2, 0x001fc29a2f906310,
+	0x001fc2c23ce98046, 0x001fc2e8a2d2c6b5, 0x001fc30d654122ee, 0x001fc33087de9c0f,
+	0x001fc3520e0b7ec8, 0x001fc371fadf66f8, 0x001fc390512a2887, 0x001fc3ad137497fa,
+	0x001fc3c844013349, 0x001fc3e1e4ccab40, 0x001fc3f9f78e4da9, 0x001fc4107db85061,
+	0x001fc4257877fd68, 0x001fc438e8b5bfc7, 0x001fc44acf15112b, 0x001fc45b2bf447e9,
+	0x001fc469ff6c4505, 0x001fc477495001b2, 0x001fc483092bfbba, 0x001fc48d3e457ff7,
+	0x001fc495e799d21c, 0x001fc49d03dd30b1, 0x001fc4a29179b434, 0x001fc4a68e8e07fc,
+	0x001fc4a8f8ebfb8d, 0x001fc4a9ce16ea9f, 0x001fc4a90b41fa36, 0x001fc4a6ad4e28a1,
+	0x001fc4a2b0c82e76, 0x001fc49d11e62de3, 0x001fc495cc852df4, 0x001fc48cdc265ec1,
+	0x001fc4823bec237a, 0x001fc475e696dee7, 0x001fc467d6817e83, 0x001fc458059dc038,
+	0x001fc4466d702e22, 0x001fc433070bcb9a, 0x001fc41dcb0d6e0e, 0x001fc406b196bbf7,
+	0x001fc3edb248cb62, 0x001fc3d2c43e593e, 0x001fc3b5de0591b5, 0x001fc396f599614d,
+	0x001fc376005a4594, 0x001fc352f3069372, 0x001fc32dc1b2281b, 0x001fc3065fbd7888,
+	0x001fc2dcbfcbf264, 0x001fc2b0d3b99fa0, 0x001fc2828c8ffcf0, 0x001fc251da79f164,
+	0x001fc21eacb6d39e, 0x001fc1e8f18c6757, 0x001fc1b09637bb3d, 0x001fc17586dccd0f,
+	0x001fc137ae74d6b8, 0x001fc0f6f6bb2416, 0x001fc0b348184da4, 0x001fc06c898baff1,
+	0x001fc022a092f365, 0x001fbfd5710f72ba, 0x001fbf84dd294890, 0x001fbf30c52fc60d,
+	0x001fbed907770cc6, 0x001fbe7d80327ddc, 0x001fbe1e094ba615, 0x001fbdba7a354408,
+	0x001fbd52a7b9f826, 0x001fbce663c6201b, 0x001fbc757d2c4de5, 0x001fbbffbf63b7aa,
+	0x001fbb84f23fe6a2, 0x001fbb04d9a0d18e, 0x001fba7f351a70ad, 0x001fb9f3bf92b61a,
+	0x001fb9622ed4abfc, 0x001fb8ca33174a18, 0x001fb82b76765b54, 0x001fb7859c5b895d,
+	0x001fb6d840d55594, 0x001fb622f7d96943, 0x001fb5654c6f37e2, 0x001fb49ebfbf69d3,
+	0x001fb3cec803e747, 0x001fb2f4cf539c40, 0x001fb21032442854, 0x001fb1203e5a9605,
+	0x001fb0243042e1c3, 0x001faf1b31c479a7, 0x001fae045767e106, 0x001facde9dbf2d73,
+	0x001faba8e640060b, 0x001faa61f399ff29, 0x001fa908656f66a2, 0x001fa79ab3508d3d,
+	0x001fa61726d1f213, 0x001fa47bd48bea00, 0x001fa2c693c5c095, 0x001fa0f4f47df316,
+	0x001f9f04336bbe0b, 0x001f9cf12b79f9bd, 0x001f9ab84415abc5, 0x001f98555b782fb9,
+	0x001f95c3abd03f7a, 0x001f92fda9cef1f3, 0x001f8ffcda9ae41d, 0x001f8cb99e7385f8,
+	0x001f892aec479608, 0x001f8545f904db90, 0x001f80fdc336039b, 0x001f7c427839e926,
+	0x001f7700a3582ace, 0x001f71200f1a241d, 0x001f6a8234b7352c, 0x001f630000a8e267,
+	0x001f5a66904fe3c6, 0x001f50724ece1173, 0x001f44c7665c6fdb, 0x001f36e5a38a59a4,
+	0x001f261434503409, 0x001f113e047b0414, 0x001ef6aefa57cbe7, 0x001ed38ca188151e,
+	0x001ea2a61e122db2, 0x001e5961c78b267d, 0x001dddf62bac0bb1, 0x001cdb4dd9e4e8c0,
+};
+
+static const double _random_exp_w[256] = {
+	0x1.164ec94bf5dc3p-50, 0x1.0589d8b5d408fp-57, 0x1.ad6b2495b4cc6p-57,
+	0x1.19335a95b8d8ep-56, 0x1.522e6e54a2a4ep-56, 0x1.85090fbc27a5ep-56,
+	0x1.b38d1ef79b7aep-56, 0x1.decd8b76dbd7bp-56, 0x1.03bf049c65c2dp-55,
+	0x1.170db24d6f662p-55, 0x1.2980290da2625p-55, 0x1.3b388fe3d6ebdp-55,
+	0x1.4c515c60bfe16p-55, 0x1.5cdf89d024ab7p-55, 0x1.6cf40f0a72bb2p-55,
+	0x1.7c9cdda17d00ep-55, 0x1.8be5954d36063p-55, 0x1.9ad80552237c7p-55,
+	0x1.a97c8be5d51f8p-55, 0x1.b7da5dddda3b9p-55, 0x1.c5f7bd78c3f7fp-55,
+	0x1.d3da24df17c2dp-55, 0x1.e186678f17352p-55, 0x1.ef00ccf5f4fa3p-55,
+	0x1.fc4d25d683201p-55, 0x1.04b76ed6a7553p-54, 0x1.0b348479b80f7p-54,
+	0x1.119f38749f5aap-54, 0x1.17f8ceb4bdf9bp-54, 0x1.1e426e93e49e1p-54,
+	0x1.247d26538ff28p-54, 0x1.2aa9ee1236804p-54, 0x1.30c9aa526da45p-54,
+	0x1.36dd2e26d81fbp-54, 0x1.3ce53d121629ap-54, 0x1.42e28ca706742p-54,
+	0x1.48d5c5f35e70cp-54, 0x1.4ebf86bcd0b8dp-54, 0x1.54a0629786f47p-54,
+	0x1.5a78e3db8bef6p-54, 0x1.60498c7dd2ec8p-54, 0x1.6612d6d0c68dap-54,
+	0x1.6bd5362faa93ep-54, 0x1.71911797990b5p-54, 0x1.7746e2307796dp-54,
+	0x1.7cf6f7c7e816cp-54, 0x1.82a1b53fed593p-54, 0x1.884772f2be1e5p-54,
+	0x1.8de8850d0c523p-54, 0x1.93853bdfda23dp-54, 0x1.991de42ad1332p-54,
+	0x1.9eb2c75ff03b8p-54, 0x1.a4442be148844p-54, 0x1.a9d255396d25bp-54,
+	0x1.af5d844f224c2p-54, 0x1.b4e5f794c9795p-54, 0x1.ba6beb33f8f83p-54,
+	0x1.bfef99359fe92p-54, 0x1.c57139a70d298p-54, 0x1.caf102bc25ad4p-54,
+	0x1.d06f28ef0e6f4p-54, 0x1.d5ebdf1d86b87p-54, 0x1.db6756a429050p-54,
+	0x1.e0e1bf77c31f8p-54, 0x1.e65b483cf103ep-54, 0x1.ebd41e5e21b5dp-54,
+	0x1.f14c6e2029499p-54, 0x1.f6c462b57feb0p-54, 0x1.fc3c26504a99cp-54,
+	0x1.00d9f119a3cd6p-53, 0x1.0395df60db15fp-53, 0x1.0651f1c7276f5p-53,
+	0x1.090e3bb4b0070p-53, 0x1.0bcad03710135p-53, 0x1.0e87c207a2f64p-53,
+	0x1.114523917ac13p-53, 0x1.140306f707dbcp-53, 0x1.16c17e1777ff9p-53,
+	0x1.19809a93d2394p-53, 0x1.1c406dd3d5281p-53, 0x1.1f01090a9c4e0p-53,
+	0x1.21c27d3b10e04p-53, 0x1.2484db3c2a329p-53, 0x1.274833bd0189fp-53,
+	0x1.2a0c9748bcda9p-53, 0x1.2cd2164a53b5dp-53, 0x1.2f98c11031720p-53,
+	0x1.3260a7cfb7611p-53, 0x1.3529daa8a1ba0p-53, 0x1.37f469a851aefp-53,
+	0x1.3ac064ccfeffcp-53, 0x1.3d8ddc08d336ep-53, 0x1.405cdf44f09c4p-53,
+	0x1.432d7e6466cd0p-53, 0x1.45ffc94716ca7p-53, 0x1.48d3cfcc883c4p-53,
+	0x1.4ba9a1d6b18a5p-53, 0x1.4e814f4cb45ebp-53, 0x1.515ae81d900fcp-53,
+	0x1.54367c42cb5f9p-53, 0x1.57141bc316f27p-53, 0x1.59f3d6b4e9cfap-53,
+	0x1.5cd5bd4119336p-53, 0x1.5fb9dfa56cf28p-53, 0x1.62a04e3731a2fp-53,
+	0x1.65891965c9b8ep-53, 0x1.687451bd3ebf0p-53, 0x1.6b6207e8d3ce1p-53,
+	0x1.6e524cb59a609p-53, 0x1.714531150a9fcp-53, 0x1.743ac61fa041dp-53,
+	0x1.77331d177d131p-53, 0x1.7a2e476b1240cp-53, 0x1.7d2c56b7d17f9p-53,
+	0x1.802d5ccce7278p-53, 0x1.83316badfe62bp-53, 0x1.86389596108e8p-53,
+	0x1.8942ecfa40f55p-53, 0x1.8c50848cc6095p-53, 0x1.8f616f3fe1514p-53,
+	0x1.9275c048e73e2p-53, 0x1.958d8b235828bp-53, 0x1.98a8e3940bbf5p-53,
+	0x1.9bc7ddac7035ep-53, 0x1.9eea8dcdde952p-53, 0x1.a21108ad0592ep-53,
+	0x1.a53b63556c691p-53, 0x1.a869b32d0f310p-53, 0x1.ab9c0df81657bp-53,
+	0x1.aed289dcaad00p-53, 0x1.b20d3d66e8bb6p-53, 0x1.b54c3f8cf2543p-53,
+	0x1.b88fa7b324fb7p-53, 0x1.bbd78db072612p-53, 0x1.bf2409d2dfd87p-53,
+	0x1.c27534e42e02fp-53, 0x1.c5cb282eab1a7p-53, 0x1.c925fd82323fep-53,
+	0x1.cc85cf395a56ep-53, 0x1.cfeab83ed7182p-53, 0x1.d354d4130f2b0p-53,
+	0x1.d6c43ed1ea401p-53, 0x1.da391538da50cp-53, 0x1.ddb374ad23581p-53,
+	0x1.e1337b426509dp-53, 0x1.e4b947c16a454p-53, 0x1.e844f9af42381p-53,
+	0x1.ebd6b154a767ap-53, 0x1.ef6e8fc5b9169p-53, 0x1.f30cb6ea0bc81p-53,
+	0x1.f6b1498515ed1p-53, 0x1.fa5c6b3efe1e6p-53, 0x1.fe0e40add09d9p-53,
+	0x1.00e377af911d5p-52, 0x1.02c34ef11391bp-52, 0x1.04a6b9e9224a3p-52,
+	0x1.068dccf1126dbp-52, 0x1.08789cf3aad0fp-52, 0x1.0a673f733c81ap-52,
+	0x1.0c59ca9009470p-52, 0x1.0e50550efcfb8p-52, 0x1.104af660befcfp-52,
+	0x1.1249c6a92154bp-52, 0x1.144cdec6f3a2cp-52, 0x1.1654585c404c1p-52,
+	0x1.18604dd6fae9ep-52, 0x1.1a70da7a27821p-52, 0x1.1c861a6782a5bp-52,
+	0x1.1ea02aa9b3371p-52, 0x1.20bf293f0f4a2p-52, 0x1.22e33524fe550p-52,
+	0x1.250c6e6403bbap-52, 0x1.273af61c7daa6p-52, 0x1.296eee942532bp-52,
+	0x1.2ba87b445db50p-52, 0x1.2de7c0e962d70p-52, 0x1.302ce59265964p-52,
+	0x1.327810b2aa7cfp-52, 0x1.34c96b33bc965p-52, 0x1.37211f88ca856p-52,
+	0x1.397f59c345143p-52, 0x1.3be447a8d8b83p-52, 0x1.3e5018caddecfp-52,
+	0x1.40c2fe9f5eeadp-52, 0x1.433d2c9bd42f8p-52, 0x1.45bed851bc92cp-52,
+	0x1.4848398d39432p-52, 0x1.4ad98a75da14cp-52, 0x1.4d7307b1cb127p-52,
+	0x1.5014f08b99508p-52, 0x1.52bf871acaab1p-52, 0x1.5573106f8a759p-52,
+	0x1.582fd4c1b4460p-52, 0x1.5af61fa38e106p-52, 0x1.5dc640388bd9cp-52,
+	0x1.60a0897081877p-52, 0x1.63855247b2e93p-52, 0x1.6674f60c3f431p-52,
+	0x1.696fd4a9748eep-52, 0x1.6c7652f9a7b1ep-52, 0x1.6f88db1f42507p-52,
+	0x1.72a7dce5cd218p-52, 0x1.75d3ce2bd71c3p-52, 0x1.790d2b56b71f9p-52,
+	0x1.7c5477d1476d3p-52, 0x1.7faa3e96e1412p-52, 0x1.830f12cc0bec3p-52,
+	0x1.8683906687341p-52, 0x1.8a085ce695baap-52, 0x1.8d9e2823b3695p-52,
+	0x1.9145ad2f37543p-52, 0x1.94ffb34fc2a0dp-52, 0x1.98cd0f18d1ad7p-52,
+	0x1.9caea3a24d9e9p-52, 0x1.a0a563e49f177p-52, 0x1.a4b2543e84c3ap-52,
+	0x1.a8d68c2ad86e8p-52, 0x1.ad13382d845c3p-52, 0x1.b1699c003b608p-52,
+	0x1.b5db15091ea0ep-52, 0x1.ba691d276da5dp-52, 0x1.bf154de4bef76p-52,
+	0x1.c3e1641c2e0a6p-52, 0x1.c8cf442c8c8f3p-52, 0x1.cde0fecf2a97fp-52,
+	0x1.d318d6b2738c5p-52, 0x1.d87946fec3becp-52, 0x1.de050af4ef19fp-52,
+	0x1.e3bf26e190960p-52, 0x1.e9aaf2af383c1p-52, 0x1.efcc26750ea4ap-52,
+	0x1.f626e9791f7a7p-52, 0x1.fcbfe43f6c6e6p-52, 0x1.01ce2b362ec2ep-51,
+	0x1.056118bf58eefp-51, 0x1.091c1cdcba54ep-51, 0x1.0d031785d48a0p-51,
+	0x1.111a8034392a6p-51, 0x1.156786775442ap-51, 0x1.19f03bcb3c2d6p-51,
+	0x1.1ebbca0c9fa7cp-51, 0x1.23d2bb659919fp-51, 0x1.293f5ae49aaa5p-51,
+	0x1.2f0e38a4411f0p-51, 0x1.354ee27ccf75dp-51, 0x1.3c14ec7c8b860p-51,
+	0x1.4379766e41361p-51, 0x1.4b9d7cd4751d0p-51, 0x1.54ad83ccf73f5p-51,
+	0x1.5ee7ae17313d2p-51, 0x1.6aa676d4bbf72p-51, 0x1.78750d6eac62fp-51,
+	0x1.8939fe6f2ed19p-51, 0x1.9e9dc0d487b85p-51, 0x1.bc39e51da71fcp-51,
+	0x1.ec9d9297ebb83p-51,
+};
+
+static const double _random_exp_f[256] = {
+	0x1.0000000000000p+0, 0x1.e0545e5881147p-1, 0x1.cd0a65081fffcp-1,
+	0x1.be5007beb7b31p-1, 0x1.b210f0ee67f32p-1, 0x1.a76baa562faeep-1,
+	0x1.9de9715556da1p-1, 0x1.95431c455aa3fp-1, 0x1.8d4a376d3d235p-1,
+	0x1.85de87806c5bdp-1, 0x1.7ee8a2d24312bp-1, 0x1.7856e9b09d483p-1,
+	0x1.721bb5ba94b67p-1, 0x1.6c2c3498418cap-1, 0x1.667fa6d4f5c0ap-1,
+	0x1.610edc1a7af6ap-1, 0x1.5bd3d694cac79p-1, 0x1.56c9882da8777p-1,
+	0x1.51eba1578899ep-1, 0x1.4d366c151f8b2p-1, 0x1.48a6afb8ee06cp-1,
+	0x1.44399afa8e128p-1, 0x1.3fecb2bb18b82p-1, 0x1.3bbdc44e1d116p-1,
+	0x1.37aada708dddcp-1, 0x1.33b23450e631bp-1, 0x1.2fd23e345da61p-1,
+	0x1.2c098b61f4f27p-1, 0x1.2856d111132c0p-1, 0x1.24b8e228c50a6p-1,
+	0x1.212eaba813eccp-1, 0x1.1db7319877b8dp-1, 0x1.1a518c71e3b29p-1,
+	0x1.16fce6dce6ff2p-1, 0x1.13b87bc33169fp-1, 0x1.108394a1cc390p-1,
+	0x1.0d5d8812b1e2ep-1, 0x1.0a45b8854d02dp-1, 0x1.073b931ee3b80p-1,
+	0x1.043e8ebd2654bp-1, 0x1.014e2b160f327p-1, 0x1.fcd3dfe21457cp-2,
+	0x1.f722d8ebfc600p-2, 0x1.f1886d1eb4253p-2, 0x1.ec03d4b969d96p-2,
+	0x1.e6945367dd357p-2, 0x1.e139375e13802p-2, 0x1.dbf1d88a72112p-2,
+	0x1.d6bd97db9ed80p-2, 0x1.d19bde97e1a11p-2, 0x1.cc8c1dc40e098p-2,
+	0x1.c78dcd983fb66p-2, 0x1.c2a06d00ea588p-2, 0x1.bdc3812aeeebbp-2,
+	0x1.b8f6951990b8ep-2, 0x1.b439394548075p-2, 0x1.af8b03428ef65p-2,
+	0x1.aaeb8d6fdf6ebp-2, 0x1.a65a76aa30145p-2, 0x1.a1d76207521f9p-2,
+	0x1.9d61f695a3797p-2, 0x1.98f9df2097badp-2, 0x1.949ec9f9a8115p-2,
+	0x1.905068c545d09p-2, 0x1.8c0e704b75d3ep-2, 0x1.87d8984bc3f90p-2,
+	0x1.83ae9b544613dp-2, 0x1.7f90369b6ce5dp-2, 0x1.7b7d29dc68022p-2,
+	0x1.77753735e72e7p-2, 0x1.7378230b08deep-2, 0x1.6f85b3e649ea1p-2,
+	0x1.6b9db25e4e99fp-2, 0x1.67bfe8fc60da1p-2, 0x1.63ec2424827e7p-2,
+	0x1.602231fef5879p-2, 0x1.5c61e2631ee6fp-2, 0x1.58ab06c3aa9f1p-2,
+	0x1.54fd721bda3e9p-2, 0x1.5158f8dde89f7p-2, 0x1.4dbd70e26f920p-2,
+	0x1.4a2ab158bdad4p-2, 0x1.46a092b80beefp-2, 0x1.431eeeb1841e2p-2,
+	0x1.3fa5a0230a14fp-2, 0x1.3c34830abb285p-2, 0x1.38cb747b17defp-2,
+	0x1.356a528fcd0ddp-2, 0x1.3210fc6312436p-2, 0x1.2ebf520394271p-2,
+	0x1.2b75346ae2263p-2, 0x1.2832857457628p-2, 0x1.24f727d4776fdp-2,
+	0x1.21c2ff10b7effp-2, 0x1.1e95ef77b09dap-2, 0x1.1b6fde19abc59p-2,
+	0x1.1850b0c191981p-2, 0x1.15384dee291eep-2, 0x1.12269ccba9fb9p-2,
+	0x1.0f1b852d9a66bp-2, 0x1.0c16ef88f5332p-2, 0x1.0918c4ee93e12p-2,
+	0x1.0620ef05d90d1p-2, 0x1.032f580797c2bp-2, 0x1.0043eab934769p-2,
+	0x1.fabd24cff9351p-3, 0x1.f4fe75c963e7bp-3, 0x1.ef4ba0fe8e098p-3,
+	0x1.e9a48005940efp-3, 0x1.e408ed62f83a4p-3, 0x1.de78c48224f37p-3,
+	0x1.d8f3e1ae3eeb6p-3, 0x1.d37a220b431fap-3, 0x1.ce0b638f6d09bp-3,
+	0x1.c8a784fce17ffp-3, 0x1.c34e65db9afecp-3, 0x1.bdffe67394433p-3,
+	0x1.b8bbe7c72e4a3p-3, 0x1.b3824b8dcef3cp-3, 0x1.ae52f42eb5b0ap-3,
+	0x1.a92dc4bc03c47p-3, 0x1.a412a0edf5cbap-3, 0x1.9f016d1e4c510p-3,
+	0x1.99fa0e43e1621p-3, 0x1.94fc69ee6929fp-3, 0x1.900866425bb78p-3,
+	0x1.8b1de9f5062d3p-3, 0x1.863cdc48c1af8p-3, 0x1.816525094e7e4p-3,
+	0x1.7c96ac8851badp-3, 0x1.77d15b99f46fdp-3, 0x1.73151b91a2838p-3,
+	0x1.6e61d63ee84e9p-3, 0x1.69b775ea6da26p-3, 0x1.6515e5530d1a9p-3,
+	0x1.607d0fab06a2ep-3, 0x1.5bece0954c2b2p-3, 0x1.57654422e78f1p-3,
+	0x1.52e626d078c46p-3, 0x1.4e6f7583cb6f7p-3, 0x1.4a011d8983093p-3,
+	0x1.459b0c92dccc3p-3, 0x1.413d30b386a97p-3, 0x1.3ce7785f8a903p-3,
+	0x1.3899d2694d5c7p-3, 0x1.34542dffa0cadp-3, 0x1.30167aabe7d6cp-3,
+	0x1.2be0a8504cf32p-3, 0x1.27b2a7260993ep-3, 0x1.238c67bbbe876p-3,
+	0x1.1f6ddaf3dca63p-3, 0x1.1b56f2031d665p-3, 0x1.17479e6f0ae77p-3,
+	0x1.133fd20c9712ep-3, 0x1.0f3f7efec171fp-3, 0x1.0b4697b54b62fp-3,
+	0x1.07550eeb7a5bfp-3, 0x1.036ad7a6e7f04p-3, 0x1.ff0fca6cbea8bp-4,
+	0x1.f758566190412p-4, 0x1.efaf3ae83c339p-4, 0x1.e8146048eb9c9p-4,
+	0x1.e087af561baf8p-4, 0x1.d909116ad9396p-4, 0x1.d198706914dd5p-4,
+	0x1.ca35b6b80fd56p-4, 0x1.c2e0cf42e10adp-4, 0x1.bb99a5771268cp-4,
+	0x1.b460254356546p-4, 0x1.ad343b1655464p-4, 0x1.a615d3dd938b6p-4,
+	0x1.9f04dd046f428p-4, 0x1.9801447336b70p-4, 0x1.910af88e574bap-4,
+	0x1.8a21e835a533dp-4, 0x1.834602c3bc4bbp-4, 0x1.7c77380d7a6f5p-4,
+	0x1.75b5786193c21p-4, 0x1.6f00b488416b8p-4, 0x1.6858ddc30b621p-4,
+	0x1.61bde5ccadef8p-4, 0x1.5b2fbed91bb40p-4, 0x1.54ae5b959d037p-4,
+	0x1.4e39af290d929p-4, 0x1.47d1ad343985cp-4, 0x1.417649d25b10fp-4,
+	0x1.3b277999b9f9fp-4, 0x1.34e5319c6e718p-4, 0x1.2eaf676948dd1p-4,
+	0x1.2886110ce0571p-4, 0x1.22692512c9d8dp-4, 0x1.1c589a86fa342p-4,
+	0x1.165468f755395p-4, 0x1.105c88756ca53p-4, 0x1.0a70f19871b3fp-4,
+	0x1.04919d7f5c81ap-4, 0x1.fd7d0ba69967cp-5, 0x1.f1ef49944e838p-5,
+	0x1.e679ea52eb2e7p-5, 0x1.db1ce49315810p-5, 0x1.cfd83031e7949p-5,
+	0x1.c4abc640721e8p-5, 0x1.b997a10bed984p-5, 0x1.ae9bbc26a8083p-5,
+	0x1.a3b81471bf138p-5, 0x1.98eca827b7c4dp-5, 0x1.8e3976e80776ep-5,
+	0x1.839e81c3a396dp-5, 0x1.791bcb4ab08a0p-5, 0x1.6eb1579b6af53p-5,
+	0x1.645f2c726a043p-5, 0x1.5a25513c5d2cdp-5, 0x1.5003cf296c5eep-5,
+	0x1.45fab14266b1bp-5, 0x1.3c0a047ff1901p-5, 0x1.3231d7e3f14b1p-5,
+	0x1.28723c956c00fp-5, 0x1.1ecb45ff312d7p-5, 0x1.153d09f19b3a5p-5,
+	0x1.0bc7a0c7cd654p-5, 0x1.026b2590dfaf0p-5, 0x1.f24f6c7af9895p-6,
+	0x1.dffae7a51746dp-6, 0x1.cdd9054331b0fp-6, 0x1.bbea150fa5871p-6,
+	0x1.aa2e6e6924e9cp-6, 0x1.98a670f132a49p-6, 0x1.8752853ec9968p-6,
+	0x1.76331da87fc96p-6, 0x1.6548b72a24077p-6, 0x1.5493da6ab0250p-6,
+	0x1.44151ce87f0bdp-6, 0x1.33cd225315d82p-6, 0x1.23bc9e1b93a30p-6,
+	0x1.13e4554725f5dp-6, 0x1.04452091e02eep-6, 0x1.e9bfdde89c7cep-7,
+	0x1.cb6b9146e275ap-7, 0x1.ad8fa5542c92dp-7, 0x1.902ea688fa7bbp-7,
+	0x1.734b6e6aa74f7p-7, 0x1.56e930be416ccp-7, 0x1.3b0b8c1516f63p-7,
+	0x1.1fb69edb37672p-7, 0x1.04ef2295fd7fbp-7, 0x1.d5751fa745dcdp-8,
+	0x1.a23e9d497483bp-8, 0x1.7049f37ec3627p-8, 0x1.3fa97cee32301p-8,
+	0x1.1073d69574045p-8, 0x1.c58b381cd4b11p-9, 0x1.6d888f3a1fefep-9,
+	0x1.1946ba8e1a326p-9, 0x1.92bb5540c3e26p-10, 0x1.fb20af78dfcb7p-11,
+	0x1.dc31c329f0b48p-12,
+};
+
+// one layer pick, true if the value is inside the layer's rectangle (about 98.5% of the time)
+static _attr_always_inline bool _random_normal_try(uint64_t r, size_t *ret_layer, double *ret_x)
+{
+	size_t i = r & 0xff;
+	uint64_t rabs = r >> 12;
+	// (branchless, the sign is unpredictable)
+	double x = rabs * _random_normal_w[i];
+	uint64_t bits;
+	memcpy(&bits, &x, sizeof(bits));
+	bits |= ((r >> 8) & 1) << 63;
+	memcpy(&x, &bits, sizeof(x));
+	*ret_layer = i;
+	*ret_x = x;
+	return rabs < _random_normal_k[i];
+}
+
+// the base layer's tail and the wedges, kept out of line so that the fast path stays small
+static _attr_noinline double _random_normal_slow(_random_source_func next, void *source, size_t i, double x)
+{
+	for (;;) {
+		if (i == 0) {
+			// the tail beyond r
+			for (;;) {
+				double xx = -__RANDOM_NORMAL_INV_R * log1p(-_random_uniform(next, source));
+				double yy = -log1p(-_random_uniform(next, source));
+				if (yy + yy > xx * xx) {
+					return signbit(x) ? -(__RANDOM_NORMAL_R + xx) : __RANDOM_NORMAL_R + xx;
+				}
+			}
+		}
+		double f = _random_normal_f[i];
+		if ((_random_normal_f[i - 1] - f) * _random_uniform(next, source) + f < exp(-0.5 * x * x)) {
+			return x;
+		}
+		if (_random_normal_try(next(source), &i, &x)) {
+			return x;
+		}
+	}
+}
+
+static _attr_always_inline double _random_normal(_random_source_func next, void *source)
+{
+	size_t i;
+	double x;
+	if (likely(_random_normal_try(next(source), &i, &x))) {
+		return x;
+	}
+	return _random_normal_slow(next, source, i, x);
+}
+
+static _attr_always_inline bool _random_exponential_try(uint64_t r, size_t *ret_layer, double *ret_x)
+{
+	size_t i = r & 0xff;
+	r >>= 11;
+	*ret_layer = i;
+	*ret_x = r * _random_exp_w[i];
+	return r < _random_exp_k[i];
+}
+
+static _attr_noinline double _random_exponential_slow(_random_source_func next, void *source, size_t i, double x)
+{
+	for (;;) {
+		if (i == 0) {
+			// the tail is memoryless
+			return __RANDOM_EXP_R - log1p(-_random_uniform(next, source));
+		}
+		double f = _random_exp_f[i];
+		if ((_random_exp_f[i - 1] - f) * _random_uniform(next, source) + f < exp(-x)) {
+			return x;
+		}
+		if (_random_exponential_try(next(source), &i, &x)) {
+			return x;
+		}
+	}
+}
+
+static _attr_always_inline double _random_exponential(_random_source_func next, void *source)
+{
+	size_t i;
+	double x;
+	if (likely(_random_exponential_try(next(source), &i, &x))) {
+		return x;
+	}
+	return _random_exponential_slow(next, source, i, x);
+}
+
+static _attr_always_inline double _random_scaled_normal(_random_source_func next, void *source, double mean,
+							 double stddev)
+{
+	return mean + stddev * _random_normal(next, source);
+}
+
+static _attr_always_inline double _random_scaled_exponential(_random_source_func next, void *source,
+							      double inv_lambda)
+{
+	return inv_lambda * _random_exponential(next, source);
+}
+
+__AD_LINKAGE double random_next_normal(struct random_state *state, double mean, double stddev)
+{
+	return _random_scaled_normal(_random_source_state, state, mean, stddev);
+}
+
+__AD_LINKAGE double random_next_exponential(struct random_state *state, double lambda)
+{
+	assert(lambda > 0);
+	return _random_scaled_exponential(_random_source_state, state, 1.0 / lambda);
+}
+
+__AD_LINKAGE void random_fill_normal(struct random_state *state, double *buf, size_t n, double mean, double stddev)
+{
+	__RANDOM_FILL_WITH(state, buf, n, _random_scaled_normal, mean, stddev);
+}
+
+__AD_LINKAGE void random_fill_exponential(struct random_state *state, double *buf, size_t n, double lambda)
+{
+	assert(lambda > 0);
+	__RANDOM_FILL_WITH(state, buf, n, _random_scaled_exponential, 1.0 / lambda);
+}
+
+/* Zipf by rejection-inversion (Hörmann and Derflinger, "Rejection-inversion to generate variates from monotone
+ * discrete distributions"): invert the integral H of the hat function h(x) = x^-s and accept almost always without
+ * evaluating the probabilities, so sampling is O(1) for any n and no table is needed.
+ */
+
+// log1p(x) / x and expm1(x) / x, without the cancellation around 0
+static double _random_zipf_helper1(double x)
+{
+	return fabs(x) > 1e-8 ? log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+}
+
+static double _random_zipf_helper2(double x)
+{
+	return fabs(x) > 1e-8 ? expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x));
+}
+
+static double _random_zipf_h(const struct random_zipf *zipf, double x)
+{
+	return exp(-zipf->_s * log(x));
+}
+
+static double _random_zipf_h_integral(const struct random_zipf *zipf, double x)
+{
+	double log_x = log(x);
+	return _random_zipf_helper2((1.0 - zipf->_s) * log_x) * log_x;
+}
+
+static double _random_zipf_h_integral_inverse(const struct random_zipf *zipf, double x)
+{
+	double t = x * (1.0 - zipf->_s);
+	if (t < -1.0) {
+		t = -1.0;
+	}
+	return exp(_random_zipf_helper1(t) * x);
+}
+
+__AD_LINKAGE void random_zipf_init(struct random_zipf *zipf, uint64_t n, double s)
+{
+	assert(n != 0 && s >= 0);
+	zipf->_n = n;
+	zipf->_s = s;
+	zipf->_h_integral_x1 = _random_zipf_h_integral(zipf, 1.5) - 1.0;
+	zipf->_h_integral_n = _random_zipf_h_integral(zipf, n + 0.5);
+	zipf->_squeeze = 2.0 - _random_zipf_h_integral_inverse(zipf, _random_zipf_h_integral(zipf, 2.5) -
+							        _random_zipf_h(zipf, 2.0));
+}
+
+static _attr_always_inline uint64_t _random_zipf(_random_source_func next, void *source,
+						  const struct random_zipf *zipf)
+{
+	for (;;) {
+		double u = zipf->_h_integral_n +
+			_random_uniform(next, source) * (zipf->_h_integral_x1 - zipf->_h_integral_n);
+		double x = _random_zipf_h_integral_inverse(zipf, u);
+		double k = floor(x + 0.5);
+		if (k < 1.0) {
+			k = 1.0;
+		} else if (k > zipf->_n) {
+			k = zipf->_n;
+		}
+		if (k - x <= zipf->_squeeze || u >= _random_zipf_h_integral(zipf, k + 0.5) - _random_zipf_h(zipf, k)) {
+			return (uint64_t)k - 1;
+		}
+	}
+}
+
+__AD_LINKAGE uint64_t random_next_zipf(struct random_state *state, const struct random_zipf *zipf)
+{
+	return _random_zipf(_random_source_state, state, zipf);
+}
+
+__AD_LINKAGE void random_fill_zipf(struct random_state *state, const struct random_zipf *zipf, uint64_t *buf,
+				   size_t n)
+{
+	__RANDOM_FILL_WITH(state, buf, n, _random_zipf, zipf);
+}
+
+/* Poisson: multiplication of uniforms for small lambda, otherwise PTRS (transformed rejection with squeeze,
+ * Hörmann, "The transformed rejection method for generating Poisson random variables"), which needs about
+ * 1.1 pairs of uniforms and accepts most of them without evaluating the probabilities.
+ */
+
+struct _random_poisson {
+	double lambda;
+	double exp_minus_lambda;
+	double log_lambda;
+	double a, b;
+	double inv_alpha;
+	double vr;
+};
+
+static void _random_poisson_init(struct _random_poisson *params, double lambda)
+{
+	assert(lambda >= 0);
+	params->lambda = lambda;
+	params->exp_minus_lambda = exp(-lambda);
+	if (lambda >= 10.0) {
+		double sqrt_lambda = sqrt(lambda);
+		params->log_lambda = log(lambda);
+		params->b = 0.931 + 2.53 * sqrt_lambda;
+		params->a = -0.059 + 0.02483 * params->b;
+		params->inv_alpha = 1.1239 + 1.1328 / (params->b - 3.4);
+		params->vr = 0.9277 - 3.6224 / (params->b - 2.0);
+	}
+}
+
+static _attr_always_inline uint64_t _random_poisson(_random_source_func next, void *source,
+						     const struct _random_poisson *params)
+{
+	if (params->lambda < 10.0) {
+		uint64_t k = 0;
+		double product = _random_uniform(next, source);
+		while (product > params->exp_minus_lambda) {
+			k++;
+			product *= _random_uniform(next, source);
+		}
+		return k;
+	}
+	const double a = params->a, b = params->b;
+	for (;;) {
+		double u = _random_uniform(next, source) - 0.5;
+		double v = _random_uniform(next, source);
+		double us = 0.5 - fabs(u);
+		double k = floor((2.0 * a / us + b) * u + params->lambda + 0.43);
+		if (us >= 0.07 && v <= params->vr) {
+			return (uint64_t)k;
+		}
+		if (k < 0.0 || (us < 0.013 && v > us)) {
+			continue;
+		}
+		if (log(v * params->inv_alpha / (a / (us * us) + b)) <=
+		    -params->lambda + k * params->log_lambda - _random_log_gamma(k + 1.0)) {
+			return (uint64_t)k;
+		}
+	}
+}
+
+__AD_LINKAGE uint64_t random_next_poisson(struct random_state *state, double lambda)
+{
+	struct _random_poisson params;
+	_random_poisson_init(&params, lambda);
+	return _random_poisson(_random_source_state, state, &params);
+}
+
+__AD_LINKAGE void random_fill_poisson(struct random_state *state, uint64_t *buf, size_t n, double lambda)
+{
+	struct _random_poisson params;
+	_random_poisson_init(&params, lambda);
+	__RANDOM_FILL_WITH(state, buf, n, _random_poisson, &params);
+}
+
+/* Binomial: inversion (walking up the probabilities from 0) if n * min(p, 1 - p) < 10, otherwise BTRS
+ * (Hörmann, "The generation of binomial random variates"). p > 1/2 is sampled as n minus the count of failures.
+ */
+
+struct _random_binomial {
+	uint64_t n;
+	double p, q;
+	bool flip;
+	// inversion
+	double q_pow_n;
+	double bound;
+	// BTRS
+	double a, b, c;
+	double alpha;
+	double vr;
+	double m;
+	double h;
+	double log_p_over_q;
+};
+
+static void _random_binomial_init(struct _random_binomial *params, uint64_t n, double p)
+{
+	assert(p >= 0 && p <= 1);
+	params->n = n;
+	params->flip = p > 0.5;
+	if (params->flip) {
+		p = 1.0 - p;
+	}
+	double q = 1.0 - p;
+	double np = n * p;
+	params->p = p;
+	params->q = q;
+	if (np < 10.0) {
+		params->q_pow_n = exp(n * log1p(-p));
+		params->bound = fmin(n, np + 10.0 * sqrt(np * q + 1.0));
+	} else {
+		double stddev = sqrt(np * q);
+		params->b = 1.15 + 2.53 * stddev;
+		params->a = -0.0873 + 0.0248 * params->b + 0.01 * p;
+		params->c = np + 0.5;
+		params->alpha = (2.83 + 5.1 / params->b) * stddev;
+		params->vr = 0.92 - 4.2 / params->b;
+		params->m = floor((n + 1) * p);
+		params->h = _random_log_gamma(params->m + 1.0) + _random_log_gamma(n - params->m + 1.0);
+		params->log_p_over_q = log(p / q);
+	}
+}
+
+static _attr_always_inline uint64_t _random_binomial_unflipped(_random_source_func next, void *source,
+								const struct _random_binomial *params)
+{
+	const double n = params->n, p = params->p, q = params->q;
+	if (n * p < 10.0) {
+		if (p == 0.0) {
+			return 0;
+		}
+		for (;;) {
+			double u = _random_uniform(next, source);
+			double px = params->q_pow_n;
+			uint64_t k = 0;
+			while (u > px) {
+				k++;
+				if (k > params->bound) {
+					break;
+				}
+				u -= px;
+				px *= ((n - k + 1) * p) / (k * q);
+			}
+			if (k <= params->bound) {
+				return k;
+			}
+		}
+	}
+	const double a = params->a, b = params->b;
+	for (;;) {
+		double u = _random_uniform(next, source) - 0.5;
+		double v = _random_uniform(next, source);
+		double us = 0.5 - fabs(u);
+		double k = floor((2.0 * a / us + b) * u + params->c);
+		if (k < 0.0 || k > n) {
+			continue;
+		}
+		if (us >= 0.07 && v <= params->vr) {
+			return (uint64_t)k;
+		}
+		v = log(v * params->alpha / (a / (us * us) + b));
+		if (v <= params->h - _random_log_gamma(k + 1.0) - _random_log_gamma(n - k + 1.0) +
+		    (k - params->m) * params->log_p_over_q) {
+			return (uint64_t)k;
+		}
+	}
+}
+
+static _attr_always_inline uint64_t _random_binomial(_random_source_func next, void *source,
+						      const struct _random_binomial *params)
+{
+	uint64_t k = _random_binomial_unflipped(next, source, params);
+	return params->flip ? params->n - k : k;
+}
+
+__AD_LINKAGE uint64_t random_next_binomial(struct random_state *state, uint64_t n, double p)
+{
+	struct _random_binomial params;
+	_random_binomial_init(&params, n, p);
+	return _random_binomial(_random_source_state, state, &params);
+}
+
+__AD_LINKAGE void random_fill_binomial(struct random_state *state, uint64_t *buf, size_t count, uint64_t n,
+				       double p)
+{
+	struct _random_binomial params;
+	_random_binomial_init(&params, n, p);
+	__RANDOM_FILL_WITH(state, buf, count, _random_binomial, &params);
+}
+
+
+/* Philox4x32-10 (Salmon, Moraes, Dror and Shaw, "Parallel random numbers: as easy as 1, 2, 3"): a counter-based
+ * generator, the output is a bijection of the counter keyed by the key, so any value can be computed on its own
+ * and blocks of counters are independent (and vectorize).
+ */
+
+#define __RANDOM_PHILOX_M0 UINT32_C(0xd2511f53)
+#define __RANDOM_PHILOX_M1 UINT32_C(0xcd9e8d57)
+#define __RANDOM_PHILOX_W0 UINT32_C(0x9e3779b9)
+#define __RANDOM_PHILOX_W1 UINT32_C(0xbb67ae85)
+
+__AD_LINKAGE void random_philox4x32(const uint32_t key[2], const uint32_t counter[4], uint32_t out[4])
+{
+	uint32_t k0 = key[0], k1 = key[1];
+	uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+	for (unsigned int round = 0; round < 10; round++) {
+		uint64_t p0 = (uint64_t)__RANDOM_PHILOX_M0 * c0;
+		uint64_t p1 = (uint64_t)__RANDOM_PHILOX_M1 * c2;
+		c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+		c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+		c1 = (uint32_t)p1;
+		c3 = (uint32_t)p0;
+		k0 += __RANDOM_PHILOX_W0;
+		k1 += __RANDOM_PHILOX_W1;
+	}
+	out[0] = c0;
+	out[1] = c1;
+	out[2] = c2;
+	out[3] = c3;
+}
+
+// value 'counter' is half of the 128-bit block counter / 2 (the low half for even counters)
+__AD_LINKAGE uint64_t random_at(uint64_t key, uint64_t counter)
+{
+	const uint32_t k[2] = {(uint32_t)key, (uint32_t)(key >> 32)};
+	const uint32_t c[4] = {(uint32_t)(counter >> 1), (uint32_t)(counter >> 33), 0, 0};
+	uint32_t out[4];
+	random_philox4x32(k, c, out);
+	return counter & 1 ? out[2] | (uint64_t)out[3] << 32 : out[0] | (uint64_t)out[1] << 32;
+}
+
+// count blocks starting at 'block', the two values of block j are out[2 * j] and out[2 * j + 1]
+static _attr_noinline void _random_philox_default(uint64_t key, uint64_t block, uint64_t *out, size_t count)
+{
+	const uint32_t k[2] = {(uint32_t)key, (uint32_t)(key >> 32)};
+	for (size_t i = 0; i < count; i++) {
+		const uint32_t c[4] = {(uint32_t)(block + i), (uint32_t)((block + i) >> 32), 0, 0};
+		uint32_t words[4];
+		random_philox4x32(k, c, words);
+		out[2 * i] = words[0] | (uint64_t)words[1] << 32;
+		out[2 * i + 1] = words[2] | (uint64_t)words[3] << 32;
+	}
+}
+
+#if defined(HAVE_CPU_DISPATCH) && defined(HAVE_ATTR_VECTOR_SIZE)
+// AVX2 has no 64-bit multiplication, but vpmuludq is exactly the 32x32->64 bit product Philox needs
+static _attr_noinline _attr_target("avx2") void _random_philox_avx2(uint64_t key, uint64_t block, uint64_t *out,
+								      size_t count)
+{
+	const __m256i m0 = _mm256_set1_epi64x(__RANDOM_PHILOX_M0);
+	const __m256i m1 = _mm256_set1_epi64x(__RANDOM_PHILOX_M1);
+	const __m256i low = _mm256_set1_epi64x(UINT32_MAX);
+	for (size_t i = 0; i < count; i += 8) {
+		__m256i c0[2], c1[2], c2[2], c3[2];
+		for (size_t h = 0; h < 2; h++) {
+			__m256i b = _mm256_add_epi64(_mm256_set1_epi64x(block + i + 4 * h),
+						     _mm256_setr_epi64x(0, 1, 2, 3));
+			c0[h] = _mm256_and_si256(b, low);
+			c1[h] = _mm256_srli_epi64(b, 32);
+			c2[h] = _mm256_setzero_si256();
+			c3[h] = _mm256_setzero_si256();
+		}
+		uint32_t k0 = (uint32_t)key, k1 = (uint32_t)(key >> 32);
+		for (unsigned int round = 0; round < 10; round++) {
+			const __m256i vk0 = _mm256_set1_epi64x(k0), vk1 = _mm256_set1_epi64x(k1);
+			for (size_t h = 0; h < 2; h++) {
+				__m256i p0 = _mm256_mul_epu32(c0[h], m0);
+				__m256i p1 = _mm256_mul_epu32(c2[h], m1);
+				c0[h] = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p1, 32), c1[h]), vk0);
+				c2[h] = _mm256_xor_si256(_mm256_xor_si256(_mm256_srli_epi64(p0, 32), c3[h]), vk1);
+				c1[h] = _mm256_and_si256(p1, low);
+				c3[h] = _mm256_and_si256(p0, low);
+			}
+			k0 += __RANDOM_PHILOX_W0;
+			k1 += __RANDOM_PHILOX_W1;
+		}
+		for (size_t h = 0; h < 2; h++) {
+			__m256i even = _mm256_or_si256(c0[h], _mm256_slli_epi64(c1[h], 32));
+			__m256i odd = _mm256_or_si256(c2[h], _mm256_slli_epi64(c3[h], 32));
+			// interleave to e0 o0 e1 o1 | e2 o2 e3 o3
+			__m256i lo = _mm256_unpacklo_epi64(even, odd);
+			__m256i hi = _mm256_unpackhi_epi64(even, odd);
+			__m256i *dst = (__m256i *)&out[2 * (i + 4 * h)];
+			_mm256_storeu_si256(dst, _mm256_permute2x128_si256(lo, hi, 0x20));
+			_mm256_storeu_si256(dst + 1, _mm256_permute2x128_si256(lo, hi, 0x31));
+		}
+	}
+}
+
+// 8 blocks at a time (count must be a multiple of 8), the 32-bit words are kept in 64-bit lanes so that the
+// products are widening multiplications
+typedef uint64_t _random_philox_v8 __attribute__((vector_size(64)));
+
+static _attr_noinline _attr_target("avx512f") void _random_philox_avx512(uint64_t key, uint64_t block,
+									  uint64_t *out, size_t count)
+{
+	const _random_philox_v8 lane = {0, 1, 2, 3, 4, 5, 6, 7};
+	const _random_philox_v8 low = (_random_philox_v8){0} + UINT32_MAX;
+	for (size_t i = 0; i < count; i += 8) {
+		_random_philox_v8 b = (block + i) + lane;
+		_random_philox_v8 c0 = b & low, c1 = (b >> 32) & low;
+		_random_philox_v8 c2 = (_random_philox_v8){0}, c3 = (_random_philox_v8){0};
+		uint32_t k0 = (uint32_t)key, k1 = (uint32_t)(key >> 32);
+		for (unsigned int round = 0; round < 10; round++) {
+			_random_philox_v8 p0 = c0 * __RANDOM_PHILOX_M0;
+			_random_philox_v8 p1 = c2 * __RANDOM_PHILOX_M1;
+			c0 = (p1 >> 32) ^ c1 ^ k0;
+			c2 = (p0 >> 32) ^ c3 ^ k1;
+			c1 = p1 & low;
+			c3 = p0 & low;
+			k0 += __RANDOM_PHILOX_W0;
+			k1 += __RANDOM_PHILOX_W1;
+		}
+		_random_philox_v8 even = c0 | (c1 << 32), odd = c2 | (c3 << 32);
+		for (size_t j = 0; j < 8; j++) {
+			out[2 * (i + j)] = even[j];
+			out[2 * (i + j) + 1] = odd[j];
+		}
+	}
+}
+
+typedef void (*_random_philox_func)(uint64_t key, uint64_t block, uint64_t *out, size_t count);
+
+static void _random_philox_resolve(uint64_t key, uint64_t block, uint64_t *out, size_t count);
+static _Atomic(_random_philox_func) _random_philox_impl = _random_philox_resolve;
+
+static void _random_philox_resolve(uint64_t key, uint64_t block, uint64_t *out, size_t count)
+{
+	_random_philox_func f = _random_philox_default;
+	if (cpu_has(CPU_FEATURE_AVX512)) {
+		f = _random_philox_avx512;
+	} else if (cpu_has(CPU_FEATURE_AVX2)) {
+		f = _random_philox_avx2;
+	}
+	atomic_store_explicit(&_random_philox_impl, f, memory_order_relaxed);
+	f(key, block, out, count);
+}
+
+# define _random_philox(key, block, out, count)				\
+	atomic_load_explicit(&_random_philox_impl, memory_order_relaxed)(key, block, out, count)
+#else
+# define _random_philox _random_philox_default
+#endif
+
+__AD_LINKAGE void random_fill_at(uint64_t key, uint64_t counter, uint64_t *buf, size_t n)
+{
+	size_t i = 0;
+	if (counter & 1 && n != 0) {
+		buf[i++] = random_at(key, counter++);
+	}
+	// whole groups of 8 blocks (16 values)
+	size_t bulk = (n - i) & ~(size_t)15;
+	if (bulk != 0) {
+		_random_philox(key, counter >> 1, &buf[i], bulk / 2);
+		i += bulk;
+		counter += bulk;
+	}
+	for (; i < n; i++) {
+		buf[i] = random_at(key, counter++);
+	}
+}
+
+
+/* Shuffling: Fisher-Yates with batched bounded indices (Brackett-Rozinsky and Lemire, "Batched Ranged Random
+ * Integer Generation"): the bounds i, i - 1, ..., i - k + 1 are multiplied into one 64-bit value one after
+ * another, each high half is an index and the low half is carried on. As long as the product of the bounds
+ * fits in 64 bits this is unbiased with the same rejection test as Lemire's method.
+ */
+
+static _attr_always_inline void _random_swap(unsigned char *base, size_t elem_size, size_t i, size_t j)
+{
+	unsigned char *a = base + i * elem_size;
+	unsigned char *b = base + j * elem_size;
+	unsigned char tmp[16];
+	for (; elem_size > sizeof(tmp); elem_size -= sizeof(tmp), a += sizeof(tmp), b += sizeof(tmp)) {
+		memcpy(tmp, a, sizeof(tmp));
+		memcpy(a, b, sizeof(tmp));
+		memcpy(b, tmp, sizeof(tmp));
+	}
+	memcpy(tmp, a, elem_size);
+	memcpy(a, b, elem_size);
+	memcpy(b, tmp, elem_size);
+}
+
+// call func(..., elem_size) with a constant elem_size for the common sizes (so the copies are inlined)
+#define __RANDOM_WITH_ELEM_SIZE(elem_size, func, ...)			\
+	switch (elem_size) {						\
+	case 1: func(__VA_ARGS__, 1); break;				\
+	case 2: func(__VA_ARGS__, 2); break;				\
+	case 4: func(__VA_ARGS__, 4); break;				\
+	case 8: func(__VA_ARGS__, 8); break;				\
+	case 16: func(__VA_ARGS__, 16); break;				\
+	default: func(__VA_ARGS__, elem_size); break;			\
+	}
+
+#ifdef __SIZEOF_INT128__
+static _attr_always_inline uint64_t _random_shuffle_indices(struct random_state *state, uint64_t i, size_t k,
+							    uint64_t *indices)
+{
+	typedef unsigned __int128 uint128_t;
+	uint64_t r = random_next_u64(state);
+	for (size_t j = 0; j < k; j++) {
+		uint128_t m = (uint128_t)r * (i - j);
+		indices[j] = m >> 64;
+		r = (uint64_t)m;
+	}
+	return r;
+}
+
+static _attr_always_inline uint64_t _random_shuffle_product(uint64_t i, size_t k)
+{
+	uint64_t product = i;
+	for (size_t j = 1; j < k; j++) {
+		product *= i - j;
+	}
+	return product;
+}
+
+// moves random elements to the positions i - 1 to i - k, 'bound' has to be at least the product of the k bounds
+// (the product of the previous batch), returns the bound for the next batch
+static _attr_always_inline uint64_t _random_shuffle_batch(struct random_state *state, unsigned char *base,
+							  size_t elem_size, uint64_t i, size_t k, uint64_t bound)
+{
+	uint64_t indices[6];
+	uint64_t r = _random_shuffle_indices(state, i, k, indices);
+	if (unlikely(r < bound)) {
+		bound = _random_shuffle_product(i, k);
+		uint64_t t = (-bound) % bound;
+		while (r < t) {
+			r = _random_shuffle_indices(state, i, k, indices);
+		}
+	}
+	for (size_t j = 0; j < k; j++) {
+		_random_swap(base, elem_size, i - 1 - j, indices[j]);
+	}
+	return bound;
+}
+
+static _attr_always_inline void _random_fisher_yates_inline(struct random_state *state, unsigned char *base,
+							    size_t n, size_t elem_size)
+{
+	// the batch size grows as the bounds shrink, the product of the bounds stays below 2^60 so rejections
+	// remain rare
+	uint64_t i = n;
+	for (; i > ((uint64_t)1 << 30); i--) {
+		_random_shuffle_batch(state, base, elem_size, i, 1, i);
+	}
+	uint64_t bound = _random_shuffle_product(i, 2);
+	for (; i > (1 << 19); i -= 2) {
+		bound = _random_shuffle_batch(state, base, elem_size, i, 2, bound);
+	}
+	bound = _random_shuffle_product(i, 3);
+	for (; i > (1 << 14); i -= 3) {
+		bound = _random_shuffle_batch(state, base, elem_size, i, 3, bound);
+	}
+	bound = _random_shuffle_product(i, 4);
+	for (; i > (1 << 11); i -= 4) {
+		bound = _random_shuffle_batch(state, base, elem_size, i, 4, bound);
+	}
+	bound = _random_shuffle_product(i, 5);
+	for (; i > (1 << 9); i -= 5) {
+		bound = _random_shuffle_batch(state, base, elem_size, i, 5, bound);
+	}
+	bound = _random_shuffle_product(i, 6);
+	for (; i > 6; i -= 6) {
+		bound = _random_shuffle_batch(state, base, elem_size, i, 6, bound);
+	}
+	if (i > 1) {
+		_random_shuffle_batch(state, base, elem_size, i, i - 1, 720);
+	}
+}
+#else
+static _attr_always_inline void _random_fisher_yates_inline(struct random_state *state, unsigned char *base,
+							    size_t n, size_t elem_size)
+{
+	for (size_t i = n; i > 1; i--) {
+		_random_swap(base, elem_size, i - 1, random_next_u64_in_range(state, 0, i - 1));
+	}
+}
+#endif
+
+static void _random_fisher_yates(struct random_state *state, unsigned char *base, size_t n, size_t elem_size)
+{
+	__RANDOM_WITH_ELEM_SIZE(elem_size, _random_fisher_yates_inline, state, base, n);
+}
+
+__AD_LINKAGE void random_shuffle(struct random_state *state, void *base, size_t n, size_t elem_size)
+{
+	_random_fisher_yates(state, base, n, elem_size);
+}
+
+/* Large arrays: Fisher-Yates swaps with a random position anywhere in the array, so once the array is much larger
+ * than the caches almost every swap is a cache (and TLB) miss. Rao-Sandelius instead sends every element to one of
+ * 64 random buckets (two sequential passes) and shuffles each bucket on its own, recursively until a bucket fits
+ * in the cache (more buckets per pass would run out of TLB entries for the scatter). The bucket sizes are random
+ * as well, so the result is still a uniformly random permutation.
+ */
+
+#define __RANDOM_SHUFFLE_BLOCK (256 * 1024)
+#define __RANDOM_SHUFFLE_BITS 6
+#define __RANDOM_SHUFFLE_BUCKETS (1 << __RANDOM_SHUFFLE_BITS)
+#define __RANDOM_SHUFFLE_LABELS (64 / __RANDOM_SHUFFLE_BITS)
+
+static _attr_always_inline void _random_scatter_inline(struct random_state *state, unsigned char *dst,
+						       const unsigned char *src, size_t n, size_t *offsets,
+						       size_t elem_size)
+{
+	size_t i = 0;
+	for (; i + __RANDOM_SHUFFLE_LABELS <= n; i += __RANDOM_SHUFFLE_LABELS) {
+		uint64_t r = random_next_u64(state);
+		for (size_t j = 0; j < __RANDOM_SHUFFLE_LABELS; j++, r >>= __RANDOM_SHUFFLE_BITS) {
+			size_t b = r & (__RANDOM_SHUFFLE_BUCKETS - 1);
+			memcpy(&dst[offsets[b]++ * elem_size], &src[(i + j) * elem_size], elem_size);
+		}
+	}
+	for (uint64_t r = random_next_u64(state); i < n; i++, r >>= __RANDOM_SHUFFLE_BITS) {
+		size_t b = r & (__RANDOM_SHUFFLE_BUCKETS - 1);
+		memcpy(&dst[offsets[b]++ * elem_size], &src[i * elem_size], elem_size);
+	}
+}
+
+static void _random_scatter(struct random_state *state, unsigned char *dst, const unsigned char *src,
+			    size_t n, size_t *offsets, size_t elem_size)
+{
+	__RANDOM_WITH_ELEM_SIZE(elem_size, _random_scatter_inline, state, dst, src, n, offsets);
+}
+
+// shuffles the n elements at 'base', 'tmp' has room for n elements as well
+static void _random_shuffle_blocks(struct random_state *state, unsigned char *base, unsigned char *tmp, size_t n,
+				   size_t elem_size)
+{
+	if (n * elem_size <= __RANDOM_SHUFFLE_BLOCK) {
+		_random_fisher_yates(state, base, n, elem_size);
+		return;
+	}
+
+	// count the bucket sizes first and then generate the same labels again to scatter the elements
+	size_t offsets[__RANDOM_SHUFFLE_BUCKETS + 1] = {0};
+	struct random_state labels = *state;
+	size_t i = 0;
+	for (; i + __RANDOM_SHUFFLE_LABELS <= n; i += __RANDOM_SHUFFLE_LABELS) {
+		uint64_t r = random_next_u64(state);
+		for (size_t j = 0; j < __RANDOM_SHUFFLE_LABELS; j++, r >>= __RANDOM_SHUFFLE_BITS) {
+			offsets[(r & (__RANDOM_SHUFFLE_BUCKETS - 1)) + 1]++;
+		}
+	}
+	for (uint64_t r = random_next_u64(state); i < n; i++, r >>= __RANDOM_SHUFFLE_BITS) {
+		offsets[(r & (__RANDOM_SHUFFLE_BUCKETS - 1)) + 1]++;
+	}
+	for (size_t b = 1; b <= __RANDOM_SHUFFLE_BUCKETS; b++) {
+		offsets[b] += offsets[b - 1];
+	}
+
+	size_t ends[__RANDOM_SHUFFLE_BUCKETS];
+	memcpy(ends, offsets, sizeof(ends));
+	_random_scatter(&labels, tmp, base, n, ends, elem_size);
+
+	for (size_t b = 0; b < __RANDOM_SHUFFLE_BUCKETS; b++) {
+		size_t start = offsets[b] * elem_size;
+		size_t size = offsets[b + 1] - offsets[b];
+		_random_shuffle_blocks(state, &tmp[start], &base[start], size, elem_size);
+		memcpy(&base[start], &tmp[start], size * elem_size);
+	}
+}
+
+__AD_LINKAGE void random_shuffle_large(struct random_state *state, void *base, size_t n, size_t elem_size)
+{
+	if (n * elem_size <= __RANDOM_SHUFFLE_BLOCK) {
+		_random_fisher_yates(state, base, n, elem_size);
+		return;
+	}
+	unsigned char *tmp = malloc(n * elem_size);
+	if (unlikely(!tmp)) {
+		abort();
+	}
+	_random_shuffle_blocks(state, base, tmp, n, elem_size);
+	free(tmp);
+}
+
+#undef __RANDOM_WITH_ELEM_SIZE
@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "random_small.h"
+
+__AD_LINKAGE void random_wyrand_init(struct random_wyrand *rng, uint64_t seed)
+{
+	rng->_s = seed;
+}
+
+__AD_LINKAGE uint64_t random_wyrand_next_u64(struct random_wyrand *rng)
+{
+	rng->_s += UINT64_C(0xa0761d6478bd642f);
+	uint64_t a = rng->_s, b = rng->_s ^ UINT64_C(0xe7037ed1a0b428db);
+#ifdef __SIZEOF_INT128__
+	unsigned __int128 m = (unsigned __int128)a * b;
+	return (uint64_t)(m >> 64) ^ (uint64_t)m;
+#else
+	uint64_t a_lo = (uint32_t)a, a_hi = a >> 32, b_lo = (uint32_t)b, b_hi = b >> 32;
+	uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+	uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi;
+	uint64_t hi = hi_hi + (hi_lo >> 32) + (cross >> 32);
+	uint64_t lo = (cross << 32) | (uint32_t)lo_lo;
+	return hi ^ lo;
+#endif
+}
+
+__AD_LINKAGE uint32_t random_wyrand_next_u32(struct random_wyrand *rng)
+{
+	return (uint32_t)(random_wyrand_next_u64(rng) >> 32);
+}
+
+__AD_LINKAGE uint32_t random_pcg32_next_u32(struct random_pcg32 *rng)
+{
+	uint64_t old = rng->_state;
+	rng->_state = old * UINT64_C(6364136223846793005) + rng->_inc;
+	uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+	uint32_t rot = (uint32_t)(old >> 59);
+	return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+__AD_LINKAGE void random_pcg32_init(struct random_pcg32 *rng, uint64_t seed, uint64_t stream)
+{
+	rng->_state = 0;
+	rng->_inc = (stream << 1) | 1;
+	random_pcg32_next_u32(rng);
+	rng->_state += seed;
+	random_pcg32_next_u32(rng);
+}
+
+__AD_LINKAGE uint64_t random_pcg32_next_u64(struct random_pcg32 *rng)
+{
+	uint64_t hi = random_pcg32_next_u32(rng);
+	return hi << 32 | random_pcg32_next_u32(rng);
+}
+
+__AD_LINKAGE uint64_t random_sfc64_next_u64(struct random_sfc64 *rng)
+{
+	uint64_t result = rng->_a + rng->_b + rng->_counter++;
+	rng->_a = rng->_b ^ (rng->_b >> 11);
+	rng->_b = rng->_c + (rng->_c << 3);
+	rng->_c = ((rng->_c << 24) | (rng->_c >> 40)) + result;
+	return result;
+}
+
+__AD_LINKAGE void random_sfc64_init(struct random_sfc64 *rng, uint64_t seed)
+{
+	rng->_a = rng->_b = rng->_c = seed;
+	rng->_counter = 1;
+	for (unsigned int i = 0; i < 12; i++) {
+		random_sfc64_next_u64(rng);
+	}
+}
+
+__AD_LINKAGE uint32_t random_sfc64_next_u32(struct random_sfc64 *rng)
+{
+	return (uint32_t)(random_sfc64_next_u64(rng) >> 32);
+}
+
+#ifdef __SIZEOF_INT128__
+# define __RANDOM_SMALL_DEFINE_U64_IN_RANGE(name)			\
+	__AD_LINKAGE uint64_t name##_next_u64_in_range(struct name *rng, uint64_t min, uint64_t max) \
+	{								\
+		assert(min <= max);					\
+		uint64_t s = max - min + 1;				\
+		uint64_t x = name##_next_u64(rng);			\
+		if (unlikely(s == 0)) {					\
+			return x;					\
+		}							\
+		unsigned __int128 m = (unsigned __int128)x * s;		\
+		uint64_t l = (uint64_t)m;				\
+		if (unlikely(l < s)) {					\
+			uint64_t t = (-s) % s;				\
+			while (l < t) {					\
+				x = name##_next_u64(rng);		\
+				m = (unsigned __int128)x * s;		\
+				l = (uint64_t)m;			\
+			}						\
+		}							\
+		return min + (uint64_t)(m >> 64);			\
+	}
+#else
+# define __RANDOM_SMALL_DEFINE_U64_IN_RANGE(name)			\
+	__AD_LINKAGE uint64_t name##_next_u64_in_range(struct name *rng, uint64_t min, uint64_t max) \
+	{								\
+		assert(min <= max);					\
+		uint64_t n = max - min + 1;				\
+		if (unlikely(n == 0)) {					\
+			return name##_next_u64(rng);			\
+		}							\
+		uint64_t remainder = UINT64_MAX % n;			\
+		uint64_t x;						\
+		do {							\
+			x = name##_next_u64(rng);			\
+		} while (x >= UINT64_MAX - remainder);			\
+		return min + x % n;					\
+	}
+#endif
+
+// the same conversions as random.c (Lemire's method for ranges: https://arxiv.org/pdf/1805.10941.pdf)
+#define __RANDOM_SMALL_DEFINE_HELPERS(name)				\
+	__AD_LINKAGE double name##_next_uniform_double(struct name *rng) \
+	{								\
+		return (name##_next_u64(rng) >> 11) * 0x1.0p-53;	\
+	}								\
+									\
+	__AD_LINKAGE float name##_next_uniform_float(struct name *rng)	\
+	{								\
+		return (name##_next_u32(rng) >> 8) * 0x1.0p-24f;	\
+	}								\
+									\
+	__AD_LINKAGE bool name##_next_bool(struct name *rng)		\
+	{								\
+		return name##_next_u32(rng) >> 31;			\
+	}								\
+									\
+	__AD_LINKAGE uint32_t name##_next_u32_in_range(struct name *rng, uint32_t min, uint32_t max) \
+	{								\
+		assert(min <= max);					\
+		uint32_t s = max - min + 1;				\
+		uint32_t x = name##_next_u32(rng);			\
+		if (unlikely(s == 0)) {					\
+			return x;					\
+		}							\
+		uint64_t m = (uint64_t)x * s;				\
+		uint32_t l = (uint32_t)m;				\
+		if (unlikely(l < s)) {					\
+			uint32_t t = (-s) % s;				\
+			while (l < t) {					\
+				x = name##_next_u32(rng);		\
+				m = (uint64_t)x * s;			\
+				l = (uint32_t)m;			\
+			}						\
+		}							\
+		return min + (uint32_t)(m >> 32);			\
+	}								\
+									\
+	__RANDOM_SMALL_DEFINE_U64_IN_RANGE(name)			\
+									\
+	__AD_LINKAGE float name##_next_float_in_range(struct name *rng, float min, float max) \
+	{								\
+		assert(min <= max);					\
+		return min + name##_next_uniform_float(rng) * (max - min); \
+	}								\
+									\
+	__AD_LINKAGE double name##_next_double_in_range(struct name *rng, double min, double max) \
+	{								\
+		assert(min <= max);					\
+		return min + name##_next_uniform_double(rng) * (max - min); \
+	}
+
+__RANDOM_SMALL_DEFINE_HELPERS(random_wyrand)
+__RANDOM_SMALL_DEFINE_HELPERS(random_pcg32)
+__RANDOM_SMALL_DEFINE_HELPERS(random_sfc64)
+
+#undef __RANDOM_SMALL_DEFINE_HELPERS
+#undef __RANDOM_SMALL_DEFINE_U64_IN_RANGE
@@ -0,0 +1,450 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "compiler.h"
+#include "config.h"
+#include "dbuf.h"
+#include "dstring.h"
+#include "rollhash.h"
+#include "utils.h"
+
+#define __ROLLHASH_ROTL(x, b) (uint64_t)(((x) << ((b) & 63)) | ((x) >> ((64 - (b)) & 63)))
+
+// (any odd multiplier works, this one mixes the high bits well)
+#define __RABIN_KARP_BASE UINT64_C(0x9e3779b97f4a7c15)
+
+// window of the buzhash and rabin-karp chunkers (gear uses its implicit 64 byte window)
+#define __CDC_WINDOW 48
+
+// 256 random values each (generated with splitmix64 seeded with 1 and 2)
+static const uint64_t _gearhash_table[256] = {
+	UINT64_C(0x910a2dec89025cc1), UINT64_C(0xbeeb8da1658eec67), UINT64_C(0xf893a2eefb32555e), UINT64_C(0x71c18690ee42c90b),
+	UINT64_C(0x71bb54d8d101b5b9), UINT64_C(0xc34d0bff90150280), UINT64_C(0xe099ec6cd7363ca5), UINT64_C(0x85e7bb0f12278575),
+	UINT64_C(0x491718de357e3da8), UINT64_C(0xcb435c8e74616796), UINT64_C(0x6775dc7701564f61), UINT64_C(0x9afcd44d14cf8bfe),
+	UINT64_C(0x7476cf8a4baa5dc0), UINT64_C(0x87b341d690d7a28a), UINT64_C(0x6f9b6dae6f4c57a8), UINT64_C(0x2ac2ce17a5794a3b),
+	UINT64_C(0xa534a6a6b7fd0b63), UINT64_C(0xd0bad0da572baaf1), UINT64_C(0xae84379630af89ee), UINT64_C(0xe263183773ef6508),
+	UINT64_C(0x10e2c46865e98746), UINT64_C(0x14d7973c5c2a449c), UINT64_C(0x7ef1fd0ed1548fcd), UINT64_C(0x1f8410633ef306ac),
+	UINT64_C(0x497305c5d1aab99f), UINT64_C(0x0c43407dc177b6f7), UINT64_C(0x83f91ca7864a7135), UINT64_C(0xb6b9aeef0d2df7ab),
+	UINT64_C(0x0b331645445bcd27), UINT64_C(0xff6c67e81909778a), UINT64_C(0x990cd70b12c5d084), UINT64_C(0x962b1967c90789ba),
+	UINT64_C(0x65ace2685a072c6d), UINT64_C(0x70616f2f48dce01c), UINT64_C(0x40d6824e2ef3fc17), UINT64_C(0x879e2e2256feff0c),
+	UINT64_C(0x8b2e02445e4be0f5), UINT64_C(0xbf8c59bb003553c1), UINT64_C(0xd16aa4b296eb9d18), UINT64_C(0xab27a171be5b133c),
+	UINT64_C(0xdca0c749607e2c86), UINT64_C(0xb54b3c40881e2907), UINT64_C(0x3c821fbf59108163), UINT64_C(0xa7ff0d388687ffb2),
+	UINT64_C(0xde70d1019fc66081), UINT64_C(0xd6de6acd12c87e38), UINT64_C(0x530e0e6118e9685e), UINT64_C(0x28bff9ea304d9f96),
+	UINT64_C(0xe4d9303221373073), UINT64_C(0xe9a6100461edd57a), UINT64_C(0x4d4673ef77ba0574), UINT64_C(0x21af8cfd4c4cbee5),
+	UINT64_C(0x536000f4bd6ae8f8), UINT64_C(0xf0af3ce429ca1790), UINT64_C(0x64c70b0b0c5b4a8f), UINT64_C(0x167587272751ecaf),
+	UINT64_C(0x9b679c859acd7aaf), UINT64_C(0x27cd5f9ec8c694cc), UINT64_C(0xf55540b2bff06252), UINT64_C(0xe02852925a4dc852),
+	UINT64_C(0x86c5d1b05ce2ce14), UINT64_C(0x1180b23a1075b77f), UINT64_C(0xc09a1a817914ffbc), UINT64_C(0x88b894e1401ed25b),
+	UINT64_C(0xb86c9a98359e0b62), UINT64_C(0x47a9dc6739325fac), UINT64_C(0x099545b4ca73e0f3), UINT64_C(0x05a2e18941c3936b),
+	UINT64_C(0x91866d4d0cde66a9), UINT64_C(0x1eb967d7929813bb), UINT64_C(0x29663e9ea0ec2561), UINT64_C(0xd2c61eeb27a21187),
+	UINT64_C(0xf902155aa328d575), UINT64_C(0xb0eb094e6f1dcf73), UINT64_C(0x90ccb6a06cd2330e), UINT64_C(0x7878834768668743),
+	UINT64_C(0x9fbd96359554aa53), UINT64_C(0xdc3320bb97ca63be), UINT64_C(0xce45a342c10ffb55), UINT64_C(0x1bea994d2e7d779d),
+	UINT64_C(0xa64b31c22cc57f39), UINT64_C(0x388495061eb06ce1), UINT64_C(0x6c38537a931e49d7), UINT64_C(0xe31d5ce0684b83f2),
+	UINT64_C(0xaf60baae69576109), UINT64_C(0xf0dad8272e600eb1), UINT64_C(0xc0257e403811c379), UINT64_C(0x2072b26dfe81f26e),
+	UINT64_C(0x2d4de979b560315c), UINT64_C(0xbcf35b6db5f3ba40), UINT64_C(0xc7c9572ddea951a8), UINT64_C(0x635b0b7e74f0c83e),
+	UINT64_C(0x18c80a5e762810c2), UINT64_C(0xf3f0a4b172d1294b), UINT64_C(0x98d0ff43e17386ae), UINT64_C(0x180a2bd6343d01f8),
+	UINT64_C(0xdb20290ac13e4a81), UINT64_C(0xd80391ffb30d1390), UINT64_C(0x00077ba99ea524f2), UINT64_C(0x4f05f03735c3b951),
+	UINT64_C(0xbc73014050141d01), UINT64_C(0x96bf5d405151ec53), UINT64_C(0xaa3de53fbde4ae5b), UINT64_C(0x7bc42e82782acb92),
+	UINT64_C(0x764176e3c9cf4b25), UINT64_C(0xfd845ef300ce2d0b), UINT64_C(0xa3e9bfbbf6c43e6f), UINT64_C(0x0781577a0f53e5d6),
+	UINT64_C(0xd909c315b21d8f6c), UINT64_C(0xe8e6022a79eb517b), UINT64_C(0x62db179ca8487c5a), UINT64_C(0x263346a69dd14426),
+	UINT64_C(0xa2e4fe841f72235e), UINT64_C(0x98f30af45f97eca2), UINT64_C(0x2f596652cb9a9f17), UINT64_C(0x19a3c59084763a12),
+	UINT64_C(0xfd0d1f90df4a692f), UINT64_C(0x67cae465669e4cc4), UINT64_C(0x795179bbe709a102), UINT64_C(0x9005becd29b95dbb),
+	UINT64_C(0xb19892fd50ff4222), UINT64_C(0xbd7de8f23cff78de), UINT64_C(0xf85a587bb6c47b9f), UINT64_C(0x7a2d99b9da657470),
+	UINT64_C(0x3782f608dcd26b70), UINT64_C(0x32647003725b6ed3), UINT64_C(0x1805127cc0db4d9d), UINT64_C(0x6524e51ffe73cb44),
+	UINT64_C(0x3d285f4226bfd385), UINT64_C(0x528f9e0312cacff8), UINT64_C(0x3df9d9ce5974e6ed), UINT64_C(0x852c7e934ff96a96),
+	UINT64_C(0x963578705d25aa70), UINT64_C(0x140232e315426b40), UINT64_C(0x75bc51bc37031a95), UINT64_C(0x0bf99fe6cbdde2d6),
+	UINT64_C(0xa97450076ed129d2), UINT64_C(0x0942629f167fa313), UINT64_C(0x159d2ce0c38cdeec), UINT64_C(0x63aa57bb3618b5f2),
+	UINT64_C(0xa6fefb55c353a1ea), UINT64_C(0xbd081362a82af3b3), UINT64_C(0x962fe90a4d66c623), UINT64_C(0x8c7ca121fd9fb515),
+	UINT64_C(0xe816e3b6f608968d), UINT64_C(0x3ffdb73eb9b069e4), UINT64_C(0xd2c7a4d8ae9e9fbd), UINT64_C(0x8b6bbb0d9453627f),
+	UINT64_C(0xd4d2fac5e33b4804), UINT64_C(0x4083da61bd55a196), UINT64_C(0x3ed180b55721039f), UINT64_C(0x8290184daf554eb1),
+	UINT64_C(0x3781b4a074d6fcc6), UINT64_C(0xceed949a2ef12bec), UINT64_C(0x3b2682ca23c4ff68), UINT64_C(0x49e92cf9955c4d96),
+	UINT64_C(0xe23e7fe1b4b4114d), UINT64_C(0x4bccda436a2ddba9), UINT64_C(0x28f7deebb10d1df4), UINT64_C(0xef6c8982a6072624),
+	UINT64_C(0x00b8c36dd01153d0), UINT64_C(0x2919452b44db5340), UINT64_C(0xb8e5450d9a3b51ab), UINT64_C(0xc655ee3eb4602dcf),
+	UINT64_C(0x4a1d2716a0fa615a), UINT64_C(0x5a6821d3d440b5a7), UINT64_C(0xdba5860ff63d5025), UINT64_C(0x701c8369e4818ff3),
+	UINT64_C(0x631669651fa41445), UINT64_C(0x100ba66a4ed81db5), UINT64_C(0x6d86104f53aa0cf9), UINT64_C(0x6c5cc4ca8405df9c),
+	UINT64_C(0x0630166a1b8951b6), UINT64_C(0xe1713a2a460ac44f), UINT64_C(0x537c82c1ec3792e6), UINT64_C(0x098b74eaa67dc0db),
+	UINT64_C(0x1d54db73ce48415b), UINT64_C(0x56e2a0da4d34c963), UINT64_C(0xecb27f56777e13da), UINT64_C(0xca750608b9bc7cfc),
+	UINT64_C(0x4e929e233ce0235b), UINT64_C(0x723bd128e303416d), UINT64_C(0x1dc28fc7eb573ea9), UINT64_C(0x6df6b932525bd556),
+	UINT64_C(0xae488090c1f8b985), UINT64_C(0x5248d49d58b70fe2), UINT64_C(0xd47b7fe21a59cf39), UINT64_C(0xeaeb4814b3a728d7),
+	UINT64_C(0x4ac155751ea11799), UINT64_C(0x115803c31e605c40), UINT64_C(0x4e3adbe865c85eee), UINT64_C(0xbabcd091951c0670),
+	UINT64_C(0xdee00a0ab25212a6), UINT64_C(0x6737584ee41de582), UINT64_C(0x27455ad965bb6738), UINT64_C(0xfb473b97f0ac3990),
+	UINT64_C(0x18a39e3eb3190b45), UINT64_C(0x4d690c33c5a4cc85), UINT64_C(0x5fe0a3c385ec9c9a), UINT64_C(0x6d50da9a2e50de5d),
+	UINT64_C(0x21b71d1f381ab62e), UINT64_C(0x690ff352d68433e0), UINT64_C(0x6d885ab0cc9e4967), UINT64_C(0xac8248b0629de91d),
+	UINT64_C(0x101d8e2989c1c2f3), UINT64_C(0x7acbb0dc0ddb767f), UINT64_C(0xfbcaee24e716973b), UINT64_C(0x116a7537117547e5),
+	UINT64_C(0x27905a1d447cd6c4), UINT64_C(0x66e5c983a8893ed9), UINT64_C(0x3409dc9828b04e0b), UINT64_C(0xb4bdc811ad928fe1),
+	UINT64_C(0xa4d7dc6e0c780e8d), UINT64_C(0x1601862897a16ed8), UINT64_C(0xbc2ab3483576b36d), UINT64_C(0xe247c75d6548c724),
+	UINT64_C(0x0804044fa2636993), UINT64_C(0xd3c4d30994a2fb8d), UINT64_C(0x13671a141437aab9), UINT64_C(0xb5c1a86ff40ff011),
+	UINT64_C(0x5568153c6e4ffd1e), UINT64_C(0x0369dd147cffd291), UINT64_C(0x99dfda573db6d447), UINT64_C(0x954ec310ef162d6b),
+	UINT64_C(0xeba0db14e1d2436b), UINT64_C(0x1528673c016bf1b5), UINT64_C(0x65aad0441c813761), UINT64_C(0x7f08ea48ceca8279),
+	UINT64_C(0x585afc2ca4abfd6f), UINT64_C(0xf12a8d4277d95551), UINT64_C(0xb9cde21bb5970cc7), UINT64_C(0x0d761b2a513f71aa),
+	UINT64_C(0xa13e727a811fd6d0), UINT64_C(0x33dd4fabe48cf51c), UINT64_C(0x50cf883505d00dc0), UINT64_C(0x7c72ddf651e496eb),
+	UINT64_C(0x2d1d63dad4a646be), UINT64_C(0x590aae464f2c3718), UINT64_C(0x767d0e5c3c13df0a), UINT64_C(0x944b051fa6dc9cde),
+	UINT64_C(0x23870c608513f820), UINT64_C(0xe8652cd8d99f06c4), UINT64_C(0xf843aeaf14077737), UINT64_C(0x912067d540a348e1),
+	UINT64_C(0x6af4982a5028fac3), UINT64_C(0x3fd4fbfaf3a8a5b3), UINT64_C(0x8b6a77fcf0cfdfd4), UINT64_C(0xc0752fda6b11ae6a),
+	UINT64_C(0x6dd644522a613d1e), UINT64_C(0x3e17e6dfc3cb0bac), UINT64_C(0xec9c8b0a8cd56c1b), UINT64_C(0xf679bf82f64681a1),
+	UINT64_C(0x34b8f365a7391077), UINT64_C(0x7804cbe741cfbac5), UINT64_C(0xd9960dbb250501f6), UINT64_C(0x20933f9b9211242a),
+};
+
+static const uint64_t _buzhash_table[256] = {
+	UINT64_C(0x975835de1c9756ce), UINT64_C(0xbfc846100bfc1e42), UINT64_C(0x987bbcbfdd7e532f), UINT64_C(0xc3f2827affe7f664),
+	UINT64_C(0x4fc446b53f17fb29), UINT64_C(0x58bc3cb37bc7b2b3), UINT64_C(0xb9f24f7bae4a6586), UINT64_C(0xbd34d3aef603e583),
+	UINT64_C(0x401478bc5887ccff), UINT64_C(0xba450a33ef6ff86c), UINT64_C(0x56e84498e8b0e635), UINT64_C(0x701560ad31bb9977),
+	UINT64_C(0x8e4858b561b10361), UINT64_C(0x5fb1940eb8cbf1ae), UINT64_C(0xee979f2730a45df3), UINT64_C(0x34116e681eda3219),
+	UINT64_C(0x333c04e09d9ae712), UINT64_C(0x5d3e47ecad6ef3d4), UINT64_C(0x60b92d2a699b5d52), UINT64_C(0x35ceedaace1296d5),
+	UINT64_C(0x0c56cd8a4cfc66c1), UINT64_C(0x8704799a02f1631d), UINT64_C(0x6189abe28d8e28b1), UINT64_C(0x54a802d271b82a96),
+	UINT64_C(0xea8bbd50dcc507e4), UINT64_C(0xbd80b4cb2ebfa252), UINT64_C(0x8675d8d1e5ceef8e), UINT64_C(0x9ea9566e32510720),
+	UINT64_C(0x02fc1efe0fccd72d), UINT64_C(0x4d06d2051c9d6d82), UINT64_C(0xddfcd92ab490c639), UINT64_C(0x9a7aa72430f9ca55),
+	UINT64_C(0x444bcaba22bb690f), UINT64_C(0x57c883255f0f9e24), UINT64_C(0xe2311b535f1fb0a9), UINT64_C(0x594dac74e9d05dd3),
+	UINT64_C(0x47602afae0d99c3c), UINT64_C(0x02bdde9d861af7d1), UINT64_C(0xe6efa7fa171cc347), UINT64_C(0x391cf0d00f6269a1),
+	UINT64_C(0xcb0714a2c315d7be), UINT64_C(0x2b3757448c2f7e6a), UINT64_C(0x021aa27732571887), UINT64_C(0xad98bc04e64e33b7),
+	UINT64_C(0xd6bc3af4ce1a0e50), UINT64_C(0x6faa36ceb3ac305a), UINT64_C(0xfac91851b0a82be1), UINT64_C(0xd9d9fe7c79a5c5a0),
+	UINT64_C(0x2cddd68e22c9399e), UINT64_C(0x8cb4863827a66cd3), UINT64_C(0x789e2d53857ddf21), UINT64_C(0xc069b999d14cb5d7),
+	UINT64_C(0x51595134ecf9dcc7), UINT64_C(0x9839e745b98cdaa6), UINT64_C(0x99865fd6f4009b0d), UINT64_C(0x3b3a8762bfcb6581),
+	UINT64_C(0x98928208b19cbbfe), UINT64_C(0x5b27a18e385a182b), UINT64_C(0x66fddff5b4309191), UINT64_C(0x2b4319a4d8416088),
+	UINT64_C(0xe5afeade560a4ebb), UINT64_C(0x5dd5d1bec99ae953), UINT64_C(0xe8c387e8e1f9a484), UINT64_C(0x530a8475bf4879d0),
+	UINT64_C(0x017536a38c412830), UINT64_C(0x9d84c218a3dff3bc), UINT64_C(0x98e99ec22e29a257), UINT64_C(0x2d57fe002233bec5),
+	UINT64_C(0x94dd0dca0260488c), UINT64_C(0xd0e5c3767c8efa67), UINT64_C(0x3f1ff7f7fc353c04), UINT64_C(0x1f0a010d1838e891),
+	UINT64_C(0x867c64929b90a0c3), UINT64_C(0xe8ba0b20f5093837), UINT64_C(0xb1bafb13d6cdfc8b), UINT64_C(0x374a9fea566dbddd),
+	UINT64_C(0x6d6bae6a85f5d90d), UINT64_C(0x600a293bce34ce56), UINT64_C(0x8c850dcecaf91228), UINT64_C(0xc259cac4e698bf9c),
+	UINT64_C(0xd0140f443f63ef0b), UINT64_C(0x5eb31425ab9a718f), UINT64_C(0x2c256428715e16f4), UINT64_C(0x13132ce05621168c),
+	UINT64_C(0x4e10e46c6ed5e249), UINT64_C(0x7a969a03967b7748), UINT64_C(0xf6f2e3414c8f366d), UINT64_C(0xee14a5ac1daa9573),
+	UINT64_C(0xc27b9fafae3e2397), UINT64_C(0xef085b3b4ba484cc), UINT64_C(0x5224d2453bf55d34), UINT64_C(0xdc6ae1f52acfaac4),
+	UINT64_C(0x62755ef4b6130fd8), UINT64_C(0x3aec667ee4c337d8), UINT64_C(0x73e3f10efbe0f760), UINT64_C(0x556a135c797831bd),
+	UINT64_C(0x912f822b1e8fe1e4), UINT64_C(0xf8606cc314fb6b96), UINT64_C(0x2067fe22cf322e4f), UINT64_C(0x8bc513e5906a18ab),
+	UINT64_C(0xb1ea028886fb6b3c), UINT64_C(0xedf1072d5d60db98), UINT64_C(0x5dae3e9624291a41), UINT64_C(0xd82f63b48106a743),
+	UINT64_C(0x4ecfebcf44055533), UINT64_C(0x65f6f9091847bab3), UINT64_C(0xabd84c2da396cf60), UINT64_C(0xe15e79ca53942f21),
+	UINT64_C(0x000bbe1e4ae78dca), UINT64_C(0xc47e438593c64693), UINT64_C(0xb7422dfe9e97ec96), UINT64_C(0x1eedc9af7adfc473),
+	UINT64_C(0x63c102baca4fc607), UINT64_C(0xcb9f82c5fc0a9cbf), UINT64_C(0x97a55f31057342e0), UINT64_C(0xf0f846e916acde9c),
+	UINT64_C(0xc40291c88688d51b), UINT64_C(0x19588dc18f57c3d0), UINT64_C(0xff19ef7d5b51d5eb), UINT64_C(0x5520eee2ed2a3111),
+	UINT64_C(0x9f9678ed02f19714), UINT64_C(0x1eeb922d0a84940d), UINT64_C(0x69d0a0f25f40d7c1), UINT64_C(0x8923a1d574aee5be),
+	UINT64_C(0xe17fd85bdc0247e6), UINT64_C(0x630342cb274fee6d), UINT64_C(0x4495775e6dfd8d8f), UINT64_C(0x7ace0e6a05997d63),
+	UINT64_C(0x755cf36e6886f3e8), UINT64_C(0x70d935326b3c16c5), UINT64_C(0x6a109bc5a16570af), UINT64_C(0x4f16bd1da528300b),
+	UINT64_C(0xeca8be5ea6a8a61a), UINT64_C(0xa7fad5258a164356), UINT64_C(0x59927723f6098ebc), UINT64_C(0x39f3cf6ddbda2c06),
+	UINT64_C(0x16419014ab48c979), UINT64_C(0x8665a9e658864d2c), UINT64_C(0x8be312d166bdfec6), UINT64_C(0xd243196bd780f8c7),
+	UINT64_C(0x4bf251135161e2a8), UINT64_C(0xc53959bd3f96aa5a), UINT64_C(0xf4e17231ecea8c61), UINT64_C(0xa58c3dd44f44230e),
+	UINT64_C(0xabe0e436c861fb73), UINT64_C(0xf2042ab74651aaeb), UINT64_C(0x5fd76a559c113292), UINT64_C(0x35e3b5e5cbebd691),
+	UINT64_C(0x03811ac1bb42d5b0), UINT64_C(0xb669b6fcc114a378), UINT64_C(0xae01825f2ca91fda), UINT64_C(0x3da49499bd18432b),
+	UINT64_C(0x363a91e9b7ef55bb), UINT64_C(0xe3d73f420e511c73), UINT64_C(0x0e4694e1f0ad58c9), UINT64_C(0xb86641752f94c77c),
+	UINT64_C(0x2e6c4f9ba30a2a99), UINT64_C(0x05fca9529c9addb4), UINT64_C(0xf87916ddb06bb977), UINT64_C(0xd1b2f53b9035607a),
+	UINT64_C(0x25b30ea66c194033), UINT64_C(0xe166ad40111a11ea), UINT64_C(0x539141003a77d260), UINT64_C(0xfd5f051d8ffac562),
+	UINT64_C(0xcf6b2d01ff1d1768), UINT64_C(0x071eb34fa43396ae), UINT64_C(0x1227044a45ccf28e), UINT64_C(0x47c70d73ca245004),
+	UINT64_C(0x7544d558906b789d), UINT64_C(0x671138797bff24dd), UINT64_C(0xb3a89d4d7ef1ffad), UINT64_C(0xe1b5b04c5cc01d63),
+	UINT64_C(0xbaf40c6b2d4c0d10), UINT64_C(0x91e0485d1dc380e7), UINT64_C(0x684b68b0ad6526b2), UINT64_C(0xd5b5ae9724916278),
+	UINT64_C(0xeac4b0fb936b7fdf), UINT64_C(0x8949df4fe1bb67d4), UINT64_C(0x94c80f651ef8d3f6), UINT64_C(0x5716722159e66bf1),
+	UINT64_C(0xe71ff48af9f2db15), UINT64_C(0x49685a8e65d34b42), UINT64_C(0x1c3775a143ae692f), UINT64_C(0x215046f309253e0b),
+	UINT64_C(0x3e380337b070a6da), UINT64_C(0x42c30503dd97508c), UINT64_C(0xe346c0750db62144), UINT64_C(0x2a66579509af5c59),
+	UINT64_C(0x61c62d5c4a485f50), UINT64_C(0xb7f38a48f6ce17a9), UINT64_C(0x0f3165d3589db6d6), UINT64_C(0x3f399d7d41cee5a5),
+	UINT64_C(0x104410149bb2b666), UINT64_C(0xc0887ca382c6ea01), UINT64_C(0x3108b2cf11c3d377), UINT64_C(0x22752d0ecc5bc6a1),
+	UINT64_C(0xc3b5252965d97e9e), UINT64_C(0x57e41a3167f9dba5), UINT64_C(0xc510efdc618d85b8), UINT64_C(0xe0fd5115862bf62b),
+	UINT64_C(0x13ef6d9f8b09e775), UINT64_C(0x2beda2bacb104659), UINT64_C(0x6a282af4c6c26228), UINT64_C(0x23b804633fe032b7),
+	UINT64_C(0xa8dac4470070658b), UINT64_C(0x395fa96df816be01), UINT64_C(0xe0e30df549e0c76b), UINT64_C(0xa73bb22e2be0943b),
+	UINT64_C(0x1b104acc477038d5), UINT64_C(0xade50f2f96420750), UINT64_C(0x943c876ebb4c7eab), UINT64_C(0xa023e7a394b5e845),
+	UINT64_C(0xa4133829b613f6ce), UINT64_C(0x4ef91cf662be5efe), UINT64_C(0x9305c310efdbd0c8), UINT64_C(0xa6d787d5622cf2ee),
+	UINT64_C(0x0b374a6d356e1a1c), UINT64_C(0x448b7528c25114ef), UINT64_C(0x91356806ab6390d5), UINT64_C(0xa230cf902968f2ee),
+	UINT64_C(0x7a96ba8aad58c85c), UINT64_C(0xc9f2ae7e62b4b2dc), UINT64_C(0xbc1a9377f64131aa), UINT64_C(0x51adca1b759a9f8f),
+	UINT64_C(0xa3758c7adbdff2e2), UINT64_C(0x6301d3c222829a5a), UINT64_C(0x8faf5c6162c4b7c7), UINT64_C(0x70998bf45b7112b3),
+	UINT64_C(0xa2c18438ec9be4c0), UINT64_C(0x0b078f0ca5b0aefa), UINT64_C(0xdf83dd15d2b501b0), UINT64_C(0x0fecc8509022f28c),
+	UINT64_C(0xfb878bb680bbe3ee), UINT64_C(0x96c1e2d971354f51), UINT64_C(0x43b15468d12c7124), UINT64_C(0x96b526109b9085b1),
+	UINT64_C(0x59fba9089d9b31d7), UINT64_C(0x1b33640501d52a8c), UINT64_C(0x437aad9b89929362), UINT64_C(0xe31b93b62c45cc62),
+	UINT64_C(0x53a5920624a5c3e7), UINT64_C(0xc3399a612b5dcbe3), UINT64_C(0xe3c2084f5ff0a555), UINT64_C(0xedeb280bef412b3b),
+	UINT64_C(0xc2a703c979776359), UINT64_C(0xa0459934dd27c1be), UINT64_C(0x14e20c7682a1803d), UINT64_C(0x4596309d2f34613d),
+	UINT64_C(0x58391ff912417c07), UINT64_C(0x7b10c211e63a171b), UINT64_C(0xe2096a91c8261e11), UINT64_C(0x466113996880d9fa),
+	UINT64_C(0xcdc54f2d800f7346), UINT64_C(0x16fd3109173fc434), UINT64_C(0x5fa5910717c369eb), UINT64_C(0xe3b806b61eef7c09),
+};
+
+__AD_LINKAGE void rabin_karp_init(struct rabin_karp *rk, size_t window)
+{
+	uint64_t factor = 1;
+	uint64_t base = __RABIN_KARP_BASE;
+	for (size_t n = window; n; n >>= 1) {
+		if (n & 1) {
+			factor *= base;
+		}
+		base *= base;
+	}
+	rk->hash = 0;
+	rk->_out_factor = factor;
+}
+
+__AD_LINKAGE void rabin_karp_push(struct rabin_karp *rk, unsigned char in)
+{
+	rk->hash = rk->hash * __RABIN_KARP_BASE + in;
+}
+
+__AD_LINKAGE void rabin_karp_roll(struct rabin_karp *rk, unsigned char out, unsigned char in)
+{
+	rk->hash = rk->hash * __RABIN_KARP_BASE + in - out * rk->_out_factor;
+}
+
+__AD_LINKAGE uint64_t rabin_karp_hash(const void *data, size_t len)
+{
+	const unsigned char *p = data;
+	uint64_t hash = 0;
+	for (size_t i = 0; i < len; i++) {
+		hash = hash * __RABIN_KARP_BASE + p[i];
+	}
+	return hash;
+}
+
+__AD_LINKAGE void buzhash_init(struct buzhash *bh, size_t window)
+{
+	bh->hash = 0;
+	bh->_out_rotation = window % 64;
+}
+
+__AD_LINKAGE void buzhash_push(struct buzhash *bh, unsigned char in)
+{
+	bh->hash = __ROLLHASH_ROTL(bh->hash, 1) ^ _buzhash_table[in];
+}
+
+__AD_LINKAGE void buzhash_roll(struct buzhash *bh, unsigned char out, unsigned char in)
+{
+	uint64_t removed = _buzhash_table[out];
+	bh->hash = __ROLLHASH_ROTL(bh->hash, 1) ^ __ROLLHASH_ROTL(removed, bh->_out_rotation) ^ _buzhash_table[in];
+}
+
+__AD_LINKAGE uint64_t buzhash_hash(const void *data, size_t len)
+{
+	const unsigned char *p = data;
+	uint64_t hash = 0;
+	for (size_t i = 0; i < len; i++) {
+		hash = __ROLLHASH_ROTL(hash, 1) ^ _buzhash_table[p[i]];
+	}
+	return hash;
+}
+
+__AD_LINKAGE uint64_t gearhash_push(uint64_t hash, unsigned char in)
+{
+	return (hash << 1) + _gearhash_table[in];
+}
+
+__AD_LINKAGE uint64_t gearhash_hash(const void *data, size_t len)
+{
+	const unsigned char *p = data;
+	uint64_t hash = 0;
+	for (size_t i = 0; i < len; i++) {
+		hash = (hash << 1) + _gearhash_table[p[i]];
+	}
+	return hash;
+}
+
+// n one bits in the part of the hash that depends on the whole window
+static uint64_t _cdc_mask(enum cdc_algorithm algorithm, unsigned int n)
+{
+	uint64_t bits = (UINT64_C(1) << n) - 1;
+	switch (algorithm) {
+	case CDC_GEAR:
+		// ends at bit 61 (depends on the last 62 bytes), so that mask << 1 still fits
+		return bits << (62 - n);
+	case CDC_BUZHASH:
+		return bits;
+	case CDC_RABIN_KARP:
+		return bits << (64 - n);
+	}
+	return 0;
+}
+
+__AD_LINKAGE bool cdc_init(struct cdc_chunker *chunker, enum cdc_algorithm algorithm, size_t min_size,
+			   size_t avg_size, size_t max_size)
+{
+	if (min_size < 64 || min_size > avg_size || avg_size > max_size || avg_size >= ((size_t)1 << 40)) {
+		return false;
+	}
+	if (algorithm != CDC_GEAR && algorithm != CDC_BUZHASH && algorithm != CDC_RABIN_KARP) {
+		return false;
+	}
+	// normalized chunking (level 2): cut points are 4 times less likely before avg_size and 4 times more
+	// likely after it, which narrows the chunk size distribution
+	unsigned int bits = ilog2(avg_size);
+	chunker->_algorithm = algorithm;
+	chunker->_min_size = min_size;
+	chunker->_avg_size = (size_t)1 << bits;
+	chunker->_max_size = max_size;
+	chunker->_mask_small = _cdc_mask(algorithm, bits + 2);
+	chunker->_mask_large = _cdc_mask(algorithm, bits - 2);
+	return true;
+}
+
+/* Gear hashing two bytes per step (from FastCDC2020): hash' = (hash << 2) + (G[a] << 1) + G[b], where
+ * (hash << 2) + (G[a] << 1) is the intermediate hash shifted left by one, so it can be checked against the
+ * shifted mask. The two table loads are independent of the hash, which shortens the dependency chain.
+ */
+#define __CDC_GEAR_SCAN(limit, mask)					\
+	do {								\
+		const uint64_t mask_shifted = (mask) << 1;		\
+		for (; i + 2 <= (limit); i += 2) {			\
+			hash = (hash << 2) + (_gearhash_table[p[i]] << 1); \
+			if (unlikely(!(hash & mask_shifted))) {		\
+				return i + 1;				\
+			}						\
+			hash += _gearhash_table[p[i + 1]];		\
+			if (unlikely(!(hash & (mask)))) {		\
+				return i + 2;				\
+			}						\
+		}							\
+		if (i < (limit)) {					\
+			hash = (hash << 1) + _gearhash_table[p[i++]];	\
+			if (!(hash & (mask))) {				\
+				return i;				\
+			}						\
+		}							\
+	} while (0)
+
+static size_t _cdc_gear(const unsigned char *p, size_t min_size, size_t normal_size, size_t end,
+			uint64_t mask_small, uint64_t mask_large)
+{
+	// bytes before min_size - 64 cannot affect the masked bits, so they are skipped entirely
+	uint64_t hash = 0;
+	size_t i = min_size - 64;
+	for (; i < min_size; i++) {
+		hash = (hash << 1) + _gearhash_table[p[i]];
+	}
+	if (!(hash & (min_size < normal_size ? mask_small : mask_large))) {
+		return min_size;
+	}
+	__CDC_GEAR_SCAN(normal_size, mask_small);
+	__CDC_GEAR_SCAN(end, mask_large);
+	return end;
+}
+
+#define __CDC_ROLLING_SCAN(init, roll, cut)				\
+	do {								\
+		uint64_t hash = 0;					\
+		size_t i = min_size - __CDC_WINDOW;			\
+		for (; i < min_size; i++) {				\
+			hash = (init);					\
+		}							\
+		uint64_t mask = min_size < normal_size ? mask_small : mask_large; \
+		if ((cut)) {						\
+			return min_size;				\
+		}							\
+		for (mask = mask_small; i < normal_size; i++) {		\
+			hash = (roll);					\
+			if (unlikely((cut))) {				\
+				return i + 1;				\
+			}						\
+		}							\
+		for (mask = mask_large; i < end; i++) {			\
+			hash = (roll);					\
+			if (unlikely((cut))) {				\
+				return i + 1;				\
+			}						\
+		}							\
+		return end;						\
+	} while (0)
+
+static size_t _cdc_buzhash(const unsigned char *p, size_t min_size, size_t normal_size, size_t end,
+			   uint64_t mask_small, uint64_t mask_large)
+{
+	__CDC_ROLLING_SCAN(__ROLLHASH_ROTL(hash, 1) ^ _buzhash_table[p[i]],
+			   __ROLLHASH_ROTL(hash, 1) ^ __ROLLHASH_ROTL(_buzhash_table[p[i - __CDC_WINDOW]], __CDC_WINDOW) ^
+			   _buzhash_table[p[i]],
+			   !(hash & mask));
+}
+
+static size_t _cdc_rabin_karp(const unsigned char *p, size_t min_size, size_t normal_size, size_t end,
+			      uint64_t mask_small, uint64_t mask_large)
+{
+	// B^__CDC_WINDOW
+	uint64_t out_factor = 1;
+	for (size_t k = 0; k < __CDC_WINDOW; k++) {
+		out_factor *= __RABIN_KARP_BASE;
+	}
+	__CDC_ROLLING_SCAN(hash * __RABIN_KARP_BASE + p[i],
+			   hash * __RABIN_KARP_BASE + p[i] - p[i - __CDC_WINDOW] * out_factor,
+			   !(hash & mask));
+}
+
+__AD_LINKAGE size_t cdc_next_chunk(const struct cdc_chunker *chunker, const void *data, size_t len)
+{
+	const unsigned char *p = data;
+	size_t min_size = chunker->_min_size;
+	size_t max_size = chunker->_max_size;
+	size_t avg_size = chunker->_avg_size;
+	if (len <= min_size) {
+		return len;
+	}
+	size_t end = min(len, max_size);
+	size_t normal_size = min(avg_size, end);
+	// (avg_size was rounded down, so normal_size can be less than min_size)
+	normal_size = max(normal_size, min_size);
+	switch (chunker->_algorithm) {
+	case CDC_GEAR:
+		return _cdc_gear(p, min_size, normal_size, end, chunker->_mask_small, chunker->_mask_large);
+	case CDC_BUZHASH:
+		return _cdc_buzhash(p, min_size, normal_size, end, chunker->_mask_small, chunker->_mask_large);
+	case CDC_RABIN_KARP:
+		return _cdc_rabin_karp(p, min_size, normal_size, end, chunker->_mask_small, chunker->_mask_large);
+	}
+	return end;
+}
+
+static void _cdc_iter_find(struct cdc_iterator *iter)
+{
+	size_t remaining = iter->_size - iter->offset;
+	iter->length = cdc_next_chunk(iter->_chunker, iter->_data + iter->offset, remaining);
+	// without a cut point (or max_size) the chunk might continue in the data that follows
+	if (!iter->_last && iter->length == remaining && iter->length < iter->_chunker->_max_size) {
+		iter->length = 0;
+	}
+}
+
+__AD_LINKAGE struct cdc_iterator cdc_iter_start(const struct cdc_chunker *chunker, const void *data, size_t size,
+						bool last)
+{
+	struct cdc_iterator iter = {
+		.offset = 0,
+		._chunker = chunker,
+		._data = data,
+		._size = size,
+		._last = last,
+	};
+	_cdc_iter_find(&iter);
+	return iter;
+}
+
+__AD_LINKAGE struct cdc_iterator cdc_iter_start_dbuf(const struct cdc_chunker *chunker, const struct dbuf *dbuf,
+						     bool last)
+{
+	return cdc_iter_start(chunker, dbuf_buffer(dbuf), dbuf_size(dbuf), last);
+}
+
+__AD_LINKAGE struct cdc_iterator cdc_iter_start_view(const struct cdc_chunker *chunker, struct strview view)
+{
+	return cdc_iter_start(chunker, view.characters, view.length, true);
+}
+
+__AD_LINKAGE bool cdc_iter_finished(const struct cdc_iterator *iter)
+{
+	return iter->length == 0;
+}
+
+__AD_LINKAGE void cdc_iter_advance(struct cdc_iterator *iter)
+{
+	iter->offset += iter->length;
+	_cdc_iter_find(iter);
+}
+
+#undef __ROLLHASH_ROTL
+#undef __RABIN_KARP_BASE
+#undef __CDC_WINDOW
+#undef __CDC_GEAR_SCAN
+#undef __CDC_ROLLING_SCAN
@@ -0,0 +1,284 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "compiler.h"
+#include "config.h"
+#include "heap.h"
+#include "random.h"
+#include "sampling.h"
+
+struct _alias_entry {
+	uint64_t threshold; // keep the column's own index if the low random bits are below this
+	size_t alias;
+};
+
+static uint64_t _alias_threshold(double p)
+{
+	return p >= 1.0 ? UINT64_MAX : (uint64_t)(p * 0x1.0p64);
+}
+
+__AD_LINKAGE void alias_table_init(struct alias_table *table, const double *weights, size_t n)
+{
+	assert(n != 0);
+	double sum = 0;
+	for (size_t i = 0; i < n; i++) {
+		assert(weights[i] >= 0 && isfinite(weights[i]));
+		sum += weights[i];
+	}
+	assert(sum > 0);
+
+	struct _alias_entry *entries = malloc(n * sizeof(entries[0]));
+	double *p = malloc(n * sizeof(p[0]));
+	// the small stack grows from the front, the large one from the back (they never hold more than n together)
+	size_t *work = malloc(n * sizeof(work[0]));
+	if (unlikely(!entries || !p || !work)) {
+		abort();
+	}
+	size_t num_small = 0, num_large = 0;
+	for (size_t i = 0; i < n; i++) {
+		p[i] = weights[i] * n / sum;
+		if (p[i] < 1.0) {
+			work[num_small++] = i;
+		} else {
+			work[n - ++num_large] = i;
+		}
+	}
+	while (num_small != 0 && num_large != 0) {
+		size_t small = work[--num_small];
+		size_t large = work[n - num_large--];
+		entries[small].threshold = _alias_threshold(p[small]);
+		entries[small].alias = large;
+		// (Vose's order of operations keeps the rounding error small)
+		p[large] = (p[large] + p[small]) - 1.0;
+		if (p[large] < 1.0) {
+			work[num_small++] = large;
+		} else {
+			work[n - ++num_large] = large;
+		}
+	}
+	// what is left is 1 up to rounding errors
+	while (num_large != 0) {
+		size_t i = work[n - num_large--];
+		entries[i].threshold = UINT64_MAX;
+		entries[i].alias = i;
+	}
+	while (num_small != 0) {
+		size_t i = work[--num_small];
+		entries[i].threshold = UINT64_MAX;
+		entries[i].alias = i;
+	}
+	free(work);
+	free(p);
+
+	table->_entries = entries;
+	table->_n = n;
+}
+
+__AD_LINKAGE void alias_table_destroy(struct alias_table *table)
+{
+	free(table->_entries);
+	table->_entries = NULL;
+	table->_n = 0;
+}
+
+#ifdef __SIZEOF_INT128__
+static _attr_always_inline size_t _alias_table_pick(const struct alias_table *table, uint64_t r)
+{
+	// r * n: the high half is a uniform column, the low half is a uniform fraction independent of it
+	typedef unsigned __int128 uint128_t;
+	uint128_t m = (uint128_t)r * table->_n;
+	const struct _alias_entry *entry = &table->_entries[(size_t)(m >> 64)];
+	return (uint64_t)m < entry->threshold ? (size_t)(m >> 64) : entry->alias;
+}
+#endif
+
+__AD_LINKAGE size_t alias_table_sample(const struct alias_table *table, struct random_state *rng)
+{
+#ifdef __SIZEOF_INT128__
+	return _alias_table_pick(table, random_next_u64(rng));
+#else
+	size_t i = random_next_u64_in_range(rng, 0, table->_n - 1);
+	return random_next_u64(rng) < table->_entries[i].threshold ? i : table->_entries[i].alias;
+#endif
+}
+
+__AD_LINKAGE void alias_table_sample_many(const struct alias_table *table, struct random_state *rng, uint64_t *out,
+					  size_t count)
+{
+#ifdef __SIZEOF_INT128__
+	random_fill_u64(rng, out, count);
+	for (size_t i = 0; i < count; i++) {
+		out[i] = _alias_table_pick(table, out[i]);
+	}
+#else
+	for (size_t i = 0; i < count; i++) {
+		out[i] = alias_table_sample(table, rng);
+	}
+#endif
+}
+
+__AD_LINKAGE size_t alias_table_size(const struct alias_table *table)
+{
+	return table->_n;
+}
+
+// uniform in (0, 1)
+static double _sampling_uniform_open(struct random_state *rng)
+{
+	return ((random_next_u64(rng) >> 11) + 0.5) * 0x1.0p-53;
+}
+
+__AD_LINKAGE void reservoir_init(struct reservoir *reservoir, size_t capacity)
+{
+	reservoir->_seen = 0;
+	reservoir->_next = capacity == 0 ? UINT64_MAX : 0;
+	reservoir->_w = 1.0;
+	reservoir->_capacity = capacity;
+}
+
+// W is the largest of the current keys, the number of skipped items is geometric with parameter W
+static void _reservoir_advance(struct reservoir *reservoir, struct random_state *rng)
+{
+	reservoir->_w *= exp(log(_sampling_uniform_open(rng)) / reservoir->_capacity);
+	double skip = floor(log(_sampling_uniform_open(rng)) / log1p(-reservoir->_w));
+	uint64_t max_skip = UINT64_MAX - reservoir->_next - 1;
+	reservoir->_next += 1 + (skip >= (double)max_skip ? max_skip : (uint64_t)skip);
+}
+
+__AD_LINKAGE size_t reservoir_offer(struct reservoir *reservoir, struct random_state *rng)
+{
+	uint64_t index = reservoir->_seen++;
+	if (index != reservoir->_next) {
+		assert(index < reservoir->_next);
+		return RESERVOIR_SKIP;
+	}
+	if (index < reservoir->_capacity) {
+		// the first items fill the reservoir
+		if (index + 1 == reservoir->_capacity) {
+			_reservoir_advance(reservoir, rng);
+		} else {
+			reservoir->_next++;
+		}
+		return index;
+	}
+	size_t slot = random_next_u64_in_range(rng, 0, reservoir->_capacity - 1);
+	_reservoir_advance(reservoir, rng);
+	return slot;
+}
+
+__AD_LINKAGE uint64_t reservoir_next(const struct reservoir *reservoir)
+{
+	return reservoir->_next;
+}
+
+__AD_LINKAGE void reservoir_skip(struct reservoir *reservoir, uint64_t n)
+{
+	assert(n <= reservoir->_next - reservoir->_seen);
+	reservoir->_seen += n;
+}
+
+__AD_LINKAGE uint64_t reservoir_seen(const struct reservoir *reservoir)
+{
+	return reservoir->_seen;
+}
+
+__AD_LINKAGE size_t reservoir_size(const struct reservoir *reservoir)
+{
+	return reservoir->_seen < reservoir->_capacity ? reservoir->_seen : reservoir->_capacity;
+}
+
+// keys are stored as log(u) / weight, which orders the items like u^(1 / weight) without underflowing to 0
+struct _weighted_reservoir_node {
+	double key;
+	size_t slot;
+};
+
+DEFINE_MINHEAP(_weighted_reservoir_heap, struct _weighted_reservoir_node, a->key < b->key)
+
+__AD_LINKAGE void weighted_reservoir_init(struct weighted_reservoir *reservoir, size_t capacity)
+{
+	reservoir->_heap = NULL;
+	if (capacity != 0) {
+		reservoir->_heap = malloc(capacity * sizeof(reservoir->_heap[0]));
+		if (unlikely(!reservoir->_heap)) {
+			abort();
+		}
+	}
+	reservoir->_size = 0;
+	reservoir->_capacity = capacity;
+	reservoir->_skip = 0;
+}
+
+__AD_LINKAGE void weighted_reservoir_destroy(struct weighted_reservoir *reservoir)
+{
+	free(reservoir->_heap);
+	reservoir->_heap = NULL;
+}
+
+// the total weight to skip until an item's key beats the smallest key T is log(u) / log(T)
+static void _weighted_reservoir_draw_skip(struct weighted_reservoir *reservoir, struct random_state *rng)
+{
+	reservoir->_skip = log(_sampling_uniform_open(rng)) / reservoir->_heap[0].key;
+}
+
+__AD_LINKAGE size_t weighted_reservoir_offer(struct weighted_reservoir *reservoir, struct random_state *rng,
+					     double weight)
+{
+	assert(weight >= 0 && isfinite(weight));
+	if (weight == 0 || reservoir->_capacity == 0) {
+		return RESERVOIR_SKIP;
+	}
+	struct _weighted_reservoir_node *heap = reservoir->_heap;
+	if (reservoir->_size < reservoir->_capacity) {
+		size_t slot = reservoir->_size++;
+		heap[slot].key = log(_sampling_uniform_open(rng)) / weight;
+		heap[slot].slot = slot;
+		_weighted_reservoir_heap_insert(heap, reservoir->_size);
+		if (reservoir->_size == reservoir->_capacity) {
+			_weighted_reservoir_draw_skip(reservoir, rng);
+		}
+		return slot;
+	}
+	reservoir->_skip -= weight;
+	if (reservoir->_skip > 0) {
+		return RESERVOIR_SKIP;
+	}
+	// the new key is conditioned on beating the smallest one: u^(1 / weight) with u uniform in (T^weight, 1)
+	size_t slot = heap[0].slot;
+	double t = expm1(heap[0].key * weight);
+	double key = log1p(t * _sampling_uniform_open(rng)) / weight;
+	// (keys have to stay negative for the skip distance)
+	heap[0].key = key < 0 ? key : -DBL_MIN;
+	_weighted_reservoir_heap_increase_key(heap, reservoir->_size, 0);
+	_weighted_reservoir_draw_skip(reservoir, rng);
+	return slot;
+}
+
+__AD_LINKAGE size_t weighted_reservoir_size(const struct weighted_reservoir *reservoir)
+{
+	return reservoir->_size;
+}
@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2020-2022 Fabian Hügel
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is furnished to do
+ * so, subject to the following conditions:
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "strdict.h"
+#include "compiler.h"
+#include "config.h"
+#include "dbuf.h"
+#include "dstring.h"
+
+/* Block layout:
+ *   head:  varint length, characters
+ *   other: varint length of the prefix shared with the previous string, varint suffix length, suffix
+ */
+
+static void _strdict_put_varint(struct dbuf *dbuf, size_t x)
+{
+	while (x >= 0x80) {
+		dbuf_add_byte(dbuf, (unsigned char)(x | 0x80));
+		x >>= 7;
+	}
+	dbuf_add_byte(dbuf, (unsigned char)x);
+}
+
+static _attr_always_inline size_t _strdict_get_varint(const unsigned char **pp)
+{
+	const unsigned char *p = *pp;
+	size_t x = 0;
+	unsigned int shift = 0;
+	while (*p & 0x80) {
+		x |= (size_t)(*p++ & 0x7f) << shift;
+		shift += 7;
+	}
+	x |= (size_t)*p++ << shift;
+	*pp = p;
+	return x;
+}
+
+static _attr_always_inline size_t _strdict_common_prefix(const void *a, size_t a_len, const void *b, size_t b_len)
+{
+	const unsigned char *x = a;
+	const unsigned char *y = b;
+	size_t n = a_len < b_len ? a_len : b_len;
+	size_t i = 0;
+	while (i < n && x[i] == y[i]) {
+		i++;
+	}
+	return i;
+}
+
+// decode the next string of a block, return a pointer to its suffix that starts at *ret_lcp
+static _attr_always_inline const unsigned char *_strdict_step(const unsigned char **pp, bool head,
+							       size_t *ret_lcp, size_t *ret_suffix_len)
+{
+	*ret_lcp = head ? 0 : _strdict_get_varint(pp);
+	*ret_suffix_len = _strdict_get_varint(pp);
+	const unsigned char *suffix = *pp;
+	*pp += *ret_suffix_len;
+	return suffix;
+}
+
+static size_t _strdict_num_blocks(const struct strdict *dict)
+{
+	return (dict->_num_strings + STRDICT_BLOCK_SIZE - 1) / STRDICT_BLOCK_SIZE;
+}
+
+static void _strdict_init_empty(struct strdict *dict)
+{
+	dict->_data = NULL;
+	dict->_block_offsets = malloc(sizeof(dict->_block_offsets[0]));
+	if (unlikely(!dict->_block_offsets)) {
+		abort();
+	}
+	dict->_block_offsets[0] = 0;
+	dict->_num_strings = 0;
+	dict->_max_length = 0;
+}
+
+__AD_LINKAGE bool strdict_init(struct strdict *dict, const struct strview *strings, size_t count)
+{
+	_strdict_init_empty(dict);
+	for (size_t i = 1; i < count; i++) {
+		if (strview_compare(strings[i - 1], strings[i]) >= 0) {
+			return false;
+		}
+	}
+
+	size_t num_blocks = (count + STRDICT_BLOCK_SIZE - 1) / STRDICT_BLOCK_SIZE;
+	size_t *offsets = realloc(dict->_block_offsets, (num_blocks + 1) * sizeof(offsets[0]));
+	if (unlikely(!offsets)) {
+		abort();
+	}
+	struct dbuf dbuf = DBUF_INITIALIZER;
+	size_t max_length = 0;
+	for (size_t i = 0; i < count; i++) {
+		struct strview s = strings[i];
+		if (s.length > max_length) {
+			max_length = s.length;
+		}
+		if (i % STRDICT_BLOCK_SIZE == 0) {
+			offsets[i / STRDICT_BLOCK_SIZE] = dbuf_size(&dbuf);
+			_strdict_put_varint(&dbuf, s.length);
+			dbuf_add_buf(&dbuf, s.characters, s.length);
+			continue;
+		}
+		struct strview prev = strings[i - 1];
+		size_t lcp = _strdict_common_prefix(prev.characters, prev.length, s.characters, s.length);
+		_strdict_put_varint(&dbuf, lcp);
+		_strdict_put_varint(&dbuf, s.length - lcp);
+		dbuf_add_buf(&dbuf, s.characters + lcp, s.length - lcp);
+	}
+	offsets[num_blocks] = dbuf_size(&dbuf);
+	dbuf_shrink_to_fit(&dbuf);
+
+	dict->_data = dbuf_finalize(&dbuf);
+	dict->_block_offsets = offsets;
+	dict->_num_strings = count;
+	dict->_max_length = max_length;
+	return true;
+}
+
+__AD_LINKAGE void strdict_destroy(struct strdict *dict)
+{
+	free(dict->_data);
+	free(dict->_block_offsets);
+	dict->_data = NULL;
+	dict->_block_offsets = NULL;
+	dict->_num_strings = 0;
+}
+
+__AD_LINKAGE size_t strdict_size(const struct strdict *dict)
+{
+	return dict->_num_strings;
+}
+
+__AD_LINKAGE size_t strdict_memory_usage(const struct strdict *dict)
+{
+	size_t num_blocks = _strdict_num_blocks(dict);
+	return dict->_block_offsets[num_blocks] + (num_blocks + 1) * sizeof(dict->_block_offsets[0]);
+}
+
+// order of s relative to q (negative if s comes first), in prefix mode strings starting with q come first
+static int _strdict_compare(const unsigned char *s, size_t s_len, struct strview q, bool prefix)
+{
+	size_t m = _strdict_common_prefix(s, s_len, q.characters, q.length);
+	if (m == q.length) {
+		return prefix ? -1 : (s_len != q.length);
+	}
+	if (m == s_len) {
+		return -1;
+	}
+	return s[m] < (unsigned char)q.characters[m] ? -1 : 1;
+}
+
+/* Return the index of the first string that does not come before q (see _strdict_compare).
+ * This only needs to look at the parts of each string that were not already known from the previous string:
+ * 'match' is the length of the prefix the previous string shares with q.
+ */
+static size_t _strdict_search(const struct strdict *dict, struct strview q, bool prefix, bool *ret_equal)
+{
+	const unsigned char *query = (const unsigned char *)q.characters;
+	*ret_equal = false;
+
+	size_t lo = 0;
+	size_t hi = _strdict_num_blocks(dict);
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		const unsigned char *p = dict->_data + dict->_block_offsets[mid];
+		size_t length = _strdict_get_varint(&p);
+		int c = _strdict_compare(p, length, q, prefix);
+		if (c == 0) {
+			*ret_equal = true;
+			return mid * STRDICT_BLOCK_SIZE;
+		}
+		if (c < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	if (lo == 0) {
+		return 0;
+	}
+
+	size_t block = lo - 1;
+	const unsigned char *p = dict->_data + dict->_block_offsets[block];
+	size_t lcp, suffix_len;
+	const unsigned char *head = _strdict_step(&p, true, &lcp, &suffix_len);
+	size_t match = _strdict_common_prefix(head, suffix_len, query, q.length);
+	size_t end = block * STRDICT_BLOCK_SIZE + STRDICT_BLOCK_SIZE;
+	if (end > dict->_num_strings) {
+		end = dict->_num_strings;
+	}
+	for (size_t i = block * STRDICT_BLOCK_SIZE + 1; i < end; i++) {
+		const unsigned char *suffix = _strdict_step(&p, false, &lcp, &suffix_len);
+		if (lcp < match) {
+			// differs from the previous string at a position where that one matched q
+			return i;
+		}
+		if (lcp > match) {
+			// same characters as the previous string where that one came before q
+			continue;
+		}
+		size_t m = lcp + _strdict_common_prefix(suffix, suffix_len, query + lcp, q.length - lcp);
+		if (m == q.length) {
+			if (!prefix) {
+				*ret_equal = lcp + suffix_len == q.length;
+				return i;
+			}
+		} else if (m != lcp + suffix_len && suffix[m - lcp] > query[m]) {
+			return i;
+		}
+		match = m;
+	}
+	return end;
+}
+
+__AD_LINKAGE size_t strdict_lookup(const struct strdict *dict, struct strview string)
+{
+	bool equal;
+	size_t i = _strdict_search(dict, string, false, &equal);
+	return equal ? i : STRDICT_NOT_FOUND;
+}
+
+__AD_LINKAGE size_t strdict_rank(const struct strdict *dict, struct strview string)
+{
+	bool equal;
+	return _strdict_search(dict, string, false, &equal);
+}
+
+__AD_LINKAGE void strdict_prefix_range(const struct strdict *dict, struct strview prefix,
+				       size_t *ret_first, size_t *ret_last)
+{
+	bool equal;
+	*ret_first = _strdict_search(dict, prefix, false, &equal);
+	*ret_last = _strdict_search(dict, prefix, true, &equal);
+}
+
+__AD_LINKAGE void strdict_extract_into(const struct strdict *dict, size_t id, dstr_t *dstrp)
+{
+	size_t block = id / STRDICT_BLOCK_SIZE;
+	const unsigned char *p = dict->_data + dict->_block_offsets[block];
+	dstr_clear(dstrp);
+	dstr_reserve(dstrp, dict->_max_length);
+	for (size_t i = block * STRDICT_BLOCK_SIZE; i <= id; i++) {
+		size_t lcp, suffix_len;
+		const unsigned char *suffix = _strdict_step(&p, i == block * STRDICT_BLOCK_SIZE, &lcp, &suffix_len);
+		dstr_erase(dstrp, lcp, dstr_length(*dstrp) - lcp);
+		dstr_append_chars(dstrp, (const char *)suffix, suffix_len);
+	}
+}
+
+__AD_LINKAGE dstr_t strdict_extract(const struct strdict *dict, size_t id)
+{
+	dstr_t dstr = dstr_new();
+	strdict_extract_into(dict, id, &dstr);
+	return dstr;
+}
+
+static void _strdict_iter_load(struct strdict_iterator *iter)
+{
+	const struct strdict *dict = iter->_dict;
+	const unsigned char *p;
+	bool head = iter->id % STRDICT_BLOCK_SIZE == 0;
+	if (head) {
+		p = dict->_data + dict->_block_offsets[iter->id / STRDICT_BLOCK_SIZE];
+	} else {
+		p = dict->_data + iter->_offset;
+	}
+	size_t lcp, suffix_len;
+	const unsigned char *suffix = _strdict_step(&p, head, &lcp, &suffix_len);
+	memcpy(iter->_buffer + lcp, suffix, suffix_len);
+	iter->_offset = (size_t)(p - dict->_data);
+	iter->string = strview_from_chars(iter->_buffer, lcp + suffix_len);
+}
+
+__AD_LINKAGE struct strdict_iterator strdict_iter_start(const struct strdict *dict, size_t first, size_t last)
+{
+	struct strdict_iterator iter = {0};
+	iter._dict = dict;
+	iter._end = last < dict->_num_strings ? last : dict->_num_strings;
+	if (first >= iter._end) {
+		iter.id = iter._end;
+		return iter;
+	}
+	iter._buffer = malloc(dict->_max_length + 1);
+	if (unlikely(!iter._buffer)) {
+		abort();
+	}
+	// decode the preceding strings of the block to get the shared prefix
+	for (iter.id = first - first % STRDICT_BLOCK_SIZE; iter.id < first; iter.id++) {
+		_strdict_iter_load(&iter);
+	}
+	_strdict_iter_load(&iter);
+	return iter;
+}
+
+__AD_LINKAGE bool strdict_iter_finished(const struct strdict_iterator *iter)
+{
+	return iter->id >= iter->_end;
+}
+
+__AD_LINKAGE void strdict_iter_advance(struct strdict_iterator *iter)
+{
+	iter->id++;
+	if (iter->id >= iter->_end) {
+		strdict_iter_destroy(iter);
+		return;
+	}
+	_strdict_iter_load(iter);
+}
+
+__AD_LINKAGE void strdict_iter_destroy(struct strdict_iterator *iter)
+{
+	free(iter->_buffer);
+	iter->_buffer = NULL;
+	iter->string = strview_from_chars(NULL, 0);
+}
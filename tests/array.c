@@ -7,6 +7,7 @@
 #include "array.h"
 #include "config.h"
 #include "compiler.h"
+#include "random.h"
 #include "testing.h"
 
 #ifdef HAVE_MALLOC_USABLE_SIZE
@@ -193,6 +194,11 @@ SIMPLE_TEST(array)
 	array_shuffle(arr2, (size_t(*)(void))random);
 	array_sort(arr2, cmp);
 	CHECK(check_array_content(10, arr2, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9));
+	struct random_state rng;
+	random_state_init(&rng, random());
+	array_shuffle_state(arr2, &rng);
+	array_sort(arr2, cmp);
+	CHECK(check_array_content(10, arr2, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9));
 	array_free(arr2);
 
 	array_add_arrayn(arr1, digits, sizeof(digits) / sizeof(digits[0]));
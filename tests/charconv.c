@@ -1,10 +1,15 @@
 #include <assert.h>
+#include <float.h>
 #include <inttypes.h>
 #include <limits.h>
+#include <math.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #include "charconv.h"
 #include "compiler.h"
 #include "random.h"
@@ -628,3 +633,280 @@ RANGE_TEST(to_chars_bases, 2, 36)
 	}
 	return true;
 }
+
+#define CHECK_FROM_CHARS(type, str, flags, expected_len, expected_value)	\
+	do {								\
+		type _value = 42;					\
+		size_t _len = from_chars(str, strlen(str), &_value, flags); \
+		CHECK(_len == (expected_len));				\
+		CHECK(_value == (_len == 0 ? 42 : (type)(expected_value))); \
+	} while (0)
+
+SIMPLE_TEST(from_chars)
+{
+	CHECK_FROM_CHARS(int, "0", 0, 1, 0);
+	CHECK_FROM_CHARS(int, "123", 0, 3, 123);
+	CHECK_FROM_CHARS(int, "-123", 0, 4, -123);
+	CHECK_FROM_CHARS(int, "+5", 0, 2, 5);
+	CHECK_FROM_CHARS(int, "-", 0, 0, 0);
+	CHECK_FROM_CHARS(int, "", 0, 0, 0);
+	CHECK_FROM_CHARS(int, "abc", 0, 0, 0);
+	CHECK_FROM_CHARS(int, " 1", 0, 0, 0);
+	CHECK_FROM_CHARS(unsigned int, "-5", 0, 0, 0);
+	CHECK_FROM_CHARS(unsigned int, "+5", 0, 0, 0);
+	CHECK_FROM_CHARS(int, "123abc", 0, 3, 123);
+	CHECK_FROM_CHARS(int, "12345678,9", 0, 8, 12345678);
+	CHECK_FROM_CHARS(long long, "1234567890123", 0, 13, 1234567890123);
+	CHECK_FROM_CHARS(long long, "000000000000000000000000000123", FROM_CHARS_DECIMAL, 30, 123);
+	CHECK_FROM_CHARS(long long, "000000000000000000000000000123", 0, 30, 0123);
+
+	CHECK_FROM_CHARS(unsigned int, "4294967295", 0, 10, UINT32_MAX);
+	CHECK_FROM_CHARS(unsigned int, "4294967296", 0, 0, 0);
+	CHECK_FROM_CHARS(int, "2147483647", 0, 10, INT32_MAX);
+	CHECK_FROM_CHARS(int, "2147483648", 0, 0, 0);
+	CHECK_FROM_CHARS(int, "-2147483648", 0, 11, INT32_MIN);
+	CHECK_FROM_CHARS(int, "-2147483649", 0, 0, 0);
+	CHECK_FROM_CHARS(unsigned long long, "18446744073709551615", 0, 20, UINT64_MAX);
+	CHECK_FROM_CHARS(unsigned long long, "18446744073709551616", 0, 0, 0);
+	CHECK_FROM_CHARS(unsigned long long, "99999999999999999999", 0, 0, 0);
+	CHECK_FROM_CHARS(unsigned long long, "184467440737095516150", 0, 0, 0);
+	CHECK_FROM_CHARS(long long, "9223372036854775807", 0, 19, INT64_MAX);
+	CHECK_FROM_CHARS(long long, "-9223372036854775808", 0, 20, INT64_MIN);
+	CHECK_FROM_CHARS(long long, "9223372036854775808", 0, 0, 0);
+	CHECK_FROM_CHARS(unsigned char, "255", 0, 3, 255);
+	CHECK_FROM_CHARS(unsigned char, "256", 0, 0, 0);
+	CHECK_FROM_CHARS(signed char, "-128", 0, 4, -128);
+	CHECK_FROM_CHARS(short, "-32769", 0, 0, 0);
+
+	CHECK_FROM_CHARS(unsigned char, "ff", FROM_CHARS_HEXADECIMAL, 2, 255);
+	CHECK_FROM_CHARS(unsigned char, "FF", FROM_CHARS_HEXADECIMAL, 2, 255);
+	CHECK_FROM_CHARS(unsigned char, "100", FROM_CHARS_HEXADECIMAL, 0, 0);
+	CHECK_FROM_CHARS(signed char, "ff", FROM_CHARS_HEXADECIMAL, 2, -1);
+	CHECK_FROM_CHARS(signed char, "-80", FROM_CHARS_HEXADECIMAL, 3, -128);
+	CHECK_FROM_CHARS(signed char, "+80", FROM_CHARS_HEXADECIMAL, 0, 0);
+	CHECK_FROM_CHARS(unsigned int, "0x10", FROM_CHARS_HEXADECIMAL, 1, 0);
+	CHECK_FROM_CHARS(unsigned int, "777", FROM_CHARS_OCTAL, 3, 511);
+	CHECK_FROM_CHARS(unsigned int, "778", FROM_CHARS_OCTAL, 2, 63);
+	CHECK_FROM_CHARS(unsigned int, "1012", FROM_CHARS_BINARY, 3, 5);
+	CHECK_FROM_CHARS(unsigned int, "zZ", 36, 2, 35 * 36 + 35);
+	CHECK_FROM_CHARS(unsigned long long, "1111111111111111111111111111111111111111111111111111111111111111",
+			 FROM_CHARS_BINARY, 64, UINT64_MAX);
+	CHECK_FROM_CHARS(unsigned long long, "10000000000000000000000000000000000000000000000000000000000000000",
+			 FROM_CHARS_BINARY, 0, 0);
+
+	CHECK_FROM_CHARS(unsigned int, "0x1F", 0, 4, 31);
+	CHECK_FROM_CHARS(unsigned int, "0X1f", 0, 4, 31);
+	CHECK_FROM_CHARS(unsigned int, "0b101", 0, 5, 5);
+	CHECK_FROM_CHARS(unsigned int, "017", 0, 3, 15);
+	CHECK_FROM_CHARS(unsigned int, "0x", 0, 1, 0);
+	CHECK_FROM_CHARS(unsigned int, "0xg", 0, 1, 0);
+	CHECK_FROM_CHARS(unsigned int, "0b2", 0, 1, 0);
+	CHECK_FROM_CHARS(unsigned int, "09", 0, 1, 0);
+	CHECK_FROM_CHARS(int, "-0x10", 0, 5, -16);
+	CHECK_FROM_CHARS(int, "10", 0, 2, 10);
+
+	int x;
+	CHECK(from_chars("123456789", 4, &x, 0) == 4 && x == 1234);
+	CHECK(from_chars("123456789", 0, &x, 0) == 0 && x == 1234);
+
+	// nothing after the last character is read (the digits end right before an inaccessible page)
+	long page_size = sysconf(_SC_PAGESIZE);
+	char *pages = mmap(NULL, 2 * page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	CHECK(pages != MAP_FAILED);
+	CHECK(mprotect(pages + page_size, page_size, PROT_NONE) == 0);
+	for (size_t n = 1; n <= 20; n++) {
+		char *digits = pages + page_size - n;
+		memset(digits, '1', n);
+		uint64_t value;
+		CHECK(from_chars(digits, n, &value, 0) == n);
+		uint64_t expected = 0;
+		for (size_t i = 0; i < n; i++) {
+			expected = expected * 10 + 1;
+		}
+		CHECK(value == expected);
+	}
+	munmap(pages, 2 * page_size);
+	return true;
+}
+
+static bool check_from_chars_round_trip(uint64_t x, unsigned int base)
+{
+	unsigned int flag_choices[] = {
+		0,
+		TO_CHARS_LEADING_ZEROS,
+		TO_CHARS_PLUS_SIGN,
+		TO_CHARS_UPPERCASE,
+		TO_CHARS_LEADING_ZEROS | TO_CHARS_PLUS_SIGN | TO_CHARS_UPPERCASE,
+	};
+	for (size_t i = 0; i < sizeof(flag_choices) / sizeof(flag_choices[0]); i++) {
+		unsigned int flags = flag_choices[i] | base;
+#define CHECK_ROUND_TRIP(type)						\
+		do {							\
+			char str[72];					\
+			type value = (type)x, parsed;			\
+			size_t len = to_chars(str, value, flags);	\
+			str[len] = '_';					\
+			CHECK(from_chars(str, len + 1, &parsed, base) == len); \
+			CHECK(parsed == value);				\
+		} while (0)
+		CHECK_ROUND_TRIP(char);
+		CHECK_ROUND_TRIP(signed char);
+		CHECK_ROUND_TRIP(unsigned char);
+		CHECK_ROUND_TRIP(short);
+		CHECK_ROUND_TRIP(unsigned short);
+		CHECK_ROUND_TRIP(int);
+		CHECK_ROUND_TRIP(unsigned int);
+		CHECK_ROUND_TRIP(long);
+		CHECK_ROUND_TRIP(unsigned long);
+		CHECK_ROUND_TRIP(long long);
+		CHECK_ROUND_TRIP(unsigned long long);
+#undef CHECK_ROUND_TRIP
+	}
+	return true;
+}
+
+RANDOM_TEST(from_chars_random, 1u << 18, 0, UINT64_MAX)
+{
+	// all lengths of numbers
+	uint64_t x = random >> (random % 64);
+	CHECK(check_from_chars_round_trip(x, 10));
+	CHECK(check_from_chars_round_trip(x, 16));
+	CHECK(check_from_chars_round_trip(x, 2));
+	CHECK(check_from_chars_round_trip(x, 8));
+	CHECK(check_from_chars_round_trip(x, 2 + random % 35));
+
+	char str[32];
+	int len = sprintf(str, "%" PRIu64, x);
+	uint64_t parsed;
+	CHECK(from_chars(str, len, &parsed, 0) == (size_t)len);
+	CHECK(parsed == strtoull(str, NULL, 10));
+	return true;
+}
+
+#define CHECK_TO_CHARS_FLOAT(func, value, flags, expected)		\
+	do {								\
+		char str[TO_CHARS_DOUBLE_MAX_LENGTH];			\
+		size_t len = func(str, value, flags);			\
+		CHECK(len == strlen(expected));				\
+		CHECK(memcmp(str, expected, len) == 0);			\
+		CHECK(func(NULL, value, flags) == len);			\
+	} while (0)
+
+SIMPLE_TEST(to_chars_double)
+{
+	CHECK_TO_CHARS_FLOAT(to_chars_double, 0.0, 0, "0");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, -0.0, 0, "-0");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, 0.0, TO_CHARS_SCIENTIFIC, "0e+00");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, 1.0, TO_CHARS_PLUS_SIGN, "+1");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, 0.1, 0, "0.1");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, 0.3, TO_CHARS_SCIENTIFIC, "3e-01");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, 0.1 + 0.2, 0, "0.30000000000000004");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, -2.5, 0, "-2.5");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, 100.0, 0, "100");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, 1000000.0, 0, "1e+06");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, 1200000.0, 0, "1200000");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, 1e-7, 0, "1e-07");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, 1e-7, TO_CHARS_FIXED, "0.0000001");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, 123456.789, 0, "123456.789");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, 123456.789, TO_CHARS_SCIENTIFIC | TO_CHARS_UPPERCASE, "1.23456789E+05");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, 1e22, TO_CHARS_FIXED, "10000000000000000000000");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, 1e23, 0, "1e+23");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, 9007199254740992.0, 0, "9007199254740992");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, 5e-324, 0, "5e-324");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, DBL_MIN, 0, "2.2250738585072014e-308");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, DBL_MAX, 0, "1.7976931348623157e+308");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, INFINITY, 0, "inf");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, -INFINITY, TO_CHARS_UPPERCASE, "-INF");
+	CHECK_TO_CHARS_FLOAT(to_chars_double, NAN, TO_CHARS_PLUS_SIGN, "+nan");
+
+	// the longest outputs
+	CHECK(to_chars_double(NULL, -5e-324, TO_CHARS_FIXED) <= TO_CHARS_DOUBLE_MAX_LENGTH);
+	CHECK(to_chars_double(NULL, -DBL_MIN, TO_CHARS_FIXED) <= TO_CHARS_DOUBLE_MAX_LENGTH);
+	CHECK(to_chars_double(NULL, -DBL_MAX, TO_CHARS_FIXED) <= TO_CHARS_DOUBLE_MAX_LENGTH);
+	CHECK(to_chars_float(NULL, -1e-45f, TO_CHARS_FIXED) <= TO_CHARS_FLOAT_MAX_LENGTH);
+	CHECK(to_chars_float(NULL, -FLT_MIN, TO_CHARS_FIXED) <= TO_CHARS_FLOAT_MAX_LENGTH);
+	CHECK(to_chars_float(NULL, -FLT_MAX, TO_CHARS_FIXED) <= TO_CHARS_FLOAT_MAX_LENGTH);
+	return true;
+}
+
+SIMPLE_TEST(to_chars_float)
+{
+	CHECK_TO_CHARS_FLOAT(to_chars_float, 0.1f, 0, "0.1");
+	CHECK_TO_CHARS_FLOAT(to_chars_float, 3.14159f, 0, "3.14159");
+	CHECK_TO_CHARS_FLOAT(to_chars_float, 16777216.0f, 0, "16777216");
+	CHECK_TO_CHARS_FLOAT(to_chars_float, 1e-45f, 0, "1e-45");
+	CHECK_TO_CHARS_FLOAT(to_chars_float, FLT_MIN, 0, "1.1754944e-38");
+	CHECK_TO_CHARS_FLOAT(to_chars_float, FLT_MAX, 0, "3.4028235e+38");
+	CHECK_TO_CHARS_FLOAT(to_chars_float, 1.0f / 3, TO_CHARS_SCIENTIFIC, "3.3333334e-01");
+	CHECK_TO_CHARS_FLOAT(to_chars, 2.5f, 0, "2.5");
+	CHECK_TO_CHARS_FLOAT(to_chars, 2.5, 0, "2.5");
+	return true;
+}
+
+// the number of significant digits printf needs to round trip x
+static int shortest_printf_digits(double x, bool is_float)
+{
+	int p;
+	for (p = 1; p < (is_float ? 9 : 17); p++) {
+		char str[64];
+		sprintf(str, "%.*e", p - 1, x);
+		if (is_float ? strtof(str, NULL) == (float)x : strtod(str, NULL) == x) {
+			break;
+		}
+	}
+	return p;
+}
+
+static size_t count_digits(const char *str, size_t len)
+{
+	size_t n = 0;
+	for (size_t i = 0; i < len && str[i] != 'e'; i++) {
+		n += str[i] >= '0' && str[i] <= '9';
+	}
+	return n;
+}
+
+RANDOM_TEST(to_chars_float_random, 1u << 16, 0, UINT64_MAX)
+{
+	static const unsigned int flag_choices[] = {0, TO_CHARS_FIXED, TO_CHARS_SCIENTIFIC};
+	char str[TO_CHARS_DOUBLE_MAX_LENGTH + 1];
+	size_t len;
+
+	double d;
+	memcpy(&d, &random, sizeof(d));
+	if (!isnan(d)) {
+		for (size_t i = 0; i < sizeof(flag_choices) / sizeof(flag_choices[0]); i++) {
+			len = to_chars_double(str, d, flag_choices[i]);
+			CHECK(len <= TO_CHARS_DOUBLE_MAX_LENGTH);
+			str[len] = '\0';
+			CHECK(strtod(str, NULL) == d);
+		}
+		if (isfinite(d) && d != 0) {
+			// shortest and correctly rounded, so the same as printf with the minimal precision
+			int p = shortest_printf_digits(d, false);
+			char expected[32];
+			sprintf(expected, "%.*e", p - 1, d);
+			len = to_chars_double(str, d, TO_CHARS_SCIENTIFIC);
+			CHECK(count_digits(str, len) == (size_t)p);
+			CHECK(len == strlen(expected) && memcmp(str, expected, len) == 0);
+		}
+	}
+
+	float f;
+	uint32_t bits = random >> 32;
+	memcpy(&f, &bits, sizeof(f));
+	if (!isnan(f)) {
+		for (size_t i = 0; i < sizeof(flag_choices) / sizeof(flag_choices[0]); i++) {
+			len = to_chars_float(str, f, flag_choices[i]);
+			CHECK(len <= TO_CHARS_FLOAT_MAX_LENGTH);
+			str[len] = '\0';
+			CHECK(strtof(str, NULL) == f);
+		}
+		if (isfinite(f) && f != 0) {
+			int p = shortest_printf_digits(f, true);
+			len = to_chars_float(str, f, TO_CHARS_SCIENTIFIC);
+			CHECK(count_digits(str, len) == (size_t)p);
+		}
+	}
+	return true;
+}
@@ -0,0 +1,74 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "checksum.h"
+#include "random.h"
+#include "testing.h"
+
+SIMPLE_TEST(crc32c)
+{
+	CHECK(crc32c(CRC32C_INIT, "", 0) == 0);
+	CHECK(crc32c(CRC32C_INIT, "123456789", 9) == UINT32_C(0xe3069283));
+	CHECK(_crc32c_portable(CRC32C_INIT, "123456789", 9) == UINT32_C(0xe3069283));
+	// from RFC 3720 (iSCSI)
+	uint8_t buf[32];
+	memset(buf, 0, sizeof(buf));
+	CHECK(crc32c(CRC32C_INIT, buf, sizeof(buf)) == UINT32_C(0x8a9136aa));
+	memset(buf, 0xff, sizeof(buf));
+	CHECK(crc32c(CRC32C_INIT, buf, sizeof(buf)) == UINT32_C(0x62a8ab43));
+	for (size_t i = 0; i < sizeof(buf); i++) {
+		buf[i] = (uint8_t)i;
+	}
+	CHECK(crc32c(CRC32C_INIT, buf, sizeof(buf)) == UINT32_C(0x46dd794e));
+	return true;
+}
+
+SIMPLE_TEST(adler32)
+{
+	CHECK(adler32(ADLER32_INIT, "", 0) == 1);
+	CHECK(adler32(ADLER32_INIT, "Wikipedia", 9) == UINT32_C(0x11e60398));
+	// the sums have to be reduced correctly for long runs of 0xff
+	size_t n = 100000;
+	uint8_t *buf = malloc(n);
+	memset(buf, 0xff, n);
+	uint32_t a = 1, b = 0;
+	for (size_t i = 0; i < n; i++) {
+		a = (a + 0xff) % 65521;
+		b = (b + a) % 65521;
+	}
+	CHECK(adler32(ADLER32_INIT, buf, n) == (a | (b << 16)));
+	free(buf);
+	return true;
+}
+
+RANDOM_TEST(checksum_streaming_and_combine, 32, 0, UINT64_MAX)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+	// large enough for the three way split with both block sizes
+	size_t n = random_next_u32(&rng) % 4 == 0 ? random_next_u32(&rng) % 100000 : random_next_u32(&rng) % 2000;
+	uint8_t *buf = malloc(n + 1);
+	for (size_t i = 0; i < n; i++) {
+		buf[i] = (uint8_t)random_next_u32(&rng);
+	}
+	size_t offset = n ? random_next_u32(&rng) % 8 % (n + 1) : 0;
+	const uint8_t *data = buf + offset;
+	size_t len = n - offset;
+
+	uint32_t crc = crc32c(CRC32C_INIT, data, len);
+	CHECK(crc == _crc32c_portable(CRC32C_INIT, data, len));
+	uint32_t adler = adler32(ADLER32_INIT, data, len);
+
+	size_t split = len ? random_next_u32(&rng) % (len + 1) : 0;
+	uint32_t crc1 = crc32c(CRC32C_INIT, data, split);
+	uint32_t crc2 = crc32c(CRC32C_INIT, data + split, len - split);
+	CHECK(crc32c(crc1, data + split, len - split) == crc);
+	CHECK(_crc32c_portable(crc1, data + split, len - split) == crc);
+	CHECK(crc32c_combine(crc1, crc2, len - split) == crc);
+	uint32_t adler1 = adler32(ADLER32_INIT, data, split);
+	uint32_t adler2 = adler32(ADLER32_INIT, data + split, len - split);
+	CHECK(adler32(adler1, data + split, len - split) == adler);
+	CHECK(adler32_combine(adler1, adler2, len - split) == adler);
+	free(buf);
+	return true;
+}
@@ -0,0 +1,158 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include "countmin.h"
+#include "random.h"
+#include "testing.h"
+
+// key i occurs about 20000 / (i + 1) times, followed by 'noise' keys that occur once, in random order
+static uint64_t *zipf_stream(struct random_state *rng, size_t heavy, size_t noise, uint64_t **ret_counts,
+			     size_t *ret_len)
+{
+	uint64_t *counts = calloc(heavy, sizeof(counts[0]));
+	size_t len = noise;
+	for (size_t i = 0; i < heavy; i++) {
+		counts[i] = 20000 / (i + 1) + 1;
+		len += counts[i];
+	}
+	uint64_t *events = malloc(len * sizeof(events[0]));
+	size_t n = 0;
+	for (size_t i = 0; i < heavy; i++) {
+		for (uint64_t j = 0; j < counts[i]; j++) {
+			events[n++] = i;
+		}
+	}
+	for (size_t i = 0; i < noise; i++) {
+		events[n++] = heavy + i;
+	}
+	for (size_t i = len - 1; i > 0; i--) {
+		size_t j = random_next_u64_in_range(rng, 0, i);
+		uint64_t tmp = events[i];
+		events[i] = events[j];
+		events[j] = tmp;
+	}
+	*ret_counts = counts;
+	*ret_len = len;
+	return events;
+}
+
+RANDOM_TEST(count_min, 1 << 4, 0, UINT64_MAX)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+	uint64_t *counts;
+	size_t len;
+	const size_t heavy = 1000;
+	const size_t noise = 50000;
+	uint64_t *events = zipf_stream(&rng, heavy, noise, &counts, &len);
+
+	struct count_min a, b;
+	count_min_init(&a, 4000, 4, random);
+	count_min_init(&b, 4096, 4, random);
+	CHECK(count_min_memory_usage(&a) >= 4096 * 4 * sizeof(uint64_t));
+	size_t half = len / 2;
+	for (size_t i = 0; i < half; i++) {
+		CHECK(count_min_add(&a, events[i], 1) >= 1);
+	}
+	count_min_add_batch(&b, events + half, len - half);
+	CHECK(count_min_total(&a) == half);
+	CHECK(count_min_total(&b) == len - half);
+
+	struct count_min c;
+	count_min_init(&c, 4096, 4, random);
+	count_min_add_batch(&c, events, half);
+	for (size_t i = 0; i < heavy + noise; i++) {
+		CHECK(count_min_estimate(&a, i) == count_min_estimate(&c, i));
+	}
+	count_min_destroy(&c);
+
+	CHECK(count_min_merge(&a, &b));
+	CHECK(count_min_total(&a) == len);
+	double error_bound = 2.718281828 / 4096 * (double)len;
+	size_t exceeded = 0;
+	for (size_t i = 0; i < heavy + noise; i++) {
+		uint64_t truth = i < heavy ? counts[i] : 1;
+		uint64_t estimate = count_min_estimate(&a, i);
+		CHECK(estimate >= truth);
+		exceeded += (double)(estimate - truth) > error_bound;
+	}
+	// the bound holds for each key with probability 1 - e^-4 (conservative updates do much better)
+	CHECK(exceeded < (heavy + noise) / 50);
+
+	struct count_min other;
+	count_min_init(&other, 4096, 4, random + 1);
+	CHECK(!count_min_merge(&a, &other));
+	count_min_destroy(&other);
+	count_min_init(&other, 4096, 3, random);
+	CHECK(!count_min_merge(&a, &other));
+	count_min_destroy(&other);
+
+	count_min_clear(&a);
+	CHECK(count_min_total(&a) == 0);
+	CHECK(count_min_estimate(&a, 0) == 0);
+	count_min_destroy(&a);
+	count_min_destroy(&b);
+	free(counts);
+	free(events);
+	return true;
+}
+
+SIMPLE_TEST(count_min_init_with_error)
+{
+	struct count_min cms;
+	count_min_init_with_error(&cms, 0.001, 0.01, 0);
+	CHECK(count_min_memory_usage(&cms) >= 2719 * 5 * sizeof(uint64_t));
+	CHECK(count_min_add(&cms, 42, UINT64_MAX - 1) == UINT64_MAX - 1);
+	CHECK(count_min_add(&cms, 42, 5) == UINT64_MAX);
+	count_min_destroy(&cms);
+	return true;
+}
+
+RANDOM_TEST(topk, 1 << 4, 0, UINT64_MAX)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+	uint64_t *counts;
+	size_t len;
+	const size_t heavy = 1000;
+	uint64_t *events = zipf_stream(&rng, heavy, 100000, &counts, &len);
+
+	const size_t k = 20;
+	struct topk topk;
+	topk_init(&topk, k, 2048, 4, random);
+	for (size_t i = 0; i < len; i++) {
+		CHECK(topk_add(&topk, events[i], 1) == topk_estimate(&topk, events[i]));
+	}
+	CHECK(topk_size(&topk) == k);
+
+	struct topk_entry list[20];
+	CHECK(topk_list(&topk, list) == k);
+	for (size_t i = 0; i < k; i++) {
+		uint64_t count;
+		CHECK(topk_query(&topk, list[i].key, &count));
+		CHECK(count == list[i].count);
+		CHECK(i == 0 || list[i - 1].count >= list[i].count);
+		CHECK(list[i].count >= (list[i].key < heavy ? counts[list[i].key] : 1));
+	}
+	// the ten heaviest keys are clearly separated from the rest
+	for (size_t i = 0; i < 10; i++) {
+		CHECK(topk_query(&topk, i, NULL));
+		CHECK(list[i].key == i);
+	}
+	CHECK(!topk_query(&topk, heavy + 1, NULL));
+
+	topk_clear(&topk);
+	CHECK(topk_size(&topk) == 0);
+	CHECK(!topk_query(&topk, 0, NULL));
+	for (uint64_t i = 0; i < 5; i++) {
+		topk_add(&topk, i, i + 1);
+	}
+	CHECK(topk_list(&topk, list) == 5);
+	for (size_t i = 0; i < 5; i++) {
+		CHECK(list[i].key == 4 - i);
+		CHECK(list[i].count == 5 - i);
+	}
+	topk_destroy(&topk);
+	free(counts);
+	free(events);
+	return true;
+}
@@ -0,0 +1,151 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "flatmap.h"
+#include "hash.h"
+#include "random.h"
+#include "testing.h"
+
+#define hash_u32(key) (hash_int32(key).u32)
+#define hash_u64(key) ((uint32_t)hash_int64(key).u64)
+
+struct pair_key {
+	uint16_t a;
+	uint16_t b;
+};
+
+static uint32_t hash_pair(struct pair_key key)
+{
+	return hash_int32(((uint32_t)key.a << 16) | key.b).u32;
+}
+
+DEFINE_FLATMAP(fm32, uint32_t, uint32_t, 4, 32, hash_u32, *a == *b)
+DEFINE_FLATMAP(fm64, uint64_t, uint64_t, 2, 16, hash_u64, *a == *b)
+DEFINE_FLATMAP(fmpair, struct pair_key, uint32_t, 8, 8, hash_pair, a->a == b->a && a->b == b->b)
+
+SIMPLE_TEST(flatmap_find)
+{
+	uint32_t keys32[67];
+	uint64_t keys64[67];
+	for (size_t n = 0; n <= 67; n++) {
+		for (size_t i = 0; i < n; i++) {
+			keys32[i] = (uint32_t)(i * 2);
+			keys64[i] = (uint64_t)(i * 2) << 32;
+		}
+		for (size_t i = 0; i < n; i++) {
+			CHECK(_flatmap_find_u32(keys32, n, (uint32_t)(i * 2)) == i);
+			CHECK(_flatmap_find_u32(keys32, n, (uint32_t)(i * 2 + 1)) == n);
+			CHECK(_flatmap_find_u64(keys64, n, (uint64_t)(i * 2) << 32) == i);
+			// only one of the two 32-bit halves matches
+			CHECK(_flatmap_find_u64(keys64, n, ((uint64_t)(i * 2) << 32) | 1) == n);
+			CHECK(_flatmap_find_u64(keys64, n, i * 2) == (i == 0 ? 0 : n));
+		}
+	}
+	return true;
+}
+
+#define FLATMAP_RANDOM_OPS(map_name, make_key, key_index)		\
+	do {								\
+		struct map_name map;					\
+		map_name##_init(&map);					\
+		size_t num_keys = 1 + random_next_u32(&rng) % 80;	\
+		bool *present = calloc(num_keys, sizeof(present[0]));	\
+		uint32_t *values = calloc(num_keys, sizeof(values[0])); \
+		size_t count = 0;					\
+		for (size_t i = 0; i < 2000; i++) {			\
+			size_t k = random_next_u32(&rng) % num_keys;	\
+			uint32_t op = random_next_u32(&rng) % 8;	\
+			if (op == 0) {					\
+				uint32_t removed;			\
+				bool ok = map_name##_remove(&map, make_key(k), &removed); \
+				CHECK(ok == present[k]);		\
+				CHECK(!ok || removed == values[k]);	\
+				count -= ok;				\
+				present[k] = false;			\
+			} else if (op < 4) {				\
+				bool found;				\
+				uint32_t value = random_next_u32(&rng);	\
+				*(map_name##_lookup_or_insert(&map, make_key(k), &found)) = value; \
+				CHECK(found == present[k]);		\
+				count += !found;			\
+				present[k] = true;			\
+				values[k] = value;			\
+			} else if (op == 4 && random_next_u32(&rng) % 64 == 0) { \
+				map_name##_clear(&map);			\
+				memset(present, 0, num_keys * sizeof(present[0])); \
+				count = 0;				\
+			} else {					\
+				uint32_t *value = map_name##_lookup(&map, make_key(k)); \
+				CHECK(!value == !present[k]);		\
+				CHECK(!value || *value == values[k]);	\
+			}						\
+			CHECK(map_name##_size(&map) == count);		\
+		}							\
+		size_t iterated = 0;					\
+		for (map_name##_iter_t iter = map_name##_iter_start(&map); \
+		     !map_name##_iter_finished(&iter); map_name##_iter_advance(&iter)) { \
+			size_t k = key_index(*iter.key);		\
+			CHECK(k < num_keys && present[k]);		\
+			CHECK((uint32_t)*iter.value == values[k]);	\
+			iterated++;					\
+		}							\
+		CHECK(iterated == count);				\
+		map_name##_destroy(&map);				\
+		free(present);						\
+		free(values);						\
+	} while (0)
+
+#define key32(k) ((uint32_t)(k) * 2654435761u)
+#define index32(key) ((size_t)((key) * 244002641u))
+#define key64(k) ((uint64_t)(k) << 40 | (k))
+#define index64(key) ((size_t)((key) & 0xffffffffff))
+#define keypair(k) ((struct pair_key){(uint16_t)(k), (uint16_t)~(k)})
+#define indexpair(key) ((size_t)(key).a)
+
+DEFINE_FLATMAP(fm64v, uint64_t, uint32_t, 2, 16, hash_u64, *a == *b)
+// SIMD search with key types that are not uint32_t/uint64_t
+DEFINE_FLATMAP(fmint, int, uint32_t, 4, 32, hash_u32, *a == *b)
+DEFINE_FLATMAP(fmll, long long, uint32_t, 2, 16, hash_u64, *a == *b)
+
+RANDOM_TEST(flatmap_random, 16, 0, UINT64_MAX)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+	FLATMAP_RANDOM_OPS(fm32, key32, index32);
+	FLATMAP_RANDOM_OPS(fm64v, key64, index64);
+	FLATMAP_RANDOM_OPS(fmint, key32, index32);
+	FLATMAP_RANDOM_OPS(fmll, key64, index64);
+	FLATMAP_RANDOM_OPS(fmpair, keypair, indexpair);
+	return true;
+}
+
+SIMPLE_TEST(flatmap_transitions)
+{
+	struct fm64 map;
+	fm64_init(&map);
+	for (uint64_t i = 0; i < 100; i++) {
+		bool found;
+		*fm64_lookup_or_insert(&map, i, &found) = i * i;
+		CHECK(!found);
+		CHECK(fm64_size(&map) == i + 1);
+		for (uint64_t j = 0; j <= i; j++) {
+			uint64_t *value = fm64_lookup(&map, j);
+			CHECK(value && *value == j * j);
+		}
+		CHECK(!fm64_lookup(&map, i + 1));
+	}
+	for (uint64_t i = 0; i < 100; i += 2) {
+		uint64_t value;
+		CHECK(fm64_remove(&map, i, &value));
+		CHECK(value == i * i);
+		CHECK(!fm64_remove(&map, i, NULL));
+	}
+	CHECK(fm64_size(&map) == 50);
+	fm64_clear(&map);
+	CHECK(fm64_size(&map) == 0);
+	CHECK(!fm64_lookup(&map, 1));
+	*fm64_lookup_or_insert(&map, 1, NULL) = 5;
+	CHECK(*fm64_lookup(&map, 1) == 5);
+	fm64_destroy(&map);
+	return true;
+}
@@ -0,0 +1,106 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "groupby.h"
+#include "hash.h"
+#include "random.h"
+#include "testing.h"
+
+#define hash_u32(key) (hash_int32(key).u32)
+
+DEFINE_GROUPBY(gb, uint32_t, int64_t, hash_u32, *key == entry->key)
+
+struct reference_group {
+	uint64_t count;
+	int64_t sum;
+	int64_t min;
+	int64_t max;
+};
+
+static bool check_groups(struct gb *tables, size_t num_tables, struct reference_group *ref, size_t num_keys)
+{
+	size_t num_groups = 0;
+	for (size_t t = 0; t < num_tables; t++) {
+		for (gb_iter_t iter = gb_iter_start(&tables[t]); !gb_iter_finished(&iter); gb_iter_advance(&iter)) {
+			struct gb_group *group = iter.entry;
+			CHECK(group->key < num_keys);
+			struct reference_group *r = &ref[group->key];
+			CHECK(group->count == r->count);
+			CHECK(group->sum == r->sum);
+			CHECK(group->min == r->min);
+			CHECK(group->max == r->max);
+			num_groups++;
+		}
+	}
+	size_t expected = 0;
+	for (size_t i = 0; i < num_keys; i++) {
+		expected += ref[i].count != 0;
+	}
+	CHECK(num_groups == expected);
+	return true;
+}
+
+RANDOM_TEST(groupby, 4, 0, UINT64_MAX)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+
+	size_t n = 1 + random_next_u32(&rng) % 100000;
+	uint32_t num_keys = 1 + random_next_u32(&rng) % 20000;
+	uint32_t *keys = malloc(n * sizeof(keys[0]));
+	int64_t *values = malloc(n * sizeof(values[0]));
+	struct reference_group *ref = calloc(num_keys, sizeof(ref[0]));
+	for (size_t i = 0; i < n; i++) {
+		keys[i] = random_next_u32(&rng) % num_keys;
+		values[i] = (int64_t)(random_next_u32(&rng) % 2001) - 1000;
+		struct reference_group *r = &ref[keys[i]];
+		if (r->count == 0 || values[i] < r->min) {
+			r->min = values[i];
+		}
+		if (r->count == 0 || values[i] > r->max) {
+			r->max = values[i];
+		}
+		r->count++;
+		r->sum += values[i];
+	}
+
+	// aggregate in two calls to check that existing groups are updated
+	struct gb table;
+	gb_init(&table, 0);
+	gb_aggregate(&table, keys, values, n / 2);
+	gb_aggregate(&table, keys + n / 2, values + n / 2, n - n / 2);
+	CHECK(check_groups(&table, 1, ref, num_keys));
+	gb_destroy(&table);
+
+	unsigned int bits = random_next_u32(&rng) % 7;
+	size_t num_tables = (size_t)1 << bits;
+	struct gb *tables = malloc(num_tables * sizeof(tables[0]));
+	for (size_t t = 0; t < num_tables; t++) {
+		gb_init(&tables[t], 0);
+	}
+	gb_aggregate_partitioned(tables, bits, keys, values, n);
+	CHECK(check_groups(tables, num_tables, ref, num_keys));
+	for (size_t t = 0; t < num_tables; t++) {
+		for (gb_iter_t iter = gb_iter_start(&tables[t]); !gb_iter_finished(&iter); gb_iter_advance(&iter)) {
+			CHECK(bits == 0 || hash_u32(iter.entry->key) >> (32 - bits) == t);
+		}
+		gb_destroy(&tables[t]);
+	}
+	free(tables);
+
+	free(keys);
+	free(values);
+	free(ref);
+	return true;
+}
+
+SIMPLE_TEST(groupby_partition_bits)
+{
+	CHECK(groupby_partition_bits(0, 64) == 0);
+	CHECK(groupby_partition_bits(100, 64) == 0);
+	unsigned int bits = groupby_partition_bits(10000000, 32);
+	CHECK(bits > 0 && bits <= GROUPBY_MAX_PARTITION_BITS);
+	CHECK((10000000 >> bits) * 2 * (32 + 4) <= GROUPBY_CACHE_SIZE);
+	CHECK(groupby_partition_bits(SIZE_MAX, 32) == GROUPBY_MAX_PARTITION_BITS);
+	return true;
+}
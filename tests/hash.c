@@ -718,6 +718,115 @@ SIMPLE_TEST(murmurhash3_x64_128)
 	return true;
 }
 
+RANDOM_TEST(siphash13_64_multi, 64, 0, UINT64_MAX)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+	uint8_t buffer[256];
+	uint8_t key[16];
+	for (size_t i = 0; i < sizeof(buffer); i++) {
+		buffer[i] = (uint8_t)random_next_u32(&rng);
+	}
+	for (size_t i = 0; i < sizeof(key); i++) {
+		key[i] = (uint8_t)random_next_u32(&rng);
+	}
+	const void *in[8];
+	size_t inlen[8];
+	for (size_t i = 0; i < 8; i++) {
+		// mostly short keys of different lengths
+		size_t max_len = random_next_u32(&rng) % 4 == 0 ? 128 : 24;
+		inlen[i] = random_next_u32(&rng) % (max_len + 1);
+		in[i] = buffer + random_next_u32(&rng) % (sizeof(buffer) - inlen[i] + 1);
+	}
+	hash64_t out[8];
+	siphash13_64_x4(in, inlen, key, out);
+	for (size_t i = 0; i < 4; i++) {
+		CHECK(memcmp(out[i].bytes, siphash13_64(in[i], inlen[i], key).bytes, sizeof(out[i])) == 0);
+	}
+	siphash13_64_x8(in, inlen, key, out);
+	for (size_t i = 0; i < 8; i++) {
+		CHECK(memcmp(out[i].bytes, siphash13_64(in[i], inlen[i], key).bytes, sizeof(out[i])) == 0);
+	}
+	return true;
+}
+
+static bool check_streaming(const uint8_t *in, size_t inlen, const uint8_t *key, struct random_state *rng)
+{
+	struct siphash_state sip24_64, sip24_128, sip13_64, sip13_128;
+	struct murmurhash3_x64_state murmur;
+	siphash24_init_64(&sip24_64, key);
+	siphash24_init_128(&sip24_128, key);
+	siphash13_init_64(&sip13_64, key);
+	siphash13_init_128(&sip13_128, key);
+	uint32_t seed;
+	memcpy(&seed, key, sizeof(seed));
+	murmurhash3_x64_init(&murmur, seed);
+	for (size_t pos = 0; pos < inlen;) {
+		size_t n = random_next_u32(rng) % (inlen - pos + 1);
+		if (random_next_u32(rng) % 2) {
+			n = n % 20;
+		}
+		siphash24_update(&sip24_64, in + pos, n);
+		siphash24_update(&sip24_128, in + pos, n);
+		siphash13_update(&sip13_64, in + pos, n);
+		siphash13_update(&sip13_128, in + pos, n);
+		murmurhash3_x64_update(&murmur, in + pos, n);
+		pos += n;
+	}
+	hash64_t h64 = siphash24_final_64(&sip24_64);
+	CHECK(memcmp(h64.bytes, siphash24_64(in, inlen, key).bytes, sizeof(h64)) == 0);
+	hash128_t h128 = siphash24_final_128(&sip24_128);
+	CHECK(memcmp(h128.bytes, siphash24_128(in, inlen, key).bytes, sizeof(h128)) == 0);
+	h64 = siphash13_final_64(&sip13_64);
+	CHECK(memcmp(h64.bytes, siphash13_64(in, inlen, key).bytes, sizeof(h64)) == 0);
+	h128 = siphash13_final_128(&sip13_128);
+	CHECK(memcmp(h128.bytes, siphash13_128(in, inlen, key).bytes, sizeof(h128)) == 0);
+	h128 = murmurhash3_x64_final_128(&murmur);
+	CHECK(memcmp(h128.bytes, murmurhash3_x64_128(in, inlen, seed).bytes, sizeof(h128)) == 0);
+	// final does not modify the state
+	h64 = murmurhash3_x64_final_64(&murmur);
+	CHECK(memcmp(h64.bytes, murmurhash3_x64_64(in, inlen, seed).bytes, sizeof(h64)) == 0);
+	return true;
+}
+
+RANDOM_TEST(streaming_hashes, 64, 0, UINT64_MAX)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+	uint8_t in[1024];
+	uint8_t key[16];
+	for (size_t i = 0; i < sizeof(in); i++) {
+		in[i] = (uint8_t)random_next_u32(&rng);
+	}
+	for (size_t i = 0; i < sizeof(key); i++) {
+		key[i] = (uint8_t)random_next_u32(&rng);
+	}
+	for (size_t inlen = 0; inlen < 40; inlen++) {
+		if (!check_streaming(in, inlen, key, &rng)) {
+			return false;
+		}
+	}
+	return check_streaming(in, random_next_u32(&rng) % (sizeof(in) + 1), key, &rng);
+}
+
+SIMPLE_TEST(xxh3_64)
+{
+	CHECK(xxh3_64(NULL, 0, 0).u64 == UINT64_C(0x2d06800538d394c2));
+	// covers all the input size classes (and the SIMD paths) with unaligned inputs and various seeds
+	static uint8_t hashes[2560][8];
+	static uint8_t in[2560];
+	for (uint32_t i = 0; i < 2560; i++) {
+		in[i] = (uint8_t)(i * 31 + 7);
+	}
+	for (uint32_t i = 0; i < 2560; i++) {
+		hash64_t hash = xxh3_64(in + (i & 3), i - (i & 3), i * UINT64_C(0x9e3779b97f4a7c15));
+		memcpy(hashes[i], hash.bytes, sizeof(hash));
+	}
+	hash64_t hash = xxh3_64(hashes, sizeof(hashes), 0);
+	CHECK(hash.u64 == UINT64_C(0xf080bd7fef6d1f99));
+	return true;
+}
+
 #if 0
 static void test_avalanche(void)
 {
@@ -857,3 +966,133 @@ SIMPLE_TEST(integer_hashes)
 	free(numbers);
 	return true;
 }
+
+SIMPLE_TEST(jump_consistent_hash)
+{
+	// from https://github.com/dgryski/go-jump
+	CHECK(jump_consistent_hash(1, 1) == 0);
+	CHECK(jump_consistent_hash(42, 57) == 43);
+	CHECK(jump_consistent_hash(0xdead10cc, 1) == 0);
+	CHECK(jump_consistent_hash(0xdead10cc, 666) == 361);
+	CHECK(jump_consistent_hash(256, 1024) == 520);
+
+	const size_t num_keys = 100000;
+	uint64_t *keys = malloc(num_keys * sizeof(keys[0]));
+	uint32_t *before = malloc(num_keys * sizeof(before[0]));
+	uint32_t *after = malloc(num_keys * sizeof(after[0]));
+	for (size_t i = 0; i < num_keys; i++) {
+		keys[i] = hash_int64(i).u64;
+	}
+	static const uint32_t sizes[] = {1, 2, 3, 10, 100, 1000, 12345};
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		uint32_t n = sizes[s];
+		// (odd count to cover the remainder of the batch)
+		jump_consistent_hash_batch(keys, num_keys - 1, n, before);
+		jump_consistent_hash_batch(keys, num_keys - 1, n + 1, after);
+		size_t moved = 0;
+		for (size_t i = 0; i < num_keys - 1; i++) {
+			CHECK(before[i] == jump_consistent_hash(keys[i], n));
+			CHECK(before[i] < n);
+			// keys only move to the new bucket
+			CHECK(after[i] == before[i] || after[i] == n);
+			moved += after[i] != before[i];
+		}
+		double expected = (double)(num_keys - 1) / (n + 1);
+		CHECK(fabs(moved - expected) < 5 * sqrt(expected) + 1);
+	}
+	free(keys);
+	free(before);
+	free(after);
+	return true;
+}
+
+SIMPLE_TEST(multiprobe_ring)
+{
+	const size_t num_shards = 64;
+	const size_t num_keys = 200000;
+	uint64_t shard_ids[64];
+	for (size_t i = 0; i < num_shards; i++) {
+		shard_ids[i] = 1000 + i;
+	}
+	uint64_t *keys = malloc(num_keys * sizeof(keys[0]));
+	uint32_t *before = malloc(num_keys * sizeof(before[0]));
+	for (size_t i = 0; i < num_keys; i++) {
+		keys[i] = hash_int64(i).u64;
+	}
+	struct multiprobe_ring ring;
+	multiprobe_ring_init(&ring, shard_ids, num_shards, MULTIPROBE_RING_DEFAULT_PROBES);
+	multiprobe_ring_lookup_batch(&ring, keys, num_keys, before);
+	size_t loads[64] = {0};
+	for (size_t i = 0; i < num_keys; i++) {
+		CHECK(before[i] < num_shards);
+		CHECK(before[i] == multiprobe_ring_lookup(&ring, keys[i]));
+		loads[before[i]]++;
+	}
+	size_t max_load = 0;
+	for (size_t i = 0; i < num_shards; i++) {
+		max_load = loads[i] > max_load ? loads[i] : max_load;
+	}
+	CHECK(max_load < 1.2 * num_keys / num_shards);
+	multiprobe_ring_destroy(&ring);
+
+	// remove shard 5 (the last one takes its index): only its keys move
+	shard_ids[5] = shard_ids[num_shards - 1];
+	multiprobe_ring_init(&ring, shard_ids, num_shards - 1, MULTIPROBE_RING_DEFAULT_PROBES);
+	for (size_t i = 0; i < num_keys; i++) {
+		uint32_t shard = multiprobe_ring_lookup(&ring, keys[i]);
+		if (before[i] == num_shards - 1) {
+			CHECK(shard == 5);
+		} else if (before[i] != 5) {
+			CHECK(shard == before[i]);
+		}
+	}
+	multiprobe_ring_destroy(&ring);
+	free(keys);
+	free(before);
+	return true;
+}
+
+SIMPLE_TEST(rendezvous_hash)
+{
+	const size_t num_shards = 8;
+	const size_t num_keys = 200000;
+	const uint64_t shard_ids[8] = {11, 22, 33, 44, 55, 66, 77, 88};
+	const double weights[8] = {1, 1, 2, 2, 4, 4, 1, 1};
+	uint64_t *keys = malloc(num_keys * sizeof(keys[0]));
+	uint32_t *out = malloc(num_keys * sizeof(out[0]));
+	for (size_t i = 0; i < num_keys; i++) {
+		keys[i] = hash_int64(i).u64;
+	}
+
+	rendezvous_hash_batch(keys, num_keys, shard_ids, weights, num_shards, out);
+	size_t loads[8] = {0};
+	for (size_t i = 0; i < num_keys; i++) {
+		CHECK(out[i] == rendezvous_hash(keys[i], shard_ids, weights, num_shards));
+		loads[out[i]]++;
+	}
+	for (size_t i = 0; i < num_shards; i++) {
+		double expected = num_keys * weights[i] / 16;
+		CHECK(fabs(loads[i] - expected) < 5 * sqrt(expected));
+	}
+
+	// without the last shard, only its keys move
+	for (size_t i = 0; i < num_keys; i++) {
+		uint32_t shard = rendezvous_hash(keys[i], shard_ids, weights, num_shards - 1);
+		CHECK(out[i] == num_shards - 1 || shard == out[i]);
+	}
+
+	rendezvous_hash_batch(keys, num_keys, shard_ids, NULL, num_shards, out);
+	memset(loads, 0, sizeof(loads));
+	for (size_t i = 0; i < num_keys; i++) {
+		CHECK(out[i] == rendezvous_hash(keys[i], shard_ids, NULL, num_shards));
+		CHECK(out[i] == num_shards - 1 || rendezvous_hash(keys[i], shard_ids, NULL, num_shards - 1) == out[i]);
+		loads[out[i]]++;
+	}
+	for (size_t i = 0; i < num_shards; i++) {
+		double expected = (double)num_keys / num_shards;
+		CHECK(fabs(loads[i] - expected) < 5 * sqrt(expected));
+	}
+	free(keys);
+	free(out);
+	return true;
+}
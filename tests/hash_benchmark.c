@@ -4,8 +4,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include "checksum.h"
 #include "hash.h"
+#include "histogram.h"
 #include "random.h"
+#include "rollhash.h"
 
 static struct random_state global_random_state;
 
@@ -29,36 +32,21 @@ static double ns_elapsed(struct timespec start, struct timespec end)
 	return ns + 1000000000 * s;
 }
 
-static int compare_doubles(const void *_a, const void *_b)
-{
-	double a = *(const double *)_a;
-	double b = *(const double *)_b;
-	return a < b ? -1 : (a == b ? 0 : 1);
-}
-
-static double get_median(double *values, size_t n)
-{
-	qsort(values, n, sizeof(values[0]), compare_doubles);
-	double x = 0.5 * (n - 1);
-	size_t idx0 = (size_t)x;
-	size_t idx1 = idx0 + (n != 1);
-	double fract = x - idx0;
-	return (1 - fract) * values[idx0] + fract * values[idx1];
-}
-
 static double overhead;
 
 static void measure_overhead(void)
 {
 	struct timespec start_tp, end_tp;
 	const unsigned int n = 10000;
-	double times[n];
+	struct ddsketch sketch;
+	ddsketch_init(&sketch, 0.01, DDSKETCH_DEFAULT_MAX_BUCKETS);
 	for (unsigned int i = 0; i < n; i++) {
 		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start_tp);
 		clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end_tp);
-		times[i] = ns_elapsed(start_tp, end_tp);
+		ddsketch_add(&sketch, ns_elapsed(start_tp, end_tp));
 	}
-	overhead = get_median(times, n);
+	overhead = ddsketch_quantile(&sketch, 0.5);
+	ddsketch_destroy(&sketch);
 }
 
 #define STRINGHASH_BENCHMARK(hash_call)					\
@@ -69,8 +57,9 @@ static void measure_overhead(void)
 		random_fill_buffer(input, 1u << max_shift);		\
 		for (unsigned int shift = 0; shift <= max_shift; shift++) { \
 			const size_t inlen = 1u << shift;		\
-			double times[5];				\
-			const unsigned int n = sizeof(times) / sizeof(times[0]); \
+			struct ddsketch sketch;				\
+			ddsketch_init(&sketch, 0.01, DDSKETCH_DEFAULT_MAX_BUCKETS); \
+			const unsigned int n = 5;			\
 			unsigned int d_shift = max_shift - shift;	\
 			const unsigned int iterations = (1u << d_shift) / (d_shift + 1) * 3; \
 			for (unsigned int k = 0; k < n; k++) {		\
@@ -81,9 +70,10 @@ static void measure_overhead(void)
 					asm volatile("" :: "g" (input), "g"(h) : "memory"); \
 				}					\
 				clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end_tp); \
-				times[k] = (ns_elapsed(start_tp, end_tp) - overhead) / iterations; \
+				ddsketch_add(&sketch, (ns_elapsed(start_tp, end_tp) - overhead) / iterations); \
 			}						\
-			double t = get_median(times, n);		\
+			double t = ddsketch_quantile(&sketch, 0.5);	\
+			ddsketch_destroy(&sketch);			\
 			printf("[%s] inlen=2^%2u: %16.2f ns %8.2f ns/B\n", \
 			       __func__ + strlen("benchmark_"), shift, t, t / inlen); \
 		}							\
@@ -93,8 +83,9 @@ static void measure_overhead(void)
 
 #define INTHASH_BENCHMARK(hash_call)					\
 	do {								\
-		double times[5];					\
-		const unsigned int n = sizeof(times) / sizeof(times[0]); \
+		struct ddsketch sketch;					\
+		ddsketch_init(&sketch, 0.01, DDSKETCH_DEFAULT_MAX_BUCKETS); \
+		const unsigned int n = 5;				\
 		const unsigned int iterations = 1 << 24;		\
 		for (unsigned int k = 0; k < n; k++) {			\
 			uint64_t input = random_next_u64(&global_random_state);	\
@@ -105,9 +96,10 @@ static void measure_overhead(void)
 				asm volatile("" :: "g" (input), "g"(h) : "memory"); \
 			}						\
 			clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end_tp); \
-			times[k] = (ns_elapsed(start_tp, end_tp) - overhead) / iterations; \
+			ddsketch_add(&sketch, (ns_elapsed(start_tp, end_tp) - overhead) / iterations); \
 		}							\
-		double t = get_median(times, n);			\
+		double t = ddsketch_quantile(&sketch, 0.5);		\
+		ddsketch_destroy(&sketch);				\
 		printf("[%s]: %16.2f ns\n", __func__ + strlen("benchmark_"), t); \
 	} while (0)
 
@@ -133,6 +125,43 @@ static void benchmark_siphash13_64(void)
 	STRINGHASH_BENCHMARK(siphash13_64(input, inlen, key));
 }
 
+// both report the time for hashing 8 inputs
+static hash64_t siphash13_64_8_serial(const void *input, size_t inlen, const void *key)
+{
+	hash64_t h = {0};
+	for (size_t i = 0; i < 8; i++) {
+		h.u64 ^= siphash13_64(input, inlen, key).u64;
+	}
+	return h;
+}
+
+static hash64_t siphash13_64_8_batch(const void *input, size_t inlen, const void *key)
+{
+	const void *in[8] = {input, input, input, input, input, input, input, input};
+	size_t lens[8] = {inlen, inlen, inlen, inlen, inlen, inlen, inlen, inlen};
+	hash64_t out[8];
+	siphash13_64_x8(in, lens, key, out);
+	hash64_t h = {0};
+	for (size_t i = 0; i < 8; i++) {
+		h.u64 ^= out[i].u64;
+	}
+	return h;
+}
+
+static void benchmark_siphash13_64_serial8(void)
+{
+	uint8_t key[16];
+	random_fill_buffer(key, sizeof(key));
+	STRINGHASH_BENCHMARK(siphash13_64_8_serial(input, inlen, key));
+}
+
+static void benchmark_siphash13_64_x8(void)
+{
+	uint8_t key[16];
+	random_fill_buffer(key, sizeof(key));
+	STRINGHASH_BENCHMARK(siphash13_64_8_batch(input, inlen, key));
+}
+
 static void benchmark_siphash13_128(void)
 {
 	uint8_t key[16];
@@ -198,6 +227,129 @@ static void benchmark_murmurhash3_x64_128(void)
 	STRINGHASH_BENCHMARK(murmurhash3_x64_128(input, inlen, seed));
 }
 
+static void benchmark_xxh3_64(void)
+{
+	uint64_t seed = random_next_u64(&global_random_state);
+	STRINGHASH_BENCHMARK(xxh3_64(input, inlen, seed));
+}
+
+static void benchmark_crc32c(void)
+{
+	STRINGHASH_BENCHMARK(crc32c(CRC32C_INIT, input, inlen));
+}
+
+static void benchmark_adler32(void)
+{
+	STRINGHASH_BENCHMARK(adler32(ADLER32_INIT, input, inlen));
+}
+
+static size_t count_chunks(const struct cdc_chunker *chunker, const void *data, size_t size)
+{
+	size_t count = 0;
+	for (struct cdc_iterator iter = cdc_iter_start(chunker, data, size, true);
+	     !cdc_iter_finished(&iter); cdc_iter_advance(&iter)) {
+		count++;
+	}
+	return count;
+}
+
+#define CDC_BENCHMARK(algorithm)					\
+	do {								\
+		struct cdc_chunker chunker;				\
+		cdc_init(&chunker, algorithm, 2048, 8192, 65536);	\
+		STRINGHASH_BENCHMARK(count_chunks(&chunker, input, inlen)); \
+	} while (0)
+
+static void benchmark_cdc_gear(void)
+{
+	CDC_BENCHMARK(CDC_GEAR);
+}
+
+static void benchmark_cdc_buzhash(void)
+{
+	CDC_BENCHMARK(CDC_BUZHASH);
+}
+
+static void benchmark_cdc_rabin_karp(void)
+{
+	CDC_BENCHMARK(CDC_RABIN_KARP);
+}
+
+// 'route' routes keys[0..num_keys) to num_shards shards and stores the results in shards[]
+#define ROUTING_BENCHMARK(setup, route, cleanup)			\
+	do {								\
+		const size_t num_keys = 1 << 16;			\
+		uint64_t *keys = malloc(num_keys * sizeof(keys[0]));	\
+		uint32_t *shards = malloc(num_keys * sizeof(shards[0])); \
+		uint64_t *shard_ids = malloc(4096 * sizeof(shard_ids[0])); \
+		double *weights = malloc(4096 * sizeof(weights[0]));	\
+		assert(keys && shards && shard_ids && weights);		\
+		for (size_t i = 0; i < num_keys; i++) {			\
+			keys[i] = random_next_u64(&global_random_state); \
+		}							\
+		for (size_t i = 0; i < 4096; i++) {			\
+			shard_ids[i] = random_next_u64(&global_random_state); \
+			weights[i] = 1 + (double)(i % 4);		\
+		}							\
+		for (size_t num_shards = 4; num_shards <= 4096; num_shards *= 4) { \
+			setup;						\
+			struct ddsketch sketch;				\
+			ddsketch_init(&sketch, 0.01, DDSKETCH_DEFAULT_MAX_BUCKETS); \
+			const unsigned int n = 5;			\
+			for (unsigned int k = 0; k < n; k++) {		\
+				struct timespec start_tp, end_tp;	\
+				clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start_tp); \
+				route;					\
+				asm volatile("" :: "g" (shards) : "memory"); \
+				clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end_tp); \
+				ddsketch_add(&sketch, (ns_elapsed(start_tp, end_tp) - overhead) / num_keys); \
+			}						\
+			cleanup;					\
+			double t = ddsketch_quantile(&sketch, 0.5);	\
+			ddsketch_destroy(&sketch);			\
+			printf("[%s] shards=%4zu: %8.2f ns/key\n",	\
+			       __func__ + strlen("benchmark_"), num_shards, t); \
+		}							\
+		free(keys);						\
+		free(shards);						\
+		free(shard_ids);					\
+		free(weights);						\
+		putchar('\n');						\
+	} while (0)
+
+static void benchmark_mod_routing(void)
+{
+	ROUTING_BENCHMARK(, for (size_t i = 0; i < num_keys; i++) shards[i] = keys[i] % num_shards, );
+}
+
+static void benchmark_jump_consistent_hash(void)
+{
+	ROUTING_BENCHMARK(, for (size_t i = 0; i < num_keys; i++) shards[i] = jump_consistent_hash(keys[i], num_shards), );
+}
+
+static void benchmark_jump_consistent_hash_batch(void)
+{
+	ROUTING_BENCHMARK(, jump_consistent_hash_batch(keys, num_keys, num_shards, shards), );
+}
+
+static void benchmark_multiprobe_ring(void)
+{
+	struct multiprobe_ring ring;
+	ROUTING_BENCHMARK(multiprobe_ring_init(&ring, shard_ids, num_shards, MULTIPROBE_RING_DEFAULT_PROBES),
+			  multiprobe_ring_lookup_batch(&ring, keys, num_keys, shards),
+			  multiprobe_ring_destroy(&ring));
+}
+
+static void benchmark_rendezvous_hash(void)
+{
+	ROUTING_BENCHMARK(, rendezvous_hash_batch(keys, num_keys, shard_ids, NULL, num_shards, shards), );
+}
+
+static void benchmark_rendezvous_hash_weighted(void)
+{
+	ROUTING_BENCHMARK(, rendezvous_hash_batch(keys, num_keys, shard_ids, weights, num_shards, shards), );
+}
+
 static void benchmark_hash_int32(void)
 {
 	INTHASH_BENCHMARK(hash_int32(input));
@@ -241,6 +393,8 @@ int main(int argc, char **argv)
 		B(siphash24_64),
 		B(siphash24_128),
 		B(siphash13_64),
+		B(siphash13_64_serial8),
+		B(siphash13_64_x8),
 		B(siphash13_128),
 		B(halfsiphash24_32),
 		B(halfsiphash24_64),
@@ -251,12 +405,24 @@ int main(int argc, char **argv)
 		B(murmurhash3_x86_128),
 		B(murmurhash3_x64_64),
 		B(murmurhash3_x64_128),
+		B(xxh3_64),
+		B(crc32c),
+		B(adler32),
+		B(cdc_gear),
+		B(cdc_buzhash),
+		B(cdc_rabin_karp),
 		B(hash_int32),
 		B(hash_int64),
 		B(fibonacci_hash32),
 		B(fibonacci_hash64),
 		B(hash_combine_int32),
 		B(hash_combine_int64),
+		B(mod_routing),
+		B(jump_consistent_hash),
+		B(jump_consistent_hash_batch),
+		B(multiprobe_ring),
+		B(rendezvous_hash),
+		B(rendezvous_hash_weighted),
 	};
 
 	for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
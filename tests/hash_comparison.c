@@ -91,6 +91,11 @@ static uint32_t murmur3(const char *str)
 	return murmurhash3_x64_64(str, strlen(str), 0).u64;
 }
 
+static uint32_t xxh3(const char *str)
+{
+	return xxh3_64(str, strlen(str), 0).u64;
+}
+
 static const uint64_t siphash_key[] = {0xdeadbeef, 0xcafebabe};
 
 static uint32_t siphash24(const char *str)
@@ -156,11 +161,6 @@ static uint32_t xxh64(const char *str)
 {
 	return XXH64(str, strlen(str), 0);
 }
-
-static uint32_t xxh3_64(const char *str)
-{
-	return XXH3_64bits(str, strlen(str));
-}
 #endif
 
 #ifdef HAVE_OPENSSL
@@ -259,6 +259,7 @@ int main(int argc, char **argv)
 	} benchmarks[] = {
 #define B(name) {#name, name}
 		B(murmur3),
+		B(xxh3),
 		B(siphash24),
 		B(siphash13),
 		B(fnv1),
@@ -268,7 +269,6 @@ int main(int argc, char **argv)
 #ifdef HAVE_XXHASH
 		B(xxh32),
 		B(xxh64),
-		B(xxh3_64),
 #endif
 // #ifdef HAVE_OPENSSL
 // 		B(md5),
@@ -0,0 +1,524 @@
+#include <assert.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "compiler.h"
+#include "hash.h"
+#include "histogram.h"
+#include "random.h"
+#include "utils.h"
+
+/* A small subset of SMHasher: avalanche (strict avalanche criterion), bit independence, bucket distribution
+ * (including a simulation of the quadratic probing table) and throughput for every hash in hash.h.
+ * The streaming and multi-lane siphash/murmurhash3 functions produce the same outputs as the one-shot ones,
+ * so they are not listed separately.
+ */
+
+struct hash_func {
+	const char *name;
+	unsigned int out_bits;
+	// exactly one of these is set, integer hashes take key_bits wide keys
+	uint64_t (*bytes)(const void *in, size_t len);
+	uint64_t (*integer)(uint64_t key);
+	unsigned int key_bits;
+	// the table index is taken from the high bits of the hash (fibonacci hashing) instead of the low bits
+	bool high_bits;
+};
+
+static const uint64_t siphash_key[2] = {UINT64_C(0x0706050403020100), UINT64_C(0x0f0e0d0c0b0a0908)};
+
+static uint64_t low64(hash128_t h)
+{
+	uint64_t x;
+	memcpy(&x, h.bytes, sizeof(x));
+	return x;
+}
+
+static uint64_t h_siphash24_64(const void *in, size_t len) { return siphash24_64(in, len, siphash_key).u64; }
+static uint64_t h_siphash24_128(const void *in, size_t len) { return low64(siphash24_128(in, len, siphash_key)); }
+static uint64_t h_siphash13_64(const void *in, size_t len) { return siphash13_64(in, len, siphash_key).u64; }
+static uint64_t h_siphash13_128(const void *in, size_t len) { return low64(siphash13_128(in, len, siphash_key)); }
+static uint64_t h_halfsiphash24_32(const void *in, size_t len) { return halfsiphash24_32(in, len, siphash_key).u32; }
+static uint64_t h_halfsiphash24_64(const void *in, size_t len) { return halfsiphash24_64(in, len, siphash_key).u64; }
+static uint64_t h_halfsiphash13_32(const void *in, size_t len) { return halfsiphash13_32(in, len, siphash_key).u32; }
+static uint64_t h_halfsiphash13_64(const void *in, size_t len) { return halfsiphash13_64(in, len, siphash_key).u64; }
+static uint64_t h_murmurhash3_x86_32(const void *in, size_t len) { return murmurhash3_x86_32(in, len, 0).u32; }
+static uint64_t h_murmurhash3_x86_64(const void *in, size_t len) { return murmurhash3_x86_64(in, len, 0).u64; }
+static uint64_t h_murmurhash3_x86_128(const void *in, size_t len) { return low64(murmurhash3_x86_128(in, len, 0)); }
+static uint64_t h_murmurhash3_x64_64(const void *in, size_t len) { return murmurhash3_x64_64(in, len, 0).u64; }
+static uint64_t h_murmurhash3_x64_128(const void *in, size_t len) { return low64(murmurhash3_x64_128(in, len, 0)); }
+static uint64_t h_xxh3_64(const void *in, size_t len) { return xxh3_64(in, len, 0).u64; }
+
+// what an "I'll just use the key" table does
+static uint64_t h_identity32(uint64_t key) { return (uint32_t)key; }
+static uint64_t h_identity64(uint64_t key) { return key; }
+static uint64_t h_hash_int32(uint64_t key) { return hash_int32(key).u32; }
+static uint64_t h_hash_int64(uint64_t key) { return hash_int64(key).u64; }
+static uint64_t h_fibonacci_hash32(uint64_t key) { return fibonacci_hash32(key, 32).u32; }
+static uint64_t h_fibonacci_hash64(uint64_t key) { return fibonacci_hash64(key, 64).u64; }
+// combining with a fixed seed, as when hashing the second member of a struct
+static uint64_t h_hash_combine_int32(uint64_t key) { return hash_combine_int32(UINT32_C(0x9e3779b9), key).u32; }
+static uint64_t h_hash_combine_int64(uint64_t key) { return hash_combine_int64(UINT64_C(0x9e3779b97f4a7c15), key).u64; }
+
+static const struct hash_func hash_funcs[] = {
+#define B(name, bits) {#name, bits, h_##name, NULL, 0, false}
+#define I(name, bits, high) {#name, bits, NULL, h_##name, bits, high}
+	B(siphash24_64, 64),
+	B(siphash24_128, 64),
+	B(siphash13_64, 64),
+	B(siphash13_128, 64),
+	B(halfsiphash24_32, 32),
+	B(halfsiphash24_64, 64),
+	B(halfsiphash13_32, 32),
+	B(halfsiphash13_64, 64),
+	B(murmurhash3_x86_32, 32),
+	B(murmurhash3_x86_64, 64),
+	B(murmurhash3_x86_128, 64),
+	B(murmurhash3_x64_64, 64),
+	B(murmurhash3_x64_128, 64),
+	B(xxh3_64, 64),
+	I(identity32, 32, false),
+	I(identity64, 64, false),
+	I(hash_int32, 32, false),
+	I(hash_int64, 64, false),
+	I(fibonacci_hash32, 32, true),
+	I(fibonacci_hash64, 64, true),
+	I(hash_combine_int32, 32, false),
+	I(hash_combine_int64, 64, false),
+#undef B
+#undef I
+};
+
+static struct random_state rng;
+static size_t num_samples = 10000;
+
+static void random_fill_buffer(void *buf, size_t size)
+{
+	uint8_t *p = buf;
+	while (size >= 8) {
+		uint64_t r = random_next_u64(&rng);
+		memcpy(p, &r, 8);
+		p += 8;
+		size -= 8;
+	}
+	uint64_t r = random_next_u64(&rng);
+	memcpy(p, &r, size);
+}
+
+// integer hashes get their key in the low key_bits bits of the (little endian) buffer
+static uint64_t hash_buffer(const struct hash_func *func, const uint8_t *buf, size_t len)
+{
+	if (func->bytes) {
+		return func->bytes(buf, len);
+	}
+	uint64_t key = 0;
+	for (size_t i = 0; i < len; i++) {
+		key |= (uint64_t)buf[i] << (8 * i);
+	}
+	return func->integer(key);
+}
+
+static uint64_t output_mask(const struct hash_func *func)
+{
+	return func->out_bits == 64 ? UINT64_MAX : (UINT64_C(1) << func->out_bits) - 1;
+}
+
+// the largest deviation expected from an ideal hash (about 3.5 standard deviations of the largest of n cells)
+static double noise_floor(size_t cells, size_t samples)
+{
+	return sqrt(2 * log((double)cells) + 3) / sqrt((double)samples);
+}
+
+/* For every input bit, flip it and count how often each output bit changes, an ideal hash changes every
+ * output bit with a probability of 50%. The bias of a cell is |2p - 1|.
+ */
+static void test_avalanche(const struct hash_func *func, size_t len)
+{
+	size_t in_bits = 8 * len;
+	size_t out_bits = func->out_bits;
+	uint32_t *counts = calloc(in_bits * out_bits, sizeof(counts[0]));
+	uint8_t *buf = malloc(len);
+	if (!counts || !buf) {
+		abort();
+	}
+	for (size_t s = 0; s < num_samples; s++) {
+		random_fill_buffer(buf, len);
+		uint64_t h = hash_buffer(func, buf, len);
+		for (size_t i = 0; i < in_bits; i++) {
+			buf[i / 8] ^= 1u << (i % 8);
+			uint64_t d = (h ^ hash_buffer(func, buf, len)) & output_mask(func);
+			buf[i / 8] ^= 1u << (i % 8);
+			while (d) {
+				counts[i * out_bits + ctz(d)]++;
+				d &= d - 1;
+			}
+		}
+	}
+	double worst = 0, sum_squares = 0;
+	size_t worst_in = 0, worst_out = 0;
+	for (size_t i = 0; i < in_bits; i++) {
+		for (size_t j = 0; j < out_bits; j++) {
+			double bias = fabs(2.0 * counts[i * out_bits + j] / num_samples - 1);
+			sum_squares += bias * bias;
+			if (bias > worst) {
+				worst = bias;
+				worst_in = i;
+				worst_out = j;
+			}
+		}
+	}
+	double floor = noise_floor(in_bits * out_bits, num_samples);
+	printf("  %-20s %4zu B: worst bias %6.4f (in bit %3zu, out bit %2zu), rms %6.4f, noise ~%6.4f %s\n",
+	       func->name, len, worst, worst_in, worst_out, sqrt(sum_squares / (in_bits * out_bits)), floor,
+	       worst > 1.5 * floor ? "<-- BIASED" : "");
+	free(counts);
+	free(buf);
+}
+
+/* Bit independence criterion: flipping an input bit should flip any two output bits independently.
+ * Reports the largest correlation (phi coefficient) between the changes of two output bits.
+ */
+static void test_bic(const struct hash_func *func, size_t len)
+{
+	size_t in_bits = 8 * len;
+	size_t out_bits = func->out_bits;
+	uint32_t *single = malloc(out_bits * sizeof(single[0]));
+	uint32_t *pair = malloc(out_bits * out_bits * sizeof(pair[0]));
+	uint8_t *bufs = malloc(num_samples * len);
+	uint64_t *hashes = malloc(num_samples * sizeof(hashes[0]));
+	if (!single || !pair || !bufs || !hashes) {
+		abort();
+	}
+	random_fill_buffer(bufs, num_samples * len);
+	for (size_t s = 0; s < num_samples; s++) {
+		hashes[s] = hash_buffer(func, bufs + s * len, len);
+	}
+	double worst = 0;
+	size_t worst_in = 0, worst_out1 = 0, worst_out2 = 0;
+	const double n = num_samples;
+	for (size_t i = 0; i < in_bits; i++) {
+		memset(single, 0, out_bits * sizeof(single[0]));
+		memset(pair, 0, out_bits * out_bits * sizeof(pair[0]));
+		for (size_t s = 0; s < num_samples; s++) {
+			uint8_t *buf = bufs + s * len;
+			buf[i / 8] ^= 1u << (i % 8);
+			uint64_t d = (hashes[s] ^ hash_buffer(func, buf, len)) & output_mask(func);
+			buf[i / 8] ^= 1u << (i % 8);
+			for (uint64_t a = d; a; a &= a - 1) {
+				size_t j = ctz(a);
+				single[j]++;
+				for (uint64_t b = a & (a - 1); b; b &= b - 1) {
+					pair[j * out_bits + ctz(b)]++;
+				}
+			}
+		}
+		for (size_t j = 0; j < out_bits; j++) {
+			for (size_t k = j + 1; k < out_bits; k++) {
+				double nj = single[j], nk = single[k];
+				double denominator = sqrt(nj * (n - nj) * nk * (n - nk));
+				// an output bit that always or never changes is already reported by the avalanche test
+				double phi = denominator == 0 ? 1 : fabs(pair[j * out_bits + k] * n - nj * nk) / denominator;
+				if (phi > worst) {
+					worst = phi;
+					worst_in = i;
+					worst_out1 = j;
+					worst_out2 = k;
+				}
+			}
+		}
+	}
+	double floor = noise_floor(in_bits * out_bits * (out_bits - 1) / 2, num_samples);
+	printf("  %-20s %4zu B: worst correlation %6.4f (in bit %3zu, out bits %2zu/%2zu), noise ~%6.4f %s\n",
+	       func->name, len, worst, worst_in, worst_out1, worst_out2, floor,
+	       worst > 1.5 * floor ? "<-- CORRELATED" : "");
+	free(single);
+	free(pair);
+	free(bufs);
+	free(hashes);
+}
+
+enum key_set {
+	KEYS_SEQUENTIAL, // 0, 1, 2, ...
+	KEYS_ALIGNED,    // i * 64, like pointers to cache line aligned allocations
+	KEYS_SPARSE,     // i << (key_bits / 2), only the high half changes
+	KEYS_RANDOM,
+	KEYS_TEXT,       // "key:0", "key:1", ... (byte hashes only)
+	KEYS_WORDS,      // random lowercase words of 4 to 12 letters, with a few duplicates (byte hashes only)
+	NUM_KEY_SETS,
+};
+
+static const char *key_set_names[NUM_KEY_SETS] = {"sequential", "aligned", "sparse", "random", "text", "words"};
+
+// returns the length of the key (integer keys are stored little endian)
+static size_t make_key(enum key_set set, size_t i, unsigned int key_bits, uint8_t buf[32])
+{
+	uint64_t key;
+	switch (set) {
+	case KEYS_SEQUENTIAL:
+		key = i;
+		break;
+	case KEYS_ALIGNED:
+		key = (uint64_t)i * 64;
+		break;
+	case KEYS_SPARSE:
+		key = (uint64_t)i << (key_bits / 2);
+		break;
+	case KEYS_RANDOM:
+		key = random_next_u64(&rng);
+		break;
+	case KEYS_TEXT:
+		return (size_t)sprintf((char *)buf, "key:%zu", i);
+	case KEYS_WORDS: {
+		size_t len = random_next_u32_in_range(&rng, 4, 12);
+		for (size_t k = 0; k < len; k++) {
+			buf[k] = 'a' + random_next_u32_in_range(&rng, 0, 25);
+		}
+		return len;
+	}
+	default:
+		abort();
+	}
+	for (size_t k = 0; k < key_bits / 8; k++) {
+		buf[k] = (uint8_t)(key >> (8 * k));
+	}
+	return key_bits / 8;
+}
+
+static int compare_u64(const void *_a, const void *_b)
+{
+	uint64_t a = *(const uint64_t *)_a;
+	uint64_t b = *(const uint64_t *)_b;
+	return a < b ? -1 : (a == b ? 0 : 1);
+}
+
+/* Inserts 3/4 * 2^table_bits keys into 2^table_bits buckets (indexed like the quadratic hashtable does) and
+ * reports the sum of squared bucket sizes relative to what a random function gives (1.0 is ideal, the
+ * tables slow down long before 2.0), the largest bucket, the average and maximum number of probes with
+ * triangular probing at that load, and the number of full hash collisions (relative to the expected number).
+ */
+static void test_buckets(const struct hash_func *func, enum key_set set, unsigned int table_bits)
+{
+	const size_t m = (size_t)1 << table_bits;
+	const size_t n = m / 4 * 3;
+	uint32_t *buckets = calloc(m, sizeof(buckets[0]));
+	bool *occupied = calloc(m, sizeof(occupied[0]));
+	uint64_t *hashes = malloc(n * sizeof(hashes[0]));
+	if (!buckets || !occupied || !hashes) {
+		abort();
+	}
+	unsigned int key_bits = func->bytes ? 64 : func->key_bits;
+	size_t total_probes = 0, max_probes = 0;
+	for (size_t i = 0; i < n; i++) {
+		uint8_t buf[32];
+		size_t len = make_key(set, i, key_bits, buf);
+		uint64_t h = hash_buffer(func, buf, len);
+		hashes[i] = h;
+		size_t index = func->high_bits ? (size_t)(h >> (func->out_bits - table_bits)) : (size_t)(h & (m - 1));
+		buckets[index]++;
+		size_t probes = 1;
+		for (size_t increment = 1; occupied[index]; increment++, probes++) {
+			index = (index + increment) & (m - 1);
+		}
+		occupied[index] = true;
+		total_probes += probes;
+		max_probes = max(max_probes, probes);
+	}
+	double sum_squares = 0;
+	uint32_t largest = 0;
+	for (size_t i = 0; i < m; i++) {
+		sum_squares += (double)buckets[i] * buckets[i];
+		largest = max(largest, buckets[i]);
+	}
+	double expected_squares = n + (double)n * (n - 1) / m;
+	qsort(hashes, n, sizeof(hashes[0]), compare_u64);
+	size_t collisions = 0;
+	for (size_t i = 1; i < n; i++) {
+		collisions += hashes[i] == hashes[i - 1];
+	}
+	double expected_collisions = (double)n * (n - 1) / 2 / ldexp(1, (int)func->out_bits);
+	double ratio = sum_squares / expected_squares;
+	printf("  %-20s %-10s: %6.3f squares ratio, largest bucket %3" PRIu32 ", probes avg %7.2f max %7zu, "
+	       "%zu collisions (%.1f expected) %s\n",
+	       func->name, key_set_names[set], ratio, largest, (double)total_probes / n, max_probes, collisions,
+	       expected_collisions, ratio > 1.05 || max_probes > 1000 ? "<-- CLUSTERED" : "");
+	free(buckets);
+	free(occupied);
+	free(hashes);
+}
+
+static double ns_elapsed(struct timespec start, struct timespec end)
+{
+	double s = end.tv_sec - start.tv_sec;
+	double ns = end.tv_nsec - start.tv_nsec;
+	return ns + 1000000000 * s;
+}
+
+// median ns per call of the function at the given offset into input (hashes are called through a pointer)
+static double time_hash(const struct hash_func *func, const uint8_t *input, size_t len)
+{
+	const size_t iterations = max((size_t)(1 << 22) / len, (size_t)16);
+	const size_t n = 5;
+	struct ddsketch sketch;
+	ddsketch_init(&sketch, 0.01, DDSKETCH_DEFAULT_MAX_BUCKETS);
+	for (size_t k = 0; k < n; k++) {
+		struct timespec start_tp, end_tp;
+		clock_gettime(CLOCK_MONOTONIC, &start_tp);
+		if (func->bytes) {
+			for (size_t i = 0; i < iterations; i++) {
+				uint64_t h = func->bytes(input, len);
+				asm volatile("" :: "g"(input), "g"(h) : "memory");
+			}
+		} else {
+			for (size_t i = 0; i < iterations; i++) {
+				uint64_t h = func->integer(i);
+				asm volatile("" :: "g"(h) : "memory");
+			}
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end_tp);
+		ddsketch_add(&sketch, ns_elapsed(start_tp, end_tp) / iterations);
+	}
+	double t = ddsketch_quantile(&sketch, 0.5);
+	ddsketch_destroy(&sketch);
+	return t;
+}
+
+static void test_speed(const struct hash_func *func)
+{
+	if (func->integer) {
+		printf("  %-20s %8.2f ns\n", func->name, time_hash(func, NULL, 1));
+		return;
+	}
+	const unsigned int max_shift = 20;
+	uint8_t *buffer = aligned_alloc(64, ((size_t)1 << max_shift) + 64);
+	if (!buffer) {
+		abort();
+	}
+	random_fill_buffer(buffer, ((size_t)1 << max_shift) + 64);
+	printf("  %-20s %10s %12s %12s\n", func->name, "length", "aligned", "unaligned");
+	for (unsigned int shift = 0; shift <= max_shift; shift++) {
+		size_t len = (size_t)1 << shift;
+		double aligned = time_hash(func, buffer, len);
+		double unaligned = time_hash(func, buffer + 1, len);
+		if (len < 1024) {
+			printf("  %-20s %10zu %9.2f ns %9.2f ns\n", "", len, aligned, unaligned);
+		} else {
+			printf("  %-20s %10zu %7.2f GB/s %7.2f GB/s\n", "", len, len / aligned, len / unaligned);
+		}
+	}
+	free(buffer);
+}
+
+static bool selected(const struct hash_func *func, int argc, char **argv)
+{
+	if (argc == 0) {
+		return true;
+	}
+	for (int i = 0; i < argc; i++) {
+		if (strstr(func->name, argv[i])) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void usage(const char *argv0)
+{
+	fprintf(stderr, "usage: %s [-t avalanche|bic|buckets|speed] [-n samples] [-b table bits] [hash name...]\n",
+		argv0);
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	const char *test = NULL;
+	unsigned int table_bits = 16;
+	int opt;
+	while ((opt = getopt(argc, argv, "t:n:b:h")) != -1) {
+		switch (opt) {
+		case 't':
+			test = optarg;
+			break;
+		case 'n':
+			num_samples = strtoul(optarg, NULL, 0);
+			break;
+		case 'b':
+			table_bits = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (num_samples == 0 || table_bits < 4 || table_bits > 30) {
+		usage(argv[0]);
+	}
+	const char *argv0 = argv[0];
+	argc -= optind;
+	argv += optind;
+	const size_t num_funcs = sizeof(hash_funcs) / sizeof(hash_funcs[0]);
+
+	if (!test || strcmp(test, "avalanche") == 0) {
+		printf("avalanche (%zu samples)\n", num_samples);
+		for (size_t i = 0; i < num_funcs; i++) {
+			const struct hash_func *func = &hash_funcs[i];
+			if (!selected(func, argc, argv)) {
+				continue;
+			}
+			if (func->integer) {
+				random_state_init(&rng, 0xdeadbeef);
+				test_avalanche(func, func->key_bits / 8);
+				continue;
+			}
+			static const size_t lengths[] = {3, 4, 8, 16, 64};
+			for (size_t k = 0; k < sizeof(lengths) / sizeof(lengths[0]); k++) {
+				random_state_init(&rng, 0xdeadbeef);
+				test_avalanche(func, lengths[k]);
+			}
+		}
+	}
+	if (!test || strcmp(test, "bic") == 0) {
+		printf("bit independence (%zu samples)\n", num_samples);
+		for (size_t i = 0; i < num_funcs; i++) {
+			const struct hash_func *func = &hash_funcs[i];
+			if (selected(func, argc, argv)) {
+				random_state_init(&rng, 0xdeadbeef);
+				test_bic(func, func->integer ? func->key_bits / 8 : 8);
+			}
+		}
+	}
+	if (!test || strcmp(test, "buckets") == 0) {
+		printf("buckets (2^%u buckets, 75%% load)\n", table_bits);
+		for (size_t i = 0; i < num_funcs; i++) {
+			const struct hash_func *func = &hash_funcs[i];
+			if (!selected(func, argc, argv)) {
+				continue;
+			}
+			for (enum key_set set = 0; set < NUM_KEY_SETS; set++) {
+				if (func->integer && (set == KEYS_TEXT || set == KEYS_WORDS)) {
+					continue;
+				}
+				random_state_init(&rng, 0xdeadbeef);
+				test_buckets(func, set, table_bits);
+			}
+		}
+	}
+	if (!test || strcmp(test, "speed") == 0) {
+		printf("speed\n");
+		for (size_t i = 0; i < num_funcs; i++) {
+			const struct hash_func *func = &hash_funcs[i];
+			if (selected(func, argc, argv)) {
+				random_state_init(&rng, 0xdeadbeef);
+				test_speed(func);
+			}
+		}
+	}
+	if (test && strcmp(test, "avalanche") != 0 && strcmp(test, "bic") != 0 && strcmp(test, "buckets") != 0 &&
+	    strcmp(test, "speed") != 0) {
+		usage(argv0);
+	}
+	return 0;
+}
@@ -98,3 +98,44 @@ RANDOM_TEST(hashmap, 2, 0, UINT64_MAX)
 
 	return true;
 }
+
+RANDOM_TEST(hashmap_lookup_or_insert, 2, 0, UINT64_MAX)
+{
+	struct itable itable;
+	itable_init(&itable, 16);
+	unsigned char present[1 << 12] = {0};
+	size_t num_present = 0;
+
+	struct random_state rng;
+	random_state_init(&rng, random);
+
+	for (unsigned long counter = 0; counter < 100000; counter++) {
+		int x = random_next_u32(&rng) % (1 << 12);
+		if (random_next_u32(&rng) % 4 != 0) {
+			bool found;
+			struct itable_entry *entry = itable_lookup_or_insert(&itable, x, integer_hash(x), &found);
+			CHECK(found == present[x]);
+			if (found) {
+				CHECK(entry->key == x && entry->value == x);
+			} else {
+				entry->key = x;
+				entry->value = x;
+				present[x] = 1;
+				num_present++;
+			}
+		} else if (present[x]) {
+			CHECK(itable_remove(&itable, x, integer_hash(x), NULL));
+			present[x] = 0;
+			num_present--;
+		}
+		CHECK(itable_num_entries(&itable) == num_present);
+	}
+
+	for (int x = 0; x < (1 << 12); x++) {
+		CHECK(!!itable_lookup(&itable, x, integer_hash(x)) == present[x]);
+	}
+
+	itable_destroy(&itable);
+
+	return true;
+}
@@ -0,0 +1,10 @@
+#ifndef __HASHTABLE_IMPLEMENTATIONS_INCLUDE__
+#define __HASHTABLE_IMPLEMENTATIONS_INCLUDE__
+
+/* The hashtable implementations that the replay tool and the benchmark suite are built with.
+ * Each one is compiled with HASHTABLE_<IMPL> defined (see hashtable.h). tests/CMakeLists.txt reads this list,
+ * so adding an implementation here adds it to both tools.
+ */
+#define HASHTABLE_IMPLEMENTATIONS(X) X(quadratic) X(hopscotch) X(robinhood)
+
+#endif
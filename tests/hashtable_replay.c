@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "array.h"
+#include "config.h"
+#include "hash.h"
+#include "random.h"
+#include "utils.h"
+#define HASHTABLE_TRACING
+#include "hashtable.h"
+#include "hashtable_trace.h"
+#include "hashtable_replay.h"
+
+/* Usage:
+ *   hashtable_replay record <trace> [num_ops]   record a synthetic skewed and churny workload
+ *   hashtable_replay <trace>...                 replay traces with every implementation and threshold
+ * Recording uses the implementation selected with HASHTABLE_IMPLEMENTATION at configure time.
+ */
+
+struct implementation {
+	const char *name;
+	void (*run)(const struct hashtable_trace_record *records, size_t num_records, size_t entry_size,
+		    unsigned int threshold, bool measure, struct hashtable_replay_stats *stats);
+};
+
+static const struct implementation implementations[] = {
+#define X(impl) {#impl, hashtable_replay_run_##impl},
+	HASHTABLE_IMPLEMENTATIONS(X)
+#undef X
+};
+
+struct session {
+	uint64_t id;
+	uint64_t last_seen;
+	char payload[48];
+};
+
+DEFINE_HASHTABLE(session_table, uint64_t, struct session, 8, entry->id == *key)
+
+static int record_synthetic(const char *path, size_t num_ops)
+{
+	FILE *file = fopen(path, "wb");
+	if (!file) {
+		perror(path);
+		return 1;
+	}
+
+	struct hashtable_trace_writer writer;
+	hashtable_trace_writer_init(&writer, file, sizeof(uint64_t), sizeof(struct session), NULL);
+	struct session_table table;
+	session_table_init(&table, 0);
+	session_table_set_trace(&table, &writer);
+
+	struct random_state rng;
+	random_state_init(&rng, 12345);
+	uint64_t universe = num_ops / 4 + 1;
+	for (size_t i = 0; i < num_ops; i++) {
+		// heavily skewed towards small ids, the set of live ids keeps changing
+		uint64_t r = random_next_u64(&rng);
+		uint64_t id = random_next_u64_in_range(&rng, 0, random_next_u64_in_range(&rng, 0, universe));
+		id += i / 64;
+		uint32_t hash = (uint32_t)hash_int64(id).u64;
+		switch (r % 8) {
+		case 0: {
+			session_table_remove(&table, id, hash, NULL);
+			break;
+		}
+		case 1:
+		case 2: {
+			bool found;
+			struct session *s = session_table_lookup_or_insert(&table, id, hash, &found);
+			s->id = id;
+			s->last_seen = i;
+			break;
+		}
+		default: {
+			struct session *s = session_table_lookup(&table, id, hash);
+			if (s) {
+				s->last_seen = i;
+			} else if (r % 64 < 8) {
+				s = session_table_insert(&table, id, hash);
+				s->id = id;
+				s->last_seen = i;
+			}
+			break;
+		}
+		}
+	}
+
+	session_table_destroy(&table);
+	bool ok = hashtable_trace_writer_finish(&writer);
+	if (fclose(file) != 0 || !ok) {
+		fprintf(stderr, "%s: write error\n", path);
+		return 1;
+	}
+	return 0;
+}
+
+static int replay_file(const char *path)
+{
+	FILE *file = fopen(path, "rb");
+	if (!file) {
+		perror(path);
+		return 1;
+	}
+	struct hashtable_trace_reader reader;
+	if (!hashtable_trace_reader_init(&reader, file)) {
+		fprintf(stderr, "%s: not a hashtable trace\n", path);
+		fclose(file);
+		return 1;
+	}
+	struct hashtable_trace_record *records = NULL;
+	struct hashtable_trace_record record;
+	while (hashtable_trace_read(&reader, &record)) {
+		array_add(records, record);
+	}
+	bool error = hashtable_trace_reader_error(&reader);
+	fclose(file);
+	if (error) {
+		fprintf(stderr, "%s: corrupt trace (replaying the first %zu records)\n", path, array_length(records));
+	}
+
+	size_t num_records = array_length(records);
+	// the fingerprint is stored at the start of each entry in place of the key
+	size_t entry_size = max(hashtable_trace_entry_size(&reader), sizeof(uint64_t));
+	double duration = num_records ? records[num_records - 1].timestamp / 1e9 : 0;
+	printf("%s: %zu ops over %.3f s, key size %zu, entry size %zu\n", path, num_records, duration,
+	       hashtable_trace_key_size(&reader), hashtable_trace_entry_size(&reader));
+	printf("%-10s %9s %10s %8s %9s %9s %12s %11s\n", "impl", "threshold", "Mops/s", "hit %",
+	       "avg probe", "max probe", "peak memory", "bytes/entry");
+	for (size_t impl = 0; impl < sizeof(implementations) / sizeof(implementations[0]); impl++) {
+		for (unsigned int threshold = 5; threshold <= 9; threshold++) {
+			struct hashtable_replay_stats stats = {0};
+			double best_ns = 0;
+			for (int run = 0; run < 5; run++) {
+				implementations[impl].run(records, num_records, entry_size, threshold, false, &stats);
+				if (run == 0 || stats.ns < best_ns) {
+					best_ns = stats.ns;
+				}
+			}
+			implementations[impl].run(records, num_records, entry_size, threshold, true, &stats);
+			size_t lookups = stats.hits + stats.misses;
+			printf("%-10s %9u %10.2f %8.2f %9.3f %9zu %12zu %11.1f\n", implementations[impl].name, threshold,
+			       num_records / best_ns * 1e3, lookups ? 100.0 * stats.hits / lookups : 0.0,
+			       stats.hits ? (double)stats.probes / stats.hits : 0.0, stats.max_probe_length,
+			       stats.peak_memory,
+			       stats.entries_at_peak ? (double)stats.peak_memory / stats.entries_at_peak : 0.0);
+		}
+	}
+	putchar('\n');
+	array_free(records);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc >= 3 && strcmp(argv[1], "record") == 0) {
+		size_t num_ops = argc >= 4 ? strtoull(argv[3], NULL, 10) : 1000000;
+		return record_synthetic(argv[2], num_ops);
+	}
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s record <trace> [num_ops]\n       %s <trace>...\n", argv[0], argv[0]);
+		return 1;
+	}
+	int ret = 0;
+	for (int i = 1; i < argc; i++) {
+		ret |= replay_file(argv[i]);
+	}
+	return ret;
+}
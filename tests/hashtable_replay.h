@@ -0,0 +1,31 @@
+#ifndef __HASHTABLE_REPLAY_INCLUDE__
+#define __HASHTABLE_REPLAY_INCLUDE__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "hashtable_implementations.h"
+#include "hashtable_trace.h"
+
+/* Every implementation in HASHTABLE_IMPLEMENTATIONS is compiled into its own object from hashtable_replay_impl.c
+ * and linked into hashtable_replay, so a trace is replayed against all of them.
+ */
+
+struct hashtable_replay_stats {
+	double ns; // only set if measure is false
+	size_t hits;
+	size_t misses;
+	size_t probes;
+	size_t max_probe_length;
+	size_t peak_memory;
+	size_t entries_at_peak;
+};
+
+// replay the records against an empty table, with measure set the statistics are collected instead of the time
+#define X(impl)								\
+	void hashtable_replay_run_##impl(const struct hashtable_trace_record *records, size_t num_records, \
+					 size_t entry_size, unsigned int threshold, bool measure, \
+					 struct hashtable_replay_stats *stats);
+HASHTABLE_IMPLEMENTATIONS(X)
+#undef X
+
+#endif
@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "config.h"
+#include "compiler.h"
+#include "utils.h"
+#include "hashtable_replay.h"
+
+/* This file is compiled once per implementation with HASHTABLE_<IMPL> and HASHTABLE_REPLAY_IMPL defined.
+ * The hashtable implementation is included with static linkage so the copies don't clash.
+ */
+#ifndef HASHTABLE_REPLAY_IMPL
+# error "HASHTABLE_REPLAY_IMPL must be defined"
+#endif
+
+#undef __AD_LINKAGE
+#define __AD_LINKAGE static
+#include "hashtable.h"
+// the single header already contains the implementation
+#ifndef __HASHTABLE_IMPLEMENTATION_INCLUDE__
+# include "../src/hashtable.c"
+#endif
+
+#define _REPLAY_CONCAT(a, b) a##b
+#define REPLAY_CONCAT(a, b) _REPLAY_CONCAT(a, b)
+
+static double ns_elapsed(struct timespec start, struct timespec end)
+{
+	double s = end.tv_sec - start.tv_sec;
+	double ns = end.tv_nsec - start.tv_nsec;
+	return ns + 1000000000 * s;
+}
+
+static bool fingerprints_match(const void *key, const void *entry)
+{
+	uint64_t fingerprint;
+	memcpy(&fingerprint, entry, sizeof(fingerprint));
+	return *(const uint64_t *)key == fingerprint;
+}
+
+void REPLAY_CONCAT(hashtable_replay_run_, HASHTABLE_REPLAY_IMPL)(const struct hashtable_trace_record *records,
+								 size_t num_records, size_t entry_size,
+								 unsigned int threshold, bool measure,
+								 struct hashtable_replay_stats *stats)
+{
+	const struct _hashtable_info info = {
+		.entry_size = entry_size,
+		.threshold = threshold,
+		.keys_match = fingerprints_match,
+	};
+	struct _hashtable table;
+	_hashtable_init(&table, 0, &info);
+
+	struct timespec start_tp, end_tp;
+	clock_gettime(CLOCK_MONOTONIC, &start_tp);
+	for (size_t i = 0; i < num_records; i++) {
+		const struct hashtable_trace_record *record = &records[i];
+		uint64_t fingerprint = record->fingerprint;
+		_hashtable_idx_t index;
+		bool found = false;
+		switch (record->op) {
+		case HASHTABLE_TRACE_LOOKUP:
+			found = _hashtable_lookup(&table, &fingerprint, record->hash, &index, &info);
+			break;
+		case HASHTABLE_TRACE_INSERT:
+			index = _hashtable_insert(&table, record->hash, &info);
+			memcpy(_hashtable_entry(&table, index, &info), &fingerprint, sizeof(fingerprint));
+			break;
+		case HASHTABLE_TRACE_REMOVE:
+			found = _hashtable_lookup(&table, &fingerprint, record->hash, &index, &info);
+			if (found) {
+				if (measure) {
+					size_t length = _hashtable_probe_length(&table, index, &info);
+					stats->probes += length;
+					stats->max_probe_length = max(stats->max_probe_length, length);
+				}
+				_hashtable_remove(&table, index, &info);
+			}
+			break;
+		case HASHTABLE_TRACE_LOOKUP_OR_INSERT:
+			found = _hashtable_lookup_or_insert(&table, &fingerprint, record->hash, &index, &info);
+			if (!found) {
+				memcpy(_hashtable_entry(&table, index, &info), &fingerprint, sizeof(fingerprint));
+			}
+			break;
+		case HASHTABLE_TRACE_CLEAR:
+			_hashtable_clear(&table, &info);
+			break;
+		case HASHTABLE_TRACE_NUM_OPS:
+			break;
+		}
+		if (!measure) {
+			continue;
+		}
+		if (found) {
+			stats->hits++;
+			if (record->op != HASHTABLE_TRACE_REMOVE) {
+				size_t length = _hashtable_probe_length(&table, index, &info);
+				stats->probes += length;
+				stats->max_probe_length = max(stats->max_probe_length, length);
+			}
+		} else if (record->op != HASHTABLE_TRACE_INSERT && record->op != HASHTABLE_TRACE_CLEAR) {
+			stats->misses++;
+		}
+		size_t memory = _hashtable_memory_usage(&table, &info);
+		if (memory > stats->peak_memory) {
+			stats->peak_memory = memory;
+			stats->entries_at_peak = table.num_entries;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end_tp);
+	if (!measure) {
+		stats->ns = ns_elapsed(start_tp, end_tp);
+	}
+	_hashtable_destroy(&table);
+}
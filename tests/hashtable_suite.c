@@ -0,0 +1,308 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "hash.h"
+#include "histogram.h"
+#include "random.h"
+#include "utils.h"
+#include "hashtable_suite.h"
+
+#ifdef __linux__
+# include <linux/perf_event.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#endif
+
+/* Usage: hashtable_suite [--json] [--quick] [--capacity N] [implementation...]
+ * Runs every implementation over a matrix of key sizes, entry sizes, load factors, hit ratios and
+ * Zipf skews and prints one CSV row (or JSON object) per combination.
+ */
+
+static const struct {
+	const char *name;
+	void (*run)(const struct hashtable_suite_table *table, const struct hashtable_suite_workload *workloads,
+		    size_t num_workloads, struct hashtable_suite_result *results);
+} implementations[] = {
+#define X(impl) {#impl, hashtable_suite_run_##impl},
+	HASHTABLE_IMPLEMENTATIONS(X)
+#undef X
+};
+
+static const size_t key_sizes[] = {4, 8, 16, 32};
+static const size_t entry_sizes[] = {0, 64}; // 0 means just the key
+static const double load_factors[] = {0.3, 0.5, 0.7, 0.85};
+static const double hit_ratios[] = {1.0, 0.5, 0.0};
+static const double zipf_skews[] = {0.0, 0.99, 1.2};
+
+static const char *counter_names[HASHTABLE_SUITE_NUM_COUNTERS] = {
+	"cycles", "instructions", "cache_misses", "branch_misses",
+};
+
+#ifdef __linux__
+static int perf_fds[HASHTABLE_SUITE_NUM_COUNTERS];
+
+static void counters_init(void)
+{
+	static const uint64_t configs[HASHTABLE_SUITE_NUM_COUNTERS] = {
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CACHE_MISSES,
+		PERF_COUNT_HW_BRANCH_MISSES,
+	};
+	for (size_t i = 0; i < HASHTABLE_SUITE_NUM_COUNTERS; i++) {
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.size = sizeof(attr);
+		attr.config = configs[i];
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		perf_fds[i] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+	}
+}
+
+void hashtable_suite_counters_start(void)
+{
+	for (size_t i = 0; i < HASHTABLE_SUITE_NUM_COUNTERS; i++) {
+		if (perf_fds[i] >= 0) {
+			ioctl(perf_fds[i], PERF_EVENT_IOC_RESET, 0);
+			ioctl(perf_fds[i], PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+}
+
+void hashtable_suite_counters_stop(double counters[HASHTABLE_SUITE_NUM_COUNTERS], size_t divisor)
+{
+	for (size_t i = 0; i < HASHTABLE_SUITE_NUM_COUNTERS; i++) {
+		uint64_t count;
+		counters[i] = -1;
+		if (perf_fds[i] < 0) {
+			continue;
+		}
+		ioctl(perf_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+		if (read(perf_fds[i], &count, sizeof(count)) == sizeof(count)) {
+			counters[i] = (double)count / divisor;
+		}
+	}
+}
+#else
+static void counters_init(void)
+{
+}
+
+void hashtable_suite_counters_start(void)
+{
+}
+
+void hashtable_suite_counters_stop(double counters[HASHTABLE_SUITE_NUM_COUNTERS], size_t divisor)
+{
+	for (size_t i = 0; i < HASHTABLE_SUITE_NUM_COUNTERS; i++) {
+		counters[i] = -1;
+	}
+}
+#endif
+
+void hashtable_suite_make_key(void *key, size_t key_size, uint32_t index)
+{
+	// hash_int32 and hash_int64 are bijective, so all keys are different
+	if (key_size == 4) {
+		uint32_t x = hash_int32(index).u32;
+		memcpy(key, &x, sizeof(x));
+		return;
+	}
+	for (size_t i = 0; i < key_size; i += 8) {
+		uint64_t x = hash_int64(((uint64_t)i << 32) | index).u64;
+		memcpy((char *)key + i, &x, sizeof(x));
+	}
+}
+
+static void generate_lookups(uint32_t *key_indices, size_t num_lookups, size_t num_entries, double hit_ratio,
+			     double skew, struct random_state *rng)
+{
+	// popular keys are scattered over the table instead of being the first ones inserted
+	uint32_t *permutation = malloc(num_entries * sizeof(permutation[0]));
+	for (size_t i = 0; i < num_entries; i++) {
+		permutation[i] = i;
+	}
+	for (size_t i = num_entries; i > 1; i--) {
+		size_t j = random_next_u64_in_range(rng, 0, i - 1);
+		uint32_t tmp = permutation[i - 1];
+		permutation[i - 1] = permutation[j];
+		permutation[j] = tmp;
+	}
+	// (rank k has weight 1 / (k + 1)^skew)
+	struct random_zipf zipf;
+	random_zipf_init(&zipf, num_entries, skew);
+	for (size_t i = 0; i < num_lookups; i++) {
+		size_t rank = random_next_zipf(rng, &zipf);
+		bool hit = random_next_uniform_double(rng) < hit_ratio;
+		key_indices[i] = permutation[rank] + (hit ? 0 : num_entries);
+	}
+	free(permutation);
+}
+
+static void print_row(bool json, bool first, const char *impl, const struct hashtable_suite_table *table,
+		      double hit_ratio, double skew, const struct hashtable_suite_result *result,
+		      size_t num_samples)
+{
+	// 1% relative error is below the noise of the measurements, and with it the default number of buckets covers
+	// any range of latencies (with 0.1% they only cover a factor of ~60, so everything below the slowest
+	// batches would be collapsed into one bucket)
+	struct ddsketch sketch;
+	ddsketch_init(&sketch, 0.01, DDSKETCH_DEFAULT_MAX_BUCKETS);
+	for (size_t i = 0; i < num_samples; i++) {
+		ddsketch_add(&sketch, result->latency_ns[i]);
+	}
+	double mean = ddsketch_mean(&sketch);
+
+	double load_factor = (double)result->num_entries / result->capacity;
+	double bytes_per_entry = (double)result->memory / max(result->num_entries, (size_t)1);
+	double p50 = ddsketch_quantile(&sketch, 0.5);
+	double p90 = ddsketch_quantile(&sketch, 0.9);
+	double p99 = ddsketch_quantile(&sketch, 0.99);
+	double p999 = ddsketch_quantile(&sketch, 0.999);
+	ddsketch_destroy(&sketch);
+	if (json) {
+		printf("%s{\"impl\": \"%s\", \"key_size\": %zu, \"entry_size\": %zu, \"load_factor\": %.3f, "
+		       "\"hit_ratio\": %.2f, \"zipf\": %.2f, \"capacity\": %zu, \"entries\": %zu, "
+		       "\"bytes_per_entry\": %.2f, \"insert_ns\": %.2f, \"lookup_ns\": %.2f, \"p50_ns\": %.2f, "
+		       "\"p90_ns\": %.2f, \"p99_ns\": %.2f, \"p999_ns\": %.2f",
+		       first ? "  " : ",\n  ", impl, table->key_size, table->entry_size, load_factor, hit_ratio, skew,
+		       result->capacity, result->num_entries, bytes_per_entry, result->insert_ns, mean, p50, p90,
+		       p99, p999);
+	} else {
+		printf("%s,%zu,%zu,%.3f,%.2f,%.2f,%zu,%zu,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f",
+		       impl, table->key_size, table->entry_size, load_factor, hit_ratio, skew, result->capacity,
+		       result->num_entries, bytes_per_entry, result->insert_ns, mean, p50, p90, p99, p999);
+	}
+	for (size_t i = 0; i < HASHTABLE_SUITE_NUM_COUNTERS; i++) {
+		double value = result->counters[i];
+		if (json) {
+			if (value < 0) {
+				printf(", \"%s\": null", counter_names[i]);
+			} else {
+				printf(", \"%s\": %.3f", counter_names[i], value);
+			}
+		} else if (value >= 0) {
+			printf(",%.3f", value);
+		} else {
+			printf(",");
+		}
+	}
+	printf(json ? "}" : "\n");
+}
+
+int main(int argc, char **argv)
+{
+	bool json = false;
+	size_t capacity = 1 << 18;
+	size_t num_lookups = 1 << 18;
+	bool selected[sizeof(implementations) / sizeof(implementations[0])] = {0};
+	bool any_selected = false;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--json") == 0) {
+			json = true;
+		} else if (strcmp(argv[i], "--quick") == 0) {
+			capacity = 1 << 14;
+			num_lookups = 1 << 14;
+		} else if (strcmp(argv[i], "--capacity") == 0 && i + 1 < argc) {
+			capacity = strtoull(argv[++i], NULL, 0);
+			if (capacity < 16 || (capacity & (capacity - 1)) != 0) {
+				fprintf(stderr, "capacity must be a power of two >= 16\n");
+				return 1;
+			}
+		} else {
+			bool found = false;
+			for (size_t j = 0; j < sizeof(implementations) / sizeof(implementations[0]); j++) {
+				if (strcmp(argv[i], implementations[j].name) == 0) {
+					selected[j] = found = any_selected = true;
+				}
+			}
+			if (!found) {
+				fprintf(stderr, "usage: %s [--json] [--quick] [--capacity N] [implementation...]\n",
+					argv[0]);
+				return 1;
+			}
+		}
+	}
+
+	counters_init();
+	struct random_state rng;
+	random_state_init(&rng, 12345);
+
+	size_t num_workloads = (sizeof(hit_ratios) / sizeof(hit_ratios[0])) *
+		(sizeof(zipf_skews) / sizeof(zipf_skews[0]));
+	struct hashtable_suite_workload *workloads = calloc(num_workloads, sizeof(workloads[0]));
+	struct hashtable_suite_result *results = calloc(num_workloads, sizeof(results[0]));
+	size_t num_samples = num_lookups / HASHTABLE_SUITE_BATCH;
+	for (size_t w = 0; w < num_workloads; w++) {
+		workloads[w].key_indices = malloc(num_lookups * sizeof(uint32_t));
+		workloads[w].num_lookups = num_lookups;
+		results[w].latency_ns = malloc(num_samples * sizeof(double));
+	}
+
+	if (json) {
+		printf("[\n");
+	} else {
+		printf("impl,key_size,entry_size,load_factor,hit_ratio,zipf,capacity,entries,bytes_per_entry,"
+		       "insert_ns,lookup_ns,p50_ns,p90_ns,p99_ns,p999_ns");
+		for (size_t i = 0; i < HASHTABLE_SUITE_NUM_COUNTERS; i++) {
+			printf(",%s", counter_names[i]);
+		}
+		printf("\n");
+	}
+
+	bool first = true;
+	for (size_t l = 0; l < sizeof(load_factors) / sizeof(load_factors[0]); l++) {
+		size_t num_entries = (size_t)(load_factors[l] * capacity);
+		size_t w = 0;
+		for (size_t h = 0; h < sizeof(hit_ratios) / sizeof(hit_ratios[0]); h++) {
+			for (size_t z = 0; z < sizeof(zipf_skews) / sizeof(zipf_skews[0]); z++) {
+				generate_lookups((uint32_t *)workloads[w++].key_indices, num_lookups, num_entries,
+						 hit_ratios[h], zipf_skews[z], &rng);
+			}
+		}
+		for (size_t k = 0; k < sizeof(key_sizes) / sizeof(key_sizes[0]); k++) {
+			for (size_t e = 0; e < sizeof(entry_sizes) / sizeof(entry_sizes[0]); e++) {
+				struct hashtable_suite_table table = {
+					.key_size = key_sizes[k],
+					.entry_size = key_sizes[k] > entry_sizes[e] ? key_sizes[k] : entry_sizes[e],
+					.capacity = capacity,
+					.num_entries = num_entries,
+				};
+				for (size_t i = 0; i < sizeof(implementations) / sizeof(implementations[0]); i++) {
+					if (any_selected && !selected[i]) {
+						continue;
+					}
+					implementations[i].run(&table, workloads, num_workloads, results);
+					w = 0;
+					for (size_t h = 0; h < sizeof(hit_ratios) / sizeof(hit_ratios[0]); h++) {
+						for (size_t z = 0; z < sizeof(zipf_skews) / sizeof(zipf_skews[0]); z++) {
+							print_row(json, first, implementations[i].name, &table,
+								  hit_ratios[h], zipf_skews[z], &results[w++],
+								  num_samples);
+							first = false;
+						}
+					}
+					fflush(stdout);
+				}
+			}
+		}
+	}
+
+	if (json) {
+		printf("\n]\n");
+	}
+
+	for (size_t w = 0; w < num_workloads; w++) {
+		free((uint32_t *)workloads[w].key_indices);
+		free(results[w].latency_ns);
+	}
+	free(workloads);
+	free(results);
+	return 0;
+}
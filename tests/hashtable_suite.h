@@ -0,0 +1,60 @@
+#ifndef __HASHTABLE_SUITE_INCLUDE__
+#define __HASHTABLE_SUITE_INCLUDE__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hashtable_implementations.h"
+
+/* Every implementation in HASHTABLE_IMPLEMENTATIONS is compiled into its own object from hashtable_suite_impl.c
+ * and linked into the hashtable_suite benchmark.
+ */
+
+// lookups are timed in batches of this size (one latency sample per batch)
+#define HASHTABLE_SUITE_BATCH 16
+
+enum hashtable_suite_counter {
+	HASHTABLE_SUITE_CYCLES,
+	HASHTABLE_SUITE_INSTRUCTIONS,
+	HASHTABLE_SUITE_CACHE_MISSES,
+	HASHTABLE_SUITE_BRANCH_MISSES,
+	HASHTABLE_SUITE_NUM_COUNTERS,
+};
+
+struct hashtable_suite_table {
+	size_t key_size; // 4, 8, 16 or 32
+	size_t entry_size; // >= key_size
+	size_t capacity; // the table is created with this capacity and threshold 9
+	size_t num_entries; // keys 0 to num_entries - 1 are inserted
+};
+
+struct hashtable_suite_workload {
+	const uint32_t *key_indices; // key indices >= num_entries are misses
+	size_t num_lookups; // multiple of HASHTABLE_SUITE_BATCH
+};
+
+struct hashtable_suite_result {
+	size_t capacity;
+	size_t num_entries;
+	size_t memory;
+	double insert_ns; // per insert
+	size_t hits;
+	double *latency_ns; // caller provides num_lookups / HASHTABLE_SUITE_BATCH samples (per lookup)
+	// per lookup, negative if the counter is not available
+	double counters[HASHTABLE_SUITE_NUM_COUNTERS];
+};
+
+// implemented in hashtable_suite.c
+void hashtable_suite_make_key(void *key, size_t key_size, uint32_t index);
+void hashtable_suite_counters_start(void);
+void hashtable_suite_counters_stop(double counters[HASHTABLE_SUITE_NUM_COUNTERS], size_t divisor);
+
+// build one table and run every workload against it (results[i] belongs to workloads[i])
+#define X(impl)								\
+	void hashtable_suite_run_##impl(const struct hashtable_suite_table *table, \
+					const struct hashtable_suite_workload *workloads, \
+					size_t num_workloads, struct hashtable_suite_result *results);
+HASHTABLE_IMPLEMENTATIONS(X)
+#undef X
+
+#endif
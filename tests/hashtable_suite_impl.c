@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "config.h"
+#include "compiler.h"
+#include "hash.h"
+#include "hashtable_trace.h"
+#include "macros.h"
+#include "utils.h"
+#include "hashtable_suite.h"
+
+/* This file is compiled once per implementation with HASHTABLE_<IMPL> and HASHTABLE_SUITE_IMPL defined.
+ * The hashtable implementation is included with static linkage so the copies don't clash.
+ */
+#ifndef HASHTABLE_SUITE_IMPL
+# error "HASHTABLE_SUITE_IMPL must be defined"
+#endif
+
+#undef __AD_LINKAGE
+#define __AD_LINKAGE static
+#include "hashtable.h"
+// the single header already contains the implementation
+#ifndef __HASHTABLE_IMPLEMENTATION_INCLUDE__
+# include "../src/hashtable.c"
+#endif
+
+#define _SUITE_CONCAT(a, b) a##b
+#define SUITE_CONCAT(a, b) _SUITE_CONCAT(a, b)
+
+static double ns_elapsed(struct timespec start, struct timespec end)
+{
+	double s = end.tv_sec - start.tv_sec;
+	double ns = end.tv_nsec - start.tv_nsec;
+	return ns + 1000000000 * s;
+}
+
+#define SUITE_DEFINE_KEY(size, hash_expr)				\
+	struct suite_key##size {					\
+		unsigned char bytes[size];				\
+	};								\
+									\
+	static bool suite_keys_match##size(const void *key, const void *entry) \
+	{								\
+		return memcmp(key, entry, size) == 0;			\
+	}								\
+									\
+	static _attr_always_inline uint32_t suite_hash##size(const struct suite_key##size *key) \
+	{								\
+		return (hash_expr);					\
+	}
+
+static _attr_always_inline uint32_t suite_load32(const void *p)
+{
+	uint32_t x;
+	memcpy(&x, p, sizeof(x));
+	return x;
+}
+
+static _attr_always_inline uint64_t suite_load64(const void *p)
+{
+	uint64_t x;
+	memcpy(&x, p, sizeof(x));
+	return x;
+}
+
+SUITE_DEFINE_KEY(4, hash_int32(suite_load32(key->bytes)).u32)
+SUITE_DEFINE_KEY(8, (uint32_t)hash_int64(suite_load64(key->bytes)).u64)
+SUITE_DEFINE_KEY(16, (uint32_t)murmurhash3_x64_64(key->bytes, 16, 0).u64)
+SUITE_DEFINE_KEY(32, (uint32_t)murmurhash3_x64_64(key->bytes, 32, 0).u64)
+
+#define SUITE_DEFINE_RUN(size)						\
+	static void suite_run##size(const struct hashtable_suite_table *params, \
+				    const struct hashtable_suite_workload *workloads, \
+				    size_t num_workloads, struct hashtable_suite_result *results) \
+	{								\
+		const struct _hashtable_info info = {			\
+			.entry_size = params->entry_size,		\
+			.threshold = 9,					\
+			.keys_match = suite_keys_match##size,		\
+		};							\
+		/* keys num_entries to 2 * num_entries - 1 are the misses */ \
+		size_t num_keys = 2 * params->num_entries;		\
+		struct suite_key##size *keys = malloc(num_keys * sizeof(keys[0]) + 1); \
+		if (!keys) {						\
+			abort();					\
+		}							\
+		for (size_t i = 0; i < num_keys; i++) {			\
+			hashtable_suite_make_key(&keys[i], size, i);	\
+		}							\
+									\
+		struct _hashtable table;				\
+		_hashtable_init(&table, params->capacity, &info);	\
+		struct timespec start_tp, end_tp;			\
+		clock_gettime(CLOCK_MONOTONIC, &start_tp);		\
+		for (size_t i = 0; i < params->num_entries; i++) {	\
+			uint32_t hash = suite_hash##size(&keys[i]);	\
+			_hashtable_idx_t index = _hashtable_insert(&table, hash, &info); \
+			memcpy(_hashtable_entry(&table, index, &info), &keys[i], size); \
+		}							\
+		clock_gettime(CLOCK_MONOTONIC, &end_tp);		\
+		double insert_ns = ns_elapsed(start_tp, end_tp) / max(params->num_entries, (size_t)1); \
+									\
+		for (size_t w = 0; w < num_workloads; w++) {		\
+			const struct hashtable_suite_workload *workload = &workloads[w]; \
+			struct hashtable_suite_result *result = &results[w]; \
+			result->capacity = table.capacity;		\
+			result->num_entries = table.num_entries;	\
+			result->memory = _hashtable_memory_usage(&table, &info); \
+			result->insert_ns = insert_ns;			\
+			size_t hits = 0;				\
+			hashtable_suite_counters_start();		\
+			for (size_t b = 0; b < workload->num_lookups; b += HASHTABLE_SUITE_BATCH) { \
+				clock_gettime(CLOCK_MONOTONIC, &start_tp); \
+				for (size_t i = b; i < b + HASHTABLE_SUITE_BATCH; i++) { \
+					struct suite_key##size *key = &keys[workload->key_indices[i]]; \
+					_hashtable_idx_t index;		\
+					hits += _hashtable_lookup(&table, key, suite_hash##size(key), &index, &info); \
+				}					\
+				clock_gettime(CLOCK_MONOTONIC, &end_tp); \
+				result->latency_ns[b / HASHTABLE_SUITE_BATCH] = \
+					ns_elapsed(start_tp, end_tp) / HASHTABLE_SUITE_BATCH; \
+			}						\
+			hashtable_suite_counters_stop(result->counters, workload->num_lookups); \
+			result->hits = hits;				\
+		}							\
+		_hashtable_destroy(&table);				\
+		free(keys);						\
+	}
+
+SUITE_DEFINE_RUN(4)
+SUITE_DEFINE_RUN(8)
+SUITE_DEFINE_RUN(16)
+SUITE_DEFINE_RUN(32)
+
+void SUITE_CONCAT(hashtable_suite_run_, HASHTABLE_SUITE_IMPL)(const struct hashtable_suite_table *table,
+							       const struct hashtable_suite_workload *workloads,
+							       size_t num_workloads,
+							       struct hashtable_suite_result *results)
+{
+	switch (table->key_size) {
+	case 4:
+		suite_run4(table, workloads, num_workloads, results);
+		break;
+	case 8:
+		suite_run8(table, workloads, num_workloads, results);
+		break;
+	case 16:
+		suite_run16(table, workloads, num_workloads, results);
+		break;
+	case 32:
+		suite_run32(table, workloads, num_workloads, results);
+		break;
+	default:
+		fprintf(stderr, "unsupported key size %zu\n", table->key_size);
+		abort();
+	}
+}
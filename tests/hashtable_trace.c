@@ -0,0 +1,133 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "hash.h"
+#include "random.h"
+#define HASHTABLE_TRACING
+#include "hashtable.h"
+#include "hashtable_trace.h"
+#include "testing.h"
+
+struct trace_entry {
+	uint32_t key;
+	uint32_t value;
+};
+
+DEFINE_HASHTABLE(trace_table, uint32_t, struct trace_entry, 7, entry->key == *key)
+
+RANDOM_TEST(hashtable_trace_roundtrip, 2, 0, UINT64_MAX)
+{
+	FILE *file = tmpfile();
+	CHECK(file);
+
+	struct hashtable_trace_writer writer;
+	CHECK(hashtable_trace_writer_init(&writer, file, sizeof(uint32_t), sizeof(struct trace_entry), NULL));
+	struct trace_table table;
+	trace_table_init(&table, 0);
+
+	struct random_state rng;
+	random_state_init(&rng, random);
+
+	// operations before set_trace must not be recorded
+	trace_table_lookup(&table, 0, hash_int32(0).u32);
+	trace_table_set_trace(&table, &writer);
+
+	enum { N = 10000 };
+	static enum hashtable_trace_op ops[N];
+	static uint32_t keys[N];
+	for (size_t i = 0; i < N; i++) {
+		uint32_t key = random_next_u32(&rng) % 512;
+		uint32_t hash = hash_int32(key).u32;
+		keys[i] = key;
+		switch (random_next_u32(&rng) % 4) {
+		case 0:
+			ops[i] = HASHTABLE_TRACE_LOOKUP;
+			trace_table_lookup(&table, key, hash);
+			break;
+		case 1:
+			ops[i] = HASHTABLE_TRACE_REMOVE;
+			trace_table_remove(&table, key, hash, NULL);
+			break;
+		case 2:
+			ops[i] = HASHTABLE_TRACE_LOOKUP_OR_INSERT;
+			trace_table_lookup_or_insert(&table, key, hash, NULL)->key = key;
+			break;
+		case 3:
+			if (trace_table_lookup(&table, key, hash)) {
+				ops[i] = HASHTABLE_TRACE_CLEAR;
+				trace_table_clear(&table);
+			} else {
+				// the lookup above is recorded too, account for it by skipping this slot
+				ops[i] = HASHTABLE_TRACE_INSERT;
+				trace_table_insert(&table, key, hash)->key = key;
+			}
+			break;
+		}
+	}
+	trace_table_destroy(&table);
+	CHECK(hashtable_trace_writer_finish(&writer));
+
+	rewind(file);
+	struct hashtable_trace_reader reader;
+	CHECK(hashtable_trace_reader_init(&reader, file));
+	CHECK(hashtable_trace_key_size(&reader) == sizeof(uint32_t));
+	CHECK(hashtable_trace_entry_size(&reader) == sizeof(struct trace_entry));
+	struct hashtable_trace_record record;
+	uint64_t last_timestamp = 0;
+	for (size_t i = 0; i < N; i++) {
+		if (ops[i] == HASHTABLE_TRACE_CLEAR || ops[i] == HASHTABLE_TRACE_INSERT) {
+			CHECK(hashtable_trace_read(&reader, &record));
+			CHECK(record.op == HASHTABLE_TRACE_LOOKUP);
+		}
+		CHECK(hashtable_trace_read(&reader, &record));
+		CHECK(record.op == ops[i]);
+		CHECK(record.timestamp >= last_timestamp);
+		last_timestamp = record.timestamp;
+		if (ops[i] == HASHTABLE_TRACE_CLEAR) {
+			CHECK(record.fingerprint == 0);
+			continue;
+		}
+		CHECK(record.hash == hash_int32(keys[i]).u32);
+		CHECK(record.fingerprint == hashtable_trace_fingerprint(&keys[i], sizeof(keys[i])));
+	}
+	CHECK(!hashtable_trace_read(&reader, &record));
+	CHECK(!hashtable_trace_reader_error(&reader));
+	fclose(file);
+	return true;
+}
+
+SIMPLE_TEST(hashtable_trace_corrupt)
+{
+	FILE *file = tmpfile();
+	CHECK(file);
+	fputs("not a trace at all", file);
+	rewind(file);
+	struct hashtable_trace_reader reader;
+	CHECK(!hashtable_trace_reader_init(&reader, file));
+	fclose(file);
+
+	file = tmpfile();
+	CHECK(file);
+	struct hashtable_trace_writer writer;
+	CHECK(hashtable_trace_writer_init(&writer, file, 8, 16, NULL));
+	struct hashtable_trace_record in = {.timestamp = 1000, .fingerprint = 42, .hash = 7, .op = HASHTABLE_TRACE_INSERT};
+	hashtable_trace_write_record(&writer, &in);
+	CHECK(hashtable_trace_writer_finish(&writer));
+	// drop the last byte of the record
+	long size = ftell(file);
+	rewind(file);
+	char buf[64];
+	CHECK(fread(buf, 1, size, file) == (size_t)size);
+	fclose(file);
+
+	file = tmpfile();
+	CHECK(file);
+	fwrite(buf, 1, size - 1, file);
+	rewind(file);
+	CHECK(hashtable_trace_reader_init(&reader, file));
+	struct hashtable_trace_record out;
+	CHECK(!hashtable_trace_read(&reader, &out));
+	CHECK(hashtable_trace_reader_error(&reader));
+	fclose(file);
+	return true;
+}
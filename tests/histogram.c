@@ -0,0 +1,229 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "histogram.h"
+#include "random.h"
+#include "testing.h"
+
+static const double quantiles[] = {0.0, 0.001, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 0.999, 1.0};
+#define NUM_QUANTILES (sizeof(quantiles) / sizeof(quantiles[0]))
+
+static int compare_u64(const void *_a, const void *_b)
+{
+	uint64_t a = *(const uint64_t *)_a;
+	uint64_t b = *(const uint64_t *)_b;
+	return a < b ? -1 : (a > b);
+}
+
+static int compare_double(const void *_a, const void *_b)
+{
+	double a = *(const double *)_a;
+	double b = *(const double *)_b;
+	return a < b ? -1 : (a > b);
+}
+
+static bool within(double value, double exact, double relative_error)
+{
+	return fabs(value - exact) <= relative_error * fabs(exact) + 1e-12;
+}
+
+RANDOM_TEST(histogram_quantiles, 1 << 6, 0, UINT64_MAX)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+	unsigned int precision = random_next_u32_in_range(&rng, 1, 12);
+	const uint64_t max_value = UINT64_C(1) << 40;
+	size_t n = random_next_u32_in_range(&rng, 1, 20000);
+	uint64_t *values = malloc(n * sizeof(values[0]));
+	struct histogram a, b, all;
+	histogram_init(&a, precision, max_value);
+	histogram_init(&b, precision, max_value / 3);
+	histogram_init(&all, precision, max_value);
+	double sum = 0.0;
+	for (size_t i = 0; i < n; i++) {
+		// log-uniform over [1, 2^40)
+		values[i] = (uint64_t)exp2(random_next_double_in_range(&rng, 0.0, 40.0));
+		if (values[i] > max_value / 3) {
+			values[i] = max_value / 3;
+		}
+		sum += (double)values[i];
+		histogram_record(i % 2 ? &a : &b, values[i]);
+		histogram_record(&all, values[i]);
+	}
+	qsort(values, n, sizeof(values[0]), compare_u64);
+	CHECK(histogram_count(&all) == n);
+	CHECK(histogram_min(&all) == values[0]);
+	CHECK(histogram_max(&all) == values[n - 1]);
+	CHECK(within(histogram_mean(&all), sum / n, 1e-9));
+
+	CHECK(histogram_merge(&a, &b));
+	uint64_t merged[NUM_QUANTILES];
+	uint64_t direct[NUM_QUANTILES];
+	histogram_quantiles(&a, quantiles, NUM_QUANTILES, merged);
+	histogram_quantiles(&all, quantiles, NUM_QUANTILES, direct);
+	double relative_error = exp2(-(double)(precision + 1));
+	for (size_t i = 0; i < NUM_QUANTILES; i++) {
+		uint64_t exact = values[(size_t)(quantiles[i] * (n - 1))];
+		CHECK(merged[i] == direct[i]);
+		CHECK(histogram_quantile(&all, quantiles[i]) == direct[i]);
+		CHECK(within((double)direct[i], (double)exact, relative_error));
+	}
+
+	struct histogram other;
+	histogram_init(&other, precision + 1, max_value);
+	CHECK(!histogram_merge(&a, &other));
+	histogram_destroy(&other);
+
+	histogram_clear(&b);
+	CHECK(histogram_count(&b) == 0);
+	CHECK(histogram_quantile(&b, 0.5) == 0);
+	CHECK(histogram_min(&b) == 0 && histogram_max(&b) == 0 && histogram_mean(&b) == 0.0);
+	CHECK(histogram_merge(&b, &all));
+	for (size_t i = 0; i < NUM_QUANTILES; i++) {
+		CHECK(histogram_quantile(&b, quantiles[i]) == direct[i]);
+	}
+	histogram_destroy(&a);
+	histogram_destroy(&b);
+	histogram_destroy(&all);
+	free(values);
+	return true;
+}
+
+SIMPLE_TEST(histogram_layout)
+{
+	struct histogram hist;
+	histogram_init(&hist, 4, 1000);
+	// values below 2^precision are exact
+	for (uint64_t v = 0; v < 16; v++) {
+		histogram_record_n(&hist, v, 2);
+	}
+	for (uint64_t v = 0; v < 16; v++) {
+		CHECK(histogram_quantile(&hist, (2.0 * v + 0.5) / 31.0) == v);
+	}
+	// values above max_value land in the last bucket but min/max stay exact
+	histogram_record(&hist, UINT64_MAX);
+	CHECK(histogram_max(&hist) == UINT64_MAX);
+	CHECK(histogram_quantile(&hist, 1.0) >= 1000 - 1000 / 32);
+	CHECK(histogram_memory_usage(&hist) < 1024);
+
+	struct histogram large;
+	histogram_init(&large, 4, UINT64_MAX);
+	histogram_record(&large, UINT64_MAX);
+	histogram_record(&large, UINT64_C(1) << 63);
+	CHECK(histogram_quantile(&large, 0.0) == UINT64_C(1) << 63);
+	CHECK(histogram_quantile(&large, 1.0) >= UINT64_MAX - (UINT64_MAX >> 5));
+	CHECK(histogram_merge(&hist, &large));
+	CHECK(histogram_count(&hist) == 35);
+	histogram_destroy(&large);
+	histogram_destroy(&hist);
+	return true;
+}
+
+RANDOM_TEST(ddsketch_quantiles, 1 << 6, 0, UINT64_MAX)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+	double alpha = random_next_double_in_range(&rng, 0.005, 0.05);
+	size_t n = random_next_u32_in_range(&rng, 1, 20000);
+	double *values = malloc(n * sizeof(values[0]));
+	struct ddsketch a, b, all;
+	ddsketch_init(&a, alpha, DDSKETCH_DEFAULT_MAX_BUCKETS);
+	ddsketch_init(&b, alpha, DDSKETCH_DEFAULT_MAX_BUCKETS);
+	ddsketch_init(&all, alpha, DDSKETCH_DEFAULT_MAX_BUCKETS);
+	for (size_t i = 0; i < n; i++) {
+		uint32_t kind = random_next_u32(&rng) % 8;
+		// (needs at most 1000 buckets per sign, so nothing is collapsed)
+		double magnitude = exp(random_next_double_in_range(&rng, -5.0, 5.0));
+		values[i] = kind == 0 ? 0.0 : kind <= 2 ? -magnitude : magnitude;
+		ddsketch_add(i % 3 ? &a : &b, values[i]);
+		ddsketch_add(&all, values[i]);
+	}
+	qsort(values, n, sizeof(values[0]), compare_double);
+	CHECK(ddsketch_count(&all) == n);
+	CHECK(ddsketch_min(&all) == values[0]);
+	CHECK(ddsketch_max(&all) == values[n - 1]);
+
+	CHECK(ddsketch_merge(&a, &b));
+	CHECK(ddsketch_count(&a) == n);
+	for (size_t i = 0; i < NUM_QUANTILES; i++) {
+		double exact = values[(size_t)(quantiles[i] * (n - 1))];
+		double estimate = ddsketch_quantile(&all, quantiles[i]);
+		CHECK(within(estimate, exact, alpha * (1 + 1e-9)));
+		CHECK(ddsketch_quantile(&a, quantiles[i]) == estimate);
+	}
+
+	CHECK(ddsketch_merge(&a, &a));
+	CHECK(ddsketch_count(&a) == 2 * n);
+	CHECK(within(ddsketch_mean(&a), ddsketch_mean(&all), 1e-9));
+	for (size_t i = 0; i < NUM_QUANTILES; i++) {
+		// (every value now occurs twice)
+		double exact = values[(size_t)(quantiles[i] * (2 * n - 1)) / 2];
+		CHECK(within(ddsketch_quantile(&a, quantiles[i]), exact, alpha * (1 + 1e-9)));
+	}
+
+	struct ddsketch other;
+	ddsketch_init(&other, alpha * 2, DDSKETCH_DEFAULT_MAX_BUCKETS);
+	CHECK(!ddsketch_merge(&a, &other));
+	ddsketch_destroy(&other);
+
+	ddsketch_clear(&a);
+	CHECK(ddsketch_count(&a) == 0 && ddsketch_quantile(&a, 0.5) == 0.0);
+	ddsketch_add(&a, 42.0);
+	CHECK(ddsketch_quantile(&a, 0.5) == 42.0);
+	ddsketch_destroy(&a);
+	ddsketch_destroy(&b);
+	ddsketch_destroy(&all);
+	free(values);
+	return true;
+}
+
+SIMPLE_TEST(ddsketch_collapse)
+{
+	// with 64 buckets only the largest values keep their accuracy
+	const double alpha = 0.01;
+	struct ddsketch sketch;
+	ddsketch_init(&sketch, alpha, 64);
+	for (int i = 0; i < 1000; i++) {
+		ddsketch_add(&sketch, exp(i * 0.01)); // spans about 250 buckets
+	}
+	CHECK(ddsketch_memory_usage(&sketch) <= sizeof(sketch) + 64 * sizeof(uint64_t));
+	CHECK(within(ddsketch_quantile(&sketch, 0.99), exp(989 * 0.01), alpha));
+	CHECK(within(ddsketch_quantile(&sketch, 0.9), exp(899 * 0.01), alpha));
+	CHECK(ddsketch_quantile(&sketch, 0.0) >= 1.0);
+	CHECK(ddsketch_quantile(&sketch, 0.0) < exp(899 * 0.01));
+	ddsketch_destroy(&sketch);
+	return true;
+}
+
+SIMPLE_TEST(ddsketch_latencies)
+{
+	// lookup latencies as in the hashtable suite: mostly a few ns, a long tail up to tens of microseconds
+	const double alpha = 0.01;
+	struct random_state rng;
+	random_state_init(&rng, 42);
+	size_t n = 100000;
+	double *values = malloc(n * sizeof(values[0]));
+	struct ddsketch sketch;
+	ddsketch_init(&sketch, alpha, DDSKETCH_DEFAULT_MAX_BUCKETS);
+	for (size_t i = 0; i < n; i++) {
+		values[i] = 2.0 + random_next_exponential(&rng, 0.05);
+		if (i % 500 == 0) {
+			values[i] *= 1000;
+		}
+		ddsketch_add(&sketch, values[i]);
+	}
+	qsort(values, n, sizeof(values[0]), compare_double);
+	double previous = 0.0;
+	for (size_t i = 0; i < NUM_QUANTILES; i++) {
+		double exact = values[(size_t)(quantiles[i] * (n - 1))];
+		double estimate = ddsketch_quantile(&sketch, quantiles[i]);
+		CHECK(within(estimate, exact, alpha * (1 + 1e-9)));
+		if (quantiles[i] >= 0.5) {
+			CHECK(estimate > previous);
+		}
+		previous = estimate;
+	}
+	ddsketch_destroy(&sketch);
+	free(values);
+	return true;
+}
@@ -0,0 +1,245 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dbuf.h"
+#include "hash.h"
+#include "hyperloglog.h"
+#include "random.h"
+#include "testing.h"
+
+static bool same_serialization(const struct hyperloglog *a, const struct hyperloglog *b)
+{
+	struct dbuf x, y;
+	dbuf_init(&x);
+	dbuf_init(&y);
+	hyperloglog_serialize(a, &x);
+	hyperloglog_serialize(b, &y);
+	bool same = dbuf_size(&x) == dbuf_size(&y) && memcmp(dbuf_buffer(&x), dbuf_buffer(&y), dbuf_size(&x)) == 0;
+	dbuf_destroy(&x);
+	dbuf_destroy(&y);
+	return same;
+}
+
+SIMPLE_TEST(hyperloglog_precision)
+{
+	struct hyperloglog hll;
+	CHECK(!hyperloglog_init(&hll, 0));
+	CHECK(!hyperloglog_init(&hll, HYPERLOGLOG_MIN_PRECISION - 1));
+	CHECK(!hyperloglog_init(&hll, HYPERLOGLOG_MAX_PRECISION + 1));
+	for (unsigned int p = HYPERLOGLOG_MIN_PRECISION; p <= HYPERLOGLOG_MAX_PRECISION; p++) {
+		CHECK(hyperloglog_init(&hll, p));
+		CHECK(hyperloglog_estimate(&hll) == 0.0);
+		hyperloglog_add(&hll, 12345);
+		CHECK(fabs(hyperloglog_estimate(&hll) - 1.0) < 0.01);
+		hyperloglog_destroy(&hll);
+	}
+	return true;
+}
+
+RANDOM_TEST(hyperloglog_accuracy, 1 << 5, 0, UINT64_MAX)
+{
+	static const size_t cardinalities[] = {1, 10, 100, 1000, 3000, 10000, 100000, 300000};
+	struct random_state rng;
+	random_state_init(&rng, random);
+	unsigned int p = random_next_u32_in_range(&rng, 10, HYPERLOGLOG_MAX_PRECISION);
+	double stderror = 1.04 / sqrt((double)((size_t)1 << p));
+	struct hyperloglog hll;
+	CHECK(hyperloglog_init(&hll, p));
+	size_t n = 0;
+	for (size_t i = 0; i < sizeof(cardinalities) / sizeof(cardinalities[0]); i++) {
+		for (; n < cardinalities[i]; n++) {
+			uint64_t hash = hash_int64(random + n).u64;
+			hyperloglog_add(&hll, hash);
+			hyperloglog_add(&hll, hash);
+		}
+		double estimate = hyperloglog_estimate(&hll);
+		double error = fabs(estimate - (double)n) / (double)n;
+		// the sparse representation is nearly exact
+		if (n * 4 <= ((size_t)1 << p) / 4) {
+			CHECK(error < 0.005);
+		} else {
+			CHECK(error < 5 * stderror);
+		}
+	}
+	hyperloglog_destroy(&hll);
+	return true;
+}
+
+RANDOM_TEST(hyperloglog_memory_usage, 1 << 5, 0, UINT64_MAX)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+	unsigned int p = random_next_u32_in_range(&rng, HYPERLOGLOG_MIN_PRECISION, 14);
+	const size_t dense = sizeof(struct hyperloglog) + ((size_t)1 << p);
+	struct hyperloglog hll;
+	CHECK(hyperloglog_init(&hll, p));
+	// the sparse list never takes more memory than the dense registers, even right before it converts
+	for (size_t i = 0; i < ((size_t)1 << p); i++) {
+		hyperloglog_add(&hll, random_next_u64(&rng));
+		CHECK(hyperloglog_memory_usage(&hll) <= dense);
+	}
+	CHECK(hyperloglog_memory_usage(&hll) == dense);
+	hyperloglog_destroy(&hll);
+	return true;
+}
+
+RANDOM_TEST(hyperloglog_add_bulk, 1 << 6, 0, UINT64_MAX)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+	unsigned int p = random_next_u32_in_range(&rng, HYPERLOGLOG_MIN_PRECISION, HYPERLOGLOG_MAX_PRECISION);
+	size_t n = random_next_u32_in_range(&rng, 0, 50000);
+	uint64_t *hashes = malloc((n + 1) * sizeof(hashes[0]));
+	for (size_t i = 0; i < n; i++) {
+		hashes[i] = random_next_u64(&rng);
+	}
+	struct hyperloglog a, b;
+	CHECK(hyperloglog_init(&a, p));
+	CHECK(hyperloglog_init(&b, p));
+	hyperloglog_add_bulk(&a, hashes, n);
+	for (size_t i = 0; i < n; i++) {
+		hyperloglog_add(&b, hashes[i]);
+	}
+	CHECK(same_serialization(&a, &b));
+	CHECK(hyperloglog_estimate(&a) == hyperloglog_estimate(&b));
+	hyperloglog_clear(&a);
+	CHECK(hyperloglog_estimate(&a) == 0.0);
+	hyperloglog_destroy(&a);
+	hyperloglog_destroy(&b);
+	free(hashes);
+	return true;
+}
+
+RANDOM_TEST(hyperloglog_merge, 1 << 7, 0, UINT64_MAX)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+	unsigned int p = random_next_u32_in_range(&rng, HYPERLOGLOG_MIN_PRECISION, 14);
+	size_t m = (size_t)1 << p;
+	// cover sparse/sparse, sparse/dense and dense/dense
+	size_t na = random_next_u32_in_range(&rng, 0, (uint32_t)m);
+	size_t nb = random_next_u32_in_range(&rng, 0, (uint32_t)m);
+	size_t overlap = random_next_u32_in_range(&rng, 0, (uint32_t)(na < nb ? na : nb));
+	struct hyperloglog a, b, u;
+	CHECK(hyperloglog_init(&a, p));
+	CHECK(hyperloglog_init(&b, p));
+	CHECK(hyperloglog_init(&u, p));
+	for (size_t i = 0; i < na; i++) {
+		hyperloglog_add(&a, hash_int64(random + i).u64);
+		hyperloglog_add(&u, hash_int64(random + i).u64);
+	}
+	for (size_t i = na - overlap; i < na - overlap + nb; i++) {
+		hyperloglog_add(&b, hash_int64(random + i).u64);
+		hyperloglog_add(&u, hash_int64(random + i).u64);
+	}
+	CHECK(hyperloglog_merge(&a, &b));
+	CHECK(hyperloglog_merge(&a, &a));
+	// registers only depend on the set of items, but the switch to dense happens at a slightly different time
+	double ea = hyperloglog_estimate(&a);
+	double eu = hyperloglog_estimate(&u);
+	if (same_serialization(&a, &u)) {
+		CHECK(ea == eu);
+	} else {
+		CHECK(fabs(ea - eu) <= 5 * 1.04 / sqrt((double)m) * (eu + 1));
+		struct hyperloglog dense;
+		CHECK(hyperloglog_init(&dense, p));
+		hyperloglog_add(&dense, 0);
+		for (size_t i = 0; i < m; i++) {
+			hyperloglog_add(&dense, (uint64_t)i << (64 - p));
+		}
+		struct hyperloglog x;
+		CHECK(hyperloglog_init(&x, p));
+		CHECK(hyperloglog_merge(&x, &dense));
+		CHECK(hyperloglog_merge(&x, &a));
+		CHECK(hyperloglog_merge(&dense, &u));
+		CHECK(same_serialization(&x, &dense));
+		hyperloglog_destroy(&x);
+		hyperloglog_destroy(&dense);
+	}
+
+	struct hyperloglog other;
+	CHECK(hyperloglog_init(&other, p == HYPERLOGLOG_MAX_PRECISION ? p - 1 : p + 1));
+	CHECK(!hyperloglog_merge(&a, &other));
+	hyperloglog_destroy(&other);
+	hyperloglog_destroy(&a);
+	hyperloglog_destroy(&b);
+	hyperloglog_destroy(&u);
+	return true;
+}
+
+RANDOM_TEST(hyperloglog_serialize, 1 << 7, 0, UINT64_MAX)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+	unsigned int p = random_next_u32_in_range(&rng, HYPERLOGLOG_MIN_PRECISION, 12);
+	size_t m = (size_t)1 << p;
+	size_t n = random_next_u32_in_range(&rng, 0, (uint32_t)m);
+	struct hyperloglog hll;
+	CHECK(hyperloglog_init(&hll, p));
+	for (size_t i = 0; i < n; i++) {
+		hyperloglog_add(&hll, random_next_u64(&rng));
+	}
+	struct dbuf buf;
+	dbuf_init(&buf);
+	hyperloglog_serialize(&hll, &buf);
+	const unsigned char *data = dbuf_buffer(&buf);
+	size_t size = dbuf_size(&buf);
+	if (data[0] & 0x80) {
+		CHECK(size == 1 + m / 4 * 3);
+	} else {
+		CHECK(size <= 2 + 5 * n);
+	}
+
+	struct hyperloglog copy;
+	CHECK(hyperloglog_deserialize(&copy, data, size));
+	CHECK(same_serialization(&hll, &copy));
+	CHECK(hyperloglog_estimate(&hll) == hyperloglog_estimate(&copy));
+	hyperloglog_add(&copy, 1);
+	hyperloglog_destroy(&copy);
+
+	// every truncation and any trailing garbage is rejected
+	for (size_t i = 0; i < size; i++) {
+		CHECK(!hyperloglog_deserialize(&copy, data, i));
+	}
+	dbuf_add_byte(&buf, 0);
+	CHECK(!hyperloglog_deserialize(&copy, dbuf_buffer(&buf), dbuf_size(&buf)));
+
+	// random corruption either fails or yields a usable sketch
+	unsigned char *corrupt = dbuf_buffer(&buf);
+	for (size_t i = 0; i < 16; i++) {
+		size_t pos = random_next_u32_in_range(&rng, 0, (uint32_t)size - 1);
+		corrupt[pos] ^= (unsigned char)random_next_u32_in_range(&rng, 1, 255);
+		if (hyperloglog_deserialize(&copy, corrupt, size)) {
+			hyperloglog_add(&copy, random_next_u64(&rng));
+			CHECK(hyperloglog_estimate(&copy) >= 0.0);
+			hyperloglog_destroy(&copy);
+		}
+	}
+	dbuf_destroy(&buf);
+	hyperloglog_destroy(&hll);
+	return true;
+}
+
+SIMPLE_TEST(hyperloglog_deserialize_invalid)
+{
+	struct hyperloglog hll;
+	static const unsigned char bad_precision[] = {3, 0};
+	static const unsigned char bad_rank[] = {4, 1, (unsigned char)((1 << 6) | 41)};
+	static const unsigned char zero_rank[] = {4, 1, 1 << 6};
+	static const unsigned char unsorted[] = {4, 2, 0x81, 0x01, 0};
+	static const unsigned char overlong[] = {4, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01};
+	static const unsigned char empty[] = {4, 0};
+	static const unsigned char dense_rank[] = {0x84, 62, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+	CHECK(!hyperloglog_deserialize(&hll, NULL, 0));
+	CHECK(!hyperloglog_deserialize(&hll, bad_precision, sizeof(bad_precision)));
+	CHECK(!hyperloglog_deserialize(&hll, bad_rank, sizeof(bad_rank)));
+	CHECK(!hyperloglog_deserialize(&hll, zero_rank, sizeof(zero_rank)));
+	CHECK(!hyperloglog_deserialize(&hll, unsorted, sizeof(unsorted)));
+	CHECK(!hyperloglog_deserialize(&hll, overlong, sizeof(overlong)));
+	CHECK(!hyperloglog_deserialize(&hll, dense_rank, sizeof(dense_rank)));
+	CHECK(hyperloglog_deserialize(&hll, empty, sizeof(empty)));
+	CHECK(hyperloglog_estimate(&hll) == 0.0);
+	hyperloglog_destroy(&hll);
+	return true;
+}
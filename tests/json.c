@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "array.h"
+#include "charconv.h"
 #include "dstring.h"
 #include "hashtable.h"
 #include "macros.h"
@@ -583,7 +584,10 @@ static void json_array_print(struct json_array *array, dstr_t *dstr)
 
 static void json_number_print(struct json_number *number, dstr_t *dstr)
 {
-	dstr_append_fmt(dstr, "%g", number->number);
+	// shortest round trip, %g would lose digits
+	char buf[TO_CHARS_DOUBLE_MAX_LENGTH];
+	size_t len = to_chars_double(buf, number->number, 0);
+	dstr_append_chars(dstr, buf, len);
 }
 
 static void json_string_print(struct json_string *string, dstr_t *dstr)
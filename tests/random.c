@@ -6,6 +6,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/random.h>
+#include <threads.h>
 #include "random.h"
 #include "testing.h"
 
@@ -120,3 +121,621 @@ RANDOM_TEST(random, 2, 0, UINT64_MAX)
 
 	return true;
 }
+
+// r = a * b modulo the characteristic polynomial of xoshiro256 (without the x^256 term)
+static void poly_mulmod(uint64_t r[4], const uint64_t a[4], const uint64_t b[4])
+{
+	static const uint64_t charpoly[4] = {
+		0x9d116f2bb0f0f001, 0x0280002bcefd1a5e, 0x04b4edcf26259f85, 0x0003c03c3f3ecb19
+	};
+	uint64_t acc[4] = {0};
+	uint64_t x[4] = {b[0], b[1], b[2], b[3]};
+	for (size_t i = 0; i < 256; i++) {
+		if ((a[i / 64] >> (i % 64)) & 1) {
+			for (size_t j = 0; j < 4; j++) {
+				acc[j] ^= x[j];
+			}
+		}
+		uint64_t carry = x[3] >> 63;
+		for (size_t j = 3; j > 0; j--) {
+			x[j] = (x[j] << 1) | (x[j - 1] >> 63);
+		}
+		x[0] <<= 1;
+		for (size_t j = 0; j < 4 && carry; j++) {
+			x[j] ^= charpoly[j];
+		}
+	}
+	memcpy(r, acc, sizeof(acc));
+}
+
+// advance the state by 2^64 steps (x^(2^64) is x squared 64 times)
+static void jump_2_64(struct random_state *state)
+{
+	uint64_t poly[4] = {2, 0, 0, 0};
+	for (int i = 0; i < 64; i++) {
+		poly_mulmod(poly, poly, poly);
+	}
+	struct random_state result = {{0, 0, 0, 0}};
+	for (size_t b = 0; b < 256; b++) {
+		if ((poly[b / 64] >> (b % 64)) & 1) {
+			for (size_t j = 0; j < 4; j++) {
+				result.s[j] ^= state->s[j];
+			}
+		}
+		random_next_u64(state);
+	}
+	*state = result;
+}
+
+// reference model of the bulk fills: lane k is the state advanced k * 2^64 steps, outputs are interleaved by
+// lane and the state continues where the last lane stopped
+static void reference_fill(struct random_state *state, uint64_t *buf, size_t n)
+{
+	struct random_state lanes[8];
+	lanes[0] = *state;
+	for (size_t k = 1; k < 8; k++) {
+		lanes[k] = lanes[k - 1];
+		jump_2_64(&lanes[k]);
+	}
+	for (size_t i = 0; i < (n + 7) / 8 * 8; i++) {
+		uint64_t x = random_next_u64(&lanes[i % 8]);
+		if (i < n) {
+			buf[i] = x;
+		}
+	}
+	*state = lanes[7];
+}
+
+RANDOM_TEST(random_fill, 2, 0, UINT64_MAX)
+{
+	static const size_t sizes[] = {0, 1, 7, 100, 1023, 1024, 1025, 1031, 4096, 10000};
+	struct random_state rng, ref;
+	random_state_init(&rng, random);
+	ref = rng;
+
+	uint64_t *buf = malloc(10000 * sizeof(buf[0]));
+	uint64_t *expected = malloc(10000 * sizeof(expected[0]));
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		size_t n = sizes[i];
+		random_fill_u64(&rng, buf, n);
+		if (n < 1024) {
+			for (size_t j = 0; j < n; j++) {
+				expected[j] = random_next_u64(&ref);
+			}
+		} else {
+			reference_fill(&ref, expected, n);
+		}
+		CHECK(memcmp(buf, expected, n * sizeof(buf[0])) == 0);
+		CHECK(memcmp(&rng, &ref, sizeof(rng)) == 0);
+	}
+
+	// u32 fills use both halves of every 64-bit output
+	uint32_t *buf32 = (uint32_t *)expected;
+	random_fill_u32(&rng, buf32, 4099);
+	reference_fill(&ref, buf, 2050);
+	CHECK(memcmp(buf32, buf, 4099 * sizeof(buf32[0])) == 0);
+	CHECK(memcmp(&rng, &ref, sizeof(rng)) == 0);
+
+	free(buf);
+	free(expected);
+	return true;
+}
+
+static int compare_u64(const void *_a, const void *_b)
+{
+	uint64_t a = *(const uint64_t *)_a;
+	uint64_t b = *(const uint64_t *)_b;
+	return a < b ? -1 : (a > b);
+}
+
+// true if the sorted arrays a and b have no value in common
+static bool disjoint(const uint64_t *a, const uint64_t *b, size_t n)
+{
+	for (size_t i = 0, j = 0; i < n && j < n;) {
+		if (a[i] == b[j]) {
+			return false;
+		}
+		a[i] < b[j] ? i++ : j++;
+	}
+	return true;
+}
+
+RANDOM_TEST(random_fill_streams, 2, 0, UINT64_MAX)
+{
+	// the lanes of a fill must not be the streams next to it
+	const size_t n = 4096;
+	uint64_t *buf = malloc(n * sizeof(buf[0]));
+	uint64_t *other = malloc(n * sizeof(other[0]));
+	struct random_state rng, stream;
+	random_stream(&rng, random, 0);
+	random_fill_u64(&rng, buf, n);
+	qsort(buf, n, sizeof(buf[0]), compare_u64);
+	for (uint64_t k = 1; k < 8; k++) {
+		random_stream(&stream, random, k);
+		for (size_t i = 0; i < n; i++) {
+			other[i] = random_next_u64(&stream);
+		}
+		qsort(other, n, sizeof(other[0]), compare_u64);
+		CHECK(disjoint(buf, other, n));
+	}
+
+	// fills (several in a row) on adjacent streams
+	for (uint64_t k = 0; k < 4; k++) {
+		random_stream(&rng, random, k);
+		random_stream(&stream, random, k + 1);
+		for (size_t i = 0; i < n; i += n / 4) {
+			random_fill_u64(&rng, buf + i, n / 4);
+			random_fill_u64(&stream, other + i, n / 4);
+		}
+		qsort(buf, n, sizeof(buf[0]), compare_u64);
+		qsort(other, n, sizeof(other[0]), compare_u64);
+		CHECK(disjoint(buf, other, n));
+	}
+	free(buf);
+	free(other);
+	return true;
+}
+
+RANDOM_TEST(random_fill_range, 2, 0, UINT64_MAX)
+{
+	const size_t N = 16 * 1024 * 1024;
+	struct random_state rng;
+	random_state_init(&rng, random);
+
+	double *numbers = malloc(N * sizeof(numbers[0]));
+	uint64_t *buf64 = malloc(N * sizeof(buf64[0]));
+	uint32_t *buf32 = malloc(N * sizeof(buf32[0]));
+
+	random_fill_u64_in_range(&rng, buf64, N, 0, 100);
+	for (size_t i = 0; i < N; i++) {
+		CHECK(buf64[i] <= 100);
+		numbers[i] = buf64[i];
+	}
+	CHECK(check_stats(numbers, N, 0, 100));
+
+	random_fill_u32_in_range(&rng, buf32, N, 0, 100);
+	for (size_t i = 0; i < N; i++) {
+		CHECK(buf32[i] <= 100);
+		numbers[i] = buf32[i];
+	}
+	CHECK(check_stats(numbers, N, 0, 100));
+
+	struct random_state copy = rng;
+	random_fill_double(&rng, numbers, N);
+	random_fill_u64(&copy, buf64, N);
+	for (size_t i = 0; i < N; i++) {
+		CHECK(numbers[i] >= 0.0 && numbers[i] < 1.0);
+		// the full 53 bits of random_next_uniform_double
+		CHECK(numbers[i] == (buf64[i] >> 11) * 0x1.0p-53);
+	}
+	CHECK(check_stats(numbers, N, 0, 1));
+
+	random_fill_double_in_range(&rng, numbers, N, -5.0, 5.0);
+	for (size_t i = 0; i < N; i++) {
+		CHECK(numbers[i] >= -5.0 && numbers[i] < 5.0);
+		numbers[i] += 5.0;
+	}
+	CHECK(check_stats(numbers, N, 0, 10));
+
+	// ranges that reject often, shifted ranges and the full range
+	uint64_t min64 = random_next_u64(&rng);
+	uint64_t max64 = min64 + (UINT64_MAX / 3 * 2);
+	if (max64 < min64) {
+		max64 = UINT64_MAX;
+	}
+	random_fill_u64_in_range(&rng, buf64, N, min64, max64);
+	for (size_t i = 0; i < N; i++) {
+		CHECK(buf64[i] >= min64 && buf64[i] <= max64);
+	}
+	uint32_t min32 = random_next_u32(&rng) / 2;
+	uint32_t max32 = min32 + UINT32_MAX / 2 + 1;
+	random_fill_u32_in_range(&rng, buf32, N, min32, max32);
+	for (size_t i = 0; i < N; i++) {
+		CHECK(buf32[i] >= min32 && buf32[i] <= max32);
+	}
+	random_fill_u64_in_range(&rng, buf64, 5, 7, 7);
+	random_fill_u32_in_range(&rng, buf32, 2000, 7, 7);
+	for (size_t i = 0; i < 2000; i++) {
+		CHECK(buf32[i] == 7 && (i >= 5 || buf64[i] == 7));
+	}
+	random_fill_u64_in_range(&rng, buf64, N, 0, UINT64_MAX);
+	random_fill_u32_in_range(&rng, buf32, N, 0, UINT32_MAX);
+	for (size_t i = 0; i < N; i++) {
+		numbers[i] = buf32[i];
+	}
+	CHECK(check_stats(numbers, N, 0, UINT32_MAX));
+
+	free(numbers);
+	free(buf64);
+	free(buf32);
+	return true;
+}
+
+RANDOM_TEST(random_jump_n, 2, 0, UINT64_MAX)
+{
+	struct random_state a, b;
+	random_state_init(&a, random);
+	b = a;
+	for (uint64_t k = 0; k < 300; k++) {
+		struct random_state c = a;
+		random_jump_n(&c, k);
+		CHECK(memcmp(&b, &c, sizeof(b)) == 0);
+		random_jump(&b);
+	}
+
+	// 2^64 jumps are a long jump
+	b = a;
+	random_jump_n(&a, UINT64_MAX);
+	random_jump(&a);
+	random_long_jump(&b);
+	CHECK(memcmp(&a, &b, sizeof(a)) == 0);
+
+	// jumps compose
+	uint64_t k1 = random >> 1, k2 = random_next_u64(&a) >> 1;
+	b = a;
+	random_jump_n(&a, k1);
+	random_jump_n(&a, k2);
+	random_jump_n(&b, k1 + k2);
+	CHECK(memcmp(&a, &b, sizeof(a)) == 0);
+
+	random_stream(&a, random, 5);
+	random_state_init(&b, random);
+	random_jump_n(&b, 5);
+	CHECK(memcmp(&a, &b, sizeof(a)) == 0);
+	return true;
+}
+
+static int thread_state_func(void *arg)
+{
+	uint64_t *out = arg;
+	if (out[0] != UINT64_MAX) {
+		random_thread_state_init(42, out[0]);
+	}
+	struct random_state *state = random_thread_state();
+	assert(state == random_thread_state());
+	out[1] = random_next_u64(state);
+	return 0;
+}
+
+SIMPLE_TEST(random_thread_state)
+{
+	enum { NUM_THREADS = 8 };
+	thrd_t threads[NUM_THREADS];
+	uint64_t results[NUM_THREADS][2];
+
+	// explicitly seeded threads get their stream, no matter which thread runs first
+	for (size_t i = 0; i < NUM_THREADS; i++) {
+		results[i][0] = i;
+		CHECK(thrd_create(&threads[i], thread_state_func, results[i]) == thrd_success);
+	}
+	for (size_t i = 0; i < NUM_THREADS; i++) {
+		CHECK(thrd_join(threads[i], NULL) == thrd_success);
+		struct random_state expected;
+		random_stream(&expected, 42, i);
+		CHECK(results[i][1] == random_next_u64(&expected));
+	}
+
+	// default states are distinct streams
+	for (size_t i = 0; i < NUM_THREADS; i++) {
+		results[i][0] = UINT64_MAX;
+		CHECK(thrd_create(&threads[i], thread_state_func, results[i]) == thrd_success);
+	}
+	for (size_t i = 0; i < NUM_THREADS; i++) {
+		CHECK(thrd_join(threads[i], NULL) == thrd_success);
+		for (size_t j = 0; j < i; j++) {
+			CHECK(results[i][1] != results[j][1]);
+		}
+	}
+	return true;
+}
+
+static void moments(const double *values, size_t n, double *mean, double *variance)
+{
+	double sum = 0, sum2 = 0;
+	for (size_t i = 0; i < n; i++) {
+		sum += values[i];
+	}
+	*mean = sum / n;
+	for (size_t i = 0; i < n; i++) {
+		sum2 += (values[i] - *mean) * (values[i] - *mean);
+	}
+	*variance = sum2 / n;
+}
+
+RANDOM_TEST(random_normal_exponential, 2, 0, UINT64_MAX)
+{
+	const size_t N = 1 << 22;
+	struct random_state rng;
+	random_state_init(&rng, random);
+	double *values = malloc(N * sizeof(values[0]));
+	double mean, variance;
+
+	for (int bulk = 0; bulk < 2; bulk++) {
+		if (bulk) {
+			random_fill_normal(&rng, values, N, 3.0, 2.0);
+		} else {
+			for (size_t i = 0; i < N; i++) {
+				values[i] = random_next_normal(&rng, 3.0, 2.0);
+			}
+		}
+		moments(values, N, &mean, &variance);
+		CHECK(fabs(mean - 3.0) < 0.01);
+		CHECK(fabs(variance - 4.0) < 0.02);
+		// the fraction beyond 1, 2 and 3 standard deviations (exercises the wedges and the tail)
+		static const double expected[3] = {0.31731050786291410, 0.04550026389635842, 0.00269979606326019};
+		for (int k = 0; k < 3; k++) {
+			size_t outside = 0;
+			for (size_t i = 0; i < N; i++) {
+				outside += fabs(values[i] - 3.0) > 2.0 * (k + 1);
+			}
+			CHECK(fabs((double)outside / N - expected[k]) < 5 * sqrt(expected[k] / N));
+		}
+
+		if (bulk) {
+			random_fill_exponential(&rng, values, N, 4.0);
+		} else {
+			for (size_t i = 0; i < N; i++) {
+				values[i] = random_next_exponential(&rng, 4.0);
+			}
+		}
+		moments(values, N, &mean, &variance);
+		CHECK(fabs(mean - 0.25) < 0.001);
+		CHECK(fabs(variance - 0.0625) < 0.001);
+		for (int k = 1; k <= 8; k++) {
+			size_t above = 0;
+			for (size_t i = 0; i < N; i++) {
+				CHECK(values[i] >= 0);
+				above += values[i] > k * 0.25;
+			}
+			double p = exp(-k);
+			CHECK(fabs((double)above / N - p) < 5 * sqrt(p / N));
+		}
+	}
+
+	// small fills are the scalar loop
+	struct random_state copy = rng;
+	random_fill_normal(&rng, values, 100, 0, 1);
+	for (size_t i = 0; i < 100; i++) {
+		CHECK(values[i] == random_next_normal(&copy, 0, 1));
+	}
+
+	free(values);
+	return true;
+}
+
+RANDOM_TEST(random_poisson_binomial, 2, 0, UINT64_MAX)
+{
+	const size_t N = 1 << 20;
+	struct random_state rng;
+	random_state_init(&rng, random);
+	uint64_t *buf = malloc(N * sizeof(buf[0]));
+	double *values = malloc(N * sizeof(values[0]));
+	double mean, variance;
+
+	static const double lambdas[] = {0.0, 0.5, 3.0, 9.9, 10.0, 50.0, 1e6};
+	for (size_t j = 0; j < sizeof(lambdas) / sizeof(lambdas[0]); j++) {
+		double lambda = lambdas[j];
+		random_fill_poisson(&rng, buf, N / 2, lambda);
+		for (size_t i = 0; i < N / 2; i++) {
+			values[i] = buf[i];
+		}
+		for (size_t i = N / 2; i < N; i++) {
+			values[i] = random_next_poisson(&rng, lambda);
+		}
+		moments(values, N, &mean, &variance);
+		CHECK(fabs(mean - lambda) <= 5 * sqrt(lambda / N));
+		CHECK(fabs(variance - lambda) <= 0.01 * lambda);
+	}
+
+	static const struct {
+		uint64_t n;
+		double p;
+	} params[] = {{0, 0.5}, {1, 0.5}, {20, 0.3}, {20, 0.0}, {20, 1.0}, {100, 0.95}, {1000, 0.4}, {1000, 0.9},
+		      {UINT64_C(1) << 40, 1e-3}};
+	for (size_t j = 0; j < sizeof(params) / sizeof(params[0]); j++) {
+		uint64_t n = params[j].n;
+		double p = params[j].p;
+		random_fill_binomial(&rng, buf, N / 2, n, p);
+		for (size_t i = 0; i < N / 2; i++) {
+			values[i] = buf[i];
+		}
+		for (size_t i = N / 2; i < N; i++) {
+			values[i] = random_next_binomial(&rng, n, p);
+		}
+		for (size_t i = 0; i < N; i++) {
+			CHECK(values[i] <= n);
+		}
+		double expected_variance = n * p * (1 - p);
+		moments(values, N, &mean, &variance);
+		CHECK(fabs(mean - n * p) <= 5 * sqrt(expected_variance / N) + 1e-9 * n);
+		CHECK(fabs(variance - expected_variance) <= 0.01 * expected_variance);
+	}
+
+	free(buf);
+	free(values);
+	return true;
+}
+
+RANDOM_TEST(random_zipf, 2, 0, UINT64_MAX)
+{
+	const size_t N = 1 << 22;
+	struct random_state rng;
+	random_state_init(&rng, random);
+	uint64_t *buf = malloc(N * sizeof(buf[0]));
+
+	static const double skews[] = {0.0, 0.5, 0.99, 1.0, 1.2, 3.0};
+	for (size_t j = 0; j < sizeof(skews) / sizeof(skews[0]); j++) {
+		double s = skews[j];
+		const uint64_t n = 50;
+		struct random_zipf zipf;
+		random_zipf_init(&zipf, n, s);
+		random_fill_zipf(&rng, &zipf, buf, N / 2);
+		for (size_t i = N / 2; i < N; i++) {
+			buf[i] = random_next_zipf(&rng, &zipf);
+		}
+		size_t counts[50] = {0};
+		for (size_t i = 0; i < N; i++) {
+			CHECK(buf[i] < n);
+			counts[buf[i]]++;
+		}
+		double sum = 0;
+		for (uint64_t k = 0; k < n; k++) {
+			sum += pow(k + 1, -s);
+		}
+		for (uint64_t k = 0; k < n; k++) {
+			double p = pow(k + 1, -s) / sum;
+			CHECK(fabs((double)counts[k] / N - p) <= 5 * sqrt(p * (1 - p) / N));
+		}
+
+		// huge ranges need no table
+		random_zipf_init(&zipf, UINT64_C(1) << 50, s);
+		for (size_t i = 0; i < 1000; i++) {
+			CHECK(random_next_zipf(&rng, &zipf) < UINT64_C(1) << 50);
+		}
+	}
+
+	free(buf);
+	return true;
+}
+
+SIMPLE_TEST(random_philox_known_answers)
+{
+	// from the Random123 known answer tests
+	static const struct {
+		uint32_t counter[4];
+		uint32_t key[2];
+		uint32_t expected[4];
+	} tests[] = {
+		{{0, 0, 0, 0}, {0, 0}, {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}},
+		{{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff},
+		 {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}},
+		{{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0},
+		 {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}},
+	};
+	for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+		uint32_t out[4];
+		random_philox4x32(tests[i].key, tests[i].counter, out);
+		CHECK(memcmp(out, tests[i].expected, sizeof(out)) == 0);
+	}
+	CHECK(random_at(0, 0) == (0x6627e8d5 | (uint64_t)0xe169c58d << 32));
+	CHECK(random_at(0, 1) == (0xbc57ac4c | (uint64_t)0x9b00dbd8 << 32));
+	return true;
+}
+
+RANDOM_TEST(random_at, 4, 0, UINT64_MAX)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+	uint64_t key = random_next_u64(&rng);
+	uint64_t buf[1000];
+	for (size_t j = 0; j < 100; j++) {
+		// (counters near 2^33 cross into the second counter word)
+		uint64_t counter = random_next_u32(&rng) % 2 ? random_next_u64(&rng) : (UINT64_C(1) << 33) - 500;
+		size_t n = random_next_u32_in_range(&rng, 0, 1000);
+		random_fill_at(key, counter, buf, n);
+		for (size_t i = 0; i < n; i++) {
+			CHECK(buf[i] == random_at(key, counter + i));
+		}
+	}
+
+	const size_t N = 1 << 24;
+	double *numbers = malloc(N * sizeof(numbers[0]));
+	for (size_t i = 0; i < N; i++) {
+		numbers[i] = (random_at(key, i) >> 11) * 0x1.0p-53;
+	}
+	CHECK(check_stats(numbers, N, 0, 1));
+	free(numbers);
+	return true;
+}
+
+// 'positions[i]' is the original index of the element at position i after shuffling n elements
+static bool check_shuffled(const uint32_t *positions, size_t n)
+{
+	// a permutation, and the original indices and new positions (in 64 bins each) are independent
+	uint8_t *seen = calloc(n, 1);
+	static uint32_t counts[64][64];
+	memset(counts, 0, sizeof(counts));
+	for (size_t i = 0; i < n; i++) {
+		CHECK(positions[i] < n && !seen[positions[i]]);
+		seen[positions[i]] = 1;
+		counts[positions[i] * 64 / n][i * 64 / n]++;
+	}
+	free(seen);
+	double expected = (double)n / (64 * 64);
+	double chi2 = 0;
+	for (size_t i = 0; i < 64; i++) {
+		for (size_t j = 0; j < 64; j++) {
+			double d = counts[i][j] - expected;
+			chi2 += d * d / expected;
+		}
+	}
+	// 4095 degrees of freedom: mean 4095, standard deviation 90.5
+	CHECK(chi2 < 4095 + 6 * 90.5);
+	return true;
+}
+
+RANDOM_TEST(random_shuffle, 2, 0, UINT64_MAX)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+
+	// all 24 permutations of 4 elements are equally likely
+	const size_t M = 240000;
+	size_t counts[256] = {0};
+	for (size_t i = 0; i < M; i++) {
+		uint8_t a[4] = {0, 1, 2, 3};
+		random_shuffle(&rng, a, 4, 1);
+		counts[a[0] * 64 + a[1] * 16 + a[2] * 4 + a[3]]++;
+	}
+	size_t permutations = 0;
+	for (size_t i = 0; i < 256; i++) {
+		if (counts[i] != 0) {
+			permutations++;
+			CHECK(counts[i] > 9500 && counts[i] < 10500);
+		}
+	}
+	CHECK(permutations == 24);
+
+	// n = 2^20 goes through all the batch sizes
+	const size_t N = 1 << 20;
+	uint32_t *positions = malloc(N * sizeof(positions[0]));
+	for (size_t i = 0; i < N; i++) {
+		positions[i] = i;
+	}
+	random_shuffle(&rng, positions, N, sizeof(positions[0]));
+	CHECK(check_shuffled(positions, N));
+	for (size_t i = 0; i < N; i++) {
+		positions[i] = i;
+	}
+	random_shuffle_large(&rng, positions, N, sizeof(positions[0]));
+	CHECK(check_shuffled(positions, N));
+
+	// odd element sizes, and the large shuffle splits the buckets again
+	struct element {
+		uint32_t index;
+		uint32_t check[2];
+	};
+	const size_t N2 = 1 << 23;
+	struct element *elements = malloc(N2 * sizeof(elements[0]));
+	positions = realloc(positions, N2 * sizeof(positions[0]));
+	for (int large = 0; large < 2; large++) {
+		for (size_t i = 0; i < N2; i++) {
+			elements[i] = (struct element){i, {~i, i * 3}};
+		}
+		if (large) {
+			random_shuffle_large(&rng, elements, N2, sizeof(elements[0]));
+		} else {
+			random_shuffle(&rng, elements, N2 / 8, sizeof(elements[0]));
+		}
+		size_t n = large ? N2 : N2 / 8;
+		for (size_t i = 0; i < n; i++) {
+			uint32_t index = elements[i].index;
+			CHECK(elements[i].check[0] == ~index && elements[i].check[1] == index * 3);
+			positions[i] = index;
+		}
+		CHECK(check_shuffled(positions, n));
+	}
+	free(elements);
+	free(positions);
+	return true;
+}
@@ -4,6 +4,7 @@
 #include <string.h>
 #include <time.h>
 #include "random.h"
+#include "random_small.h"
 
 static double ns_elapsed(struct timespec start, struct timespec end)
 {
@@ -45,9 +46,13 @@ static void measure_overhead(void)
 }
 
 #define BENCHMARK(random_call)						\
+	BENCHMARK_GENERATOR(struct random_state, random_state_init(&rng, 0xdeadbeef), random_call)
+
+// 'init' initializes a state_type called rng
+#define BENCHMARK_GENERATOR(state_type, init, random_call)		\
 	do {								\
-		struct random_state rng;				\
-		random_state_init(&rng, 0xdeadbeef);			\
+		state_type rng;						\
+		init;							\
 		double times[5];					\
 		const unsigned int n = sizeof(times) / sizeof(times[0]); \
 		const unsigned int iterations = 1 << 28;		\
@@ -80,6 +85,183 @@ static void benchmark_random32_range(void)
 	BENCHMARK(random_next_u32_in_range(&rng, 0, 100));
 }
 
+static void benchmark_wyrand64(void)
+{
+	BENCHMARK_GENERATOR(struct random_wyrand, random_wyrand_init(&rng, 0xdeadbeef), random_wyrand_next_u64(&rng));
+}
+
+static void benchmark_wyrand32_range(void)
+{
+	BENCHMARK_GENERATOR(struct random_wyrand, random_wyrand_init(&rng, 0xdeadbeef),
+			    random_wyrand_next_u32_in_range(&rng, 0, 100));
+}
+
+static void benchmark_pcg32(void)
+{
+	BENCHMARK_GENERATOR(struct random_pcg32, random_pcg32_init(&rng, 0xdeadbeef, 0), random_pcg32_next_u32(&rng));
+}
+
+static void benchmark_pcg32_range(void)
+{
+	BENCHMARK_GENERATOR(struct random_pcg32, random_pcg32_init(&rng, 0xdeadbeef, 0),
+			    random_pcg32_next_u32_in_range(&rng, 0, 100));
+}
+
+static void benchmark_sfc64(void)
+{
+	BENCHMARK_GENERATOR(struct random_sfc64, random_sfc64_init(&rng, 0xdeadbeef), random_sfc64_next_u64(&rng));
+}
+
+static void benchmark_sfc64_32_range(void)
+{
+	BENCHMARK_GENERATOR(struct random_sfc64, random_sfc64_init(&rng, 0xdeadbeef),
+			    random_sfc64_next_u32_in_range(&rng, 0, 100));
+}
+
+static void benchmark_random_at(void)
+{
+	uint64_t counter = 0;
+	BENCHMARK(random_at(0xdeadbeef, counter++));
+}
+
+static void benchmark_normal(void)
+{
+	BENCHMARK((uint64_t)random_next_normal(&rng, 0, 1000));
+}
+
+static void benchmark_exponential(void)
+{
+	BENCHMARK((uint64_t)random_next_exponential(&rng, 0.001));
+}
+
+static void benchmark_zipf(void)
+{
+	struct random_zipf zipf;
+	random_zipf_init(&zipf, 1000000, 0.99);
+	BENCHMARK(random_next_zipf(&rng, &zipf));
+}
+
+static void benchmark_poisson(void)
+{
+	BENCHMARK(random_next_poisson(&rng, 50));
+}
+
+static void benchmark_binomial(void)
+{
+	BENCHMARK(random_next_binomial(&rng, 1000, 0.3));
+}
+
+// ns per value for filling a buffer of 'size' values
+#define FILL_BENCHMARK(type, size, fill_call)				\
+	do {								\
+		struct random_state rng;				\
+		random_state_init(&rng, 0xdeadbeef);			\
+		static type buf[size];					\
+		const size_t n = sizeof(buf) / sizeof(buf[0]);		\
+		double times[5];					\
+		const unsigned int k_max = sizeof(times) / sizeof(times[0]); \
+		const unsigned int iterations = (1 << 28) / (size);	\
+		for (unsigned int k = 0; k < k_max; k++) {		\
+			struct timespec start_tp, end_tp;		\
+			clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start_tp); \
+			for (unsigned int i = 0; i < iterations; i++) {	\
+				(fill_call);				\
+				asm volatile("" :: "g"(buf) : "memory"); \
+			}						\
+			clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end_tp); \
+			times[k] = (ns_elapsed(start_tp, end_tp) - overhead) / ((double)iterations * n); \
+		}							\
+		double t = get_median(times, k_max);			\
+		printf("[%s/%zu]: %16.2f ns\n", __func__ + strlen("benchmark_"), n, t); \
+	} while (0)
+
+static void benchmark_fill_u64(void)
+{
+	FILL_BENCHMARK(uint64_t, 1024, random_fill_u64(&rng, buf, n));
+	FILL_BENCHMARK(uint64_t, 1 << 16, random_fill_u64(&rng, buf, n));
+}
+
+static void benchmark_fill_u32(void)
+{
+	FILL_BENCHMARK(uint32_t, 1 << 16, random_fill_u32(&rng, buf, n));
+}
+
+static void benchmark_fill_double(void)
+{
+	FILL_BENCHMARK(double, 1 << 16, random_fill_double(&rng, buf, n));
+}
+
+static void benchmark_fill_u32_range(void)
+{
+	FILL_BENCHMARK(uint32_t, 1 << 16, random_fill_u32_in_range(&rng, buf, n, 0, 100));
+}
+
+static void benchmark_fill_u64_range(void)
+{
+	FILL_BENCHMARK(uint64_t, 1 << 16, random_fill_u64_in_range(&rng, buf, n, 0, 100));
+}
+
+static void benchmark_fill_at(void)
+{
+	uint64_t counter = 0;
+	FILL_BENCHMARK(uint64_t, 1 << 16, (random_fill_at(0xdeadbeef, counter, buf, n), counter += n));
+}
+
+static void benchmark_fill_normal(void)
+{
+	FILL_BENCHMARK(double, 1 << 16, random_fill_normal(&rng, buf, n, 0, 1));
+}
+
+static void benchmark_fill_exponential(void)
+{
+	FILL_BENCHMARK(double, 1 << 16, random_fill_exponential(&rng, buf, n, 1));
+}
+
+static void benchmark_fill_zipf(void)
+{
+	struct random_zipf zipf;
+	random_zipf_init(&zipf, 1000000, 0.99);
+	FILL_BENCHMARK(uint64_t, 1 << 16, random_fill_zipf(&rng, &zipf, buf, n));
+}
+
+static void benchmark_fill_poisson(void)
+{
+	FILL_BENCHMARK(uint64_t, 1 << 16, random_fill_poisson(&rng, buf, n, 50));
+}
+
+static void benchmark_fill_binomial(void)
+{
+	FILL_BENCHMARK(uint64_t, 1 << 16, random_fill_binomial(&rng, buf, n, 1000, 0.3));
+}
+
+// what array_shuffle does (a modulo per element)
+static void shuffle_modulo(struct random_state *state, uint32_t *a, size_t n)
+{
+	for (size_t i = n - 1; i > 0; i--) {
+		size_t j = random_next_u64(state) % (i + 1);
+		uint32_t tmp = a[i];
+		a[i] = a[j];
+		a[j] = tmp;
+	}
+}
+
+static void benchmark_shuffle_modulo(void)
+{
+	FILL_BENCHMARK(uint32_t, 1 << 16, shuffle_modulo(&rng, buf, n));
+	FILL_BENCHMARK(uint32_t, 1 << 27, shuffle_modulo(&rng, buf, n));
+}
+
+static void benchmark_shuffle(void)
+{
+	FILL_BENCHMARK(uint32_t, 1 << 16, random_shuffle(&rng, buf, n, sizeof(buf[0])));
+	FILL_BENCHMARK(uint32_t, 1 << 27, random_shuffle(&rng, buf, n, sizeof(buf[0])));
+}
+
+static void benchmark_shuffle_large(void)
+{
+	FILL_BENCHMARK(uint32_t, 1 << 27, random_shuffle_large(&rng, buf, n, sizeof(buf[0])));
+}
+
 int main(int argc, char **argv)
 {
 	measure_overhead();
@@ -87,4 +269,30 @@ int main(int argc, char **argv)
 	benchmark_random64();
 	benchmark_random64_range();
 	benchmark_random32_range();
+	benchmark_wyrand64();
+	benchmark_wyrand32_range();
+	benchmark_pcg32();
+	benchmark_pcg32_range();
+	benchmark_sfc64();
+	benchmark_sfc64_32_range();
+	benchmark_fill_u64();
+	benchmark_fill_u32();
+	benchmark_fill_double();
+	benchmark_fill_u32_range();
+	benchmark_fill_u64_range();
+	benchmark_random_at();
+	benchmark_fill_at();
+	benchmark_normal();
+	benchmark_exponential();
+	benchmark_zipf();
+	benchmark_poisson();
+	benchmark_binomial();
+	benchmark_fill_normal();
+	benchmark_fill_exponential();
+	benchmark_fill_zipf();
+	benchmark_fill_poisson();
+	benchmark_fill_binomial();
+	benchmark_shuffle_modulo();
+	benchmark_shuffle();
+	benchmark_shuffle_large();
 }
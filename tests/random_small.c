@@ -0,0 +1,94 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "random_small.h"
+#include "testing.h"
+
+SIMPLE_TEST(random_pcg32_known_answers)
+{
+	// from pcg32-demo (seed 42, stream 54)
+	static const uint32_t expected[] = {0xa15c02b7, 0x7b47f409, 0xba1d3330, 0x83d2f293, 0xbfa4784b, 0xcbed606e};
+	struct random_pcg32 rng;
+	random_pcg32_init(&rng, 42, 54);
+	for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+		CHECK(random_pcg32_next_u32(&rng) == expected[i]);
+	}
+	CHECK(sizeof(struct random_wyrand) == 8);
+	CHECK(sizeof(struct random_pcg32) == 16);
+	return true;
+}
+
+static bool check_mean(double sum, size_t n, double min, double max)
+{
+	// within 5 standard deviations of a uniform distribution
+	double mean = sum / n;
+	double expected = (min + max) / 2;
+	double stddev = (max - min) / sqrt(12.0 * n);
+	CHECK(fabs(mean - expected) <= 5 * stddev);
+	return true;
+}
+
+#define CHECK_GENERATOR(name, ...)					\
+	do {								\
+		struct name rng;					\
+		name##_init(&rng, __VA_ARGS__);				\
+		const size_t n = 1 << 20;				\
+		double sum_u64 = 0, sum_u32 = 0, sum_double = 0, sum_float = 0; \
+		double sum_range32 = 0, sum_range64 = 0, sum_drange = 0; \
+		size_t ntrue = 0;					\
+		for (size_t i = 0; i < n; i++) {			\
+			sum_u64 += name##_next_u64(&rng);		\
+			sum_u32 += name##_next_u32(&rng);		\
+			double d = name##_next_uniform_double(&rng);	\
+			CHECK(d >= 0 && d < 1);				\
+			sum_double += d;				\
+			float f = name##_next_uniform_float(&rng);	\
+			CHECK(f >= 0 && f < 1);				\
+			sum_float += f;					\
+			uint32_t x32 = name##_next_u32_in_range(&rng, 10, 110); \
+			CHECK(x32 >= 10 && x32 <= 110);			\
+			sum_range32 += x32;				\
+			uint64_t x64 = name##_next_u64_in_range(&rng, UINT64_C(1) << 40, (UINT64_C(1) << 40) + 1000); \
+			CHECK(x64 >= UINT64_C(1) << 40 && x64 <= (UINT64_C(1) << 40) + 1000); \
+			sum_range64 += x64 - (UINT64_C(1) << 40);	\
+			double dr = name##_next_double_in_range(&rng, -3, 5); \
+			CHECK(dr >= -3 && dr < 5);			\
+			sum_drange += dr;				\
+			float fr = name##_next_float_in_range(&rng, 2, 4); \
+			CHECK(fr >= 2 && fr <= 4);			\
+			ntrue += name##_next_bool(&rng);		\
+		}							\
+		CHECK(check_mean(sum_u64, n, 0, (double)UINT64_MAX));	\
+		CHECK(check_mean(sum_u32, n, 0, UINT32_MAX));		\
+		CHECK(check_mean(sum_double, n, 0, 1));			\
+		CHECK(check_mean(sum_float, n, 0, 1));			\
+		/* (discrete uniform variance is ((b - a + 1)^2 - 1) / 12) */ \
+		CHECK(check_mean(sum_range32, n, 9.5, 110.5));		\
+		CHECK(check_mean(sum_range64, n, -0.5, 1000.5));	\
+		CHECK(check_mean(sum_drange, n, -3, 5));		\
+		CHECK(check_mean(ntrue, n, -0.5, 1.5));			\
+		CHECK(name##_next_u32_in_range(&rng, 7, 7) == 7);	\
+		CHECK(name##_next_u64_in_range(&rng, 0, UINT64_MAX) != name##_next_u64_in_range(&rng, 0, UINT64_MAX)); \
+	} while (0)
+
+RANDOM_TEST(random_small_generators, 2, 0, UINT64_MAX)
+{
+	CHECK_GENERATOR(random_wyrand, random);
+	CHECK_GENERATOR(random_pcg32, random, random >> 7);
+	CHECK_GENERATOR(random_sfc64, random);
+	return true;
+}
+
+RANDOM_TEST(random_pcg32_streams, 2, 0, UINT64_MAX)
+{
+	// the same seed on different streams gives unrelated sequences
+	struct random_pcg32 a, b;
+	random_pcg32_init(&a, random, 1);
+	random_pcg32_init(&b, random, 2);
+	size_t equal = 0;
+	for (size_t i = 0; i < 1000; i++) {
+		equal += random_pcg32_next_u32(&a) == random_pcg32_next_u32(&b);
+	}
+	CHECK(equal < 5);
+	return true;
+}
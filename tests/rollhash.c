@@ -0,0 +1,219 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dbuf.h"
+#include "dstring.h"
+#include "random.h"
+#include "rollhash.h"
+#include "testing.h"
+
+static void random_bytes(struct random_state *rng, unsigned char *buf, size_t size)
+{
+	for (size_t i = 0; i < size; i++) {
+		buf[i] = (unsigned char)random_next_u32(rng);
+	}
+}
+
+RANDOM_TEST(rolling_hashes, 1 << 8, 1, 200)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+	size_t window = random % 100 + 1;
+	unsigned char data[512];
+	random_bytes(&rng, data, sizeof(data));
+
+	struct rabin_karp rk;
+	struct buzhash bh;
+	rabin_karp_init(&rk, window);
+	buzhash_init(&bh, window);
+	uint64_t gh = 0;
+	for (size_t i = 0; i < window; i++) {
+		rabin_karp_push(&rk, data[i]);
+		buzhash_push(&bh, data[i]);
+		gh = gearhash_push(gh, data[i]);
+	}
+	CHECK(rk.hash == rabin_karp_hash(data, window));
+	CHECK(bh.hash == buzhash_hash(data, window));
+	CHECK(gh == gearhash_hash(data, window));
+	for (size_t i = window; i < sizeof(data); i++) {
+		rabin_karp_roll(&rk, data[i - window], data[i]);
+		buzhash_roll(&bh, data[i - window], data[i]);
+		gh = gearhash_push(gh, data[i]);
+		CHECK(rk.hash == rabin_karp_hash(data + i + 1 - window, window));
+		CHECK(bh.hash == buzhash_hash(data + i + 1 - window, window));
+		// only the last 64 bytes matter
+		CHECK(gh == gearhash_hash(data + (i + 1 > 64 ? i + 1 - 64 : 0), i + 1 > 64 ? 64 : i + 1));
+	}
+	return true;
+}
+
+SIMPLE_TEST(cdc_init)
+{
+	struct cdc_chunker chunker;
+	CHECK(cdc_init(&chunker, CDC_GEAR, 2048, 8192, 65536));
+	CHECK(cdc_init(&chunker, CDC_BUZHASH, 64, 64, 64));
+	CHECK(!cdc_init(&chunker, CDC_GEAR, 32, 8192, 65536));
+	CHECK(!cdc_init(&chunker, CDC_GEAR, 8192, 2048, 65536));
+	CHECK(!cdc_init(&chunker, CDC_GEAR, 2048, 8192, 4096));
+	CHECK(!cdc_init(&chunker, (enum cdc_algorithm)42, 2048, 8192, 65536));
+	return true;
+}
+
+// the straightforward FastCDC loop, one byte per step
+static size_t reference_gear_chunk(const unsigned char *p, size_t len, size_t min_size, size_t avg_size,
+				   size_t max_size)
+{
+	if (len <= min_size) {
+		return len;
+	}
+	unsigned int bits = 0;
+	while (((size_t)2 << bits) <= avg_size) {
+		bits++;
+	}
+	uint64_t mask_small = ((UINT64_C(1) << (bits + 2)) - 1) << (62 - (bits + 2));
+	uint64_t mask_large = ((UINT64_C(1) << (bits - 2)) - 1) << (62 - (bits - 2));
+	size_t end = len < max_size ? len : max_size;
+	size_t normal_size = (size_t)1 << bits;
+	normal_size = normal_size < end ? normal_size : end;
+	normal_size = normal_size > min_size ? normal_size : min_size;
+	uint64_t hash = gearhash_hash(p + min_size - 64, 64);
+	if (!(hash & (min_size < normal_size ? mask_small : mask_large))) {
+		return min_size;
+	}
+	for (size_t i = min_size; i < end; i++) {
+		hash = gearhash_push(hash, p[i]);
+		if (!(hash & (i < normal_size ? mask_small : mask_large))) {
+			return i + 1;
+		}
+	}
+	return end;
+}
+
+RANDOM_TEST(cdc_gear_reference, 1 << 6, 0, UINT64_MAX)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+	size_t min_size = 64 + random_next_u32(&rng) % 512;
+	size_t avg_size = min_size + random_next_u32(&rng) % 2048;
+	size_t max_size = avg_size + random_next_u32(&rng) % 8192;
+	struct cdc_chunker chunker;
+	CHECK(cdc_init(&chunker, CDC_GEAR, min_size, avg_size, max_size));
+	size_t size = 1 << 16;
+	unsigned char *data = malloc(size);
+	random_bytes(&rng, data, size);
+	for (size_t offset = 0; offset < size;) {
+		size_t length = cdc_next_chunk(&chunker, data + offset, size - offset);
+		CHECK(length == reference_gear_chunk(data + offset, size - offset, min_size, avg_size, max_size));
+		offset += length;
+	}
+	free(data);
+	return true;
+}
+
+static const enum cdc_algorithm algorithms[] = {CDC_GEAR, CDC_BUZHASH, CDC_RABIN_KARP};
+
+SIMPLE_TEST(cdc_chunk_sizes)
+{
+	struct random_state rng;
+	random_state_init(&rng, 1234);
+	size_t size = 1 << 24;
+	unsigned char *data = malloc(size);
+	random_bytes(&rng, data, size);
+	for (size_t a = 0; a < sizeof(algorithms) / sizeof(algorithms[0]); a++) {
+		struct cdc_chunker chunker;
+		CHECK(cdc_init(&chunker, algorithms[a], 2048, 8192, 65536));
+		size_t num_chunks = 0;
+		size_t end = 0;
+		for (struct cdc_iterator iter = cdc_iter_start(&chunker, data, size, true);
+		     !cdc_iter_finished(&iter); cdc_iter_advance(&iter)) {
+			CHECK(iter.offset == end);
+			CHECK(iter.length <= 65536);
+			CHECK(iter.length >= 2048 || iter.offset + iter.length == size);
+			end = iter.offset + iter.length;
+			num_chunks++;
+		}
+		CHECK(end == size);
+		size_t avg = size / num_chunks;
+		CHECK(avg > 8192 / 2 && avg < 8192 * 2);
+	}
+	free(data);
+	return true;
+}
+
+// chunks after an edit are the same as before (that is the point of content-defined chunking)
+SIMPLE_TEST(cdc_shift_resistance)
+{
+	struct random_state rng;
+	random_state_init(&rng, 5678);
+	size_t size = 1 << 20;
+	unsigned char *data = malloc(size + 100);
+	random_bytes(&rng, data, size + 100);
+	for (size_t a = 0; a < sizeof(algorithms) / sizeof(algorithms[0]); a++) {
+		struct cdc_chunker chunker;
+		CHECK(cdc_init(&chunker, algorithms[a], 1024, 4096, 16384));
+		// chunks of data[100:] and data[0:] (the same data with 100 bytes inserted at the front)
+		size_t ends[1024];
+		size_t num_ends = 0;
+		for (struct cdc_iterator iter = cdc_iter_start(&chunker, data + 100, size, true);
+		     !cdc_iter_finished(&iter); cdc_iter_advance(&iter)) {
+			CHECK(num_ends < 1024);
+			ends[num_ends++] = 100 + iter.offset + iter.length;
+		}
+		size_t shared = 0;
+		size_t k = 0;
+		for (struct cdc_iterator iter = cdc_iter_start(&chunker, data, size + 100, true);
+		     !cdc_iter_finished(&iter); cdc_iter_advance(&iter)) {
+			size_t end = iter.offset + iter.length;
+			while (k < num_ends && ends[k] < end) {
+				k++;
+			}
+			shared += k < num_ends && ends[k] == end;
+		}
+		CHECK(shared + 3 >= num_ends);
+	}
+	free(data);
+	return true;
+}
+
+RANDOM_TEST(cdc_streaming, 1 << 4, 0, UINT64_MAX)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+	size_t size = 1 << 18;
+	unsigned char *data = malloc(size);
+	random_bytes(&rng, data, size);
+	enum cdc_algorithm algorithm = algorithms[random % 3];
+	struct cdc_chunker chunker;
+	CHECK(cdc_init(&chunker, algorithm, 256, 1024, 4096));
+
+	size_t *lengths = malloc(size * sizeof(lengths[0]));
+	size_t num_chunks = 0;
+	for (struct cdc_iterator iter = cdc_iter_start_view(&chunker, strview_from_chars((const char *)data, size));
+	     !cdc_iter_finished(&iter); cdc_iter_advance(&iter)) {
+		lengths[num_chunks++] = iter.length;
+	}
+
+	// feed the same data in random pieces through a stream buffer
+	struct dbuf dbuf = DBUF_INITIALIZER;
+	size_t k = 0;
+	for (size_t fed = 0; fed < size;) {
+		size_t n = random_next_u32(&rng) % 10000;
+		n = n < size - fed ? n : size - fed;
+		dbuf_add_buf(&dbuf, data + fed, n);
+		fed += n;
+		struct cdc_iterator iter = cdc_iter_start_dbuf(&chunker, &dbuf, fed == size);
+		for (; !cdc_iter_finished(&iter); cdc_iter_advance(&iter)) {
+			CHECK(k < num_chunks && iter.length == lengths[k]);
+			k++;
+		}
+		char *buf = dbuf_buffer(&dbuf);
+		memmove(buf, buf + iter.offset, dbuf_size(&dbuf) - iter.offset);
+		dbuf_truncate(&dbuf, dbuf_size(&dbuf) - iter.offset);
+	}
+	CHECK(k == num_chunks);
+	CHECK(dbuf_size(&dbuf) == 0);
+	dbuf_destroy(&dbuf);
+	free(lengths);
+	free(data);
+	return true;
+}
@@ -0,0 +1,217 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "random.h"
+#include "sampling.h"
+#include "testing.h"
+
+// |observed - expected| within 5 standard deviations of a binomial count
+static bool check_frequency(size_t count, size_t total, double p)
+{
+	double expected = p * total;
+	double stddev = sqrt(total * p * (1 - p));
+	return fabs(count - expected) <= 5 * stddev + 1e-9;
+}
+
+RANDOM_TEST(alias_table, 4, 0, UINT64_MAX)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+
+	const size_t n = 1 + random % 100;
+	double *weights = malloc(n * sizeof(weights[0]));
+	double sum = 0;
+	for (size_t i = 0; i < n; i++) {
+		// some zero weights and a wide range of magnitudes
+		double magnitude = random_next_double_in_range(&rng, -5, 5);
+		weights[i] = random_next_u32_in_range(&rng, 0, 3) == 0 ? 0 : exp(magnitude);
+		sum += weights[i];
+	}
+	if (sum == 0) {
+		weights[0] = 1;
+		sum = 1;
+	}
+	struct alias_table table;
+	alias_table_init(&table, weights, n);
+	CHECK(alias_table_size(&table) == n);
+
+	const size_t N = 1 << 21;
+	size_t *counts = calloc(n, sizeof(counts[0]));
+	for (size_t i = 0; i < N; i++) {
+		size_t x = alias_table_sample(&table, &rng);
+		CHECK(x < n);
+		counts[x]++;
+	}
+	uint64_t *samples = malloc(N * sizeof(samples[0]));
+	alias_table_sample_many(&table, &rng, samples, N);
+	for (size_t i = 0; i < N; i++) {
+		CHECK(samples[i] < n);
+		counts[samples[i]]++;
+	}
+	for (size_t i = 0; i < n; i++) {
+		CHECK(weights[i] != 0 || counts[i] == 0);
+		CHECK(check_frequency(counts[i], 2 * N, weights[i] / sum));
+	}
+
+	alias_table_destroy(&table);
+	free(samples);
+	free(counts);
+	free(weights);
+	return true;
+}
+
+SIMPLE_TEST(alias_table_degenerate)
+{
+	struct random_state rng;
+	random_state_init(&rng, 0);
+	struct alias_table table;
+	double one = 3.0;
+	alias_table_init(&table, &one, 1);
+	for (size_t i = 0; i < 1000; i++) {
+		CHECK(alias_table_sample(&table, &rng) == 0);
+	}
+	alias_table_destroy(&table);
+
+	double weights[] = {0, 0, 1, 0};
+	alias_table_init(&table, weights, 4);
+	for (size_t i = 0; i < 1000; i++) {
+		CHECK(alias_table_sample(&table, &rng) == 2);
+	}
+	alias_table_destroy(&table);
+	return true;
+}
+
+RANDOM_TEST(reservoir, 4, 0, UINT64_MAX)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+
+	// every item ends up in the sample with probability k / n
+	const size_t k = 10, n = 200, trials = 40000;
+	size_t counts[200] = {0};
+	size_t slots[10];
+	for (size_t trial = 0; trial < trials; trial++) {
+		struct reservoir reservoir;
+		reservoir_init(&reservoir, k);
+		for (size_t i = 0; i < n; i++) {
+			CHECK(reservoir_seen(&reservoir) == i);
+			CHECK(reservoir_next(&reservoir) >= i);
+			size_t slot = reservoir_offer(&reservoir, &rng);
+			if (i < k) {
+				CHECK(slot == i);
+			}
+			if (slot != RESERVOIR_SKIP) {
+				CHECK(slot < k);
+				slots[slot] = i;
+			}
+		}
+		CHECK(reservoir_size(&reservoir) == k);
+		for (size_t i = 0; i < k; i++) {
+			counts[slots[i]]++;
+		}
+	}
+	for (size_t i = 0; i < n; i++) {
+		CHECK(check_frequency(counts[i], trials, (double)k / n));
+	}
+
+	// skipping ahead gives the same sample as offering every item
+	struct random_state rng1 = rng, rng2 = rng;
+	struct reservoir r1, r2;
+	reservoir_init(&r1, 100);
+	reservoir_init(&r2, 100);
+	size_t sample1[100], sample2[100];
+	for (uint64_t i = 0; i < 1000000; i++) {
+		size_t slot = reservoir_offer(&r1, &rng1);
+		if (slot != RESERVOIR_SKIP) {
+			sample1[slot] = i;
+		}
+	}
+	while (reservoir_seen(&r2) < 1000000) {
+		uint64_t next = reservoir_next(&r2);
+		if (next >= 1000000) {
+			reservoir_skip(&r2, 1000000 - reservoir_seen(&r2));
+			break;
+		}
+		reservoir_skip(&r2, next - reservoir_seen(&r2));
+		size_t slot = reservoir_offer(&r2, &rng2);
+		CHECK(slot != RESERVOIR_SKIP);
+		sample2[slot] = next;
+	}
+	CHECK(memcmp(sample1, sample2, sizeof(sample1)) == 0);
+
+	struct reservoir empty;
+	reservoir_init(&empty, 0);
+	for (size_t i = 0; i < 100; i++) {
+		CHECK(reservoir_offer(&empty, &rng) == RESERVOIR_SKIP);
+	}
+	CHECK(reservoir_size(&empty) == 0);
+	return true;
+}
+
+RANDOM_TEST(weighted_reservoir, 4, 0, UINT64_MAX)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+
+	// with a single slot, item i is picked with probability weights[i] / sum(weights)
+	const size_t n = 50, trials = 100000;
+	double weights[50];
+	double sum = 0;
+	for (size_t i = 0; i < n; i++) {
+		weights[i] = i % 7 == 3 ? 0 : random_next_double_in_range(&rng, 0.1, 10);
+		sum += weights[i];
+	}
+	size_t counts[50] = {0};
+	for (size_t trial = 0; trial < trials; trial++) {
+		struct weighted_reservoir reservoir;
+		weighted_reservoir_init(&reservoir, 1);
+		size_t picked = SIZE_MAX;
+		for (size_t i = 0; i < n; i++) {
+			size_t slot = weighted_reservoir_offer(&reservoir, &rng, weights[i]);
+			if (slot != RESERVOIR_SKIP) {
+				CHECK(slot == 0);
+				picked = i;
+			}
+		}
+		CHECK(picked < n);
+		counts[picked]++;
+		weighted_reservoir_destroy(&reservoir);
+	}
+	for (size_t i = 0; i < n; i++) {
+		CHECK(check_frequency(counts[i], trials, weights[i] / sum));
+	}
+
+	// with k slots (sampling without replacement), two items of equal weight are just as likely and heavier items
+	// are more likely, items with weight 0 never get in
+	const size_t k = 5;
+	size_t heavy = 0, light_a = 0, light_b = 0;
+	for (size_t trial = 0; trial < trials / 10; trial++) {
+		struct weighted_reservoir reservoir;
+		weighted_reservoir_init(&reservoir, k);
+		size_t slots[5];
+		for (size_t i = 0; i < 1000; i++) {
+			double weight = i == 10 ? 50.0 : (i % 2 ? 1.0 : 0.0);
+			size_t slot = weighted_reservoir_offer(&reservoir, &rng, weight);
+			if (slot != RESERVOIR_SKIP) {
+				CHECK(slot < k && weight != 0);
+				slots[slot] = i;
+			}
+		}
+		CHECK(weighted_reservoir_size(&reservoir) == k);
+		for (size_t i = 0; i < k; i++) {
+			heavy += slots[i] == 10;
+			light_a += slots[i] == 11;
+			light_b += slots[i] == 999;
+		}
+		weighted_reservoir_destroy(&reservoir);
+	}
+	// the heavy item has 50 of the total weight of 550 and every draw before it removes a light item
+	double p_missed = 1;
+	for (size_t j = 0; j < k; j++) {
+		p_missed *= 1 - 50.0 / (550 - j);
+	}
+	CHECK(check_frequency(heavy, trials / 10, 1 - p_missed));
+	CHECK(fabs((double)light_a - light_b) < 0.25 * (light_a + light_b) + 10);
+	return true;
+}
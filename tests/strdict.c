@@ -0,0 +1,143 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "array.h"
+#include "dstring.h"
+#include "random.h"
+#include "strdict.h"
+#include "testing.h"
+
+static int compare_views(const void *a, const void *b)
+{
+	return strview_compare(*(const struct strview *)a, *(const struct strview *)b);
+}
+
+// random strings over a tiny alphabet with lots of shared prefixes (and strings that are prefixes of others)
+static array_t(struct strview) random_strings(struct random_state *rng, size_t n, char *storage, size_t max_length)
+{
+	array_t(struct strview) strings = NULL;
+	for (size_t i = 0; i < n; i++) {
+		char *s = storage + i * max_length;
+		size_t length = random_next_u32(rng) % (max_length + 1);
+		for (size_t j = 0; j < length; j++) {
+			s[j] = "ab\x80/"[random_next_u32(rng) % 4];
+		}
+		array_add(strings, strview_from_chars(s, length));
+	}
+	qsort(strings, array_length(strings), sizeof(strings[0]), compare_views);
+	size_t unique = 0;
+	for (size_t i = 0; i < array_length(strings); i++) {
+		if (unique == 0 || !strview_equal(strings[unique - 1], strings[i])) {
+			strings[unique++] = strings[i];
+		}
+	}
+	array_truncate(strings, unique);
+	return strings;
+}
+
+SIMPLE_TEST(strdict_basic)
+{
+	const char *words[] = {"", "http://a.com/", "http://a.com/x", "http://a.com/xy", "http://b.org", "z"};
+	struct strview views[sizeof(words) / sizeof(words[0])];
+	for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+		views[i] = strview_from_cstr(words[i]);
+	}
+	struct strdict dict;
+	CHECK(strdict_init(&dict, views, 6));
+	CHECK(strdict_size(&dict) == 6);
+	for (size_t i = 0; i < 6; i++) {
+		CHECK(strdict_lookup(&dict, views[i]) == i);
+		dstr_t s = strdict_extract(&dict, i);
+		CHECK(dstr_equal_cstr(s, words[i]));
+		dstr_free(&s);
+	}
+	CHECK(strdict_lookup(&dict, strview_from_cstr("http://a.com")) == STRDICT_NOT_FOUND);
+	CHECK(strdict_rank(&dict, strview_from_cstr("http://a.com")) == 1);
+	CHECK(strdict_rank(&dict, strview_from_cstr("zz")) == 6);
+	size_t first, last;
+	strdict_prefix_range(&dict, strview_from_cstr("http://a.com/"), &first, &last);
+	CHECK(first == 1 && last == 4);
+	strdict_prefix_range(&dict, strview_from_cstr("http://c"), &first, &last);
+	CHECK(first == last);
+	strdict_destroy(&dict);
+
+	CHECK(!strdict_init(&dict, (struct strview[]){views[1], views[1]}, 2));
+	CHECK(!strdict_init(&dict, (struct strview[]){views[2], views[1]}, 2));
+	CHECK(strdict_size(&dict) == 0);
+	CHECK(strdict_lookup(&dict, views[0]) == STRDICT_NOT_FOUND);
+	strdict_destroy(&dict);
+	return true;
+}
+
+RANDOM_TEST(strdict_random, 32, 0, UINT64_MAX)
+{
+	struct random_state rng;
+	random_state_init(&rng, random);
+	size_t max_length = 1 + random_next_u32(&rng) % 12;
+	size_t n = random_next_u32(&rng) % 1000;
+	char *storage = malloc(2 * n * max_length + 1);
+	array_t(struct strview) strings = random_strings(&rng, n, storage, max_length);
+	array_t(struct strview) queries = random_strings(&rng, n, storage + n * max_length, max_length);
+	size_t count = array_length(strings);
+
+	struct strdict dict;
+	CHECK(strdict_init(&dict, strings, count));
+	CHECK(strdict_size(&dict) == count);
+	dstr_t s = dstr_new();
+	for (size_t i = 0; i < count; i++) {
+		CHECK(strdict_lookup(&dict, strings[i]) == i);
+		CHECK(strdict_rank(&dict, strings[i]) == i);
+		strdict_extract_into(&dict, i, &s);
+		CHECK(dstr_equal_view(s, strings[i]));
+	}
+	dstr_free(&s);
+
+	for (size_t q = 0; q < array_length(queries); q++) {
+		struct strview query = queries[q];
+		size_t rank = 0;
+		size_t found = STRDICT_NOT_FOUND;
+		size_t first = count, last = 0;
+		for (size_t i = 0; i < count; i++) {
+			int c = strview_compare(strings[i], query);
+			rank += c < 0;
+			if (c == 0) {
+				found = i;
+			}
+			if (strview_startswith(strings[i], query)) {
+				first = first < i ? first : i;
+				last = i + 1;
+			}
+		}
+		CHECK(strdict_lookup(&dict, query) == found);
+		CHECK(strdict_rank(&dict, query) == rank);
+		size_t dict_first, dict_last;
+		strdict_prefix_range(&dict, query, &dict_first, &dict_last);
+		if (first == count) {
+			CHECK(dict_first == dict_last);
+			continue;
+		}
+		CHECK(dict_first == first && dict_last == last);
+		size_t id = first;
+		for (struct strdict_iterator iter = strdict_iter_start(&dict, first, last);
+		     !strdict_iter_finished(&iter); strdict_iter_advance(&iter)) {
+			CHECK(iter.id == id);
+			CHECK(strview_equal(iter.string, strings[id]));
+			id++;
+		}
+		CHECK(id == last);
+	}
+
+	// iterators that are stopped early
+	if (count > 0) {
+		size_t first = random_next_u32(&rng) % count;
+		struct strdict_iterator iter = strdict_iter_start(&dict, first, count);
+		CHECK(!strdict_iter_finished(&iter) && strview_equal(iter.string, strings[first]));
+		strdict_iter_destroy(&iter);
+	}
+
+	strdict_destroy(&dict);
+	array_free(strings);
+	array_free(queries);
+	free(storage);
+	return true;
+}